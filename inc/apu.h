@@ -0,0 +1,90 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef APU_H
+#define APU_H
+
+// Included by gb.h, as the APU state is part of the gb struct
+typedef struct gameBoy gameBoy_t;
+// Lock-free ring buffer samples are pushed into (see ring.h)
+typedef struct ring ring_t;
+
+// Registers. Each channel has 5 (NRx0-NRx4), though not all of them are used
+#define APU_REG_NR10 		0xFF10 // Channel 1 sweep
+#define APU_REG_NR11 		0xFF11 // Channel 1 duty and length
+#define APU_REG_NR12 		0xFF12 // Channel 1 envelope
+#define APU_REG_NR13 		0xFF13 // Channel 1 frequency, low 8 bits
+#define APU_REG_NR14 		0xFF14 // Channel 1 trigger, length enable and frequency, high 3 bits
+#define APU_REG_NR30 		0xFF1A // Channel 3 DAC enable
+#define APU_REG_NR50 		0xFF24 // Left/right master volume
+#define APU_REG_NR51 		0xFF25 // Which channels go to the left/right outputs
+#define APU_REG_NR52 		0xFF26 // Power, and which channels are on
+#define APU_ADDR_WAVE 		0xFF30 // Wave RAM: 32 4-bit samples for channel 3, high nibble first
+#define APU_ADDR_END 		0xFF3F
+
+// NRx4 bits
+#define APU_NRX4_TRIGGER 	(1 << 7)
+#define APU_NRX4_LENGTH 	(1 << 6)
+// NR52 bits
+#define APU_NR52_POWER 		(1 << 7)
+
+#define APU_NUM_OF_CHANNELS 	4
+#define APU_CHANNEL_SQUARE1 	0
+#define APU_CHANNEL_SQUARE2 	1
+#define APU_CHANNEL_WAVE 	2
+#define APU_CHANNEL_NOISE 	3
+
+// Output sample rate in Hz. Samples are stereo, left first
+#define APU_SAMPLE_RATE 	48000
+// The frame sequencer (length counters, envelopes, sweep) steps at 512Hz. Samples are handed out on each step
+#define APU_FRAME_SEQ_CYCLES 	8192
+
+// Band-limited steps: each level change is spread over APU_BLEP_TAPS output samples, with the kernel picked out of
+// APU_BLEP_PHASES by where between two samples the change falls
+#define APU_BLEP_TAPS 		16
+#define APU_BLEP_PHASES 	32
+// Fixed point fraction bits of the kernel. Each phase adds up to exactly 1 << APU_BLEP_BITS
+#define APU_BLEP_BITS 		15
+// Samples buffered between two frame sequencer steps. A step is ~94 samples apart
+#define APU_BUFFER_SAMPLES 	256
+
+typedef struct
+{
+	bool enabled;
+	uint64_t next; 		// Cycle count the channel's timer next moves the waveform on at
+	uint16_t length; 	// Length counter. The channel is turned off once it counts down to 0
+	uint8_t volume; 	// Envelope volume (unused by the wave channel)
+	uint8_t envelopeTimer;
+	uint8_t position; 	// Duty step (square), sample index (wave)
+	uint16_t lfsr; 		// Noise only
+	int32_t level[2]; 	// Left/right level last output, which level changes are added to the buffers relative to
+} apuChannel_t;
+
+// Channel state only changes on register writes and frame sequencer steps. Waveforms are rendered up to the CPU
+// from the cycle counts the channels' timers are due at, whenever either happens (see apuSync)
+typedef struct
+{
+	uint8_t frameStep; 	// Frame sequencer step (0-7) run next
+	apuChannel_t channels[APU_NUM_OF_CHANNELS];
+	// Channel 1 frequency sweep
+	uint16_t sweepShadow;
+	uint8_t sweepTimer;
+	bool sweepEnabled;
+	// Output. Level changes are added to buffer as band-limited steps, relative to where sample 0 of the buffer is
+	// due. offset is the 32.32 fixed point sample position of cycle count timeBase
+	ring_t* output; 	// NULL to keep channel state up to date without synthesising anything
+	uint64_t timeBase;
+	uint64_t offset;
+	int32_t buffer[2][APU_BUFFER_SAMPLES + APU_BLEP_TAPS];
+	int32_t integrator[2]; 	// Running sum of buffer, i.e. the output level, less what the high-pass filter removed
+} apu_t;
+
+// Function prototypes
+void apuInit(gameBoy_t* gb);
+void apuSetOutput(gameBoy_t* gb, ring_t* output);
+void apuSync(gameBoy_t* gb);
+void apuEvent(gameBoy_t* gb);
+uint8_t apuRead(gameBoy_t* gb, uint16_t addr);
+void apuWrite(gameBoy_t* gb, uint16_t addr, uint8_t value);
+
+#endif // APU_H
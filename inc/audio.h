@@ -0,0 +1,15 @@
+#include <stdint.h>
+#include "ring.h"
+
+#ifndef AUDIO_H
+#define AUDIO_H
+
+// Size of the ring buffer between the emulation thread and the audio callback, in samples (~85ms of 48kHz stereo)
+#define AUDIO_RING_SAMPLES 	8192
+// Sample frames the audio device asks for at a time (~10ms)
+#define AUDIO_DEVICE_FRAMES 	512
+
+int audioInit(ring_t* ring);
+void audioDeinit(void);
+
+#endif // AUDIO_H
@@ -0,0 +1,139 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "gb.h"
+#include "cart.h"
+
+#ifndef BLOCK_H
+#define BLOCK_H
+
+// Number of entries in the (direct-mapped) block cache. Must be a power of 2
+#define BLOCK_CACHE_SIZE 	    4096
+// Longest run of instructions decoded into a single block
+#define BLOCK_MAX_INSTRUCTIONS  32
+// Blocks starting at or above this address live in RAM and can be overwritten
+#define BLOCK_RAM_START 	    0x8000
+// Code isn't cached from OAM and the I/O registers (0xFE00-0xFF7F), as LY, STAT, DIV, P1, etc. change without being
+// written, so codeMap would never see their blocks go stale. Starts early enough to cover instructions reaching into it
+#define BLOCK_UNCACHED_START 	0xFDFE
+#define BLOCK_UNCACHED_END 	    0xFF80
+
+// A single pre-decoded instruction
+typedef struct
+{
+	gbOpCode* operation;
+	uint16_t opCode; 	// Index into gbDispatchTable (CB-prefixed op codes are 0x100 | second byte)
+	uint16_t immediate; // Operand bytes following the op code (d8/r8/a8 in the low byte, d16/a16 little-endian)
+	uint8_t clockCycles;
+	uint8_t clockCyclesExtra;
+	uint8_t opCodeSize;
+	bool writesMemory; 	// Instruction can write to memory, which may invalidate the block it's running from
+	bool readsMemory; 	// Instruction can read an I/O register, which may request an interrupt
+} blockInstruction_t;
+
+// Native translation of a block (see jit.c). Returns the number of instructions it ran
+typedef uint8_t jitBlockFn(gameBoy_t* gb);
+
+// A run of instructions up to and including the next branch
+typedef struct
+{
+	bool valid;
+	uint16_t pc;
+	uint16_t bank;
+	uint16_t length; 	// Length of the block in bytes
+	uint32_t cycles; 	// Sum of clockCycles over every instruction in the block (taken branch extras not included)
+	uint8_t count;
+	uint32_t execCount; // Number of times the block has been run, used to find hot blocks worth translating
+	jitBlockFn* jitCode;
+	blockInstruction_t instructions[BLOCK_MAX_INSTRUCTIONS];
+} block_t;
+
+struct blockCache
+{
+	block_t blocks[BLOCK_CACHE_SIZE];
+	// Number of cached blocks covering each byte of 0x8000-0xFFFF
+	uint16_t codeMap[GB_MEMORY_SIZE - BLOCK_RAM_START];
+	// Block being run by gbRunCycles
+	block_t* running;
+};
+
+// Function prototypes
+blockCache_t* blockCacheCreate(void);
+void blockCacheDestroy(blockCache_t* cache);
+block_t* blockBuildAt(gameBoy_t* gb, block_t* block, uint16_t bank);
+void blockInvalidate(gameBoy_t* gb, uint16_t addr);
+void blockRemapped(gameBoy_t* gb, uint16_t addr, uint32_t size);
+void blockInvalidateRam(gameBoy_t* gb);
+
+/*
+ * @brief Returns the bank mapped in at an address, which is part of the key for blocks in banked ROM/RAM
+ * @note Unmapped cartridge RAM gets a key of its own, so blocks decoded from RAM aren't run while it's disabled
+ */
+static inline uint16_t blockBank(const gameBoy_t* gb, uint16_t addr)
+{
+	const cart_t* cart = gb->cart;
+
+	if(cart == NULL)
+	{
+		return 0;
+	}
+	if(addr < 0x4000)
+	{
+		return cart->romBank0;
+	}
+	if(addr < 0x8000)
+	{
+		return cart->romBankX;
+	}
+	if((addr >= 0xA000) && (addr < 0xC000))
+	{
+		return cart->ramMapped ? cart->ramBank : 0xFFFF;
+	}
+
+	return 0;
+}
+
+/*
+ * @brief Checks whether an instruction starting at an address can be part of a block
+ */
+static inline bool blockIsUncached(uint16_t addr)
+{
+	return (addr >= BLOCK_UNCACHED_START) && (addr < BLOCK_UNCACHED_END);
+}
+
+/*
+ * @brief Returns the block starting at the current PC, decoding it first if it isn't cached
+ * @param gb Pointer to gb struct containing registers
+ * @return Pointer to the cached block, or NULL if PC is somewhere blocks aren't cached for (see blockIsUncached), in
+	which case the instruction has to be run on its own
+ * @note The hit path is inline since it runs once per block executed
+ */
+static inline block_t* blockLookup(gameBoy_t* gb)
+{
+	uint16_t bank = 0;
+	block_t* block = NULL;
+
+	if(blockIsUncached(gb->pc))
+	{
+		return NULL;
+	}
+
+	bank = blockBank(gb, gb->pc);
+	block = &gb->blockCache->blocks[(gb->pc ^ (bank << 5)) & (BLOCK_CACHE_SIZE - 1)];
+	if(block->valid && (block->pc == gb->pc) && (block->bank == bank))
+	{
+		return block;
+	}
+
+	return blockBuildAt(gb, block, bank);
+}
+
+/*
+ * @brief Checks whether a byte of RAM is part of a cached block
+ * @note Called from the memory write path, so it's kept inline
+ */
+static inline bool blockIsCode(const blockCache_t* cache, uint16_t addr)
+{
+	return (addr >= BLOCK_RAM_START) && (cache->codeMap[addr - BLOCK_RAM_START] != 0);
+}
+
+#endif // BLOCK_H
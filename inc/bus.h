@@ -0,0 +1,80 @@
+#include <stdint.h>
+#include "gb.h"
+#ifdef GB_CORE_BLOCK
+#include "block.h"
+#endif
+
+#ifndef BUS_H
+#define BUS_H
+
+// Memory map
+#define BUS_ADDR_ROM0 		0x0000 // Cartridge ROM, fixed bank (banked on MBC1 in mode 1)
+#define BUS_ADDR_ROMX 		0x4000 // Cartridge ROM, switchable bank
+#define BUS_ADDR_VRAM 		0x8000
+#define BUS_ADDR_CART_RAM 	0xA000 // Cartridge RAM (or MBC3 RTC registers), switchable bank
+#define BUS_ADDR_WRAM 		0xC000
+#define BUS_ADDR_ECHO 		0xE000 // Mirror of 0xC000-0xDDFF
+#define BUS_ADDR_OAM 		0xFE00
+#define BUS_ADDR_UNUSABLE 	0xFEA0
+#define BUS_ADDR_IO 		0xFF00
+#define BUS_ADDR_HRAM 		0xFF80
+#define BUS_ADDR_IE 		0xFFFF
+
+// I/O registers with side effects on write
+#define BUS_REG_DMA 		0xFF46 // OAM DMA source address / 0x100
+
+// Function prototypes
+void busRemap(gameBoy_t* gb);
+void busMap(gameBoy_t* gb, uint16_t addr, uint32_t size, const uint8_t* read, uint8_t* write);
+uint8_t busReadSlow(gameBoy_t* gb, uint16_t addr);
+void busWriteSlow(gameBoy_t* gb, uint16_t addr, uint8_t value);
+
+/*
+ * @brief Reads a byte from the GameBoy's address space
+ * @param gb pointer to gb struct containing memory
+ * @param addr 16-bit address to be read from
+ * @return 8-bit value read
+ * @note Pages of plain ROM/RAM are read straight through the page table. Everything else goes through busReadSlow
+ */
+static inline uint8_t gbRead8(gameBoy_t* gb, uint16_t addr)
+{
+	const uint8_t* page = gb->readPage[addr >> GB_PAGE_SHIFT];
+
+	if(page != NULL)
+	{
+		return page[addr & (GB_PAGE_SIZE - 1)];
+	}
+
+	return busReadSlow(gb, addr);
+}
+
+/*
+ * @brief Writes a byte to the GameBoy's address space
+ * @param gb pointer to gb struct containing memory
+ * @param addr 16-bit address to be written to
+ * @param value 8-bit value to be written
+ * @return void
+ * @note Every memory write made by an instruction goes through here, so writes over cached code can be caught.
+ * ROM (MBC control), I/O registers and anything else with side effects goes through busWriteSlow
+ */
+static inline void gbWrite8(gameBoy_t* gb, uint16_t addr, uint8_t value)
+{
+	uint8_t* page = gb->writePage[addr >> GB_PAGE_SHIFT];
+
+	if(page == NULL)
+	{
+		busWriteSlow(gb, addr, value);
+		return;
+	}
+
+	page[addr & (GB_PAGE_SIZE - 1)] = value;
+
+#ifdef GB_CORE_BLOCK
+	if((gb->blockCache != NULL) && blockIsCode(gb->blockCache, addr))
+	{
+		blockInvalidate(gb, addr);
+	}
+#endif
+}
+
+#endif // BUS_H
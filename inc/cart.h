@@ -1,5 +1,10 @@
+#include <stdint.h>
+#include <stdbool.h>
 #include "gb.h"
 
+#ifndef CART_H
+#define CART_H
+
 // Memory map
 #define ADDR_ENTRY_START  	0x0100
 #define ADDR_ENTRY_END 	  	0x0103
@@ -20,6 +25,103 @@
 #define ADDR_OLD_LICENSEE_START 0x014B // Used in older (Pre-SGB) carts to specify publisher
 #define ADDR_ROM_VERSION_NUMBER 0x014C // Used to specify version number of the game
 #define ADDR_HEADER_CHECKSUM    0x014D // Contains checksum computed from 0x0134 - 0x014C. Boot ROM will lock if checksum fails
+#define ADDR_GLOBAL_CHECKSUM    0x014E // Big-endian sum of every ROM byte except these two. Not checked by hardware
+#define ADDR_HEADER_END 	0x0150
+
+#define CART_TITLE_SIZE 	(ADDR_TITLE_END - ADDR_TITLE_START + 1)
+
+// Cartridge types (ADDR_CART_TYPE) with a memory bank controller that's supported
+#define CART_TYPE_ROM_ONLY 	0x00
+#define CART_TYPE_MBC1 		0x01 // Up to 0x03 (+RAM, +RAM+BATTERY)
+#define CART_TYPE_MBC1_LAST 	0x03
+#define CART_TYPE_ROM_RAM 	0x08 // Up to 0x09 (+BATTERY)
+#define CART_TYPE_ROM_RAM_LAST 	0x09
+#define CART_TYPE_MBC3 		0x0F // Up to 0x13 (+TIMER, +RAM, +BATTERY)
+#define CART_TYPE_MBC3_LAST 	0x13
+#define CART_TYPE_MBC5 		0x19 // Up to 0x1E (+RAM, +BATTERY, +RUMBLE)
+#define CART_TYPE_MBC5_LAST 	0x1E
+
+#define CART_ROM_BANK_SIZE 	0x4000
+#define CART_RAM_BANK_SIZE 	0x2000
+// MBC5 addresses up to 512 ROM banks
+#define CART_ROM_MAX_SIZE 	0x800000
+// MBC5 addresses up to 16 RAM banks
+#define CART_RAM_MAX_SIZE 	0x20000
+
+// MBC3 real time clock registers, selected by writing 0x08-0x0C to 0x4000-0x5FFF
+#define CART_RTC_SELECT 	0x08
+#define CART_RTC_SECONDS 	0
+#define CART_RTC_MINUTES 	1
+#define CART_RTC_HOURS 		2
+#define CART_RTC_DAY_LOW 	3
+#define CART_RTC_DAY_HIGH 	4 // Bit 0: day bit 8. Bit 6: halt. Bit 7: day counter carry
+#define CART_RTC_NUM_OF_REGS 	5
+
+// A ROM file mapped into memory, shared by every gb instance that has it loaded (see cart.c)
+typedef struct cartRom cartRom_t;
+
+typedef enum
+{
+	CART_MBC_NONE,
+	CART_MBC1,
+	CART_MBC3,
+	CART_MBC5,
+	CART_MBC_UNSUPPORTED
+} cartMbc_t;
+
+// Cartridge header (0x0100-0x014F), as parsed by cartParseHeader
+typedef struct
+{
+	char title[CART_TITLE_SIZE + 1]; // NUL terminated, non-printable characters replaced by '?'
+	uint8_t cgbFlag;
+	uint8_t sgbFlag;
+	uint8_t cartType;
+	cartMbc_t mbc;
+	uint32_t romSize; 	// As declared by the header, in bytes. 0 if the size code is unknown
+	uint32_t ramSize; 	// As declared by the header, in bytes
+	uint8_t destinationCode;
+	uint8_t version;
+	uint8_t headerChecksum;
+	uint16_t globalChecksum;
+	bool headerChecksumValid;
+	bool globalChecksumValid;
+} cartHeader_t;
+
+struct cart
+{
+	cartMbc_t mbc;
+	cartRom_t* romFile;
+	const uint8_t* rom; 	// Read only, and shared with other instances. Points into romFile's mapping
+	uint32_t romSize; 	// Power of 2, at least 2 banks
+	uint32_t ramSize; 	// 0 or a multiple of CART_RAM_BANK_SIZE
+	bool external; 		// Not allocated by cartLoadRom (e.g. part of a snapshot fork's mapping), so never freed
+	// MBC registers, as last written
+	bool ramEnable;
+	uint16_t romBankSelect; // MBC1: 5 bits, MBC3: 7 bits, MBC5: 9 bits
+	uint8_t ramBankSelect; 	// MBC1: 2 bits (also ROM bank bits 5-6), MBC3: RAM bank or RTC register, MBC5: 4 bits
+	uint8_t bankingMode; 	// MBC1 only
+	// Banks currently mapped in. Part of the key for cached blocks (see blockBank)
+	uint16_t romBank0;
+	uint16_t romBankX;
+	uint8_t ramBank;
+	bool ramMapped;
+	// MBC3 real time clock. Counts emulated time, so runs are reproducible
+	uint8_t rtc[CART_RTC_NUM_OF_REGS];
+	uint8_t rtcLatched[CART_RTC_NUM_OF_REGS];
+	uint8_t rtcLatchWrite;
+	uint64_t rtcCycles; 	// Value of cyclesCurrent when rtc[] was last brought up to date
+	uint8_t ram[CART_RAM_MAX_SIZE];
+};
 
 // Function prototypes
-void cartLoadRom(gameBoy_t* gb, const char* gameRom);
+cartHeader_t cartParseHeader(const uint8_t* rom, uint32_t size);
+const char* cartMbcName(cartMbc_t mbc);
+bool cartLoadRom(gameBoy_t* gb, const char* gameRom);
+void cartUnload(gameBoy_t* gb);
+cartRom_t* cartRetainRom(const cart_t* cart);
+void cartReleaseRom(cartRom_t* rom);
+void cartRemap(gameBoy_t* gb);
+uint8_t cartRead(gameBoy_t* gb, uint16_t addr);
+void cartWrite(gameBoy_t* gb, uint16_t addr, uint8_t value);
+
+#endif // CART_H
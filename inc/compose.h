@@ -0,0 +1,11 @@
+#include <stdint.h>
+
+#ifndef COMPOSE_H
+#define COMPOSE_H
+
+// Function prototypes
+void composeLine(uint32_t* line, const uint8_t* bg, const uint8_t* obj, const uint8_t* attr, uint32_t count,
+	uint8_t bgp, uint8_t obp0, uint8_t obp1);
+uint32_t composeColour(uint8_t palette, uint8_t colour);
+
+#endif // COMPOSE_H
@@ -1,15 +1,22 @@
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
 
-// Struct for emuContext
+// Struct for emuContext. One per running emulator, owned by the frontend running it
 typedef struct
 {
-	bool paused;
-	bool running;
+	// Read by the emulation thread, set from the main thread
+	atomic_bool paused;
+	atomic_bool running;
+	atomic_bool rewinding; 	// Step back through the rewind history instead of running frames
+	_Atomic uint8_t buttons; 	// INPUT_* bits of the buttons held on the keyboard
 	uint64_t ticks;
 } emuContext_t;
 
 // Function prototypes
-emuContext_t* getEmuContext();
-void setEmuContextPaused(bool newVal);
-void setEmuContextRunning(bool newVal);
-void setEmuContextTicks(uint64_t newVal);
+void emuContextInit(emuContext_t* context);
+void setEmuContextPaused(emuContext_t* context, bool newVal);
+void setEmuContextRunning(emuContext_t* context, bool newVal);
+void setEmuContextRewinding(emuContext_t* context, bool newVal);
+void setEmuContextButtons(emuContext_t* context, uint8_t newVal);
+void setEmuContextTicks(emuContext_t* context, uint64_t newVal);
@@ -1,5 +1,11 @@
 #include <stdint.h>
 #include <stdbool.h>
+#include "ppu.h"
+#include "sched.h"
+#include "timers.h"
+#include "apu.h"
+#include "idle.h"
+#include "input.h"
 
 #define FLAG_REG_ZERO  	    (1 << 7)
 #define FLAG_REG_SUB  	    (1 << 6)
@@ -7,6 +13,28 @@
 #define FLAG_REG_CARRY 	    (1 << 4)
 
 #define GB_MEMORY_SIZE 	    0x10000
+// The address space is split into 256 byte pages for the memory bus (see bus.c)
+#define GB_PAGE_SHIFT 	    8
+#define GB_PAGE_SIZE 	    (1 << GB_PAGE_SHIFT)
+#define GB_NUM_OF_PAGES     (GB_MEMORY_SIZE >> GB_PAGE_SHIFT)
+
+// 0xCB prefixes a second page of 256 op codes, stored after the first 256 in the dispatch table
+#define GB_OPCODE_PREFIX_CB 0xCB
+#define GB_OPCODE_CB_OFFSET 0x100
+
+// 154 scanlines of 456 clock cycles each
+#define GB_CYCLES_PER_FRAME 70224
+// Clock cycles per second
+#define GB_CLOCK_HZ 	    4194304
+
+// Interrupt flag/enable registers and their bits
+#define GB_REG_IF 	    0xFF0F
+#define GB_REG_IE 	    0xFFFF
+#define GB_INT_VBLANK 	    (1 << 0)
+#define GB_INT_STAT 	    (1 << 1)
+#define GB_INT_TIMER 	    (1 << 2)
+#define GB_INT_SERIAL 	    (1 << 3)
+#define GB_INT_JOYPAD 	    (1 << 4)
 
 #ifndef GB_H
 #define GB_H
@@ -17,7 +45,16 @@
 // CPU specification for the GameBoy 
 // CPU is Sharp LR35902 custom chip (Z80-like CPU, similar to Intel 8080)
 
+// Cartridge ROM/RAM and memory bank controller state (see cart.h)
+typedef struct cart cart_t;
+// Cache of pre-decoded basic blocks (see block.h)
+typedef struct blockCache blockCache_t;
+// Executable memory for blocks translated to native code (see jit.h)
+typedef struct jitArena jitArena_t;
+
 // Struct for general purpose registers
+// Note: Each pair is declared low byte first so the 16-bit view matches the register pair on a little-endian host
+// (e.g. B is the high byte of BC)
 typedef struct
 {
 	// Union for the A and F registers
@@ -25,8 +62,8 @@ typedef struct
 	{
 		struct
 		{
-			uint8_t a; // Accumulator
 			uint8_t f; // Flags reg. Note: Lower nibble is always 0
+			uint8_t a; // Accumulator
 		};
 		uint16_t af;
 	};
@@ -35,8 +72,8 @@ typedef struct
 	{
 		struct
 		{
-			uint8_t b;
 			uint8_t c;
+			uint8_t b;
 		};
 		uint16_t bc;
 	};
@@ -45,8 +82,8 @@ typedef struct
 	{
 		struct
 		{
-			uint8_t d;
 			uint8_t e;
+			uint8_t d;
 		};
 		uint16_t de;
 	};
@@ -55,29 +92,85 @@ typedef struct
 	{
 		struct
 		{
-			uint8_t h;
 			uint8_t l;
+			uint8_t h;
 		};
 		uint16_t hl;
 	};
 } cpuReg_t;
 
-typedef struct 
+// ALU operations whose flags can be left unevaluated when built with LAZY_FLAGS=1
+typedef enum
+{
+	GB_FLAGS_OP_NONE = 0, // generalReg.f is up to date
+	GB_FLAGS_OP_ADD,      // ADD/ADC A
+	GB_FLAGS_OP_SUB,      // SUB/SBC/CP A
+	GB_FLAGS_OP_AND,      // AND A
+	GB_FLAGS_OP_OR,       // XOR/OR A
+	GB_FLAGS_OP_INC,      // INC r8
+	GB_FLAGS_OP_DEC,      // DEC r8
+	GB_FLAGS_OP_ADD16     // ADD HL, rr
+} gbFlagsOp_t;
+
+// Last flag-setting ALU operation, from which F is computed only once something reads it
+typedef struct
+{
+	uint8_t op;       // gbFlagsOp_t
+	uint8_t carryIn;  // Carry added/subtracted by ADC/SBC
+	uint8_t keep;     // Flags the operation leaves untouched, as they were beforehand
+	uint16_t lhs;
+	uint16_t rhs;
+	uint16_t result;
+} gbLazyFlags_t;
+
+typedef struct gameBoy
 {
 	// 8-bit General-Purpose Registers: (A)ccumulator, B, C, D, E, H, L
 	// Can be paired for 16-bit operations: (AF, BC, DE, HL)
 	cpuReg_t generalReg;
+	// Only used when built with LAZY_FLAGS=1. Call gbFlagsSync before reading generalReg.f from outside the CPU core
+	gbLazyFlags_t lazyFlags;
 	
 	bool cyclesExtraFlag;
 	// Increments by 1
 	uint64_t cyclesCurrent;
 	// Will be used to ensure we maintain proper instruction timing
 	uint64_t cyclesTarget;
+	// Cycle count the CPU core runs up to. Brought forward by schedAdd when something is scheduled sooner
+	uint64_t cyclesEnd;
 	// Special Purpose Registers: (F)lags, Program Counter, Stack Pointer
 	uint16_t pc;
 	uint16_t sp;	
+	// Interrupt Master Enable flag. Set by EI/RETI, cleared by DI and when an interrupt is taken
+	bool ime;
+	// Set by HALT/STOP until an interrupt wakes the CPU (see interrupts.c). Nothing is run in the meantime
+	bool halted;
+	bool stopped;
 	// The Gameboy has 64KB of addressable memory (65535 bytes)
+	// Note: Cartridge ROM and RAM live in the cart struct once one is loaded. Read through gbRead8 (see bus.h)
 	uint8_t memory [GB_MEMORY_SIZE];
+	// Host pointer to each page of the address space, for reads and writes. NULL pages go through the bus slow path.
+	// Note: Some point into memory[] above, so the struct can't simply be copied. Call busRemap on the copy
+	const uint8_t* readPage[GB_NUM_OF_PAGES];
+	uint8_t* writePage[GB_NUM_OF_PAGES];
+	// Loaded by cartLoadRom, freed by gbDeinit. NULL until then, in which case 0x0000-0xBFFF is plain memory[]
+	cart_t* cart;
+	// Only used by the block core. Allocated on first run, freed by gbDeinit
+	blockCache_t* blockCache;
+	// Only used when built with JIT=1. Allocated on first run, freed by gbDeinit
+	jitArena_t* jitArena;
+	// Brought up to the CPU's cycle count by ppuSync (see ppu.c)
+	ppu_t ppu;
+	// DIV/TIMA, worked out from the cycle count when accessed (see timers.c)
+	timers_t timers;
+	// Sound channels, rendered up to the CPU on register writes and frame sequencer steps (see apu.c)
+	apu_t apu;
+	// Joypad buttons held, set by the frontend between runs (see input.c)
+	input_t input;
+	// Pending events of the PPU and other components, which the CPU runs up to (see sched.c)
+	sched_t sched;
+	// Polling loops found by JR instructions, which can be skipped ahead (see idle.c)
+	idle_t idle;
 	// 
 } gameBoy_t;
 
@@ -94,7 +187,16 @@ typedef struct gbInstruction
 	uint8_t opCodeSize;
 } gbInstruction;
 
+extern struct gbInstruction gbDispatchTable[];
+
+void invalid(gameBoy_t* gb);
+void gbFlagsSync(gameBoy_t* gb);
+void gbPush16(gameBoy_t* gb, uint16_t value);
+void gbInit(gameBoy_t* gb);
+void gbDeinit(gameBoy_t* gb);
 void gbHandleCycle(gameBoy_t* gb);
+uint32_t gbRunCycles(gameBoy_t* gb, uint32_t budget);
+uint32_t gbRunFrame(gameBoy_t* gb);
 
 #endif // GB_H
 
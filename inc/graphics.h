@@ -1,8 +1,21 @@
+#include <stdbool.h>
 #include <SDL2/SDL.h>
 #define RESOLUTION_X 160 
 #define RESOLUTION_Y 144 
 #define RESOLUTION_SCALE 3
 
+// How frames from the emulation thread are handed to the presenting thread
+typedef enum
+{
+	GRAPHICS_PRESENT_LATEST = 0, 	// Only the newest frame is presented, older ones not presented yet are dropped.
+					// Emulation never waits on the display
+	GRAPHICS_PRESENT_EVERY 		// Every frame is presented. Emulation waits for the previous frame to be taken
+} graphicsPresentMode_t;
 
 int graphicsInit(SDL_Window** window , SDL_Renderer** renderer);
+void graphicsDeinit(void);
+void graphicsSetPresentMode(graphicsPresentMode_t mode);
+void graphicsPublishFrame(const uint32_t* frame);
+bool graphicsPresent(SDL_Renderer* renderer);
+void graphicsStop(void);
 
@@ -0,0 +1,56 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef IDLE_H
+#define IDLE_H
+
+// Included by gb.h, as the idle loop cache is part of the gb struct
+typedef struct gameBoy gameBoy_t;
+
+// Longest loop looked at, in bytes including the closing JR
+#define IDLE_MAX_LENGTH 	16
+// Most memory reads a loop can make and still be skipped
+#define IDLE_MAX_READS 		4
+// Number of entries in the (direct-mapped) cache of loops looked at. Must be a power of 2
+#define IDLE_CACHE_SIZE 	16
+
+// Where a read made by a loop gets its address from
+typedef enum
+{
+	IDLE_READ_ADDR = 0, 	// Fixed address (a16, or 0xFF00 + a8)
+	IDLE_READ_C, 		// 0xFF00 + C
+	IDLE_READ_BC,
+	IDLE_READ_DE,
+	IDLE_READ_HL
+} idleRead_t;
+
+// A loop closed by a backward JR, and whether it's safe to skip
+typedef struct
+{
+	uint16_t pc; 			// Address of the JR
+	uint16_t target; 		// Address the JR jumps back to
+	const uint8_t* page; 		// Page table entry the JR was read through, which tells ROM banks apart
+	bool idle; 			// Every pass through the loop leaves the CPU as it found it (see idleAnalyse)
+	uint8_t length; 		// Length of the loop in bytes, from target up to and including the JR
+	uint8_t cycles; 		// Clock cycles per pass, including the JR being taken
+	uint8_t code[IDLE_MAX_LENGTH]; 	// Copy of the loop. Code in RAM can change, so it's compared again each time
+	uint8_t readCount;
+	uint8_t readKind[IDLE_MAX_READS]; // idleRead_t
+	uint16_t readAddr[IDLE_MAX_READS]; // Address for IDLE_READ_ADDR
+	uint64_t lastCycles; 		// Cycle count the JR was last taken at
+	uint64_t lastStable; 		// Cycle count what the loop reads was unchanged until, as of then
+} idleLoop_t;
+
+typedef struct
+{
+	bool enabled;
+	idleLoop_t loops[IDLE_CACHE_SIZE];
+} idle_t;
+
+// Function prototypes
+void idleInit(gameBoy_t* gb);
+void idleReset(gameBoy_t* gb);
+void idleSetEnabled(gameBoy_t* gb, bool enabled);
+void idleSkip(gameBoy_t* gb, uint16_t pc, uint16_t target);
+
+#endif // IDLE_H
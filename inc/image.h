@@ -0,0 +1,11 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+// Function prototypes
+bool imageWritePpm(const char* path, const uint32_t* pixels, uint32_t width, uint32_t height);
+bool imageWritePng(const char* path, const uint32_t* pixels, uint32_t width, uint32_t height);
+
+#endif // IMAGE_H
@@ -0,0 +1,38 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef INPUT_H
+#define INPUT_H
+
+// Included by gb.h, as the joypad state is part of the gb struct
+typedef struct gameBoy gameBoy_t;
+
+// Joypad register. Bits 4-5 (written) select the directions and/or the buttons, which bits 0-3 then read, 0 pressed
+#define INPUT_REG_P1 		0xFF00
+#define INPUT_P1_DIRECTIONS 	(1 << 4) // 0 to select the directions
+#define INPUT_P1_BUTTONS 	(1 << 5) // 0 to select the buttons
+#define INPUT_P1_SELECT 	(INPUT_P1_DIRECTIONS | INPUT_P1_BUTTONS)
+
+// Buttons held, 1 pressed. The directions and buttons each line up with P1 bits 0-3 once selected
+#define INPUT_RIGHT 		(1 << 0)
+#define INPUT_LEFT 		(1 << 1)
+#define INPUT_UP 		(1 << 2)
+#define INPUT_DOWN 		(1 << 3)
+#define INPUT_A 		(1 << 4)
+#define INPUT_B 		(1 << 5)
+#define INPUT_SELECT 		(1 << 6)
+#define INPUT_START 		(1 << 7)
+
+typedef struct
+{
+	uint8_t buttons; 	// INPUT_* bits of the buttons held
+} input_t;
+
+// Function prototypes
+void inputInit(gameBoy_t* gb);
+void inputSetButtons(gameBoy_t* gb, uint8_t buttons);
+bool inputPressed(const gameBoy_t* gb);
+uint8_t inputRead(gameBoy_t* gb);
+void inputWrite(gameBoy_t* gb, uint8_t value);
+
+#endif // INPUT_H
@@ -0,0 +1,23 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef INTERRUPTS_H
+#define INTERRUPTS_H
+
+typedef struct gameBoy gameBoy_t;
+
+// Interrupts are requested in bits 0-4 of IF and enabled in the same bits of IE (see GB_INT_* in gb.h)
+#define INTERRUPTS_MASK 		0x1F
+// Address of the handler for interrupt bit n is 0x40 + n * 8
+#define INTERRUPTS_VECTOR_BASE 		0x0040
+#define INTERRUPTS_VECTOR_SPACING 	8
+// Clock cycles taken to push PC and jump to the handler
+#define INTERRUPTS_DISPATCH_CYCLES 	20
+
+// Function prototypes
+void interruptsRequest(gameBoy_t* gb, uint8_t mask);
+void interruptsCheck(gameBoy_t* gb);
+void interruptsEvent(gameBoy_t* gb);
+void interruptsEnableEvent(gameBoy_t* gb);
+
+#endif // INTERRUPTS_H
@@ -0,0 +1,29 @@
+#include <stdint.h>
+#include <stddef.h>
+#include "gb.h"
+#include "block.h"
+
+#ifndef JIT_H
+#define JIT_H
+
+// Number of times a block has to be run by the block core before it's translated to native code
+#define JIT_HOT_THRESHOLD 	32
+// Size of the executable arena translated blocks are emitted into. It's flushed as a whole once full
+#define JIT_ARENA_SIZE 		(4 * 1024 * 1024)
+// Worst case size of the native code for a single instruction, used to check the arena has room for a block
+#define JIT_MAX_INSTRUCTION_SIZE 128
+
+// Executable arena translated blocks live in
+struct jitArena
+{
+	uint8_t* code;
+	size_t used;
+	bool disabled; // Set if the host refused an executable mapping, in which case everything stays interpreted
+};
+
+// Function prototypes
+jitArena_t* jitArenaCreate(void);
+void jitArenaDestroy(jitArena_t* arena);
+void jitCompile(gameBoy_t* gb, block_t* block);
+
+#endif // JIT_H
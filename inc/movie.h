@@ -0,0 +1,28 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "gb.h"
+#include "utils.h"
+
+#ifndef MOVIE_H
+#define MOVIE_H
+
+// Movie files start with MOVIE_MAGIC and MOVIE_VERSION (see movie.c). Fields are little-endian
+#define MOVIE_MAGIC 		"FGBM"
+#define MOVIE_VERSION 		1
+
+// Buttons held on each frame of a run from power-on, and hashes of where the run ended up (see movie.c)
+typedef struct movie movie_t;
+
+// Function prototypes
+movie_t* movieCreate(gameBoy_t* gb);
+movie_t* movieLoad(gameBoy_t* gb, const char* path);
+void movieDestroy(movie_t* movie);
+void movieAddFrame(movie_t* movie, uint8_t buttons);
+uint32_t movieFrameCount(const movie_t* movie);
+uint8_t movieGetFrame(const movie_t* movie, uint32_t frame);
+bool movieSave(movie_t* movie, gameBoy_t* gb, const char* path);
+bool movieCheck(const movie_t* movie, gameBoy_t* gb);
+void movieHashMemory(gameBoy_t* gb, uint8_t digest[UTILS_SHA1_SIZE]);
+void movieHashFrame(gameBoy_t* gb, uint8_t digest[UTILS_SHA1_SIZE]);
+
+#endif // MOVIE_H
@@ -0,0 +1,13 @@
+#include <stdint.h>
+
+#ifndef POOL_H
+#define POOL_H
+
+// Called once for each task index, from whichever worker thread ends up running it
+typedef void poolTask_t(void* arg, uint32_t index);
+
+// Function prototypes
+uint32_t poolDefaultThreads(void);
+void poolRun(uint32_t count, uint32_t threads, poolTask_t* task, void* arg);
+
+#endif // POOL_H
@@ -0,0 +1,148 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef PPU_H
+#define PPU_H
+
+// Included by gb.h, as the PPU state is part of the gb struct
+typedef struct gameBoy gameBoy_t;
+
+#define PPU_SCREEN_WIDTH 	160
+#define PPU_SCREEN_HEIGHT 	144
+// ARGB8888 colour of the screen while the LCD is off
+#define PPU_COLOUR_OFF 		0xFFFFFFFF
+
+// Line timing in clock cycles. Mode 3 really runs 172-289 cycles depending on sprites/SCX, the scanline renderer
+// always uses the shortest
+#define PPU_CYCLES_PER_LINE 	456
+#define PPU_CYCLES_MODE_2 	80
+#define PPU_CYCLES_MODE_3 	172
+#define PPU_LINES_PER_FRAME 	154
+
+// STAT modes
+#define PPU_MODE_HBLANK 	0
+#define PPU_MODE_VBLANK 	1
+#define PPU_MODE_OAM_SCAN 	2
+#define PPU_MODE_DRAWING 	3
+
+// Registers
+#define PPU_REG_LCDC 		0xFF40
+#define PPU_REG_STAT 		0xFF41
+#define PPU_REG_SCY 		0xFF42
+#define PPU_REG_SCX 		0xFF43
+#define PPU_REG_LY 		0xFF44
+#define PPU_REG_LYC 		0xFF45
+#define PPU_REG_BGP 		0xFF47
+#define PPU_REG_OBP0 		0xFF48
+#define PPU_REG_OBP1 		0xFF49
+#define PPU_REG_WY 		0xFF4A
+#define PPU_REG_WX 		0xFF4B
+
+// LCDC bits
+#define PPU_LCDC_BG_ENABLE 	(1 << 0) // On DMG, also gates the window
+#define PPU_LCDC_OBJ_ENABLE 	(1 << 1)
+#define PPU_LCDC_OBJ_SIZE 	(1 << 2) // 8x16 sprites
+#define PPU_LCDC_BG_MAP 	(1 << 3) // 0x9C00 rather than 0x9800
+#define PPU_LCDC_TILE_DATA 	(1 << 4) // 0x8000 unsigned rather than 0x9000 signed
+#define PPU_LCDC_WINDOW_ENABLE 	(1 << 5)
+#define PPU_LCDC_WINDOW_MAP 	(1 << 6) // 0x9C00 rather than 0x9800
+#define PPU_LCDC_ENABLE 	(1 << 7)
+
+// STAT bits (0-1 are the mode)
+#define PPU_STAT_COINCIDENCE 	(1 << 2)
+#define PPU_STAT_INT_HBLANK 	(1 << 3)
+#define PPU_STAT_INT_VBLANK 	(1 << 4)
+#define PPU_STAT_INT_OAM 	(1 << 5)
+#define PPU_STAT_INT_LYC 	(1 << 6)
+
+// Sprite attribute bits
+#define PPU_OBJ_PALETTE 	(1 << 4)
+#define PPU_OBJ_FLIP_X 		(1 << 5)
+#define PPU_OBJ_FLIP_Y 		(1 << 6)
+#define PPU_OBJ_BEHIND_BG 	(1 << 7)
+
+#define PPU_OAM_ENTRIES 	40
+#define PPU_OBJS_PER_LINE 	10
+
+// Tile data at 0x8000-0x97FF: 384 tiles of 8x8 pixels, 16 bytes each
+#define PPU_ADDR_TILE_DATA 	0x8000
+#define PPU_ADDR_TILE_MAP 	0x9800
+#define PPU_NUM_OF_TILES 	384
+#define PPU_TILE_SIZE 		8
+#define PPU_TILE_BYTES 		16
+
+// How lines are drawn. Picked per gb struct with ppuSetRenderer
+typedef enum
+{
+	PPU_RENDERER_SCANLINE = 0, 	// Whole lines at once at the end of mode 3, which always lasts 172 cycles. Fast
+	PPU_RENDERER_FIFO 		// Pixel by pixel through the pixel FIFO, a clock cycle at a time. Register writes
+					// take effect mid-line and mode 3 lasts as long as on hardware
+} ppuRenderer_t;
+
+// State of the pixel FIFO renderer within the current line (see ppuFifoDot)
+typedef struct
+{
+	bool active; 			// This line is being drawn by the pixel FIFO
+	bool window; 			// Fetcher has switched to the window for the rest of the line
+	bool wyTriggered; 		// LY has matched WY this frame, so the window can start
+	uint8_t x; 			// Pixels output so far
+	uint8_t discard; 		// Pixels still to be dropped for SCX % 8
+	// Background FIFO. Only ever refilled once empty, so it holds at most one tile row
+	uint8_t bgColour[PPU_TILE_SIZE];
+	uint8_t bgCount;
+	// Sprite FIFO. Always 8 entries long, colour 0 being transparent
+	uint8_t objColour[PPU_TILE_SIZE];
+	uint8_t objAttr[PPU_TILE_SIZE];
+	uint8_t objHead;
+	// Background fetcher: get tile number, low byte, high byte (2 cycles each), then push once the FIFO is empty
+	uint8_t fetchStep;
+	uint8_t fetchCycles;
+	uint8_t fetchX; 		// Tile column being fetched, counted from the left of the line/window
+	uint8_t fetchTile;
+	uint8_t fetchRow[PPU_TILE_SIZE];
+	bool fetchDummy; 		// First fetch of the line, which is thrown away
+	// Sprites picked by the OAM scan, and which of them have been fetched
+	uint8_t objSelected[PPU_OBJS_PER_LINE];
+	uint8_t objCount;
+	uint16_t objFetched;
+	int8_t objPending; 		// Index into objSelected of the sprite being fetched, or -1
+	uint8_t objCycles;
+} ppuFifo_t;
+
+typedef struct
+{
+	uint64_t cycles; 	// Value of cyclesCurrent the PPU has been brought up to
+	uint16_t lineCycles; 	// Clock cycles into the current line
+	uint8_t ly;
+	uint8_t mode;
+	uint8_t windowLine; 	// Internal line counter of the window, which only advances on lines it's drawn on
+	bool statLine; 		// STAT interrupt line. The interrupt is requested on its rising edge
+	uint32_t frameCount; 	// Number of frames completed
+	uint8_t renderer; 	// ppuRenderer_t
+	ppuFifo_t fifo;
+	// Tile data decoded to colour numbers (0-3), one byte per pixel. A tile is only decoded again once a VRAM write
+	// has set its bit in tileDirty
+	uint8_t tileCache[PPU_NUM_OF_TILES][PPU_TILE_SIZE][PPU_TILE_SIZE];
+	uint64_t tileDirty[PPU_NUM_OF_TILES / 64];
+	// ARGB8888 colour of each colour number through BGP, OBP0 and OBP1, kept up to date by ppuWriteRegister. Used by
+	// the pixel FIFO, which maps a pixel at a time
+	uint32_t palettes[3][4];
+	// ARGB8888, row by row. Lines are rendered into framebuffer as the PPU reaches them, which is copied to frame on
+	// entering VBlank, so frame always holds a whole frame
+	uint32_t framebuffer[PPU_SCREEN_WIDTH * PPU_SCREEN_HEIGHT];
+	uint32_t frame[PPU_SCREEN_WIDTH * PPU_SCREEN_HEIGHT];
+} ppu_t;
+
+// Function prototypes
+void ppuInit(gameBoy_t* gb);
+void ppuSetRenderer(gameBoy_t* gb, ppuRenderer_t renderer);
+void ppuSync(gameBoy_t* gb);
+uint64_t ppuNextChange(gameBoy_t* gb, uint16_t addr);
+void ppuEvent(gameBoy_t* gb);
+void ppuWriteRegister(gameBoy_t* gb, uint16_t addr, uint8_t value);
+void ppuWriteVram(gameBoy_t* gb, uint16_t addr);
+void ppuInvalidateTiles(gameBoy_t* gb);
+void ppuDecodePalettes(gameBoy_t* gb);
+const uint32_t* ppuGetFrame(gameBoy_t* gb);
+
+#endif // PPU_H
@@ -0,0 +1,25 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "gb.h"
+
+#ifndef REWIND_H
+#define REWIND_H
+
+// Room for the compressed history. ~60 seconds at the default interval for typical games
+#define REWIND_DEFAULT_CAPACITY 	(64 << 20)
+// Frames between two snapshots
+#define REWIND_DEFAULT_INTERVAL 	4
+// Shortest run of unchanged bytes worth ending a run of changed ones for, in the delta encoding (see rewind.c)
+#define REWIND_MIN_ZERO_RUN 		8
+
+// History of save states, newest kept whole and the rest as compressed deltas (see rewind.c)
+typedef struct rewind rewind_t;
+
+// Function prototypes
+rewind_t* rewindCreate(size_t capacity, uint32_t interval);
+void rewindDestroy(rewind_t* history);
+void rewindFrame(rewind_t* history, gameBoy_t* gb);
+bool rewindStep(rewind_t* history, gameBoy_t* gb);
+
+#endif // REWIND_H
@@ -0,0 +1,25 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#ifndef RING_H
+#define RING_H
+
+// Lock-free ring buffer of 16-bit samples, for exactly one producer thread and one consumer thread
+typedef struct ring
+{
+	int16_t* data;
+	size_t mask; 				// Capacity - 1. The capacity is a power of 2
+	// Running totals of samples pushed/popped. Each is only written by its own side, and kept on its own cache line
+	// so the two threads don't fight over it
+	_Alignas(64) atomic_size_t head; 	// Written by the producer
+	_Alignas(64) atomic_size_t tail; 	// Written by the consumer
+} ring_t;
+
+// Function prototypes
+ring_t* ringCreate(size_t capacity);
+void ringDestroy(ring_t* ring);
+size_t ringPush(ring_t* ring, const int16_t* samples, size_t count);
+size_t ringPop(ring_t* ring, int16_t* samples, size_t count);
+
+#endif // RING_H
@@ -0,0 +1,51 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/stat.h>
+#include "cart.h"
+#include "utils.h"
+
+#ifndef ROMINDEX_H
+#define ROMINDEX_H
+
+// Longest ROM file name that can be indexed, not including the NUL
+#define ROM_INDEX_NAME_MAX 	255
+// Index file format: magic, version, entry count, then one variable size record per ROM (see romindex.c)
+#define ROM_INDEX_MAGIC 	"FGBI"
+#define ROM_INDEX_VERSION 	1
+
+// Everything known about one ROM file
+typedef struct
+{
+	char name[ROM_INDEX_NAME_MAX + 1]; // File name, relative to the indexed directory
+	// File identity. Entries are only reused while these still match the file
+	uint64_t fileSize;
+	int64_t mtimeSec;
+	uint32_t mtimeNsec;
+	uint32_t crc32;
+	uint8_t sha1[UTILS_SHA1_SIZE];
+	char title[CART_TITLE_SIZE + 1];
+	uint8_t cartType;
+	uint8_t mbc; 		// cartMbc_t
+	uint32_t romSize; 	// As declared by the header
+	uint32_t ramSize; 	// As declared by the header
+	bool headerChecksumValid;
+	bool globalChecksumValid;
+} romIndexEntry_t;
+
+// Entries are kept sorted by name
+typedef struct
+{
+	uint32_t count;
+	uint32_t capacity;
+	romIndexEntry_t* entries;
+} romIndex_t;
+
+// Function prototypes
+bool romIndexLoad(const char* indexPath, romIndex_t* index);
+bool romIndexSave(const char* indexPath, romIndex_t* index);
+void romIndexFree(romIndex_t* index);
+const romIndexEntry_t* romIndexFind(const romIndex_t* index, const char* name, const struct stat* fileStat);
+bool romIndexLookup(const romIndex_t* index, const char* path, romIndexEntry_t* entry);
+bool romIndexBuild(const char* romDir, const char* indexPath);
+
+#endif // ROMINDEX_H
@@ -0,0 +1,47 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef SCHED_H
+#define SCHED_H
+
+// Included by gb.h, as the scheduler state is part of the gb struct
+typedef struct gameBoy gameBoy_t;
+
+// Events components can ask to be woken up for. Each has at most one pending time
+typedef enum
+{
+	SCHED_EVENT_PPU = 0, 	// Next PPU mode change (see ppuEvent)
+	SCHED_EVENT_TIMER, 	// Next TIMA overflow (see timersEvent)
+	SCHED_EVENT_INTERRUPT, 	// An interrupt may need taking, or the CPU waking up (see interruptsEvent)
+	SCHED_EVENT_IME, 	// IME being set once the instruction after EI has run (see interruptsEnableEvent)
+	SCHED_EVENT_APU, 	// Next APU frame sequencer step, which also hands out finished samples (see apuEvent)
+	SCHED_NUM_OF_EVENTS
+} schedEvent_t;
+
+// Min-heap of pending events, keyed on the absolute cycle count they're due at
+typedef struct
+{
+	uint64_t time[SCHED_NUM_OF_EVENTS]; 	// Cycle count each event is due at, by event
+	uint8_t heap[SCHED_NUM_OF_EVENTS]; 	// Pending events, soonest first
+	uint8_t position[SCHED_NUM_OF_EVENTS]; 	// Index of each pending event in heap
+	uint8_t count;
+} sched_t;
+
+// Function prototypes
+void schedInit(gameBoy_t* gb);
+void schedAdd(gameBoy_t* gb, schedEvent_t event, uint64_t time);
+void schedCancel(gameBoy_t* gb, schedEvent_t event);
+void schedRun(gameBoy_t* gb);
+
+/*
+ * @brief Returns the cycle count the soonest pending event is due at
+ * @param sched Pointer to the gb struct's scheduler
+ * @return Cycle count, or UINT64_MAX if nothing is pending
+ * @note The CPU runs uninterrupted up to here, then calls schedRun
+ */
+static inline uint64_t schedNext(const sched_t* sched)
+{
+	return (sched->count > 0) ? sched->time[sched->heap[0]] : UINT64_MAX;
+}
+
+#endif // SCHED_H
@@ -0,0 +1,17 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "gb.h"
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+// A frozen copy of a gb struct (and its cartridge) that any number of instances can be forked from (see snapshot.c)
+typedef struct snapshot snapshot_t;
+
+// Function prototypes
+snapshot_t* snapshotCreate(gameBoy_t* gb);
+void snapshotDestroy(snapshot_t* snapshot);
+gameBoy_t* snapshotFork(snapshot_t* snapshot);
+void snapshotRelease(gameBoy_t* gb);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,24 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "gb.h"
+
+#ifndef STATE_H
+#define STATE_H
+
+// Save states start with STATE_MAGIC and STATE_VERSION, then hold a run of chunks, each a 4 character tag and a
+// 32-bit size followed by that many bytes. Chunks are copied straight to and from the structs in the gb struct, so
+// states are only portable between builds with the same struct layouts and byte order. STATE_VERSION goes up
+// whenever a struct that's saved changes
+#define STATE_MAGIC 		"FGBS"
+#define STATE_VERSION 		3
+#define STATE_TAG_SIZE 		4
+
+// Function prototypes
+size_t stateSize(gameBoy_t* gb);
+size_t stateSave(gameBoy_t* gb, uint8_t* buffer, size_t size);
+bool stateLoad(gameBoy_t* gb, const uint8_t* buffer, size_t size);
+bool stateSaveFile(gameBoy_t* gb, const char* path);
+bool stateLoadFile(gameBoy_t* gb, const char* path);
+
+#endif // STATE_H
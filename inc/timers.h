@@ -0,0 +1,36 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef TIMERS_H
+#define TIMERS_H
+
+// Included by gb.h, as the timer state is part of the gb struct
+typedef struct gameBoy gameBoy_t;
+
+// Registers
+#define TIMERS_REG_DIV 		0xFF04 // Upper 8 bits of the 16-bit system counter. Any write resets the counter
+#define TIMERS_REG_TIMA 	0xFF05 // Counts up at the rate picked by TAC, requesting the timer interrupt on overflow
+#define TIMERS_REG_TMA 		0xFF06 // Reloaded into TIMA on overflow
+#define TIMERS_REG_TAC 		0xFF07 // Bit 2 enables TIMA, bits 0-1 pick its rate
+
+#define TIMERS_TAC_ENABLE 	(1 << 2)
+// TIMA reads 0 for this many clock cycles after overflowing, before TMA is loaded and the interrupt requested
+#define TIMERS_RELOAD_DELAY 	4
+
+// The registers are only brought up to date when read or written, from the cycle counts below
+typedef struct
+{
+	uint64_t divBase; 	// Value of cyclesCurrent when the system counter was last 0
+	uint64_t timaBase; 	// Value of cyclesCurrent tima is correct as of
+	uint64_t overflow; 	// When TIMA last overflowed, if TMA hasn't been loaded yet. UINT64_MAX otherwise
+	uint8_t tima;
+} timers_t;
+
+// Function prototypes
+void timersInit(gameBoy_t* gb);
+void timersEvent(gameBoy_t* gb);
+uint8_t timersRead(gameBoy_t* gb, uint16_t addr);
+uint64_t timersNextChange(gameBoy_t* gb, uint16_t addr);
+void timersWrite(gameBoy_t* gb, uint16_t addr, uint8_t value);
+
+#endif // TIMERS_H
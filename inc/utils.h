@@ -0,0 +1,14 @@
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef UTILS_H
+#define UTILS_H
+
+// Size of a SHA-1 digest in bytes
+#define UTILS_SHA1_SIZE 20
+
+// Function prototypes
+uint32_t utilsCrc32(uint32_t crc, const void* data, size_t size);
+void utilsSha1(const void* data, size_t size, uint8_t digest[UTILS_SHA1_SIZE]);
+
+#endif // UTILS_H
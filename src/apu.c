@@ -0,0 +1,700 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include "gb.h"
+#include "sched.h"
+#include "ring.h"
+#include "apu.h"
+
+/*
+ * apu.c: Audio processing unit: two square channels (the first with a frequency sweep), a wave channel playing back
+ * wave RAM and a noise channel. Nothing is sampled per cycle. Each channel's timer is kept as the cycle count it next
+ * moves the waveform on at, and channels are only rendered up to the CPU before a register write and on each frame
+ * sequencer step, which is scheduled as SCHED_EVENT_APU. Rendering a channel adds a band-limited step (BLEP) to the
+ * output buffer wherever its level changes, at the exact point between two 48kHz samples it falls. The buffer holds
+ * differences, so summing it gives the output already filtered and resampled. Each frame sequencer step hands the
+ * finished samples to the output ring buffer, which is drained by the audio thread
+ */
+
+// 32.32 fixed point output samples per clock cycle. Exact, as GB_CLOCK_HZ is a power of 2
+#define APU_SAMPLE_STEP 	(((uint64_t)APU_SAMPLE_RATE << 32) / GB_CLOCK_HZ)
+// Scales a channel's DAC output (-15 to 15) times master volume (1-8), so all 4 channels together fit an int16_t
+#define APU_AMPLITUDE 		32
+// Decay of the high-pass filter standing in for the output capacitor, which takes the DC offset out (~15Hz)
+#define APU_HIGHPASS_SHIFT 	9
+// Cutoff of the band-limited step's low-pass filter, as a fraction of the output's Nyquist frequency
+#define APU_BLEP_CUTOFF 	0.9
+
+// Square wave duty cycles (12.5%, 25%, 50%, 75%), 8 steps each, first step in bit 7
+static const uint8_t apuDuty[4] = { 0x01, 0x81, 0x87, 0x7E };
+// Noise timer divisors, by NR43 bits 0-2
+static const uint8_t apuNoiseDivisor[8] = { 8, 16, 32, 48, 64, 80, 96, 112 };
+// Bits which read back as 1 regardless of what was written, NR10 to NR52
+static const uint8_t apuReadMask[APU_REG_NR52 - APU_REG_NR10 + 1] =
+{
+	0x80, 0x3F, 0x00, 0xFF, 0xBF, 	// NR10-NR14
+	0xFF, 0x3F, 0x00, 0xFF, 0xBF, 	// NR20-NR24
+	0x7F, 0xFF, 0x9F, 0xFF, 0xBF, 	// NR30-NR34
+	0xFF, 0xFF, 0x00, 0x00, 0xBF, 	// NR40-NR44
+	0x00, 0x00, 0x70 		// NR50-NR52
+};
+
+// Step response differences of a windowed sinc low-pass filter, by phase. A change in level at phase p between two
+// samples is spread over the APU_BLEP_TAPS samples from there, centred APU_BLEP_TAPS / 2 samples on
+static int32_t apuKernel[APU_BLEP_PHASES][APU_BLEP_TAPS];
+static pthread_once_t apuKernelOnce = PTHREAD_ONCE_INIT;
+
+/*
+ * @brief Fills in apuKernel. Each phase is normalised to add up to exactly 1 << APU_BLEP_BITS, so a step always
+	settles at the level it steps to
+ */
+static void apuKernelInit(void)
+{
+	for(uint8_t phase = 0; phase < APU_BLEP_PHASES; phase++)
+	{
+		double taps[APU_BLEP_TAPS];
+		double sum = 0;
+		int32_t total = 0;
+		uint8_t largest = 0;
+
+		for(uint8_t i = 0; i < APU_BLEP_TAPS; i++)
+		{
+			double x = i - (APU_BLEP_TAPS / 2) - ((double)phase / APU_BLEP_PHASES);
+			double t = x / (APU_BLEP_TAPS / 2);
+			// Blackman window
+			double window = (fabs(t) < 1.0) ? (0.42 + 0.5 * cos(M_PI * t) + 0.08 * cos(2 * M_PI * t)) : 0;
+			double sinc = (x == 0) ? 1.0 : (sin(M_PI * APU_BLEP_CUTOFF * x) / (M_PI * APU_BLEP_CUTOFF * x));
+
+			taps[i] = sinc * window;
+			sum += taps[i];
+		}
+		for(uint8_t i = 0; i < APU_BLEP_TAPS; i++)
+		{
+			apuKernel[phase][i] = (int32_t)lround(taps[i] / sum * (1 << APU_BLEP_BITS));
+			total += apuKernel[phase][i];
+			if(apuKernel[phase][i] > apuKernel[phase][largest])
+			{
+				largest = i;
+			}
+		}
+		apuKernel[phase][largest] += (1 << APU_BLEP_BITS) - total;
+	}
+}
+
+/*
+ * @brief Returns one of a channel's 5 registers (NRx0-NRx4)
+ */
+static inline uint8_t apuReg(const gameBoy_t* gb, uint8_t channel, uint8_t reg)
+{
+	return gb->memory[APU_REG_NR10 + (channel * 5) + reg];
+}
+
+/*
+ * @brief Returns the 11-bit frequency value of a square or wave channel, from NRx3 and NRx4
+ */
+static inline uint16_t apuFrequency(const gameBoy_t* gb, uint8_t channel)
+{
+	return apuReg(gb, channel, 3) | ((apuReg(gb, channel, 4) & 0x07) << 8);
+}
+
+/*
+ * @brief Returns the number of clock cycles between two steps of a channel's waveform
+ */
+static uint32_t apuPeriod(const gameBoy_t* gb, uint8_t channel)
+{
+	uint8_t nr43 = gb->memory[APU_REG_NR10 + (APU_CHANNEL_NOISE * 5) + 3];
+
+	switch(channel)
+	{
+		case APU_CHANNEL_WAVE:
+			return (2048 - apuFrequency(gb, channel)) * 2;
+		case APU_CHANNEL_NOISE:
+			return (uint32_t)apuNoiseDivisor[nr43 & 0x07] << (nr43 >> 4);
+		default:
+			return (2048 - apuFrequency(gb, channel)) * 4;
+	}
+}
+
+/*
+ * @brief Returns whether a channel's DAC is on. A channel is turned off whenever its DAC is
+ */
+static inline bool apuDacOn(const gameBoy_t* gb, uint8_t channel)
+{
+	if(channel == APU_CHANNEL_WAVE)
+	{
+		return (gb->memory[APU_REG_NR30] & 0x80) != 0;
+	}
+	return (apuReg(gb, channel, 2) & 0xF8) != 0;
+}
+
+/*
+ * @brief Returns whether a channel is on but outputting a constant level, so its waveform can't be heard
+ */
+static inline bool apuSilent(const gameBoy_t* gb, uint8_t channel)
+{
+	if(channel == APU_CHANNEL_WAVE)
+	{
+		return (apuReg(gb, channel, 2) & 0x60) == 0;
+	}
+	return gb->apu.channels[channel].volume == 0;
+}
+
+/*
+ * @brief Returns the digital (0-15) output of a channel at its current waveform step
+ */
+static uint8_t apuDigital(const gameBoy_t* gb, uint8_t channel)
+{
+	const apuChannel_t* state = &gb->apu.channels[channel];
+	uint8_t sample = 0;
+	uint8_t shift = 0;
+
+	switch(channel)
+	{
+		case APU_CHANNEL_WAVE:
+			// Volume code 0 mutes the channel, 1-3 shift samples right by 0-2
+			shift = (apuReg(gb, channel, 2) >> 5) & 0x03;
+			sample = gb->memory[APU_ADDR_WAVE + (state->position >> 1)];
+			sample = (state->position & 0x01) ? (sample & 0x0F) : (sample >> 4);
+			return (shift == 0) ? 0 : (sample >> (shift - 1));
+		case APU_CHANNEL_NOISE:
+			return (state->lfsr & 0x01) ? 0 : state->volume;
+		default:
+			return ((apuDuty[apuReg(gb, channel, 1) >> 6] >> (7 - state->position)) & 0x01) ? state->volume : 0;
+	}
+}
+
+/*
+ * @brief Adds a band-limited step to one side of the output buffer
+ * @param apu Pointer to the APU
+ * @param side 0 for left, 1 for right
+ * @param time Cycle count the step happens at. Never before apu->timeBase
+ * @param delta Change in level
+ * @return void
+ */
+static void apuAddStep(apu_t* apu, uint8_t side, uint64_t time, int32_t delta)
+{
+	uint64_t position = apu->offset + ((time - apu->timeBase) * APU_SAMPLE_STEP);
+	uint32_t index = (uint32_t)(position >> 32);
+	const int32_t* kernel = apuKernel[((position & UINT32_MAX) * APU_BLEP_PHASES) >> 32];
+	int32_t* buffer = &apu->buffer[side][index];
+
+	// Samples are handed out on every frame sequencer step, so the buffer never gets close to full
+	if(index >= APU_BUFFER_SAMPLES)
+	{
+		return;
+	}
+
+	for(uint8_t i = 0; i < APU_BLEP_TAPS; i++)
+	{
+		buffer[i] += kernel[i] * delta;
+	}
+}
+
+/*
+ * @brief Works out a channel's left/right level from its output, NR50 and NR51, and steps the output buffer to it if
+	it's changed
+ * @param gb Pointer to gb struct containing the APU
+ * @param channel Channel index
+ * @param time Cycle count the change happens at
+ * @return void
+ */
+static void apuUpdate(gameBoy_t* gb, uint8_t channel, uint64_t time)
+{
+	apu_t* apu = &gb->apu;
+	apuChannel_t* state = &apu->channels[channel];
+	uint8_t nr50 = gb->memory[APU_REG_NR50];
+	uint8_t nr51 = gb->memory[APU_REG_NR51];
+	int32_t level = 0;
+	int32_t left = 0;
+	int32_t right = 0;
+
+	if(apu->output == NULL)
+	{
+		return;
+	}
+
+	// DAC output is -15 to 15. A channel that's off outputs 0
+	level = state->enabled ? ((apuDigital(gb, channel) * 2 - 15) * APU_AMPLITUDE) : 0;
+	left = (nr51 & (0x10 << channel)) ? (level * (((nr50 >> 4) & 0x07) + 1)) : 0;
+	right = (nr51 & (0x01 << channel)) ? (level * ((nr50 & 0x07) + 1)) : 0;
+	if(left != state->level[0])
+	{
+		apuAddStep(apu, 0, time, left - state->level[0]);
+		state->level[0] = left;
+	}
+	if(right != state->level[1])
+	{
+		apuAddStep(apu, 1, time, right - state->level[1]);
+		state->level[1] = right;
+	}
+}
+
+/*
+ * @brief Runs a channel's timer up to a given cycle count, stepping its waveform each time it's due
+ * @param gb Pointer to gb struct containing the APU
+ * @param channel Channel index
+ * @param until Cycle count to run up to, inclusive
+ * @return void
+ */
+static void apuRender(gameBoy_t* gb, uint8_t channel, uint64_t until)
+{
+	apu_t* apu = &gb->apu;
+	apuChannel_t* state = &apu->channels[channel];
+	uint32_t period = 0;
+
+	if(!state->enabled || (state->next > until))
+	{
+		return;
+	}
+	period = apuPeriod(gb, channel);
+
+	// Nothing to be heard, so the waveform's moved on all at once. The noise channel's LFSR has to be run regardless
+	if((channel != APU_CHANNEL_NOISE) && ((apu->output == NULL) || apuSilent(gb, channel)))
+	{
+		uint64_t steps = (until - state->next) / period + 1;
+
+		state->position = (uint8_t)((state->position + steps) & ((channel == APU_CHANNEL_WAVE) ? 31 : 7));
+		state->next += steps * period;
+		return;
+	}
+
+	while(state->next <= until)
+	{
+		uint64_t time = state->next;
+
+		if(channel == APU_CHANNEL_NOISE)
+		{
+			uint16_t feedback = (state->lfsr ^ (state->lfsr >> 1)) & 0x01;
+
+			state->lfsr = (state->lfsr >> 1) | (feedback << 14);
+			// 7-bit mode also feeds back into bit 6
+			if(apuReg(gb, channel, 3) & 0x08)
+			{
+				state->lfsr = (state->lfsr & ~(1 << 6)) | (feedback << 6);
+			}
+		}
+		else
+		{
+			state->position = (state->position + 1) & ((channel == APU_CHANNEL_WAVE) ? 31 : 7);
+		}
+		state->next += period;
+		apuUpdate(gb, channel, time);
+	}
+}
+
+/*
+ * @brief Works out channel 1's next swept frequency, turning the channel off if it overflows 11 bits
+ */
+static uint16_t apuSweepNext(gameBoy_t* gb)
+{
+	apu_t* apu = &gb->apu;
+	uint8_t nr10 = gb->memory[APU_REG_NR10];
+	uint16_t delta = apu->sweepShadow >> (nr10 & 0x07);
+	uint16_t next = (nr10 & 0x08) ? (apu->sweepShadow - delta) : (apu->sweepShadow + delta);
+
+	if(next > 0x7FF)
+	{
+		apu->channels[APU_CHANNEL_SQUARE1].enabled = false;
+	}
+	return next;
+}
+
+/*
+ * @brief Restarts a channel, on a write to NRx4 with bit 7 set
+ * @param gb Pointer to gb struct containing the APU
+ * @param channel Channel index
+ * @return void
+ */
+static void apuTrigger(gameBoy_t* gb, uint8_t channel)
+{
+	apu_t* apu = &gb->apu;
+	apuChannel_t* state = &apu->channels[channel];
+	uint8_t envelope = apuReg(gb, channel, 2);
+
+	state->enabled = apuDacOn(gb, channel);
+	if(state->length == 0)
+	{
+		state->length = (channel == APU_CHANNEL_WAVE) ? 256 : 64;
+	}
+	state->next = gb->cyclesCurrent + apuPeriod(gb, channel);
+	state->volume = envelope >> 4;
+	state->envelopeTimer = (envelope & 0x07) ? (envelope & 0x07) : 8;
+
+	if(channel == APU_CHANNEL_WAVE)
+	{
+		state->position = 0;
+	}
+	else if(channel == APU_CHANNEL_NOISE)
+	{
+		state->lfsr = 0x7FFF;
+	}
+	else if(channel == APU_CHANNEL_SQUARE1)
+	{
+		uint8_t nr10 = gb->memory[APU_REG_NR10];
+
+		apu->sweepShadow = apuFrequency(gb, channel);
+		apu->sweepTimer = (nr10 & 0x70) ? ((nr10 >> 4) & 0x07) : 8;
+		apu->sweepEnabled = (nr10 & 0x77) != 0;
+		// The overflow check is made straight away if there's a shift
+		if(nr10 & 0x07)
+		{
+			apuSweepNext(gb);
+		}
+	}
+}
+
+/*
+ * @brief Runs one step of the frame sequencer: length counters on even steps, the sweep on steps 2 and 6 and
+	envelopes on step 7
+ * @param gb Pointer to gb struct containing the APU
+ * @return void
+ */
+static void apuFrameStep(gameBoy_t* gb)
+{
+	apu_t* apu = &gb->apu;
+	uint8_t step = apu->frameStep;
+
+	apu->frameStep = (step + 1) & 0x07;
+
+	if((step & 0x01) == 0)
+	{
+		for(uint8_t channel = 0; channel < APU_NUM_OF_CHANNELS; channel++)
+		{
+			apuChannel_t* state = &apu->channels[channel];
+
+			if((apuReg(gb, channel, 4) & APU_NRX4_LENGTH) && (state->length > 0) && (--state->length == 0))
+			{
+				state->enabled = false;
+			}
+		}
+	}
+
+	if(((step == 2) || (step == 6)) && apu->sweepEnabled && (--apu->sweepTimer == 0))
+	{
+		uint8_t nr10 = gb->memory[APU_REG_NR10];
+
+		apu->sweepTimer = (nr10 & 0x70) ? ((nr10 >> 4) & 0x07) : 8;
+		if(nr10 & 0x70)
+		{
+			uint16_t next = apuSweepNext(gb);
+
+			if((next <= 0x7FF) && (nr10 & 0x07))
+			{
+				apu->sweepShadow = next;
+				gb->memory[APU_REG_NR13] = next & 0xFF;
+				gb->memory[APU_REG_NR14] = (gb->memory[APU_REG_NR14] & ~0x07) | (next >> 8);
+				apuSweepNext(gb);
+			}
+		}
+	}
+
+	if(step == 7)
+	{
+		for(uint8_t channel = 0; channel < APU_NUM_OF_CHANNELS; channel++)
+		{
+			apuChannel_t* state = &apu->channels[channel];
+			uint8_t envelope = apuReg(gb, channel, 2);
+
+			if((channel == APU_CHANNEL_WAVE) || ((envelope & 0x07) == 0) || (--state->envelopeTimer != 0))
+			{
+				continue;
+			}
+			state->envelopeTimer = envelope & 0x07;
+			if((envelope & 0x08) && (state->volume < 15))
+			{
+				state->volume++;
+			}
+			else if(!(envelope & 0x08) && (state->volume > 0))
+			{
+				state->volume--;
+			}
+		}
+	}
+
+	for(uint8_t channel = 0; channel < APU_NUM_OF_CHANNELS; channel++)
+	{
+		apuUpdate(gb, channel, gb->cyclesCurrent);
+	}
+}
+
+/*
+ * @brief Hands every sample finished so far to the output ring buffer
+ * @param gb Pointer to gb struct containing the APU
+ * @return void
+ * @note Channels must have been rendered up to the CPU. Samples that don't fit in the ring buffer are dropped, so
+ * the emulation thread never waits on the audio thread
+ */
+static void apuFlush(gameBoy_t* gb)
+{
+	apu_t* apu = &gb->apu;
+	uint64_t end = apu->offset + ((gb->cyclesCurrent - apu->timeBase) * APU_SAMPLE_STEP);
+	uint32_t count = (uint32_t)(end >> 32);
+	int16_t samples[APU_BUFFER_SAMPLES * 2];
+
+	apu->timeBase = gb->cyclesCurrent;
+	apu->offset = end & UINT32_MAX;
+	if(apu->output == NULL)
+	{
+		return;
+	}
+	if(count > APU_BUFFER_SAMPLES)
+	{
+		count = APU_BUFFER_SAMPLES;
+	}
+
+	for(uint8_t side = 0; side < 2; side++)
+	{
+		int32_t* buffer = apu->buffer[side];
+		int32_t sum = apu->integrator[side];
+
+		for(uint32_t i = 0; i < count; i++)
+		{
+			int32_t sample = 0;
+
+			sum += buffer[i];
+			sample = sum >> APU_BLEP_BITS;
+			sum -= sum >> APU_HIGHPASS_SHIFT;
+			samples[i * 2 + side] = (sample > INT16_MAX) ? INT16_MAX : ((sample < INT16_MIN) ? INT16_MIN : sample);
+		}
+		apu->integrator[side] = sum;
+
+		// Steps near the end spill over into samples which aren't finished yet
+		memmove(buffer, &buffer[count], APU_BLEP_TAPS * sizeof(int32_t));
+		memset(&buffer[APU_BLEP_TAPS], 0, count * sizeof(int32_t));
+	}
+
+	ringPush(apu->output, samples, count * 2);
+}
+
+/*
+ * @brief Schedules SCHED_EVENT_APU for the next frame sequencer step. Steps are on falling edges of bit 12 of the
+	system counter DIV is the top of
+ * @param gb Pointer to gb struct containing the APU
+ * @return void
+ * @note Resetting DIV only moves the steps after the next one
+ */
+static void apuSchedule(gameBoy_t* gb)
+{
+	uint64_t counter = gb->cyclesCurrent - gb->timers.divBase;
+
+	schedAdd(gb, SCHED_EVENT_APU, gb->cyclesCurrent + APU_FRAME_SEQ_CYCLES - (counter % APU_FRAME_SEQ_CYCLES));
+}
+
+/*
+ * @brief Turns the APU on or off, on a write to NR52
+ * @param gb Pointer to gb struct containing the APU
+ * @param on New state of the power bit
+ * @return void
+ */
+static void apuPower(gameBoy_t* gb, bool on)
+{
+	apu_t* apu = &gb->apu;
+
+	if(!on && (gb->memory[APU_REG_NR52] & APU_NR52_POWER))
+	{
+		// Turning off clears every register but wave RAM
+		memset(&gb->memory[APU_REG_NR10], 0, APU_REG_NR52 - APU_REG_NR10);
+		for(uint8_t channel = 0; channel < APU_NUM_OF_CHANNELS; channel++)
+		{
+			apu->channels[channel].enabled = false;
+			apu->channels[channel].length = 0;
+			apuUpdate(gb, channel, gb->cyclesCurrent);
+		}
+		apu->sweepEnabled = false;
+	}
+	else if(on && !(gb->memory[APU_REG_NR52] & APU_NR52_POWER))
+	{
+		apu->frameStep = 0;
+	}
+	gb->memory[APU_REG_NR52] = on ? APU_NR52_POWER : 0;
+}
+
+/*
+ * @brief Sets the APU up as the boot ROM leaves it, with channel 1 still on from the startup sound but silent
+ * @param gb Pointer to gb struct containing the APU
+ * @return void
+ * @note Must be called after timersInit, as frame sequencer steps follow the system counter
+ */
+void apuInit(gameBoy_t* gb)
+{
+	static const uint8_t registers[APU_REG_NR52 - APU_REG_NR10 + 1] =
+	{
+		0x80, 0xBF, 0xF3, 0xFF, 0xBF,
+		0xFF, 0x3F, 0x00, 0xFF, 0xBF,
+		0x7F, 0xFF, 0x9F, 0xFF, 0xBF,
+		0xFF, 0xFF, 0x00, 0x00, 0xBF,
+		0x77, 0xF3, APU_NR52_POWER
+	};
+	apu_t* apu = &gb->apu;
+
+	pthread_once(&apuKernelOnce, apuKernelInit);
+
+	memset(apu, 0, sizeof(apu_t));
+	memcpy(&gb->memory[APU_REG_NR10], registers, sizeof(registers));
+	apu->channels[APU_CHANNEL_SQUARE1].enabled = true;
+	apu->channels[APU_CHANNEL_SQUARE1].next = gb->cyclesCurrent + apuPeriod(gb, APU_CHANNEL_SQUARE1);
+	apu->timeBase = gb->cyclesCurrent;
+	apuSchedule(gb);
+}
+
+/*
+ * @brief Picks where finished samples go
+ * @param gb Pointer to gb struct containing the APU
+ * @param output Ring buffer for the samples, or NULL to skip synthesis altogether (e.g. when running headless)
+ * @return void
+ * @note Samples are 16-bit stereo at APU_SAMPLE_RATE, left first. Only the emulation thread may push into output
+ */
+void apuSetOutput(gameBoy_t* gb, ring_t* output)
+{
+	apu_t* apu = &gb->apu;
+
+	apuSync(gb);
+	apu->output = output;
+	memset(apu->buffer, 0, sizeof(apu->buffer));
+	memset(apu->integrator, 0, sizeof(apu->integrator));
+	for(uint8_t channel = 0; channel < APU_NUM_OF_CHANNELS; channel++)
+	{
+		apu->channels[channel].level[0] = 0;
+		apu->channels[channel].level[1] = 0;
+		apuUpdate(gb, channel, gb->cyclesCurrent);
+	}
+}
+
+/*
+ * @brief Renders every channel up to the CPU's cycle count
+ * @param gb Pointer to gb struct containing the APU
+ * @return void
+ */
+void apuSync(gameBoy_t* gb)
+{
+	for(uint8_t channel = 0; channel < APU_NUM_OF_CHANNELS; channel++)
+	{
+		apuRender(gb, channel, gb->cyclesCurrent);
+	}
+}
+
+/*
+ * @brief Handler for SCHED_EVENT_APU. Renders up to the frame sequencer step, runs it, hands out the samples
+	finished so far and schedules the next step
+ * @param gb Pointer to gb struct containing the APU
+ * @return void
+ */
+void apuEvent(gameBoy_t* gb)
+{
+	apuSync(gb);
+	if(gb->memory[APU_REG_NR52] & APU_NR52_POWER)
+	{
+		apuFrameStep(gb);
+	}
+	apuFlush(gb);
+	apuSchedule(gb);
+}
+
+/*
+ * @brief Handles a read from the APU registers or wave RAM (0xFF10-0xFF3F)
+ * @param gb Pointer to gb struct containing the APU
+ * @param addr Register address
+ * @return 8-bit value read
+ * @note Channels are only turned off by writes and frame sequencer steps, so NR52 needs no syncing
+ */
+uint8_t apuRead(gameBoy_t* gb, uint16_t addr)
+{
+	uint8_t value = 0;
+
+	if(addr >= APU_ADDR_WAVE)
+	{
+		return gb->memory[addr];
+	}
+	if(addr > APU_REG_NR52)
+	{
+		return 0xFF;
+	}
+	if(addr != APU_REG_NR52)
+	{
+		return gb->memory[addr] | apuReadMask[addr - APU_REG_NR10];
+	}
+
+	value = gb->memory[APU_REG_NR52] | apuReadMask[APU_REG_NR52 - APU_REG_NR10];
+	for(uint8_t channel = 0; channel < APU_NUM_OF_CHANNELS; channel++)
+	{
+		value |= gb->apu.channels[channel].enabled ? (1 << channel) : 0;
+	}
+	return value;
+}
+
+/*
+ * @brief Handles a write to the APU registers or wave RAM (0xFF10-0xFF3F)
+ * @param gb Pointer to gb struct containing the APU
+ * @param addr Register address
+ * @param value 8-bit value written
+ * @return void
+ * @note Channels are rendered up to the write first, so it only affects what's output from here on
+ */
+void apuWrite(gameBoy_t* gb, uint16_t addr, uint8_t value)
+{
+	apu_t* apu = &gb->apu;
+	uint8_t channel = (addr - APU_REG_NR10) / 5;
+	apuChannel_t* state = NULL;
+
+	apuSync(gb);
+
+	if(addr >= APU_ADDR_WAVE)
+	{
+		gb->memory[addr] = value;
+		return;
+	}
+	if(addr == APU_REG_NR52)
+	{
+		apuPower(gb, (value & APU_NR52_POWER) != 0);
+		return;
+	}
+	// Everything else is read only while the APU is off
+	if((addr > APU_REG_NR52) || !(gb->memory[APU_REG_NR52] & APU_NR52_POWER))
+	{
+		return;
+	}
+	gb->memory[addr] = value;
+
+	if(channel >= APU_NUM_OF_CHANNELS)
+	{
+		// NR50/NR51 change the level of every channel
+		for(channel = 0; channel < APU_NUM_OF_CHANNELS; channel++)
+		{
+			apuUpdate(gb, channel, gb->cyclesCurrent);
+		}
+		return;
+	}
+
+	state = &apu->channels[channel];
+	switch((addr - APU_REG_NR10) % 5)
+	{
+		case 0:
+			// NR30: DAC enable
+			if((channel == APU_CHANNEL_WAVE) && !apuDacOn(gb, channel))
+			{
+				state->enabled = false;
+			}
+			break;
+		case 1:
+			state->length = (channel == APU_CHANNEL_WAVE) ? (256 - value) : (64 - (value & 0x3F));
+			break;
+		case 2:
+			// Envelope (or the wave channel's volume). Clearing the top 5 bits turns the DAC off
+			if((channel != APU_CHANNEL_WAVE) && !apuDacOn(gb, channel))
+			{
+				state->enabled = false;
+			}
+			break;
+		case 4:
+			if(value & APU_NRX4_TRIGGER)
+			{
+				apuTrigger(gb, channel);
+			}
+			break;
+		default:
+			break;
+	}
+	apuUpdate(gb, channel, gb->cyclesCurrent);
+}
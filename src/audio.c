@@ -0,0 +1,75 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include "apu.h"
+#include "ring.h"
+#include "audio.h"
+
+/*
+ * audio.c: SDL audio output. The APU pushes samples into a ring buffer from the emulation thread (see apuSetOutput),
+ * and SDL's audio callback drains it from its own thread. Neither waits on the other: the APU drops samples if the
+ * ring buffer is full, and the callback plays silence for whatever it's short of
+ */
+
+static SDL_AudioDeviceID audioDevice = 0;
+
+/*
+ * @brief SDL audio callback. Fills the device's buffer from the ring buffer
+ * @param userdata Ring buffer passed to audioInit
+ * @param stream Buffer to be filled with 16-bit stereo samples
+ * @param len Size of stream in bytes
+ * @return void
+ */
+static void audioCallback(void* userdata, uint8_t* stream, int len)
+{
+	ring_t* ring = userdata;
+	size_t count = (size_t)len / sizeof(int16_t);
+	size_t popped = ringPop(ring, (int16_t*)stream, count);
+
+	// Ran dry (paused, or the emulation thread fell behind)
+	memset(stream + popped * sizeof(int16_t), 0, (count - popped) * sizeof(int16_t));
+}
+
+/*
+ * @brief Opens the default audio device and starts playing from a ring buffer
+ * @param ring Ring buffer the APU pushes samples into
+ * @return 0 on success, -1 if no audio device could be opened
+ * @note SDL_INIT_AUDIO must already have been initialised (see graphicsInit)
+ */
+int audioInit(ring_t* ring)
+{
+	SDL_AudioSpec want;
+
+	memset(&want, 0, sizeof(want));
+	want.freq = APU_SAMPLE_RATE;
+	want.format = AUDIO_S16SYS;
+	want.channels = 2;
+	want.samples = AUDIO_DEVICE_FRAMES;
+	want.callback = audioCallback;
+	want.userdata = ring;
+
+	// No changes allowed, so SDL converts if the device wants another format
+	audioDevice = SDL_OpenAudioDevice(NULL, 0, &want, NULL, 0);
+	if(audioDevice == 0)
+	{
+		printf("Failed to open an audio device: %s\r\n", SDL_GetError());
+		return -1;
+	}
+	SDL_PauseAudioDevice(audioDevice, 0);
+
+	return 0;
+}
+
+/*
+ * @brief Closes the audio device opened by audioInit. Once this returns, the callback no longer runs
+ * @return void
+ */
+void audioDeinit(void)
+{
+	if(audioDevice != 0)
+	{
+		SDL_CloseAudioDevice(audioDevice);
+		audioDevice = 0;
+	}
+}
@@ -0,0 +1,306 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "block.h"
+#include "bus.h"
+
+/*
+ * block.c: Cache of pre-decoded basic blocks, used by the block core (make CORE=block).
+ * A block is the run of instructions starting at some PC up to and including the next branch. Decoding it once
+ * means the core doesn't have to re-fetch op codes and re-index gbDispatchTable on every pass through a loop.
+ * Blocks are keyed by PC and ROM bank. Blocks in RAM are counted byte by byte in codeMap so that writes to them
+ * (self-modifying code, or code copied into HRAM/WRAM) invalidate them
+ */
+
+/*
+ * @brief Checks whether an instruction has to be the last one in a block
+ * @details Anything that can move PC somewhere other than the next instruction (or that stops the CPU) ends the block
+ */
+static bool blockIsTerminator(uint16_t opCode)
+{
+	switch(opCode)
+	{
+		case 0x10: // STOP
+		case 0x18: case 0x20: case 0x28: case 0x30: case 0x38: // JR
+		case 0x76: // HALT
+		case 0xC0: case 0xC8: case 0xD0: case 0xD8: case 0xC9: case 0xD9: // RET, RETI
+		case 0xC2: case 0xCA: case 0xD2: case 0xDA: case 0xC3: case 0xE9: // JP
+		case 0xC4: case 0xCC: case 0xD4: case 0xDC: case 0xCD: // CALL
+		case 0xC7: case 0xCF: case 0xD7: case 0xDF: case 0xE7: case 0xEF: case 0xF7: case 0xFF: // RST
+		case 0xF3: case 0xFB: // DI, EI
+			return true;
+		default:
+			// Illegal op codes lock up the CPU
+			return gbDispatchTable[opCode].operation == invalid;
+	}
+}
+
+/*
+ * @brief Checks whether an instruction (that isn't a terminator) can write to memory
+ */
+static bool blockWritesMemory(uint16_t opCode)
+{
+	if(opCode >= GB_OPCODE_CB_OFFSET)
+	{
+		// (HL) forms of everything but BIT
+		return ((opCode & 0x07) == 0x06) && ((opCode & 0xC0) != 0x40);
+	}
+
+	switch(opCode)
+	{
+		case 0x02: case 0x08: case 0x12: case 0x22: case 0x32: case 0x34: case 0x35: case 0x36:
+		case 0x70: case 0x71: case 0x72: case 0x73: case 0x74: case 0x75: case 0x77:
+		case 0xC5: case 0xD5: case 0xE5: case 0xF5: // PUSH
+		case 0xE0: case 0xE2: case 0xEA:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * @brief Checks whether an instruction (that isn't a terminator) can read memory through an address that may be an
+	I/O register. Catching up on such a read (see ppuSync) can request an interrupt
+ */
+static bool blockReadsMemory(uint16_t opCode)
+{
+	if(opCode >= GB_OPCODE_CB_OFFSET)
+	{
+		// BIT n, (HL). The other (HL) forms also write, so are covered by blockWritesMemory
+		return (opCode & 0xC7) == 0x46;
+	}
+
+	switch(opCode)
+	{
+		case 0x0A: case 0x1A: case 0x2A: case 0x3A: // LD A, (BC)/(DE)/(HL+)/(HL-)
+		case 0x46: case 0x4E: case 0x56: case 0x5E: case 0x66: case 0x6E: case 0x7E: // LD r, (HL)
+		case 0x86: case 0x8E: case 0x96: case 0x9E: case 0xA6: case 0xAE: case 0xB6: case 0xBE: // ALU A, (HL)
+		case 0xF0: case 0xF2: case 0xFA: // LDH A, (a8) / LD A, (C) / LD A, (a16)
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * @brief Maps an echo RAM address to the WRAM address it mirrors. Other addresses are returned as is
+ * @note Echo RAM is only ever written through its WRAM address (see busWriteSlow), so that's what codeMap tracks
+ */
+static uint32_t blockEchoToWram(uint32_t addr)
+{
+	if((addr >= BUS_ADDR_ECHO) && (addr < BUS_ADDR_OAM))
+	{
+		return addr - (BUS_ADDR_ECHO - BUS_ADDR_WRAM);
+	}
+
+	return addr;
+}
+
+/*
+ * @brief Checks whether a block was decoded from the byte at an address
+ */
+static bool blockCovers(const block_t* block, uint32_t addr)
+{
+	return (addr >= block->pc) && (addr < (uint32_t)block->pc + block->length);
+}
+
+/*
+ * @brief Adds (or removes) a block in RAM to/from the map of bytes which are covered by cached code
+ * @param cache Block cache the block belongs to
+ * @param block Block being added to or removed from the cache
+ * @param delta 1 when adding the block, -1 when removing it
+ * @return void
+ */
+static void blockCodeMapUpdate(blockCache_t* cache, const block_t* block, int delta)
+{
+	if(block->pc < BLOCK_RAM_START)
+	{
+		return;
+	}
+
+	for(uint32_t addr = block->pc; (addr < (uint32_t)block->pc + block->length) && (addr < GB_MEMORY_SIZE); addr++)
+	{
+		cache->codeMap[blockEchoToWram(addr) - BLOCK_RAM_START] += delta;
+	}
+}
+
+/*
+ * @brief Decodes the instructions starting at PC into a block
+ * @param gb Pointer to gb struct containing registers
+ * @param block Cache entry to decode into
+ * @param bank ROM bank mapped in at PC
+ * @return void
+ */
+static void blockBuild(gameBoy_t* gb, block_t* block, uint16_t bank)
+{
+	uint16_t addr = gb->pc;
+	uint16_t opCode = 0;
+
+	block->valid = true;
+	block->pc = gb->pc;
+	block->bank = bank;
+	block->cycles = 0;
+	block->count = 0;
+	block->execCount = 0;
+	block->jitCode = NULL;
+
+	do
+	{
+		blockInstruction_t* instruction = &block->instructions[block->count++];
+
+		opCode = gbRead8(gb, addr);
+		if(opCode == GB_OPCODE_PREFIX_CB)
+		{
+			opCode = GB_OPCODE_CB_OFFSET | gbRead8(gb, addr + 1);
+		}
+
+		instruction->operation = gbDispatchTable[opCode].operation;
+		instruction->opCode = opCode;
+		instruction->clockCycles = gbDispatchTable[opCode].clockCycles;
+		instruction->clockCyclesExtra = gbDispatchTable[opCode].clockCyclesExtra;
+		instruction->opCodeSize = gbDispatchTable[opCode].opCodeSize;
+		instruction->writesMemory = blockWritesMemory(opCode);
+		instruction->readsMemory = blockReadsMemory(opCode);
+		instruction->immediate = 0;
+		if((opCode < GB_OPCODE_CB_OFFSET) && (instruction->opCodeSize > 1))
+		{
+			instruction->immediate = gbRead8(gb, addr + 1);
+			if(instruction->opCodeSize > 2)
+			{
+				instruction->immediate |= gbRead8(gb, addr + 2) << 8;
+			}
+		}
+
+		block->cycles += instruction->clockCycles;
+		addr += instruction->opCodeSize;
+
+	// Also stop at 8KB region boundaries, as the next region can be banked independently, and short of OAM/I/O
+	} while((block->count < BLOCK_MAX_INSTRUCTIONS) && !blockIsTerminator(opCode) && (((addr ^ block->pc) & 0xE000) == 0) &&
+		(addr > block->pc) && !blockIsUncached(addr));
+
+	block->length = (uint16_t)(addr - block->pc);
+	if(block->length == 0 || addr < block->pc)
+	{
+		// Wrapped around the end of the address space
+		block->length = (uint16_t)(GB_MEMORY_SIZE - block->pc);
+	}
+}
+
+/*
+ * @brief Allocates an empty block cache
+ * @return Pointer to the new cache. Exits if out of memory
+ */
+blockCache_t* blockCacheCreate(void)
+{
+	blockCache_t* cache = calloc(1, sizeof(blockCache_t));
+
+	if(cache == NULL)
+	{
+		printf("Block cache allocation error\r\n");
+		exit(1);
+	}
+
+	return cache;
+}
+
+/*
+ * @brief Frees a block cache
+ */
+void blockCacheDestroy(blockCache_t* cache)
+{
+	free(cache);
+}
+
+/*
+ * @brief Decodes the block starting at the current PC into a cache entry, evicting whatever was there
+ * @param gb Pointer to gb struct containing registers
+ * @param block Cache entry PC maps to
+ * @param bank ROM bank mapped in at PC
+ * @return Pointer to the newly decoded block
+ * @note Slow path of blockLookup
+ */
+block_t* blockBuildAt(gameBoy_t* gb, block_t* block, uint16_t bank)
+{
+	if(block->valid)
+	{
+		blockCodeMapUpdate(gb->blockCache, block, -1);
+	}
+	blockBuild(gb, block, bank);
+	blockCodeMapUpdate(gb->blockCache, block, 1);
+
+	return block;
+}
+
+/*
+ * @brief Invalidates the block currently running if the memory it was decoded from is being bank switched out
+ * @param gb Pointer to gb struct containing registers
+ * @param addr First address of the range being remapped
+ * @param size Size of the range in bytes
+ * @return void
+ * @note Other blocks in the range stay cached, as they're keyed by bank. Only the running one would carry on with
+ * instructions from the old bank
+ */
+void blockRemapped(gameBoy_t* gb, uint16_t addr, uint32_t size)
+{
+	blockCache_t* cache = gb->blockCache;
+	block_t* block = (cache != NULL) ? cache->running : NULL;
+
+	if((block != NULL) && block->valid && (block->pc >= addr) && ((uint32_t)block->pc < (uint32_t)addr + size))
+	{
+		block->valid = false;
+		blockCodeMapUpdate(cache, block, -1);
+	}
+}
+
+/*
+ * @brief Invalidates every cached block covering a RAM address that has just been written to
+ * @param gb Pointer to gb struct containing registers
+ * @param addr Address written to
+ * @return void
+ * @note Only called when codeMap says the address is code, so the scan over the whole cache is rare. Blocks run
+ * from echo RAM are matched through the WRAM address they mirror
+ */
+void blockInvalidate(gameBoy_t* gb, uint16_t addr)
+{
+	blockCache_t* cache = gb->blockCache;
+
+	for(uint32_t i = 0; i < BLOCK_CACHE_SIZE; i++)
+	{
+		block_t* block = &cache->blocks[i];
+		if(block->valid && (block->pc >= BLOCK_RAM_START) && (blockCovers(block, addr) ||
+			((addr >= BUS_ADDR_WRAM) && (addr < BUS_ADDR_WRAM + (BUS_ADDR_OAM - BUS_ADDR_ECHO)) &&
+			blockCovers(block, addr + (BUS_ADDR_ECHO - BUS_ADDR_WRAM)))))
+		{
+			block->valid = false;
+			blockCodeMapUpdate(cache, block, -1);
+		}
+	}
+}
+
+/*
+ * @brief Invalidates every cached block decoded from RAM
+ * @param gb Pointer to gb struct containing registers
+ * @return void
+ * @note For when RAM is overwritten without going through the bus (see stateLoad). Blocks in ROM stay cached, as the
+ * ROM can't change underneath them
+ */
+void blockInvalidateRam(gameBoy_t* gb)
+{
+	blockCache_t* cache = gb->blockCache;
+
+	if(cache == NULL)
+	{
+		return;
+	}
+	for(uint32_t i = 0; i < BLOCK_CACHE_SIZE; i++)
+	{
+		block_t* block = &cache->blocks[i];
+		if(block->valid && (block->pc >= BLOCK_RAM_START))
+		{
+			block->valid = false;
+			blockCodeMapUpdate(cache, block, -1);
+		}
+	}
+	cache->running = NULL;
+}
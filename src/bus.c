@@ -0,0 +1,234 @@
+#include <stdint.h>
+#include <stddef.h>
+#include "bus.h"
+#include "cart.h"
+#include "ppu.h"
+#include "timers.h"
+#include "apu.h"
+#include "interrupts.h"
+#include "input.h"
+
+/*
+ * bus.c: The GameBoy's memory bus. Every read and write made by the CPU goes through gbRead8/gbWrite8 (see bus.h).
+ * The address space is split into 256 pages of 256 bytes, each with a host pointer for reads and one for writes.
+ * Plain ROM/RAM pages point straight at the memory backing them, so most accesses are a table lookup. Pages with
+ * side effects (cartridge ROM writes, which control the MBC, VRAM writes, I/O registers, echo RAM, OAM) are left NULL
+ * and handled by the slow path below. Bank switching only repoints entries, nothing is copied
+ */
+
+/*
+ * @brief Stores a byte to the memory[] array from the slow path
+ * @note Invalidates cached blocks covering the address, same as the gbWrite8 fast path
+ */
+static void busStore(gameBoy_t* gb, uint16_t addr, uint8_t value)
+{
+	gb->memory[addr] = value;
+
+#ifdef GB_CORE_BLOCK
+	if((gb->blockCache != NULL) && blockIsCode(gb->blockCache, addr))
+	{
+		blockInvalidate(gb, addr);
+	}
+#endif
+}
+
+/*
+ * @brief Handles a write to the I/O registers (0xFF00-0xFF7F)
+ * @param gb pointer to gb struct containing memory
+ * @param addr I/O register address
+ * @param value 8-bit value written
+ * @return void
+ */
+static void busWriteIo(gameBoy_t* gb, uint16_t addr, uint8_t value)
+{
+	switch(addr)
+	{
+		case TIMERS_REG_DIV:
+		case TIMERS_REG_TIMA:
+		case TIMERS_REG_TMA:
+		case TIMERS_REG_TAC:
+			timersWrite(gb, addr, value);
+			break;
+		case INPUT_REG_P1:
+			inputWrite(gb, value);
+			break;
+		case GB_REG_IF:
+			// The PPU has to catch up first, so interrupts it requests before the write are the ones overwritten
+			ppuSync(gb);
+			busStore(gb, addr, value);
+			interruptsCheck(gb);
+			break;
+		case BUS_REG_DMA:
+			// Copies 160 bytes into OAM. Done all at once rather than over the 160 cycles it takes on hardware
+			ppuSync(gb);
+			busStore(gb, addr, value);
+			for(uint16_t i = 0; i < (BUS_ADDR_UNUSABLE - BUS_ADDR_OAM); i++)
+			{
+				busStore(gb, BUS_ADDR_OAM + i, gbRead8(gb, (uint16_t)((value << 8) + i)));
+			}
+			break;
+		default:
+			if((addr >= PPU_REG_LCDC) && (addr <= PPU_REG_WX))
+			{
+				ppuSync(gb);
+				ppuWriteRegister(gb, addr, value);
+			}
+			else if((addr >= APU_REG_NR10) && (addr <= APU_ADDR_END))
+			{
+				apuWrite(gb, addr, value);
+			}
+			else
+			{
+				busStore(gb, addr, value);
+			}
+			break;
+	}
+}
+
+/*
+ * @brief Points a range of pages at host memory
+ * @param gb pointer to gb struct containing the page table
+ * @param addr first address of the range. Must be page aligned
+ * @param size size of the range in bytes. Must be a multiple of the page size
+ * @param read host memory backing the range for reads, or NULL to send reads to busReadSlow
+ * @param write host memory backing the range for writes, or NULL to send writes to busWriteSlow
+ * @return void
+ * @note Used for bank switching, so it has to stay cheap: a bank is 16-64 table entries
+ */
+void busMap(gameBoy_t* gb, uint16_t addr, uint32_t size, const uint8_t* read, uint8_t* write)
+{
+	uint32_t first = addr >> GB_PAGE_SHIFT;
+	uint32_t count = size >> GB_PAGE_SHIFT;
+
+#ifdef GB_CORE_BLOCK
+	// Code running from the range is about to be swapped out from under the block decoded from it
+	if(gb->readPage[first] != read)
+	{
+		blockRemapped(gb, addr, size);
+	}
+#endif
+
+	for(uint32_t i = 0; i < count; i++)
+	{
+		gb->readPage[first + i] = (read != NULL) ? (read + (i << GB_PAGE_SHIFT)) : NULL;
+		gb->writePage[first + i] = (write != NULL) ? (write + (i << GB_PAGE_SHIFT)) : NULL;
+	}
+}
+
+/*
+ * @brief Rebuilds the whole page table
+ * @param gb pointer to gb struct containing the page table
+ * @return void
+ * @note Called by gbInit. Has to be called again whenever the gb struct is copied, as some pages point into it
+ */
+void busRemap(gameBoy_t* gb)
+{
+	// Without a cartridge, ROM and cartridge RAM are backed by memory[] (ROM is still read only)
+	busMap(gb, BUS_ADDR_ROM0, BUS_ADDR_VRAM - BUS_ADDR_ROM0, &gb->memory[BUS_ADDR_ROM0], NULL);
+	// VRAM is written through busWriteSlow so the PPU can catch up on the lines drawn with the old contents first
+	busMap(gb, BUS_ADDR_VRAM, BUS_ADDR_CART_RAM - BUS_ADDR_VRAM, &gb->memory[BUS_ADDR_VRAM], NULL);
+	busMap(gb, BUS_ADDR_CART_RAM, BUS_ADDR_ECHO - BUS_ADDR_CART_RAM, &gb->memory[BUS_ADDR_CART_RAM],
+		&gb->memory[BUS_ADDR_CART_RAM]);
+	// Echo RAM is read straight from WRAM, but written through busWriteSlow so writes invalidate code in WRAM
+	busMap(gb, BUS_ADDR_ECHO, BUS_ADDR_OAM - BUS_ADDR_ECHO, &gb->memory[BUS_ADDR_WRAM], NULL);
+	// OAM, I/O registers, HRAM and IE
+	busMap(gb, BUS_ADDR_OAM, GB_MEMORY_SIZE - BUS_ADDR_OAM, NULL, NULL);
+
+	if(gb->cart != NULL)
+	{
+		cartRemap(gb);
+	}
+}
+
+/*
+ * @brief Reads a byte from a page with no host memory behind it
+ * @param gb pointer to gb struct containing memory
+ * @param addr 16-bit address to be read from
+ * @return 8-bit value read
+ */
+uint8_t busReadSlow(gameBoy_t* gb, uint16_t addr)
+{
+	if((addr >= BUS_ADDR_CART_RAM) && (addr < BUS_ADDR_WRAM))
+	{
+		// Disabled cartridge RAM or MBC3 RTC registers
+		return (gb->cart != NULL) ? cartRead(gb, addr) : 0xFF;
+	}
+	if((addr >= BUS_ADDR_UNUSABLE) && (addr < BUS_ADDR_IO))
+	{
+		return 0x00;
+	}
+	if(addr >= BUS_ADDR_OAM)
+	{
+		// OAM, I/O registers, HRAM and IE. LY, STAT and IF change as the PPU runs, so it has to catch up first
+		if((addr == GB_REG_IF) || ((addr >= PPU_REG_LCDC) && (addr <= PPU_REG_WX)))
+		{
+			ppuSync(gb);
+			if(addr == GB_REG_IF)
+			{
+				// Only the low 5 bits are there. The rest always read back as 1
+				return gb->memory[addr] | (uint8_t)~INTERRUPTS_MASK;
+			}
+		}
+		else if(addr == INPUT_REG_P1)
+		{
+			return inputRead(gb);
+		}
+		else if((addr >= TIMERS_REG_DIV) && (addr <= TIMERS_REG_TAC))
+		{
+			return timersRead(gb, addr);
+		}
+		else if((addr >= APU_REG_NR10) && (addr <= APU_ADDR_END))
+		{
+			return apuRead(gb, addr);
+		}
+		return gb->memory[addr];
+	}
+
+	return 0xFF;
+}
+
+/*
+ * @brief Writes a byte to a page with no host memory behind it
+ * @param gb pointer to gb struct containing memory
+ * @param addr 16-bit address to be written to
+ * @param value 8-bit value to be written
+ * @return void
+ */
+void busWriteSlow(gameBoy_t* gb, uint16_t addr, uint8_t value)
+{
+	if((addr < BUS_ADDR_VRAM) || ((addr >= BUS_ADDR_CART_RAM) && (addr < BUS_ADDR_WRAM)))
+	{
+		// MBC control registers, disabled cartridge RAM or MBC3 RTC registers. ROM itself is never written
+		if(gb->cart != NULL)
+		{
+			cartWrite(gb, addr, value);
+		}
+	}
+	else if((addr >= BUS_ADDR_ECHO) && (addr < BUS_ADDR_OAM))
+	{
+		gbWrite8(gb, addr - (BUS_ADDR_ECHO - BUS_ADDR_WRAM), value);
+	}
+	else if((addr >= BUS_ADDR_IO) && (addr < BUS_ADDR_HRAM))
+	{
+		busWriteIo(gb, addr, value);
+	}
+	else if((addr < BUS_ADDR_CART_RAM) || ((addr >= BUS_ADDR_OAM) && (addr < BUS_ADDR_UNUSABLE)))
+	{
+		// VRAM and OAM. Lines the PPU hasn't caught up on yet were drawn with the old contents
+		ppuSync(gb);
+		busStore(gb, addr, value);
+		if(addr < BUS_ADDR_CART_RAM)
+		{
+			ppuWriteVram(gb, addr);
+		}
+	}
+	else if(addr >= BUS_ADDR_HRAM)
+	{
+		// HRAM and IE
+		busStore(gb, addr, value);
+		if(addr == BUS_ADDR_IE)
+		{
+			interruptsCheck(gb);
+		}
+	}
+}
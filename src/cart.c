@@ -1,7 +1,15 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "gb.h"
+#include "bus.h"
+#include "cart.h"
 
 /*
  * cart.c: Contains logic related to loading and managing Game ROM as well as 
@@ -10,42 +18,581 @@
  * battery-backed save files
  */
 
+struct cartRom
+{
+	// File identity. A file that's been rewritten since it was mapped gets a new mapping
+	dev_t dev;
+	ino_t ino;
+	off_t fileSize;
+	struct timespec mtime;
+	const uint8_t* data;
+	uint32_t size; 		// Size of the mapping: fileSize rounded up to a power of 2 number of banks
+	uint32_t refCount;
+	struct cartRom* next;
+};
+
+// Every ROM file currently mapped, so instances loading the same file share one read only mapping
+static cartRom_t* cartRomList = NULL;
+static pthread_mutex_t cartRomLock = PTHREAD_MUTEX_INITIALIZER;
+
 void bootSequence(void)
 {
 
 }
 
+/*
+ * @brief Maps a ROM file into memory, or takes another reference to it if it's already mapped
+ * @param gameRom Path to the ROM file
+ * @return Pointer to the mapped ROM, or NULL if the file can't be loaded
+ * @note The file is mapped read only and MAP_PRIVATE, so nothing is read up front and the page cache backs every
+ * instance (and process) using it. The padding up to a power of 2 number of banks is anonymous memory and reads as 0
+ */
+static cartRom_t* cartRomAcquire(const char* gameRom)
+{
+	int fd = open(gameRom, O_RDONLY);
+	struct stat fileStat;
+	cartRom_t* rom = NULL;
+	uint32_t size = 2 * CART_ROM_BANK_SIZE;
+	uint8_t* data = NULL;
+
+	if((fd < 0) || (fstat(fd, &fileStat) != 0))
+	{
+		printf("Loading ROM NULL error: %s\r\n", gameRom);
+		if(fd >= 0)
+		{
+			close(fd);
+		}
+		return NULL;
+	}
+	if(fileStat.st_size > CART_ROM_MAX_SIZE)
+	{
+		printf("Game ROM too large error: %s\r\n", gameRom);
+		close(fd);
+		return NULL;
+	}
+	if(fileStat.st_size <= ADDR_HEADER_CHECKSUM)
+	{
+		printf("Game ROM too small error: %s\r\n", gameRom);
+		close(fd);
+		return NULL;
+	}
+
+	pthread_mutex_lock(&cartRomLock);
+
+	for(rom = cartRomList; rom != NULL; rom = rom->next)
+	{
+		if((rom->dev == fileStat.st_dev) && (rom->ino == fileStat.st_ino) && (rom->fileSize == fileStat.st_size) &&
+			(rom->mtime.tv_sec == fileStat.st_mtim.tv_sec) && (rom->mtime.tv_nsec == fileStat.st_mtim.tv_nsec))
+		{
+			rom->refCount++;
+			pthread_mutex_unlock(&cartRomLock);
+			close(fd);
+			return rom;
+		}
+	}
+
+	// Round up to a power of 2 number of banks, so bank numbers can be masked
+	while(size < fileStat.st_size)
+	{
+		size <<= 1;
+	}
+
+	// Reserve the whole range, then map the file over the start of it
+	data = mmap(NULL, size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if((data == MAP_FAILED) ||
+		(mmap(data, fileStat.st_size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED))
+	{
+		printf("Game ROM mapping error: %s\r\n", gameRom);
+		if(data != MAP_FAILED)
+		{
+			munmap(data, size);
+		}
+		pthread_mutex_unlock(&cartRomLock);
+		close(fd);
+		return NULL;
+	}
+	close(fd);
+
+	rom = calloc(1, sizeof(cartRom_t));
+	if(rom == NULL)
+	{
+		printf("Cartridge allocation error\r\n");
+		exit(1);
+	}
+	rom->dev = fileStat.st_dev;
+	rom->ino = fileStat.st_ino;
+	rom->fileSize = fileStat.st_size;
+	rom->mtime = fileStat.st_mtim;
+	rom->data = data;
+	rom->size = size;
+	rom->refCount = 1;
+	rom->next = cartRomList;
+	cartRomList = rom;
+
+	pthread_mutex_unlock(&cartRomLock);
+	return rom;
+}
+
+/*
+ * @brief Drops a reference to a mapped ROM, unmapping it once no instance is using it
+ * @param rom ROM returned by cartRomAcquire
+ * @return void
+ */
+static void cartRomRelease(cartRom_t* rom)
+{
+	cartRom_t** link = NULL;
+
+	pthread_mutex_lock(&cartRomLock);
+
+	if(--rom->refCount == 0)
+	{
+		for(link = &cartRomList; *link != NULL; link = &(*link)->next)
+		{
+			if(*link == rom)
+			{
+				*link = rom->next;
+				break;
+			}
+		}
+		munmap((void*)rom->data, rom->size);
+		free(rom);
+	}
+
+	pthread_mutex_unlock(&cartRomLock);
+}
+
+/*
+ * @brief Brings the MBC3 real time clock up to date with emulated time
+ * @param gb Pointer to gb struct containing the cartridge
+ * @return void
+ */
+static void cartRtcSync(gameBoy_t* gb)
+{
+	cart_t* cart = gb->cart;
+	uint64_t seconds = (gb->cyclesCurrent - cart->rtcCycles) / GB_CLOCK_HZ;
+	uint64_t total = 0;
+	uint32_t days = 0;
+
+	if(cart->rtc[CART_RTC_DAY_HIGH] & 0x40)
+	{
+		// Halted
+		cart->rtcCycles = gb->cyclesCurrent;
+		return;
+	}
+	if(seconds == 0)
+	{
+		return;
+	}
+	cart->rtcCycles += seconds * GB_CLOCK_HZ;
+
+	days = cart->rtc[CART_RTC_DAY_LOW] | ((cart->rtc[CART_RTC_DAY_HIGH] & 0x01) << 8);
+	total = cart->rtc[CART_RTC_SECONDS] + 60 * (cart->rtc[CART_RTC_MINUTES] + 60 * (cart->rtc[CART_RTC_HOURS] +
+		24 * (uint64_t)days)) + seconds;
+
+	cart->rtc[CART_RTC_SECONDS] = total % 60;
+	total /= 60;
+	cart->rtc[CART_RTC_MINUTES] = total % 60;
+	total /= 60;
+	cart->rtc[CART_RTC_HOURS] = total % 24;
+	total /= 24;
+
+	// Day counter is 9 bits, with a sticky carry bit for overflow
+	if(total > 0x1FF)
+	{
+		cart->rtc[CART_RTC_DAY_HIGH] |= 0x80;
+	}
+	cart->rtc[CART_RTC_DAY_LOW] = total & 0xFF;
+	cart->rtc[CART_RTC_DAY_HIGH] = (cart->rtc[CART_RTC_DAY_HIGH] & 0xFE) | ((total >> 8) & 0x01);
+}
+
+/*
+ * @brief Points the cartridge areas of the page table (0x0000-0x7FFF, 0xA000-0xBFFF) at the selected banks
+ * @param gb Pointer to gb struct containing the cartridge
+ * @return void
+ * @note Called after every MBC register write. Bank numbers beyond the end of the ROM/RAM wrap around
+ */
+void cartRemap(gameBoy_t* gb)
+{
+	cart_t* cart = gb->cart;
+	uint16_t romBankMask = (cart->romSize / CART_ROM_BANK_SIZE) - 1;
+	uint8_t ramBankMask = (cart->ramSize > 0) ? (cart->ramSize / CART_RAM_BANK_SIZE) - 1 : 0;
+	uint16_t romBank0 = 0;
+	uint16_t romBankX = 1;
+	uint8_t ramBank = 0;
+	bool ramMapped = cart->ramEnable && (cart->ramSize > 0);
+
+	switch(cart->mbc)
+	{
+		case CART_MBC1:
+			romBankX = cart->romBankSelect | (cart->ramBankSelect << 5);
+			if(cart->bankingMode == 1)
+			{
+				romBank0 = cart->ramBankSelect << 5;
+				ramBank = cart->ramBankSelect;
+			}
+			break;
+		case CART_MBC3:
+			romBankX = cart->romBankSelect;
+			ramBank = cart->ramBankSelect;
+			if(cart->ramBankSelect >= CART_RTC_SELECT)
+			{
+				// RTC register. Goes through cartRead/cartWrite
+				ramMapped = false;
+			}
+			break;
+		case CART_MBC5:
+			romBankX = cart->romBankSelect;
+			ramBank = cart->ramBankSelect;
+			break;
+		default:
+			break;
+	}
+
+	cart->romBank0 = romBank0 & romBankMask;
+	cart->romBankX = romBankX & romBankMask;
+	cart->ramBank = ramBank & ramBankMask;
+	cart->ramMapped = ramMapped;
+
+	busMap(gb, BUS_ADDR_ROM0, CART_ROM_BANK_SIZE, &cart->rom[cart->romBank0 * CART_ROM_BANK_SIZE], NULL);
+	busMap(gb, BUS_ADDR_ROMX, CART_ROM_BANK_SIZE, &cart->rom[cart->romBankX * CART_ROM_BANK_SIZE], NULL);
+	if(ramMapped)
+	{
+		uint8_t* ram = &cart->ram[cart->ramBank * CART_RAM_BANK_SIZE];
+		busMap(gb, BUS_ADDR_CART_RAM, CART_RAM_BANK_SIZE, ram, ram);
+	}
+	else
+	{
+		busMap(gb, BUS_ADDR_CART_RAM, CART_RAM_BANK_SIZE, NULL, NULL);
+	}
+}
+
+/*
+ * @brief Reads from the cartridge RAM area while it isn't mapped to RAM
+ * @param gb Pointer to gb struct containing the cartridge
+ * @param addr Address in 0xA000-0xBFFF
+ * @return Latched RTC register if one is selected, 0xFF otherwise (open bus)
+ */
+uint8_t cartRead(gameBoy_t* gb, uint16_t addr)
+{
+	cart_t* cart = gb->cart;
+	(void)addr;
+
+	if((cart->mbc == CART_MBC3) && cart->ramEnable && (cart->ramBankSelect >= CART_RTC_SELECT) &&
+		(cart->ramBankSelect < CART_RTC_SELECT + CART_RTC_NUM_OF_REGS))
+	{
+		return cart->rtcLatched[cart->ramBankSelect - CART_RTC_SELECT];
+	}
+
+	return 0xFF;
+}
+
+/*
+ * @brief Handles a write to the cartridge: MBC control registers (0x0000-0x7FFF) or unmapped cartridge RAM
+ * @param gb Pointer to gb struct containing the cartridge
+ * @param addr Address written to
+ * @param value 8-bit value written
+ * @return void
+ */
+void cartWrite(gameBoy_t* gb, uint16_t addr, uint8_t value)
+{
+	cart_t* cart = gb->cart;
+
+	if(addr >= BUS_ADDR_CART_RAM)
+	{
+		// RTC register
+		if((cart->mbc == CART_MBC3) && cart->ramEnable && (cart->ramBankSelect >= CART_RTC_SELECT) &&
+			(cart->ramBankSelect < CART_RTC_SELECT + CART_RTC_NUM_OF_REGS))
+		{
+			cartRtcSync(gb);
+			cart->rtc[cart->ramBankSelect - CART_RTC_SELECT] = value;
+			if(cart->ramBankSelect == CART_RTC_SELECT + CART_RTC_SECONDS)
+			{
+				// Writing the seconds resets the sub-second counter
+				cart->rtcCycles = gb->cyclesCurrent;
+			}
+		}
+		return;
+	}
+
+	switch(cart->mbc)
+	{
+		case CART_MBC1:
+			if(addr < 0x2000)
+			{
+				cart->ramEnable = ((value & 0x0F) == 0x0A);
+			}
+			else if(addr < 0x4000)
+			{
+				// Bank 0 can't be selected here, as it's always at 0x0000-0x3FFF
+				cart->romBankSelect = ((value & 0x1F) == 0) ? 1 : (value & 0x1F);
+			}
+			else if(addr < 0x6000)
+			{
+				cart->ramBankSelect = value & 0x03;
+			}
+			else
+			{
+				cart->bankingMode = value & 0x01;
+			}
+			break;
+		case CART_MBC3:
+			if(addr < 0x2000)
+			{
+				cart->ramEnable = ((value & 0x0F) == 0x0A);
+			}
+			else if(addr < 0x4000)
+			{
+				cart->romBankSelect = ((value & 0x7F) == 0) ? 1 : (value & 0x7F);
+			}
+			else if(addr < 0x6000)
+			{
+				cart->ramBankSelect = value & 0x0F;
+			}
+			else
+			{
+				// Writing 0 then 1 latches the clock
+				if((cart->rtcLatchWrite == 0x00) && (value == 0x01))
+				{
+					cartRtcSync(gb);
+					memcpy(cart->rtcLatched, cart->rtc, sizeof(cart->rtc));
+				}
+				cart->rtcLatchWrite = value;
+			}
+			break;
+		case CART_MBC5:
+			if(addr < 0x2000)
+			{
+				cart->ramEnable = ((value & 0x0F) == 0x0A);
+			}
+			else if(addr < 0x3000)
+			{
+				cart->romBankSelect = (cart->romBankSelect & 0x100) | value;
+			}
+			else if(addr < 0x4000)
+			{
+				cart->romBankSelect = (cart->romBankSelect & 0xFF) | ((value & 0x01) << 8);
+			}
+			else if(addr < 0x6000)
+			{
+				cart->ramBankSelect = value & 0x0F;
+			}
+			break;
+		default:
+			// ROM only carts may still have RAM, which is always enabled
+			return;
+	}
+
+	cartRemap(gb);
+}
+
+/*
+ * @brief Parses and validates the cartridge header
+ * @param rom Pointer to the start of the ROM
+ * @param size Size of the ROM in bytes. Needed for the global checksum, which covers the whole ROM
+ * @return Parsed header. If the ROM is too small to hold one, the header is zeroed and both checksums are invalid
+ */
+cartHeader_t cartParseHeader(const uint8_t* rom, uint32_t size)
+{
+	cartHeader_t header;
+	uint8_t headerChecksum = 0;
+	uint16_t globalChecksum = 0;
+	// RAM size in bytes by ADDR_RAM_SIZE code
+	static const uint32_t ramSizes[] = { 0, 0x800, CART_RAM_BANK_SIZE, 4 * CART_RAM_BANK_SIZE,
+		16 * CART_RAM_BANK_SIZE, 8 * CART_RAM_BANK_SIZE };
+
+	memset(&header, 0, sizeof(header));
+	if(size < ADDR_HEADER_END)
+	{
+		header.mbc = CART_MBC_UNSUPPORTED;
+		return header;
+	}
+
+	for(uint32_t i = 0; i < CART_TITLE_SIZE; i++)
+	{
+		char c = rom[ADDR_TITLE_START + i];
+		if(c == '\0')
+		{
+			break;
+		}
+		header.title[i] = ((c >= ' ') && (c <= '~')) ? c : '?';
+	}
+
+	header.cgbFlag = rom[ADDR_CGB_FLAG];
+	header.sgbFlag = rom[ADDR_SGB_FLAG];
+	header.cartType = rom[ADDR_CART_TYPE];
+	header.destinationCode = rom[ADDR_DESTINATION_CODE];
+	header.version = rom[ADDR_ROM_VERSION_NUMBER];
+	header.headerChecksum = rom[ADDR_HEADER_CHECKSUM];
+	header.globalChecksum = (rom[ADDR_GLOBAL_CHECKSUM] << 8) | rom[ADDR_GLOBAL_CHECKSUM + 1];
+
+	// 32KB << code
+	if(rom[ADDR_ROM_SIZE] <= 0x08)
+	{
+		header.romSize = (2 * CART_ROM_BANK_SIZE) << rom[ADDR_ROM_SIZE];
+	}
+	if(rom[ADDR_RAM_SIZE] < (sizeof(ramSizes) / sizeof(ramSizes[0])))
+	{
+		header.ramSize = ramSizes[rom[ADDR_RAM_SIZE]];
+	}
+
+	if((header.cartType >= CART_TYPE_MBC1) && (header.cartType <= CART_TYPE_MBC1_LAST))
+	{
+		header.mbc = CART_MBC1;
+	}
+	else if((header.cartType >= CART_TYPE_MBC3) && (header.cartType <= CART_TYPE_MBC3_LAST))
+	{
+		header.mbc = CART_MBC3;
+	}
+	else if((header.cartType >= CART_TYPE_MBC5) && (header.cartType <= CART_TYPE_MBC5_LAST))
+	{
+		header.mbc = CART_MBC5;
+	}
+	else if((header.cartType == CART_TYPE_ROM_ONLY) ||
+		((header.cartType >= CART_TYPE_ROM_RAM) && (header.cartType <= CART_TYPE_ROM_RAM_LAST)))
+	{
+		header.mbc = CART_MBC_NONE;
+	}
+	else
+	{
+		header.mbc = CART_MBC_UNSUPPORTED;
+	}
+
+	// Same computation the boot ROM does
+	for(uint16_t addr = ADDR_TITLE_START; addr <= ADDR_ROM_VERSION_NUMBER; addr++)
+	{
+		headerChecksum = headerChecksum - rom[addr] - 1;
+	}
+	header.headerChecksumValid = (headerChecksum == header.headerChecksum);
+
+	for(uint32_t addr = 0; addr < size; addr++)
+	{
+		if((addr != ADDR_GLOBAL_CHECKSUM) && (addr != ADDR_GLOBAL_CHECKSUM + 1))
+		{
+			globalChecksum += rom[addr];
+		}
+	}
+	header.globalChecksumValid = (globalChecksum == header.globalChecksum);
+
+	return header;
+}
+
+/*
+ * @brief Returns a printable name for a memory bank controller
+ */
+const char* cartMbcName(cartMbc_t mbc)
+{
+	switch(mbc)
+	{
+		case CART_MBC_NONE:
+			return "ROM";
+		case CART_MBC1:
+			return "MBC1";
+		case CART_MBC3:
+			return "MBC3";
+		case CART_MBC5:
+			return "MBC5";
+		default:
+			return "unsupported";
+	}
+}
+
 /*
  * @brief Loads game ROM into the GameBoy's memory
- * @return null
+ * @param gb Pointer to gb struct to load the cartridge into
+ * @param gameRom Path to the ROM file
+ * @return false if the file couldn't be loaded or its cartridge type isn't supported, in which case gb is untouched
  * @note This must be called after the Boot ROM BIOS sequence, as 
  * that sequence uses the first 256 bytes of memory during execution
+ * @note The ROM isn't copied. The page table points straight into a mapping of the file shared by every instance
  */
-void cartLoadRom(gameBoy_t* gb, const char* gameRom)
+bool cartLoadRom(gameBoy_t* gb, const char* gameRom)
 {
-	FILE* file = fopen(gameRom, "rb");
-	uint32_t romSize = 0;
+	cart_t* cart = calloc(1, sizeof(cart_t));
+	cartHeader_t header;
 
-	if (file == NULL)
+	if(cart == NULL)
 	{
-		printf("Loading ROM NULL error\r\n");
+		printf("Cartridge allocation error\r\n");
 		exit(1);
 	}
 
-	fseek(file, 0, SEEK_END);
-	romSize = ftell(file);
-	fseek(file, 0, SEEK_SET);
+	cart->romFile = cartRomAcquire(gameRom);
+	if(cart->romFile == NULL)
+	{
+		free(cart);
+		return false;
+	}
+	cart->rom = cart->romFile->data;
+	cart->romSize = cart->romFile->size;
 
-	if (romSize > GB_MEMORY_SIZE)
+	// Only the header is needed here, so the size passed in stops short of the global checksum touching every page
+	header = cartParseHeader(cart->rom, ADDR_HEADER_END);
+	cart->mbc = header.mbc;
+	if(cart->mbc == CART_MBC_UNSUPPORTED)
 	{
-		printf("Game ROM too large error\r\n");
-		fclose(file);
-		exit(1);
+		printf("Unsupported cartridge type: %#04x: %s\r\n", header.cartType, gameRom);
+		cartRomRelease(cart->romFile);
+		free(cart);
+		return false;
+	}
+	if(cart->mbc == CART_MBC_NONE)
+	{
+		// ROM only carts may still have RAM, which is always enabled
+		cart->ramEnable = true;
 	}
 
-	// Load ROM into memory. 
-	// TODO: Integrate logic for memory bank switching
-	fread(gb->memory, sizeof(uint8_t), romSize, file);
-	fclose(file);
+	// 2KB RAM is given a whole bank
+	cart->ramSize = ((header.ramSize + CART_RAM_BANK_SIZE - 1) / CART_RAM_BANK_SIZE) * CART_RAM_BANK_SIZE;
+	cart->romBankSelect = 1;
+	cart->rtcCycles = gb->cyclesCurrent;
+
+	cartUnload(gb);
+	gb->cart = cart;
+	cartRemap(gb);
+	return true;
+}
 
+/*
+ * @brief Removes the cartridge, if any, handing 0x0000-0xBFFF back to memory[]
+ * @param gb Pointer to gb struct containing the cartridge
+ * @return void
+ */
+void cartUnload(gameBoy_t* gb)
+{
+	if(gb->cart == NULL)
+	{
+		return;
+	}
+
+	cartRomRelease(gb->cart->romFile);
+	if(!gb->cart->external)
+	{
+		free(gb->cart);
+	}
+	gb->cart = NULL;
+	busRemap(gb);
+}
+
+/*
+ * @brief Takes another reference to a cartridge's ROM mapping, e.g. for a copy of the cart struct made outside cart.c
+ * @param cart Cart struct (or copy of one) whose ROM is to be kept mapped
+ * @return The ROM, to be given back to cartReleaseRom. A copy of the cart struct can also have cartUnload release it
+ */
+cartRom_t* cartRetainRom(const cart_t* cart)
+{
+	pthread_mutex_lock(&cartRomLock);
+	cart->romFile->refCount++;
+	pthread_mutex_unlock(&cartRomLock);
+
+	return cart->romFile;
+}
+
+/*
+ * @brief Releases a reference taken by cartRetainRom, unmapping the ROM if nothing else has it loaded
+ * @param rom ROM returned by cartRetainRom
+ * @return void
+ */
+void cartReleaseRom(cartRom_t* rom)
+{
+	cartRomRelease(rom);
 }
@@ -0,0 +1,250 @@
+#include <stdint.h>
+#include <pthread.h>
+#include "compose.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/*
+ * compose.c: Turns one line of background/window and sprite colour numbers into ARGB8888 pixels. Applies the
+ * BGP/OBP0/OBP1 palettes and resolves which layer shows through, which is most of the PPU's per pixel work.
+ * SSE2 and AVX2 versions handle 16/32 pixels at a time. The best one the host supports is picked on first use, with
+ * the scalar version as the fallback on other CPUs
+ */
+
+// Grey level of each DMG shade, lightest first
+static const uint8_t composeShades[4] = { 0xFF, 0xAA, 0x55, 0x00 };
+
+// Grey level of each colour number (0-3) through BGP, OBP0 and OBP1, in that order
+typedef uint8_t composePalettes_t[3][4];
+
+typedef void composeKernel_t(uint32_t* line, const uint8_t* bg, const uint8_t* obj, const uint8_t* attr,
+	uint32_t count, const composePalettes_t palettes);
+
+static composeKernel_t* composeKernel;
+static pthread_once_t composeOnce = PTHREAD_ONCE_INIT;
+
+/*
+ * @brief Composes pixels one at a time. Also finishes off the pixels left over by the SIMD versions
+ * @param line Output pixels
+ * @param bg Background/window colour numbers
+ * @param obj Sprite colour numbers, 0 where there's no sprite
+ * @param attr Attributes of the sprite at each pixel. Only bits 4 (palette) and 7 (behind background) are used
+ * @param count Number of pixels
+ * @param palettes Grey level of each colour number through BGP, OBP0 and OBP1
+ * @return void
+ */
+static void composeScalar(uint32_t* line, const uint8_t* bg, const uint8_t* obj, const uint8_t* attr,
+	uint32_t count, const composePalettes_t palettes)
+{
+	for(uint32_t i = 0; i < count; i++)
+	{
+		uint8_t grey = palettes[0][bg[i] & 0x03];
+
+		// Sprites flagged as behind the background only show over colour 0
+		if((obj[i] != 0) && !((attr[i] & 0x80) && (bg[i] != 0)))
+		{
+			grey = palettes[1 + ((attr[i] >> 4) & 0x01)][obj[i] & 0x03];
+		}
+		line[i] = 0xFF000000 | (grey * 0x010101u);
+	}
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/*
+ * @brief Maps 16 colour numbers through a palette, by comparing against each of the 4 colours
+ * @param palette Grey level of each colour, repeated across all 16 bytes
+ */
+__attribute__((target("sse2")))
+static inline __m128i composeLookupSse2(__m128i colour, const __m128i palette[4])
+{
+	__m128i grey = _mm_setzero_si128();
+
+	for(uint8_t i = 0; i < 4; i++)
+	{
+		__m128i match = _mm_cmpeq_epi8(colour, _mm_set1_epi8((char)i));
+		grey = _mm_or_si128(grey, _mm_and_si128(match, palette[i]));
+	}
+
+	return grey;
+}
+
+/*
+ * @brief SSE2 version of composeScalar, 16 pixels at a time
+ */
+__attribute__((target("sse2")))
+static void composeSse2(uint32_t* line, const uint8_t* bg, const uint8_t* obj, const uint8_t* attr,
+	uint32_t count, const composePalettes_t palettes)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi8((char)0xFF);
+	const __m128i paletteBit = _mm_set1_epi8(0x10);
+	const __m128i behindBit = _mm_set1_epi8((char)0x80);
+	__m128i greys[3][4];
+	uint32_t i = 0;
+
+	// Broadcasting a byte takes several instructions without SSSE3, so it's done once up front
+	for(uint8_t p = 0; p < 3; p++)
+	{
+		for(uint8_t colour = 0; colour < 4; colour++)
+		{
+			greys[p][colour] = _mm_set1_epi8((char)palettes[p][colour]);
+		}
+	}
+
+	for(; i + 16 <= count; i += 16)
+	{
+		__m128i bgColour = _mm_loadu_si128((const __m128i*)&bg[i]);
+		__m128i objColour = _mm_loadu_si128((const __m128i*)&obj[i]);
+		__m128i objAttr = _mm_loadu_si128((const __m128i*)&attr[i]);
+		__m128i bgGrey = composeLookupSse2(bgColour, greys[0]);
+		__m128i obp1 = _mm_cmpeq_epi8(_mm_and_si128(objAttr, paletteBit), paletteBit);
+		__m128i objGrey = _mm_or_si128(_mm_and_si128(obp1, composeLookupSse2(objColour, greys[2])),
+			_mm_andnot_si128(obp1, composeLookupSse2(objColour, greys[1])));
+		// Background shows where there's no sprite, or the sprite is behind a non-zero background colour
+		__m128i behind = _mm_cmpeq_epi8(_mm_and_si128(objAttr, behindBit), behindBit);
+		__m128i showBg = _mm_or_si128(_mm_cmpeq_epi8(objColour, zero),
+			_mm_andnot_si128(_mm_cmpeq_epi8(bgColour, zero), behind));
+		__m128i grey = _mm_or_si128(_mm_and_si128(showBg, bgGrey), _mm_andnot_si128(showBg, objGrey));
+		// Widen each grey byte g to the pixel 0xFFgggggg
+		__m128i greyPairs = _mm_unpacklo_epi8(grey, grey);
+		__m128i greyAlpha = _mm_unpacklo_epi8(grey, alpha);
+
+		_mm_storeu_si128((__m128i*)&line[i], _mm_unpacklo_epi16(greyPairs, greyAlpha));
+		_mm_storeu_si128((__m128i*)&line[i + 4], _mm_unpackhi_epi16(greyPairs, greyAlpha));
+		greyPairs = _mm_unpackhi_epi8(grey, grey);
+		greyAlpha = _mm_unpackhi_epi8(grey, alpha);
+		_mm_storeu_si128((__m128i*)&line[i + 8], _mm_unpacklo_epi16(greyPairs, greyAlpha));
+		_mm_storeu_si128((__m128i*)&line[i + 12], _mm_unpackhi_epi16(greyPairs, greyAlpha));
+	}
+
+	composeScalar(&line[i], &bg[i], &obj[i], &attr[i], count - i, palettes);
+}
+
+/*
+ * @brief Maps 32 colour numbers through a palette
+ * @param palette Grey level of each colour in its first 4 bytes, repeated in both 128-bit lanes
+ */
+__attribute__((target("avx2")))
+static inline __m256i composeLookupAvx2(__m256i colour, __m256i palette)
+{
+	// Colour numbers are 0-3, so they can index the palette directly
+	return _mm256_shuffle_epi8(palette, colour);
+}
+
+/*
+ * @brief AVX2 version of composeScalar, 32 pixels at a time
+ */
+__attribute__((target("avx2")))
+static void composeAvx2(uint32_t* line, const uint8_t* bg, const uint8_t* obj, const uint8_t* attr,
+	uint32_t count, const composePalettes_t palettes)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+	const __m256i widen = _mm256_set1_epi32(0x010101);
+	const __m256i paletteBit = _mm256_set1_epi8(0x10);
+	const __m256i behindBit = _mm256_set1_epi8((char)0x80);
+	__m256i greys[3];
+	uint32_t i = 0;
+
+	for(uint8_t p = 0; p < 3; p++)
+	{
+		uint32_t packed = palettes[p][0] | (palettes[p][1] << 8) | (palettes[p][2] << 16) |
+			((uint32_t)palettes[p][3] << 24);
+		greys[p] = _mm256_set1_epi32((int)packed);
+	}
+
+	for(; i + 32 <= count; i += 32)
+	{
+		__m256i bgColour = _mm256_loadu_si256((const __m256i*)&bg[i]);
+		__m256i objColour = _mm256_loadu_si256((const __m256i*)&obj[i]);
+		__m256i objAttr = _mm256_loadu_si256((const __m256i*)&attr[i]);
+		__m256i bgGrey = composeLookupAvx2(bgColour, greys[0]);
+		__m256i obp1 = _mm256_cmpeq_epi8(_mm256_and_si256(objAttr, paletteBit), paletteBit);
+		__m256i objGrey = _mm256_blendv_epi8(composeLookupAvx2(objColour, greys[1]),
+			composeLookupAvx2(objColour, greys[2]), obp1);
+		// Background shows where there's no sprite, or the sprite is behind a non-zero background colour
+		__m256i behind = _mm256_cmpeq_epi8(_mm256_and_si256(objAttr, behindBit), behindBit);
+		__m256i showBg = _mm256_or_si256(_mm256_cmpeq_epi8(objColour, zero),
+			_mm256_andnot_si256(_mm256_cmpeq_epi8(bgColour, zero), behind));
+		__m256i grey = _mm256_blendv_epi8(objGrey, bgGrey, showBg);
+		__m128i greyLow = _mm256_castsi256_si128(grey);
+		__m128i greyHigh = _mm256_extracti128_si256(grey, 1);
+		__m128i quarters[4] = { greyLow, _mm_srli_si128(greyLow, 8), greyHigh, _mm_srli_si128(greyHigh, 8) };
+
+		// Widen each grey byte g to the pixel 0xFFgggggg, 8 at a time
+		for(uint8_t j = 0; j < 4; j++)
+		{
+			__m256i pixels = _mm256_mullo_epi32(_mm256_cvtepu8_epi32(quarters[j]), widen);
+			_mm256_storeu_si256((__m256i*)&line[i + j * 8], _mm256_or_si256(pixels, alpha));
+		}
+	}
+
+	composeScalar(&line[i], &bg[i], &obj[i], &attr[i], count - i, palettes);
+}
+
+#endif // __x86_64__ || __i386__
+
+/*
+ * @brief Picks the fastest kernel the host CPU supports
+ */
+static void composeInit(void)
+{
+	composeKernel = composeScalar;
+
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2"))
+	{
+		composeKernel = composeAvx2;
+	}
+	else if(__builtin_cpu_supports("sse2"))
+	{
+		composeKernel = composeSse2;
+	}
+#endif
+}
+
+/*
+ * @brief Composes a line of pixels from the background/window and sprite layers
+ * @param line Output pixels, ARGB8888
+ * @param bg Background/window colour numbers (0-3)
+ * @param obj Sprite colour numbers (0-3), 0 where there's no sprite
+ * @param attr Attributes of the sprite at each pixel. Only bits 4 (palette) and 7 (behind background) are used
+ * @param count Number of pixels
+ * @param bgp BGP register
+ * @param obp0 OBP0 register
+ * @param obp1 OBP1 register
+ * @return void
+ * @note All of attr is read, including where obj is 0, so it must be initialized
+ */
+void composeLine(uint32_t* line, const uint8_t* bg, const uint8_t* obj, const uint8_t* attr, uint32_t count,
+	uint8_t bgp, uint8_t obp0, uint8_t obp1)
+{
+	composePalettes_t palettes;
+	uint8_t registers[3] = { bgp, obp0, obp1 };
+
+	pthread_once(&composeOnce, composeInit);
+
+	for(uint8_t p = 0; p < 3; p++)
+	{
+		for(uint8_t colour = 0; colour < 4; colour++)
+		{
+			palettes[p][colour] = composeShades[(registers[p] >> (colour * 2)) & 0x03];
+		}
+	}
+
+	composeKernel(line, bg, obj, attr, count, palettes);
+}
+
+/*
+ * @brief Maps a single colour number through a palette
+ * @param palette BGP, OBP0 or OBP1 register
+ * @param colour Colour number (0-3)
+ * @return ARGB8888 pixel
+ */
+uint32_t composeColour(uint8_t palette, uint8_t colour)
+{
+	return 0xFF000000 | (composeShades[(palette >> (colour * 2)) & 0x03] * 0x010101u);
+}
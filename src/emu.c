@@ -14,24 +14,42 @@
  * Timer: Used in several parts of the GB
  */
 
-static emuContext_t context;
+/*
+ * @brief Sets a context up for an emulator that's running, not paused
+ * @param context Pointer to the context, owned by the caller. There's no shared state, so any number of emulators
+	can run side by side
+ * @return void
+ */
+void emuContextInit(emuContext_t* context)
+{
+	atomic_init(&context->paused, false);
+	atomic_init(&context->running, true);
+	atomic_init(&context->rewinding, false);
+	atomic_init(&context->buttons, 0);
+	context->ticks = 0;
+}
+
+void setEmuContextPaused(emuContext_t* context, bool newVal)
+{
+	context->paused = newVal;
+}
 
-emuContext_t* getEmuContext(void)
+void setEmuContextRunning(emuContext_t* context, bool newVal)
 {
-	return &context;
+	context->running = newVal;
 }
 
-void setEmuContextPaused(bool newVal)
+void setEmuContextRewinding(emuContext_t* context, bool newVal)
 {
-	context.paused = newVal;
+	context->rewinding = newVal;
 }
 
-void setEmuContextRunning(bool newVal)
+void setEmuContextButtons(emuContext_t* context, uint8_t newVal)
 {
-	context.running = newVal;
+	context->buttons = newVal;
 }
 
-void setEmuContextTicks(uint64_t newVal)
+void setEmuContextTicks(emuContext_t* context, uint64_t newVal)
 {
-	context.ticks = newVal;
+	context->ticks = newVal;
 }
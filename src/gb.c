@@ -1,16 +1,159 @@
 #include <stdio.h>
+#include <string.h>
 #include "gb.h"
+#include "bus.h"
+#include "cart.h"
+#include "block.h"
+#include "jit.h"
+#include "ppu.h"
+#include "sched.h"
+#include "timers.h"
+#include "apu.h"
+#include "interrupts.h"
+#include "idle.h"
+#include "input.h"
 
 #define GB_NUM_OF_OPCODES 512
 
+// Evaluates to 1 if the carry flag is set, 0 otherwise. Used by the instructions that shift/add the carry back in
+#define GB_CARRY_BIT(gb) ((gbFlagsGet(gb) & FLAG_REG_CARRY) ? 1 : 0)
+
 //gb.c: opcodes/registers related to the GameBoy. emu.c: logic related specifically to emulation such as pausing/resuming execution
 
 /*
  * @brief Helper function which returns the op code currently being pointed to by the Program Counter
+ * @note CB-prefixed op codes are returned as 0x100 | second byte, which is their index in gbDispatchTable
  */
 uint16_t gbGetOpCode(gameBoy_t* gb)
 {
-	return gb->memory[gb->pc];	
+	uint16_t opCode = gbRead8(gb, gb->pc);
+
+	if(opCode == GB_OPCODE_PREFIX_CB)
+	{
+		opCode = GB_OPCODE_CB_OFFSET | gbRead8(gb, gb->pc + 1);
+	}
+
+	return opCode;
+}
+
+#ifdef GB_LAZY_FLAGS
+/*
+ * @brief Computes F from the last ALU operation recorded by gbFlagsRecord
+ * @param gb pointer to gb struct containing registers
+ * @return Value F would hold had the operation set its flags eagerly
+ */
+static uint8_t gbFlagsValue(const gameBoy_t* gb)
+{
+	const gbLazyFlags_t* lazy = &gb->lazyFlags;
+	uint8_t flags = lazy->keep;
+
+	switch(lazy->op)
+	{
+		case GB_FLAGS_OP_ADD:
+			flags |= ((lazy->result & 0xFF) == 0) ? FLAG_REG_ZERO : 0;
+			flags |= (((lazy->lhs & 0x0F) + (lazy->rhs & 0x0F) + lazy->carryIn) > 0x0F) ? FLAG_REG_HALF_CARRY : 0;
+			flags |= (lazy->result > 0xFF) ? FLAG_REG_CARRY : 0;
+			return flags;
+		case GB_FLAGS_OP_SUB:
+			flags |= FLAG_REG_SUB;
+			flags |= ((lazy->result & 0xFF) == 0) ? FLAG_REG_ZERO : 0;
+			flags |= ((lazy->lhs & 0x0F) < ((lazy->rhs & 0x0F) + lazy->carryIn)) ? FLAG_REG_HALF_CARRY : 0;
+			flags |= (lazy->lhs < (lazy->rhs + lazy->carryIn)) ? FLAG_REG_CARRY : 0;
+			return flags;
+		case GB_FLAGS_OP_AND:
+			flags |= FLAG_REG_HALF_CARRY;
+			flags |= (lazy->result == 0) ? FLAG_REG_ZERO : 0;
+			return flags;
+		case GB_FLAGS_OP_OR:
+			flags |= (lazy->result == 0) ? FLAG_REG_ZERO : 0;
+			return flags;
+		case GB_FLAGS_OP_INC:
+			flags |= (lazy->result == 0) ? FLAG_REG_ZERO : 0;
+			flags |= ((lazy->result & 0x0F) == 0x00) ? FLAG_REG_HALF_CARRY : 0;
+			return flags;
+		case GB_FLAGS_OP_DEC:
+			flags |= FLAG_REG_SUB;
+			flags |= (lazy->result == 0) ? FLAG_REG_ZERO : 0;
+			flags |= ((lazy->result & 0x0F) == 0x0F) ? FLAG_REG_HALF_CARRY : 0;
+			return flags;
+		case GB_FLAGS_OP_ADD16:
+			flags |= (((lazy->lhs & 0xFFF) + (lazy->rhs & 0xFFF)) > 0xFFF) ? FLAG_REG_HALF_CARRY : 0;
+			flags |= (((uint32_t)lazy->lhs + (uint32_t)lazy->rhs) > 0xFFFF) ? FLAG_REG_CARRY : 0;
+			return flags;
+		default:
+			return gb->generalReg.f;
+	}
+}
+
+/*
+ * @brief Records an ALU operation in place of setting its flags
+ * @param gb pointer to gb struct containing registers
+ * @param op GB_FLAGS_OP_* operation performed
+ * @param lhs first operand
+ * @param rhs second operand
+ * @param carryIn carry added/subtracted by ADC/SBC, 0 otherwise
+ * @param result result of the operation, before truncation for ADD
+ * @param keep flags the operation leaves untouched, as they were beforehand
+ * @return void
+ */
+static inline void gbFlagsRecord(gameBoy_t* gb, uint8_t op, uint16_t lhs, uint16_t rhs, uint8_t carryIn,
+	uint16_t result, uint8_t keep)
+{
+	gb->lazyFlags.op = op;
+	gb->lazyFlags.lhs = lhs;
+	gb->lazyFlags.rhs = rhs;
+	gb->lazyFlags.carryIn = carryIn;
+	gb->lazyFlags.result = result;
+	gb->lazyFlags.keep = keep;
+}
+#endif
+
+/*
+ * @brief Writes the flags of the last recorded ALU operation back to register F
+ * @param gb pointer to gb struct containing registers
+ * @return void
+ * @note Does nothing unless built with LAZY_FLAGS=1. Anything outside of the CPU core (debugger, save states) has
+ * to call this before reading generalReg.f
+ */
+void gbFlagsSync(gameBoy_t* gb)
+{
+#ifdef GB_LAZY_FLAGS
+	if(gb->lazyFlags.op != GB_FLAGS_OP_NONE)
+	{
+		gb->generalReg.f = gbFlagsValue(gb);
+		gb->lazyFlags.op = GB_FLAGS_OP_NONE;
+	}
+#else
+	(void)gb;
+#endif
+}
+
+/*
+ * @brief Returns the current value of register F without writing back pending lazy flags
+ * @param gb pointer to gb struct containing registers
+ * @return Value of register F
+ */
+static inline uint8_t gbFlagsGet(gameBoy_t* gb)
+{
+#ifdef GB_LAZY_FLAGS
+	return gbFlagsValue(gb);
+#else
+	return gb->generalReg.f;
+#endif
+}
+
+/*
+ * @brief Drops pending lazy flags ahead of an instruction that overwrites all of register F
+ * @param gb pointer to gb struct containing registers
+ * @return void
+ */
+static inline void gbFlagsDiscard(gameBoy_t* gb)
+{
+#ifdef GB_LAZY_FLAGS
+	gb->lazyFlags.op = GB_FLAGS_OP_NONE;
+#else
+	(void)gb;
+#endif
 }
 
 /*
@@ -24,6 +167,9 @@ void gbINC_r8(gameBoy_t* gb, uint8_t* reg)
 {
 	uint8_t result = *reg + 1;
 
+#ifdef GB_LAZY_FLAGS
+	gbFlagsRecord(gb, GB_FLAGS_OP_INC, *reg, 1, 0, result, gbFlagsGet(gb) & FLAG_REG_CARRY);
+#else
 	// Set Z if result is 0
 	if(result == 0)
 	{
@@ -46,6 +192,7 @@ void gbINC_r8(gameBoy_t* gb, uint8_t* reg)
 
 	// Clear N
 	gb->generalReg.f &= ~FLAG_REG_SUB;
+#endif
 	*reg = result;
 }
 
@@ -60,6 +207,9 @@ void gbDEC_r8(gameBoy_t* gb, uint8_t* reg)
 {
 	uint8_t result = *reg - 1;
 
+#ifdef GB_LAZY_FLAGS
+	gbFlagsRecord(gb, GB_FLAGS_OP_DEC, *reg, 1, 0, result, gbFlagsGet(gb) & FLAG_REG_CARRY);
+#else
 	// Set Z if result is 0
 	if(result == 0)
 	{
@@ -82,6 +232,7 @@ void gbDEC_r8(gameBoy_t* gb, uint8_t* reg)
 
 	// Set N
 	gb->generalReg.f |= FLAG_REG_SUB;
+#endif
 	*reg = result;
 }
 
@@ -94,8 +245,9 @@ void gbDEC_r8(gameBoy_t* gb, uint8_t* reg)
  */
 void gbADD_HL_r16(gameBoy_t* gb, uint16_t value)
 {
-	gb->generalReg.hl += value;
-
+#ifdef GB_LAZY_FLAGS
+	gbFlagsRecord(gb, GB_FLAGS_OP_ADD16, gb->generalReg.hl, value, 0, 0, gbFlagsGet(gb) & FLAG_REG_ZERO);
+#else
 	// Set H if overflow from bit 11
 	if(((gb->generalReg.hl & 0xFFF) + (value & 0xFFF)) > 0xFFF)
 	{
@@ -118,510 +270,520 @@ void gbADD_HL_r16(gameBoy_t* gb, uint16_t value)
 
 	// Clear N flag
 	gb->generalReg.f &= ~FLAG_REG_SUB;
+#endif
+	gb->generalReg.hl += value;
 }
 
 /*
- * @brief Handles invalid or unknown opcodes and prints it
- * @param Pointer to gb struct containing registers
+ * @brief Helper function for adding an 8-bit value to register A
+ * @param gb pointer to gb struct containing registers
+ * @param value 8-bit number to be added to register A
+ * @param carry 1 to also add the carry flag (ADC), 0 otherwise (ADD)
  * @return void
- * @note Shouldn't exectute under normal circumstances
+ * @note Affects flags: Z N H C
  */
-void invalid(gameBoy_t* gb)
+void gbADD_A_r8(gameBoy_t* gb, uint8_t value, uint8_t carry)
 {
-	printf("Invalid opcode: %#04x\r\n", gb->memory[gb->pc]);
+	uint16_t result = gb->generalReg.a + value + carry;
+
+#ifdef GB_LAZY_FLAGS
+	gbFlagsRecord(gb, GB_FLAGS_OP_ADD, gb->generalReg.a, value, carry, result, 0);
+#else
+	uint8_t flags = 0x00;
+
+	// Set Z if result is 0
+	if((result & 0xFF) == 0)
+	{
+		flags |= FLAG_REG_ZERO;
+	}
+
+	// Set H if overflow from bit 3
+	if(((gb->generalReg.a & 0x0F) + (value & 0x0F) + carry) > 0x0F)
+	{
+		flags |= FLAG_REG_HALF_CARRY;
+	}
+
+	// Set C if overflow from bit 7
+	if(result > 0xFF)
+	{
+		flags |= FLAG_REG_CARRY;
+	}
+
+	// N is always cleared
+	gb->generalReg.f = flags;
+#endif
+	gb->generalReg.a = (uint8_t)result;
 }
 
 /*
- * @brief Op code function for No Operation instruction (0x00): NOP 
- * @details Performs no work but consumes 4 clock cycles
- * @param Pointer to gb struct containing registers
+ * @brief Helper function for subtracting an 8-bit value from register A
+ * @param gb pointer to gb struct containing registers
+ * @param value 8-bit number to be subtracted from register A
+ * @param carry 1 to also subtract the carry flag (SBC), 0 otherwise (SUB)
+ * @param store false to only compare (CP) and leave register A untouched
  * @return void
- * @note This instruction is 1 byte long and requires 4 cycles to execute
+ * @note Affects flags: Z N H C
  */
-void opNOP_0x00(gameBoy_t* gb)
+void gbSUB_A_r8(gameBoy_t* gb, uint8_t value, uint8_t carry, bool store)
 {
-	printf("NOP: %#04x\r\n", gb->memory[gb->pc]);
+	uint8_t result = gb->generalReg.a - value - carry;
+
+#ifdef GB_LAZY_FLAGS
+	gbFlagsRecord(gb, GB_FLAGS_OP_SUB, gb->generalReg.a, value, carry, result, 0);
+#else
+	uint8_t flags = FLAG_REG_SUB;
+
+	// Set Z if result is 0
+	if(result == 0)
+	{
+		flags |= FLAG_REG_ZERO;
+	}
+
+	// Set H if borrow from bit 4
+	if((gb->generalReg.a & 0x0F) < ((value & 0x0F) + carry))
+	{
+		flags |= FLAG_REG_HALF_CARRY;
+	}
+
+	// Set C if borrow from bit 8
+	if(gb->generalReg.a < (value + carry))
+	{
+		flags |= FLAG_REG_CARRY;
+	}
+
+	gb->generalReg.f = flags;
+#endif
+	if(store)
+	{
+		gb->generalReg.a = result;
+	}
 }
 
 /*
- * @brief Op code function for Load instruction (0x01): LD BC, d16
- * @details Loads 16-bit immediate value into register BC
- * @param Pointer to gb struct containing registers
+ * @brief Helper function for the bitwise operations (AND, XOR, OR) on register A
+ * @param gb pointer to gb struct containing registers
+ * @param result value register A is to hold after the operation
+ * @param halfCarry FLAG_REG_HALF_CARRY for AND, 0 for XOR/OR
  * @return void
- * @note This instruction is 3 bytes long and requires 12 cycles to execute
+ * @note Affects flags: Z N H C
  */
-void opLD_0x01(gameBoy_t* gb)
+void gbLogic_A_r8(gameBoy_t* gb, uint8_t result, uint8_t halfCarry)
 {
-	uint16_t value = gb->memory[gb->pc + 1] | (gb->memory[gb->pc + 2] << 8);
-	gb->generalReg.bc = value;
+#ifdef GB_LAZY_FLAGS
+	gbFlagsRecord(gb, halfCarry ? GB_FLAGS_OP_AND : GB_FLAGS_OP_OR, 0, 0, 0, result, 0);
+#else
+	// N and C are always cleared. H is set for AND only
+	gb->generalReg.f = halfCarry;
+
+	// Set Z if result is 0
+	if(result == 0)
+	{
+		gb->generalReg.f |= FLAG_REG_ZERO;
+	}
+#endif
+
+	gb->generalReg.a = result;
 }
 
 /*
- * @brief Op code function for Load instruction (0x02): LD (BC), A
- * @details Loads the value from register A to memory address specified by BC
- * @param Pointer to gb struct containing registers
+ * @brief Helpers for the 8-bit arithmetic/logic operations on register A, one per ALU op code row (0x80-0xBF)
+ * @param gb pointer to gb struct containing registers
+ * @param value 8-bit operand
  * @return void
- * @note This instruction is 1 byte long and requires 8 cycles to execute
+ * @note Affects flags: Z N H C
  */
-void opLD_0x02(gameBoy_t* gb)
+void gbADD_A(gameBoy_t* gb, uint8_t value)
 {
-	uint8_t value = gb->generalReg.a;
-	gb->memory[gb->generalReg.bc] = value;
+	gbADD_A_r8(gb, value, 0);
 }
 
-/*
- * @brief Op code function for Increment instruction (0x03): INC BC
- * @details Increments the value in register BC
- * @param Pointer to gb struct containing registers
- * @return void
- * @note This instruction is 1 byte long and requires 8 cycles to execute
- */
-void opINC_0x03(gameBoy_t* gb)
+void gbADC_A(gameBoy_t* gb, uint8_t value)
 {
-	gb->generalReg.bc++;
+	gbADD_A_r8(gb, value, GB_CARRY_BIT(gb));
 }
 
-/*
- * @brief Op code function for Increment instruction (0x04): INC B
- * @details Increments the value in register B
- * @param Pointer to gb struct containing registers
- * @return void
- * @note This instruction is 1 byte long and requires 4 cycles to execute
- * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
- */
-void opINC_0x04(gameBoy_t* gb)
+void gbSUB_A(gameBoy_t* gb, uint8_t value)
 {
-	gbINC_r8(gb, &gb->generalReg.b);
+	gbSUB_A_r8(gb, value, 0, true);
 }
 
-/*
- * @brief Op code function for Decrement instruction (0x04): DEC B
- * @details Decrements the value in register B
- * @param Pointer to gb struct containing registers
- * @return void
- * @note This instruction is 1 byte long and requires 4 cycles to execute
- * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
- */
-void opDEC_0x05(gameBoy_t* gb)
+void gbSBC_A(gameBoy_t* gb, uint8_t value)
 {
-	gbDEC_r8(gb, &gb->generalReg.b);
+	gbSUB_A_r8(gb, value, GB_CARRY_BIT(gb), true);
 }
 
-/*
- * @brief Op code function for Load instruction (0x06): LD B, d8
- * @details Loads 8-bit immediate value into register B
- * @param Pointer to gb struct containing registers
- * @return void
- * @note This instruction is 2 bytes long and requires 8 cycles to execute
- */
-void opLD_0x06(gameBoy_t* gb)
+void gbAND_A(gameBoy_t* gb, uint8_t value)
 {
-	uint8_t value = gb->memory[gb->pc + 1];
-	gb->generalReg.b = value;
+	gbLogic_A_r8(gb, gb->generalReg.a & value, FLAG_REG_HALF_CARRY);
+}
+
+void gbXOR_A(gameBoy_t* gb, uint8_t value)
+{
+	gbLogic_A_r8(gb, gb->generalReg.a ^ value, 0);
+}
+
+void gbOR_A(gameBoy_t* gb, uint8_t value)
+{
+	gbLogic_A_r8(gb, gb->generalReg.a | value, 0);
+}
+
+void gbCP_A(gameBoy_t* gb, uint8_t value)
+{
+	gbSUB_A_r8(gb, value, 0, false);
 }
 
 /*
- * @brief Op code function for Rotate Left instruction (0x07): RLCA
- * @details Shift bits left in register A by 1. bit 7 is shifted to C flag and bit 0
- * @param Pointer to gb struct containing registers
- * @return void
- * @note This instruction is 1 byte long and requires 4 cycles to execute
- * @note Affects (Z)ero, (N)Sub, (H)alf Carry, and (C)arry flags
+ * @brief Helper function for setting the flags shared by every CB-prefixed rotate/shift instruction
+ * @param gb pointer to gb struct containing registers
+ * @param result value produced by the rotate/shift
+ * @param carry true if a set bit was shifted out
+ * @return result, so callers can store it straight back to the operand
+ * @note Affects flags: Z N H C
  */
-void opRLCA_0x07(gameBoy_t* gb)
+uint8_t gbShiftFlags(gameBoy_t* gb, uint8_t result, bool carry)
 {
-	uint8_t carry = 0x00;
+	// N and H are always cleared
+	gbFlagsDiscard(gb);
+	gb->generalReg.f = 0x00;
 
-	// Set C flag if bit 7 is set
-	if((gb->generalReg.a & 0x80) == 0x80)
+	if(result == 0)
+	{
+		gb->generalReg.f |= FLAG_REG_ZERO;
+	}
+	if(carry)
 	{
-		carry = 0x01;
 		gb->generalReg.f |= FLAG_REG_CARRY;
 	}
-	
-	// Shift left by 1
-	gb->generalReg.a = (gb->generalReg.a << 1) | carry;
 
-	// Clear the Z, N, and H flags
-	gb->generalReg.f &= ~FLAG_REG_ZERO;
-	gb->generalReg.f &= ~FLAG_REG_SUB;
-	gb->generalReg.f &= ~FLAG_REG_HALF_CARRY;
+	return result;
 }
 
 /*
- * @brief Op code function for Load instruction (0x08): LD (a16), SP
- * @details Loads the stack pointer into a 16-bit memory address
- * @param Pointer to gb struct containing registers
- * @return void
- * @note This instruction is 3 bytes long and requires 20 cycles to execute
+ * @brief Helpers for the CB-prefixed rotate/shift operations, one per op code row (0xCB00-0xCB3F)
+ * @param gb pointer to gb struct containing registers
+ * @param value 8-bit operand
+ * @return Rotated/shifted value
+ * @note Affects flags: Z N H C
  */
-void opLD_0x08(gameBoy_t* gb)
+uint8_t gbRLC_r8(gameBoy_t* gb, uint8_t value)
 {
-	uint16_t value = gb->sp;
-	uint16_t memAddr = gb->memory[gb->pc + 1] | (gb->memory[gb->pc + 2] << 8);
-	// memory is uint8_t array, but sp is uint16_t. Store in 8-bit chunks (little-endian)
-	gb->memory[memAddr] = value & 0xFF;
-	gb->memory[memAddr + 1] = value >> 8;
+	return gbShiftFlags(gb, (value << 1) | (value >> 7), value & 0x80);
 }
 
-/*
- * @brief Op code function for Add instruction (0x09): ADD HL, BC
- * @details Adds the value of register BC to register HL
- * @param Pointer to gb struct containing registers
- * @return void
- * @note This instruction is 1 bytes long and requires 8 cycles to execute
- * @note Affects (N)Sub, (H)alf Carry, and (C)arry flags
- */
-void opADD_0x09(gameBoy_t* gb)
+uint8_t gbRRC_r8(gameBoy_t* gb, uint8_t value)
 {
-	uint16_t value = gb->generalReg.bc;
-	gbADD_HL_r16(gb, value);
+	return gbShiftFlags(gb, (value >> 1) | (value << 7), value & 0x01);
 }
 
-/*
- * @brief Op code function for Load instruction (0x0A): LD A, (BC) 
- * @details Loads the value from a memory address specified by BC to register A
- * @param Pointer to gb struct containing registers
- * @return void
- * @note This instruction is 1 byte long and requires 8 cycles to execute
- */
-void opLD_0x0A(gameBoy_t* gb)
+uint8_t gbRL_r8(gameBoy_t* gb, uint8_t value)
 {
-	uint8_t value = gb->memory[gb->generalReg.bc];
-	gb->generalReg.a = value;
+	return gbShiftFlags(gb, (value << 1) | GB_CARRY_BIT(gb), value & 0x80);
 }
 
-/*
- * @brief Op code function for Decrement instruction (0x0B): DEC BC
- * @details Decrements the value in register BC
- * @param Pointer to gb struct containing registers
- * @return void
- * @note This instruction is 1 byte long and requires 8 cycles to execute
- */
-void opDEC_0x0B(gameBoy_t* gb)
+uint8_t gbRR_r8(gameBoy_t* gb, uint8_t value)
 {
-	gb->generalReg.b--;
+	return gbShiftFlags(gb, (value >> 1) | (GB_CARRY_BIT(gb) << 7), value & 0x01);
 }
 
-/*
- * @brief Op code function for Increment instruction (0x0C): INC C
- * @details Increments the value in register C
- * @param Pointer to gb struct containing registers
- * @return void
- * @note This instruction is 1 byte long and requires 4 cycles to execute
- * @note Affects (Z)ero, (N)Sub, (H)alf Carry flags
- */
-void opINC_0x0C(gameBoy_t* gb)
+uint8_t gbSLA_r8(gameBoy_t* gb, uint8_t value)
 {
-	gbINC_r8(gb, &gb->generalReg.c);
+	return gbShiftFlags(gb, value << 1, value & 0x80);
 }
 
-/*
- * @brief Op code function for Decrement instruction (0x0D): DEC C
- * @details Increments the value in register C
- * @param Pointer to gb struct containing registers
- * @return void
- * @note This instruction is 1 byte long and requires 4 cycles to execute
- * @note Affects (Z)ero, (N)Sub, (H)alf Carry flags
- */
-void opDEC_0x0D(gameBoy_t* gb)
+uint8_t gbSRA_r8(gameBoy_t* gb, uint8_t value)
 {
-	gbDEC_r8(gb, &gb->generalReg.c);
+	return gbShiftFlags(gb, (value >> 1) | (value & 0x80), value & 0x01);
 }
 
-/*
- * @brief Op code function for Load instruction (0x0E): LD C, d8 
- * @details Loads the 8-bit value to register C
- * @param Pointer to gb struct containing registers
- * @return void
- * @note This instruction is 2 byte long and requires 8 cycles to execute
- */
-void opLD_0x0E(gameBoy_t* gb)
+uint8_t gbSWAP_r8(gameBoy_t* gb, uint8_t value)
 {
-	uint8_t value = gb->memory[gb->pc + 1];
-	gb->generalReg.c = value;
+	return gbShiftFlags(gb, (value << 4) | (value >> 4), false);
+}
+
+uint8_t gbSRL_r8(gameBoy_t* gb, uint8_t value)
+{
+	return gbShiftFlags(gb, value >> 1, value & 0x01);
 }
 
 /*
- * @brief Op code function for Rotate Right instruction (0x0F): RRCA
- * @details Shift bits right in register A by 1. bit 0 is shifted to C flag and bit 7
- * @param Pointer to gb struct containing registers
+ * @brief Helper function for testing a single bit of an 8-bit value (BIT)
+ * @param gb pointer to gb struct containing registers
+ * @param bit bit number to be tested (0-7)
+ * @param value 8-bit value to be tested
  * @return void
- * @note This instruction is 1 byte long and requires 4 cycles to execute
- * @note Affects (Z)ero, (N)Sub, (H)alf Carry, and (C)arry flags
+ * @note Affects flags: Z N H
  */
-void opRRCA_0x0F(gameBoy_t* gb)
+void gbBIT_r8(gameBoy_t* gb, uint8_t bit, uint8_t value)
 {
-	uint8_t carry = 0x00;
+	gbFlagsSync(gb);
 
-	// Set C flag if bit 0 is set
-	if((gb->generalReg.a & 0x01) == 0x01)
+	// Set Z if the bit is clear
+	if(value & (1 << bit))
 	{
-		carry = 0x80;
-		gb->generalReg.f |= FLAG_REG_CARRY;
+		gb->generalReg.f &= ~FLAG_REG_ZERO;
+	}
+	else
+	{
+		gb->generalReg.f |= FLAG_REG_ZERO;
 	}
-	
-	// Shift left by 1
-	gb->generalReg.a = (gb->generalReg.a >> 1) | carry;
 
-	// Clear the Z, N, and H flags
-	gb->generalReg.f &= ~FLAG_REG_ZERO;
+	// Clear N, set H. C is untouched
 	gb->generalReg.f &= ~FLAG_REG_SUB;
-	gb->generalReg.f &= ~FLAG_REG_HALF_CARRY;
+	gb->generalReg.f |= FLAG_REG_HALF_CARRY;
 }
 
-// TODO: Research and implement STOP functionality 
-void opSTOP_0x10(gameBoy_t* gb)
+/*
+ * @brief Helper function for adding a signed 8-bit offset to SP (ADD SP, r8 / LD HL, SP+r8)
+ * @param gb pointer to gb struct containing registers
+ * @return SP plus the signed immediate following the op code
+ * @note Affects flags: Z N H C. H and C are computed on the low byte as an unsigned add
+ */
+uint16_t gbSP_r8(gameBoy_t* gb)
 {
-	printf("STOP: %#04x\r\n", gb->memory[gb->pc]);
+	uint8_t value = gbRead8(gb, gb->pc + 1);
+	uint8_t flags = 0x00;
+
+	// Set H if overflow from bit 3
+	if(((gb->sp & 0x0F) + (value & 0x0F)) > 0x0F)
+	{
+		flags |= FLAG_REG_HALF_CARRY;
+	}
+
+	// Set C if overflow from bit 7
+	if(((gb->sp & 0xFF) + value) > 0xFF)
+	{
+		flags |= FLAG_REG_CARRY;
+	}
+
+	// Z and N are always cleared
+	gbFlagsDiscard(gb);
+	gb->generalReg.f = flags;
+	return gb->sp + (int8_t)value;
 }
 
 /*
- * @brief Op code function for Load instruction (0x11): LD DE, d16
- * @details Loads 16-bit value into register DE
- * @param Pointer to gb struct containing registers
+ * @brief Helper function for pushing a 16-bit value onto the stack
+ * @param gb pointer to gb struct containing registers
+ * @param value 16-bit value to be pushed
  * @return void
- * @note This instruction is 3 bytes long and requires 12 cycles to execute
  */
-void opLD_0x11(gameBoy_t* gb)
+void gbPush16(gameBoy_t* gb, uint16_t value)
 {
-	uint16_t value = gb->memory[gb->pc + 1] | gb->memory[gb->pc + 2] << 8;
-	gb->generalReg.de = value;
+	gb->sp--;
+	gbWrite8(gb, gb->sp, value >> 8);
+	gb->sp--;
+	gbWrite8(gb, gb->sp, value & 0xFF);
 }
 
 /*
- * @brief Op code function for Load instruction (0x12): LD (DE), A
- * @details Loads value from register A to memory address specified by register DE
- * @param Pointer to gb struct containing registers
- * @return void
- * @note This instruction is 1 byte long and requires 8 cycles to execute
+ * @brief Helper function for popping a 16-bit value off of the stack
+ * @param gb pointer to gb struct containing registers
+ * @return 16-bit value popped
  */
-void opLD_0x12(gameBoy_t* gb)
+uint16_t gbPop16(gameBoy_t* gb)
 {
-	uint8_t value = gb->generalReg.a;
-	uint16_t memAddr = gb->generalReg.de;
-	gb->memory[memAddr] = value;
+	uint16_t value = gbRead8(gb, gb->sp);
+	gb->sp++;
+	value |= gbRead8(gb, gb->sp) << 8;
+	gb->sp++;
+	return value;
 }
 
 /*
- * @brief Op code function for Increment instruction (0x13): INC DE
- * @details Increments the value in register DE
- * @param Pointer to gb struct containing registers
+ * @brief Helper function for transferring control to an absolute address
+ * @param gb pointer to gb struct containing registers
+ * @param addr address of the next instruction to execute
+ * @param opCodeSize size in bytes of the instruction performing the jump
  * @return void
- * @note This instruction is 1 byte long and requires 8 cycles to execute
+ * @note The dispatcher adds the op code size to PC after every handler, so it's taken back off here. That
+ * keeps the dispatcher free of a "did PC change" check
  */
-void opINC_0x13(gameBoy_t* gb)
+void gbJump(gameBoy_t* gb, uint16_t addr, uint8_t opCodeSize)
 {
-	gb->generalReg.de++;	
+	gb->pc = addr - opCodeSize;
 }
 
 /*
- * @brief Op code function for Increment instruction (0x14): INC D
- * @details Increments the value in register D
- * @param Pointer to gb struct containing registers
+ * @brief Helper function for a taken relative jump (JR)
+ * @param gb pointer to gb struct containing registers
+ * @param offset signed offset from the address following the JR
  * @return void
- * @note This instruction is 1 byte long and requires 4 cycles to execute
- * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
+ * @note Short backward jumps close loops, which are passed on to idleSkip in case they're only polling something
  */
-void opINC_0x14(gameBoy_t* gb)
+static inline void gbJumpRelative(gameBoy_t* gb, int8_t offset)
 {
-	gbINC_r8(gb, &gb->generalReg.d);
+	if(gb->idle.enabled && (offset < 0) && (offset >= -IDLE_MAX_LENGTH))
+	{
+		idleSkip(gb, gb->pc, gb->pc + 2 + offset);
+	}
+	gb->pc += offset;
 }
 
 /*
- * @brief Op code function for Decrement instruction (0x15): DEC D
- * @details Decrements the value in register D
- * @param Pointer to gb struct containing registers
+ * @brief Helper function for calling a subroutine (CALL/RST)
+ * @param gb pointer to gb struct containing registers
+ * @param addr address of the subroutine
+ * @param opCodeSize size in bytes of the instruction performing the call
  * @return void
- * @note This instruction is 1 byte long and requires 4 cycles to execute
- * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
  */
-void opDEC_0x15(gameBoy_t* gb)
+void gbCall(gameBoy_t* gb, uint16_t addr, uint8_t opCodeSize)
 {
-	gbDEC_r8(gb, &gb->generalReg.d);
+	gbPush16(gb, gb->pc + opCodeSize);
+	gbJump(gb, addr, opCodeSize);
 }
 
 /*
- * @brief Op code function for Load instruction (0x16): LD D, d8
- * @details Loads 8-bit value into register D
- * @param Pointer to gb struct containing registers
+ * @brief Helper function for returning from a subroutine (RET/RETI)
+ * @param gb pointer to gb struct containing registers
  * @return void
- * @note This instruction is 2 bytes long and requires 8 cycles to execute
+ * @note Every return instruction is 1 byte long
  */
-void opLD_0x16(gameBoy_t* gb)
+void gbReturn(gameBoy_t* gb)
 {
-	uint8_t value = gb->memory[gb->pc + 1];
-	gb->generalReg.d = value;
+	gbJump(gb, gbPop16(gb), 1);
 }
 
 /*
- * @brief Op code function for Load instruction (0x17): RLA
- * @details Rotate register A left, through the carry flag (b7 -> C, C -> b0)
- * @param Pointer to gb struct containing registers
- * @return void
- * @note This instruction is 2 bytes long and requires 8 cycles to execute
- * @note Affects (Z)ero, (N)Sub, (H)alf Carry, and (C)arry flags
+ * @brief Helper function for evaluating the condition encoded in bits 4-3 of a conditional op code
+ * @param gb pointer to gb struct containing registers
+ * @param opCode conditional JR/JP/CALL/RET op code
+ * @return true if the condition (NZ, Z, NC, C) holds
  */
-void opRLA_0x17(gameBoy_t* gb)
+bool gbCondition(gameBoy_t* gb, uint8_t opCode)
 {
+	gbFlagsSync(gb);
 
-	uint8_t carry = 0x00;
-
-	// Save the carry to be moved to bit 0
-	carry = (gb->generalReg.f & FLAG_REG_CARRY) ? 1 : 0;
-
-	// Shift bit 7 to carry register
-	if((gb->generalReg.a & 0x80) == 0x80)
+	switch((opCode >> 3) & 0x03)
 	{
-		gb->generalReg.f |= FLAG_REG_CARRY;
+		case 0:
+			return !(gb->generalReg.f & FLAG_REG_ZERO);
+		case 1:
+			return (gb->generalReg.f & FLAG_REG_ZERO);
+		case 2:
+			return !(gb->generalReg.f & FLAG_REG_CARRY);
+		default:
+			return (gb->generalReg.f & FLAG_REG_CARRY);
 	}
-	else
-	{
-		gb->generalReg.f &= ~FLAG_REG_CARRY;
-	}	
-
-	// Shift register A left 1
-	gb->generalReg.a = (gb->generalReg.a << 1) | carry;
-
-	gb->generalReg.f &= ~FLAG_REG_ZERO;
-	gb->generalReg.f &= ~FLAG_REG_SUB;
-	gb->generalReg.f &= ~FLAG_REG_HALF_CARRY;
 }
 
 /*
- * @brief Op code function for Relative Jump instruction (0x18): JR r8
- * @details Unconditional relative jump by adding 8-bit offset to PC
+ * @brief Handles invalid or unknown opcodes and prints it
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 2 bytes long and requires 12 cycles to execute
+ * @note Shouldn't exectute under normal circumstances
  */
-void opJR_0x18(gameBoy_t* gb)
+void invalid(gameBoy_t* gb)
 {
-	int8_t offset = (int8_t)gb->memory[gb->pc + 1];
+	printf("Invalid opcode: %#04x\r\n", gbRead8(gb, gb->pc));
+}
 
-	gb->pc += offset;
+/*
+ * @brief Op code function for No Operation instruction (0x00): NOP 
+ * @details Performs no work but consumes 4 clock cycles
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
+ */
+void opNOP_0x00(gameBoy_t* gb)
+{
+	(void)gb;
 }
 
 /*
- * @brief Op code function for Add instruction (0x19): ADD HL, DE
- * @details Add the value in register DE to register HL
+ * @brief Op code function for Load instruction (0x01): LD BC, d16
+ * @details Loads 16-bit immediate value into register BC
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 1 byte long and requires 8 cycles to execute
- * @note Affects (N)Sub, (H)alf Carry, (C)arry flags
+ * @note This instruction is 3 bytes long and requires 12 cycles to execute
  */
-void opADD_0x19(gameBoy_t* gb) 
+void opLD_0x01(gameBoy_t* gb)
 {
-	uint16_t value = gb->generalReg.de;
-	gbADD_HL_r16(gb, value);
+	uint16_t value = gbRead8(gb, gb->pc + 1) | (gbRead8(gb, gb->pc + 2) << 8);
+	gb->generalReg.bc = value;
 }
 
 /*
- * @brief Op code function for Load instruction (0x1A): LD A,(DE)
- * @details Loads value pointed to register DE to register A
+ * @brief Op code function for Load instruction (0x02): LD (BC), A
+ * @details Loads the value from register A to memory address specified by BC
  * @param Pointer to gb struct containing registers
  * @return void
  * @note This instruction is 1 byte long and requires 8 cycles to execute
  */
-void opLD_0x1A(gameBoy_t* gb)
+void opLD_0x02(gameBoy_t* gb)
 {
-	uint8_t value = gb->memory[gb->generalReg.de];
-	gb->generalReg.a = value;
+	uint8_t value = gb->generalReg.a;
+	gbWrite8(gb, gb->generalReg.bc, value);
 }
 
 /*
- * @brief Op code function for Decrement instruction (0x1B): DEC DE
- * @details Decrements the value in register DE
+ * @brief Op code function for Increment instruction (0x03): INC BC
+ * @details Increments the value in register BC
  * @param Pointer to gb struct containing registers
  * @return void
  * @note This instruction is 1 byte long and requires 8 cycles to execute
  */
-void opDEC_0x1B(gameBoy_t* gb)  // DEC DE
+void opINC_0x03(gameBoy_t* gb)
 {
-	gb->generalReg.de--;
+	gb->generalReg.bc++;
 }
 
 /*
- * @brief Op code function for Increment instruction (0x1C): INC E
- * @details Increment the value in register E
+ * @brief Op code function for Increment instruction (0x04): INC B
+ * @details Increments the value in register B
  * @param Pointer to gb struct containing registers
  * @return void
  * @note This instruction is 1 byte long and requires 4 cycles to execute
  * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
  */
-void opINC_0x1C(gameBoy_t* gb)
+void opINC_0x04(gameBoy_t* gb)
 {
-	gbINC_r8(gb, &gb->generalReg.e);
+	gbINC_r8(gb, &gb->generalReg.b);
 }
 
 /*
- * @brief Op code function for Decrement instruction (0x1D): DEC E
- * @details Decrement the value in register E
+ * @brief Op code function for Decrement instruction (0x04): DEC B
+ * @details Decrements the value in register B
  * @param Pointer to gb struct containing registers
  * @return void
  * @note This instruction is 1 byte long and requires 4 cycles to execute
  * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
  */
-void opDEC_0x1D(gameBoy_t* gb)
+void opDEC_0x05(gameBoy_t* gb)
 {
-	gb->generalReg.e--;
-
-	// Set Z if result is 0
-	if(gb->generalReg.e == 0)
-	{
-		gb->generalReg.f |= FLAG_REG_ZERO;
-	}
-	else
-	{
-		gb->generalReg.f &= ~FLAG_REG_ZERO;
-	}
-
-	// Set H if borrow from bit 4
-	if((gb->generalReg.e & 0xF) == 0xF)
-	{
-		gb->generalReg.f |= FLAG_REG_HALF_CARRY;
-	}
-	else
-	{
-		gb->generalReg.f &= ~FLAG_REG_HALF_CARRY;
-	}
-	
-	// Set the flag
-	gb->generalReg.f |= FLAG_REG_SUB;
+	gbDEC_r8(gb, &gb->generalReg.b);
 }
 
 /*
- * @brief Op code function for Load instruction (0x1E): LD E,d8
- * @details Loads 8-bit value into register E
+ * @brief Op code function for Load instruction (0x06): LD B, d8
+ * @details Loads 8-bit immediate value into register B
  * @param Pointer to gb struct containing registers
  * @return void
  * @note This instruction is 2 bytes long and requires 8 cycles to execute
  */
-void opLD_0x1E(gameBoy_t* gb)
+void opLD_0x06(gameBoy_t* gb)
 {
-	uint8_t value = gb->memory[gb->pc + 1];
-	gb->generalReg.e = value;
+	uint8_t value = gbRead8(gb, gb->pc + 1);
+	gb->generalReg.b = value;
 }
 
-// 
 /*
- * @brief Op code function for Rotate Right instruction (0x1F): RRA
- * @details Rotate register A right, through the carry flag ( C -> b7, b0 -> C)
+ * @brief Op code function for Rotate Left instruction (0x07): RLCA
+ * @details Shift bits left in register A by 1. bit 7 is shifted to C flag and bit 0
  * @param Pointer to gb struct containing registers
  * @return void
  * @note This instruction is 1 byte long and requires 4 cycles to execute
+ * @note Affects (Z)ero, (N)Sub, (H)alf Carry, and (C)arry flags
  */
-void opRRA_0x1F(gameBoy_t* gb)
+void opRLCA_0x07(gameBoy_t* gb)
 {
-
 	uint8_t carry = 0x00;
-	
-	// Save the old carry
-	carry = (gb->generalReg.f & FLAG_REG_CARRY) ? 0x80 : 0x00;
 
-	// Move bit 0 to carry
-	if((gb->generalReg.a & 0x01) == 0x01)
+	gbFlagsSync(gb);
+
+	// Set C flag if bit 7 is set
+	if((gb->generalReg.a & 0x80) == 0x80)
 	{
+		carry = 0x01;
 		gb->generalReg.f |= FLAG_REG_CARRY;
 	}
 	else
@@ -629,564 +791,2621 @@ void opRRA_0x1F(gameBoy_t* gb)
 		gb->generalReg.f &= ~FLAG_REG_CARRY;
 	}
 	
-	// Shift bits right	
-	gb->generalReg.a = (gb->generalReg.a >> 1) | carry;
+	// Shift left by 1
+	gb->generalReg.a = (gb->generalReg.a << 1) | carry;
 
+	// Clear the Z, N, and H flags
 	gb->generalReg.f &= ~FLAG_REG_ZERO;
 	gb->generalReg.f &= ~FLAG_REG_SUB;
 	gb->generalReg.f &= ~FLAG_REG_HALF_CARRY;
 }
 
 /*
- * @brief Op code function for Relative Jump instruction (0x20): JR r8
- * @details If Z flag is clear, jump to 8-bit signed offset 
+ * @brief Op code function for Load instruction (0x08): LD (a16), SP
+ * @details Loads the stack pointer into a 16-bit memory address
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 2 bytes long and requires 8(false) or 12(true) cycles to execute
+ * @note This instruction is 3 bytes long and requires 20 cycles to execute
  */
-void opJR_0x20(gameBoy_t* gb)  // JR NZ, e8 
+void opLD_0x08(gameBoy_t* gb)
 {
-	// Memory needs to be casted as int8_t 
-	int8_t offset = (int8_t)gb->memory[gb->pc + 1];
-
-	// Jump if flag Z is not set
-	if(!(gb->generalReg.f & FLAG_REG_ZERO))
-	{
-		gb->pc += offset;
-		// If true, add 4 cycles to the 8 in table to get 12
-		gb->cyclesExtraFlag = true;
-	}
+	uint16_t value = gb->sp;
+	uint16_t memAddr = gbRead8(gb, gb->pc + 1) | (gbRead8(gb, gb->pc + 2) << 8);
+	// memory is uint8_t array, but sp is uint16_t. Store in 8-bit chunks (little-endian)
+	gbWrite8(gb, memAddr, value & 0xFF);
+	gbWrite8(gb, memAddr + 1, value >> 8);
 }
 
 /*
- * @brief Op code function for Load instruction (0x21): LD HL, d16
- * @details Loads 16-bit value into register HL
+ * @brief Op code function for Add instruction (0x09): ADD HL, BC
+ * @details Adds the value of register BC to register HL
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 3 bytes long and requires 12 cycles to execute
+ * @note This instruction is 1 bytes long and requires 8 cycles to execute
+ * @note Affects (N)Sub, (H)alf Carry, and (C)arry flags
  */
-void opLD_0x21(gameBoy_t* gb)
+void opADD_0x09(gameBoy_t* gb)
 {
-	uint16_t value = gb->memory[gb->pc + 1] | gb->memory[gb->pc + 2];
-	gb->generalReg.hl = value;
+	uint16_t value = gb->generalReg.bc;
+	gbADD_HL_r16(gb, value);
 }
 
 /*
- * @brief Op code function for Load instruction (0x22): LD (HL+),A
- * @details Stores the value of register A into register HL. HL is then incremented by 1
+ * @brief Op code function for Load instruction (0x0A): LD A, (BC) 
+ * @details Loads the value from a memory address specified by BC to register A
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 3 bytes long and requires 8 cycles to execute
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
  */
-void opLD_0x22(gameBoy_t* gb)
+void opLD_0x0A(gameBoy_t* gb)
 {
-	uint16_t value = gb->generalReg.a;
-	gb->generalReg.hl = value;
-	gb->generalReg.hl++;
+	uint8_t value = gbRead8(gb, gb->generalReg.bc);
+	gb->generalReg.a = value;
 }
 
 /*
- * @brief Op code function for Increment instruction (0x1C): INC HL
- * @details Increment the value in register HL
+ * @brief Op code function for Decrement instruction (0x0B): DEC BC
+ * @details Decrements the value in register BC
  * @param Pointer to gb struct containing registers
  * @return void
  * @note This instruction is 1 byte long and requires 8 cycles to execute
- * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
  */
-void opINC_0x23(gameBoy_t* gb)
+void opDEC_0x0B(gameBoy_t* gb)
 {
-	gb->generalReg.hl++;
+	gb->generalReg.bc--;
 }
 
 /*
- * @brief Op code function for Increment instruction (0x1C): INC H
- * @details Increment the value in register H
+ * @brief Op code function for Increment instruction (0x0C): INC C
+ * @details Increments the value in register C
  * @param Pointer to gb struct containing registers
  * @return void
  * @note This instruction is 1 byte long and requires 4 cycles to execute
- * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
+ * @note Affects (Z)ero, (N)Sub, (H)alf Carry flags
  */
-void opINC_0x24(gameBoy_t* gb)
+void opINC_0x0C(gameBoy_t* gb)
 {
-	gbINC_r8(gb, &gb->generalReg.h);
+	gbINC_r8(gb, &gb->generalReg.c);
 }
 
 /*
- * @brief Op code function for Decrement instruction (0x1D): DEC H
- * @details Decrement the value in register H
+ * @brief Op code function for Decrement instruction (0x0D): DEC C
+ * @details Increments the value in register C
  * @param Pointer to gb struct containing registers
  * @return void
  * @note This instruction is 1 byte long and requires 4 cycles to execute
- * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
+ * @note Affects (Z)ero, (N)Sub, (H)alf Carry flags
  */
-void opDEC_0x25(gameBoy_t* gb)
+void opDEC_0x0D(gameBoy_t* gb)
 {
-	gbDEC_r8(gb, &gb->generalReg.h);
+	gbDEC_r8(gb, &gb->generalReg.c);
 }
 
 /*
- * @brief Op code function for Decrement instruction (0x1D): DEC HL
- * @details Decrement the value in register HL
+ * @brief Op code function for Load instruction (0x0E): LD C, d8 
+ * @details Loads the 8-bit value to register C
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 2 byte long and requires 8 cycles to execute
+ */
+void opLD_0x0E(gameBoy_t* gb)
+{
+	uint8_t value = gbRead8(gb, gb->pc + 1);
+	gb->generalReg.c = value;
+}
+
+/*
+ * @brief Op code function for Rotate Right instruction (0x0F): RRCA
+ * @details Shift bits right in register A by 1. bit 0 is shifted to C flag and bit 7
  * @param Pointer to gb struct containing registers
  * @return void
  * @note This instruction is 1 byte long and requires 4 cycles to execute
+ * @note Affects (Z)ero, (N)Sub, (H)alf Carry, and (C)arry flags
  */
-void opDEC_0x2B(gameBoy_t* gb)
+void opRRCA_0x0F(gameBoy_t* gb)
 {
-	gb->generalReg.hl--;
+	uint8_t carry = 0x00;
+
+	gbFlagsSync(gb);
+
+	// Set C flag if bit 0 is set
+	if((gb->generalReg.a & 0x01) == 0x01)
+	{
+		carry = 0x80;
+		gb->generalReg.f |= FLAG_REG_CARRY;
+	}
+	else
+	{
+		gb->generalReg.f &= ~FLAG_REG_CARRY;
+	}
+	
+	// Shift left by 1
+	gb->generalReg.a = (gb->generalReg.a >> 1) | carry;
+
+	// Clear the Z, N, and H flags
+	gb->generalReg.f &= ~FLAG_REG_ZERO;
+	gb->generalReg.f &= ~FLAG_REG_SUB;
+	gb->generalReg.f &= ~FLAG_REG_HALF_CARRY;
 }
 
 /*
- * @brief Op code function for Increment instruction (0x1C): INC L
- * @details Increment the value in register L
+ * @brief Op code function for Stop instruction (0x10): STOP
+ * @details Stops the CPU (and resets DIV) until a button in a selected group is held. IF and IE don't matter
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 2 bytes long and requires 4 cycles to execute
+ * @note The LCD keeps running, rather than being blanked as on hardware
+ */
+void opSTOP_0x10(gameBoy_t* gb)
+{
+	timersWrite(gb, TIMERS_REG_DIV, 0);
+	gb->halted = true;
+	gb->stopped = true;
+	// Stops the CPU core, so gbRunCycles can skip ahead
+	schedAdd(gb, SCHED_EVENT_INTERRUPT, gb->cyclesCurrent);
+}
+
+/*
+ * @brief Op code function for Load instruction (0x11): LD DE, d16
+ * @details Loads 16-bit value into register DE
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 3 bytes long and requires 12 cycles to execute
+ */
+void opLD_0x11(gameBoy_t* gb)
+{
+	uint16_t value = gbRead8(gb, gb->pc + 1) | gbRead8(gb, gb->pc + 2) << 8;
+	gb->generalReg.de = value;
+}
+
+/*
+ * @brief Op code function for Load instruction (0x12): LD (DE), A
+ * @details Loads value from register A to memory address specified by register DE
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
+ */
+void opLD_0x12(gameBoy_t* gb)
+{
+	uint8_t value = gb->generalReg.a;
+	uint16_t memAddr = gb->generalReg.de;
+	gbWrite8(gb, memAddr, value);
+}
+
+/*
+ * @brief Op code function for Increment instruction (0x13): INC DE
+ * @details Increments the value in register DE
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
+ */
+void opINC_0x13(gameBoy_t* gb)
+{
+	gb->generalReg.de++;	
+}
+
+/*
+ * @brief Op code function for Increment instruction (0x14): INC D
+ * @details Increments the value in register D
  * @param Pointer to gb struct containing registers
  * @return void
  * @note This instruction is 1 byte long and requires 4 cycles to execute
  * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
  */
-void opINC_0x2C(gameBoy_t* gb) 
+void opINC_0x14(gameBoy_t* gb)
 {
-	gbINC_r8(gb, &gb->generalReg.l);
+	gbINC_r8(gb, &gb->generalReg.d);
 }
 
 /*
- * @brief Op code function for Decrement instruction (0x1D): DEC L
- * @details Decrement the value in register L
+ * @brief Op code function for Decrement instruction (0x15): DEC D
+ * @details Decrements the value in register D
  * @param Pointer to gb struct containing registers
  * @return void
  * @note This instruction is 1 byte long and requires 4 cycles to execute
  * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
  */
-void opDEC_0x2D(gameBoy_t* gb)
+void opDEC_0x15(gameBoy_t* gb)
 {
-	gbDEC_r8(gb, &gb->generalReg.l);
+	gbDEC_r8(gb, &gb->generalReg.d);
 }
 
 /*
- * @brief Op code function for Load instruction (0x26): LD H, d8
- * @details Loads 8-bit value to register H
+ * @brief Op code function for Load instruction (0x16): LD D, d8
+ * @details Loads 8-bit value into register D
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 2 byte long and requires 8 cycles to execute
+ * @note This instruction is 2 bytes long and requires 8 cycles to execute
  */
-void opLD_0x26(gameBoy_t* gb)  
+void opLD_0x16(gameBoy_t* gb)
 {
-	uint8_t value = gb->memory[gb->pc + 1];
-	gb->generalReg.h = value;
+	uint8_t value = gbRead8(gb, gb->pc + 1);
+	gb->generalReg.d = value;
 }
 
 /*
- * @brief Op code function for Decimal Adjust Accumulator instruction (0x27): DAA
- * @details if (N):: if (H): Add $6 to adjust / if (C): Add $60 to adjust. Subtract adjust from register A
-	if (!N):: initialize adjust to 0 / if(H || A & $F > $9): add $6 to adjust / if(C || A > $99): add
-	$60 to adjust and set C flag/ Add adjust to register A. Binary Coded Decimal
+ * @brief Op code function for Load instruction (0x17): RLA
+ * @details Rotate register A left, through the carry flag (b7 -> C, C -> b0)
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 1 byte long and requires 4 cycles to execute
- * @note Affects flags: Z, H, C
+ * @note This instruction is 2 bytes long and requires 8 cycles to execute
+ * @note Affects (Z)ero, (N)Sub, (H)alf Carry, and (C)arry flags
  */
-void opDAA_0x27(gameBoy_t* gb)  
+void opRLA_0x17(gameBoy_t* gb)
 {
-	uint8_t adjust = 0;
+	uint8_t carry = 0x00;
 
-	// Behavior differs based on whether N flag is set or not
-	if(gb->generalReg.f & FLAG_REG_SUB)
+	gbFlagsSync(gb);
+
+	// Save the carry to be moved to bit 0
+	carry = (gb->generalReg.f & FLAG_REG_CARRY) ? 1 : 0;
+
+	// Shift bit 7 to carry register
+	if((gb->generalReg.a & 0x80) == 0x80)
 	{
-		if(gb->generalReg.f & FLAG_REG_HALF_CARRY)
-		{
-			adjust += 0x06;
-		}
-		if(gb->generalReg.f & FLAG_REG_CARRY)
-		{
-			adjust += 0x60;
-		}
-		gb->generalReg.a -= adjust;
+		gb->generalReg.f |= FLAG_REG_CARRY;
 	}
 	else
 	{
-		if((gb->generalReg.f & FLAG_REG_HALF_CARRY) || ((gb->generalReg.a & 0x0F) > 0x09))
-		{
-			adjust += 0x06;
-		}
-		if((gb->generalReg.f & FLAG_REG_CARRY) || (gb->generalReg.a > 0x99))
-		{
-			adjust += 0x60;
-			gb->generalReg.f |= FLAG_REG_CARRY;
-		}
-		gb->generalReg.a += adjust;
-	}
+		gb->generalReg.f &= ~FLAG_REG_CARRY;
+	}	
+
+	// Shift register A left 1
+	gb->generalReg.a = (gb->generalReg.a << 1) | carry;
+
+	gb->generalReg.f &= ~FLAG_REG_ZERO;
+	gb->generalReg.f &= ~FLAG_REG_SUB;
+	gb->generalReg.f &= ~FLAG_REG_HALF_CARRY;
+}
+
+/*
+ * @brief Op code function for Relative Jump instruction (0x18): JR r8
+ * @details Unconditional relative jump by adding 8-bit offset to PC
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 2 bytes long and requires 12 cycles to execute
+ */
+void opJR_0x18(gameBoy_t* gb)
+{
+	int8_t offset = (int8_t)gbRead8(gb, gb->pc + 1);
+
+	gbJumpRelative(gb, offset);
+}
+
+/*
+ * @brief Op code function for Add instruction (0x19): ADD HL, DE
+ * @details Add the value in register DE to register HL
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
+ * @note Affects (N)Sub, (H)alf Carry, (C)arry flags
+ */
+void opADD_0x19(gameBoy_t* gb) 
+{
+	uint16_t value = gb->generalReg.de;
+	gbADD_HL_r16(gb, value);
+}
+
+/*
+ * @brief Op code function for Load instruction (0x1A): LD A,(DE)
+ * @details Loads value pointed to register DE to register A
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
+ */
+void opLD_0x1A(gameBoy_t* gb)
+{
+	uint8_t value = gbRead8(gb, gb->generalReg.de);
+	gb->generalReg.a = value;
+}
+
+/*
+ * @brief Op code function for Decrement instruction (0x1B): DEC DE
+ * @details Decrements the value in register DE
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
+ */
+void opDEC_0x1B(gameBoy_t* gb)  // DEC DE
+{
+	gb->generalReg.de--;
+}
+
+/*
+ * @brief Op code function for Increment instruction (0x1C): INC E
+ * @details Increment the value in register E
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
+ * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
+ */
+void opINC_0x1C(gameBoy_t* gb)
+{
+	gbINC_r8(gb, &gb->generalReg.e);
+}
+
+/*
+ * @brief Op code function for Decrement instruction (0x1D): DEC E
+ * @details Decrement the value in register E
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
+ * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
+ */
+void opDEC_0x1D(gameBoy_t* gb)
+{
+	gbDEC_r8(gb, &gb->generalReg.e);
+}
+
+/*
+ * @brief Op code function for Load instruction (0x1E): LD E,d8
+ * @details Loads 8-bit value into register E
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 2 bytes long and requires 8 cycles to execute
+ */
+void opLD_0x1E(gameBoy_t* gb)
+{
+	uint8_t value = gbRead8(gb, gb->pc + 1);
+	gb->generalReg.e = value;
+}
+
+// 
+/*
+ * @brief Op code function for Rotate Right instruction (0x1F): RRA
+ * @details Rotate register A right, through the carry flag ( C -> b7, b0 -> C)
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
+ */
+void opRRA_0x1F(gameBoy_t* gb)
+{
+	uint8_t carry = 0x00;
+
+	gbFlagsSync(gb);
+
+	// Save the old carry
+	carry = (gb->generalReg.f & FLAG_REG_CARRY) ? 0x80 : 0x00;
+
+	// Move bit 0 to carry
+	if((gb->generalReg.a & 0x01) == 0x01)
+	{
+		gb->generalReg.f |= FLAG_REG_CARRY;
+	}
+	else
+	{
+		gb->generalReg.f &= ~FLAG_REG_CARRY;
+	}
+	
+	// Shift bits right	
+	gb->generalReg.a = (gb->generalReg.a >> 1) | carry;
+
+	gb->generalReg.f &= ~FLAG_REG_ZERO;
+	gb->generalReg.f &= ~FLAG_REG_SUB;
+	gb->generalReg.f &= ~FLAG_REG_HALF_CARRY;
+}
+
+/*
+ * @brief Op code function for Relative Jump instruction (0x20): JR r8
+ * @details If Z flag is clear, jump to 8-bit signed offset 
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 2 bytes long and requires 8(false) or 12(true) cycles to execute
+ */
+void opJR_0x20(gameBoy_t* gb)  // JR NZ, e8 
+{
+	// Memory needs to be casted as int8_t 
+	int8_t offset = (int8_t)gbRead8(gb, gb->pc + 1);
+
+	gbFlagsSync(gb);
+
+	// Jump if flag Z is not set
+	if(!(gb->generalReg.f & FLAG_REG_ZERO))
+	{
+		gbJumpRelative(gb, offset);
+		// If true, add 4 cycles to the 8 in table to get 12
+		gb->cyclesExtraFlag = true;
+	}
+}
+
+/*
+ * @brief Op code function for Load instruction (0x21): LD HL, d16
+ * @details Loads 16-bit value into register HL
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 3 bytes long and requires 12 cycles to execute
+ */
+void opLD_0x21(gameBoy_t* gb)
+{
+	uint16_t value = gbRead8(gb, gb->pc + 1) | (gbRead8(gb, gb->pc + 2) << 8);
+	gb->generalReg.hl = value;
+}
+
+/*
+ * @brief Op code function for Load instruction (0x22): LD (HL+),A
+ * @details Stores the value of register A into the memory address pointed to by register HL. HL is then incremented by 1
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
+ */
+void opLD_0x22(gameBoy_t* gb)
+{
+	uint8_t value = gb->generalReg.a;
+	gbWrite8(gb, gb->generalReg.hl, value);
+	gb->generalReg.hl++;
+}
+
+/*
+ * @brief Op code function for Increment instruction (0x1C): INC HL
+ * @details Increment the value in register HL
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
+ * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
+ */
+void opINC_0x23(gameBoy_t* gb)
+{
+	gb->generalReg.hl++;
+}
+
+/*
+ * @brief Op code function for Increment instruction (0x1C): INC H
+ * @details Increment the value in register H
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
+ * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
+ */
+void opINC_0x24(gameBoy_t* gb)
+{
+	gbINC_r8(gb, &gb->generalReg.h);
+}
+
+/*
+ * @brief Op code function for Decrement instruction (0x1D): DEC H
+ * @details Decrement the value in register H
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
+ * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
+ */
+void opDEC_0x25(gameBoy_t* gb)
+{
+	gbDEC_r8(gb, &gb->generalReg.h);
+}
+
+/*
+ * @brief Op code function for Decrement instruction (0x1D): DEC HL
+ * @details Decrement the value in register HL
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
+ */
+void opDEC_0x2B(gameBoy_t* gb)
+{
+	gb->generalReg.hl--;
+}
+
+/*
+ * @brief Op code function for Increment instruction (0x1C): INC L
+ * @details Increment the value in register L
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
+ * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
+ */
+void opINC_0x2C(gameBoy_t* gb) 
+{
+	gbINC_r8(gb, &gb->generalReg.l);
+}
+
+/*
+ * @brief Op code function for Decrement instruction (0x1D): DEC L
+ * @details Decrement the value in register L
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
+ * @note Affects (Z)ero, (N)Sub, and (H)alf Carry flags
+ */
+void opDEC_0x2D(gameBoy_t* gb)
+{
+	gbDEC_r8(gb, &gb->generalReg.l);
+}
+
+/*
+ * @brief Op code function for Load instruction (0x26): LD H, d8
+ * @details Loads 8-bit value to register H
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 2 byte long and requires 8 cycles to execute
+ */
+void opLD_0x26(gameBoy_t* gb)  
+{
+	uint8_t value = gbRead8(gb, gb->pc + 1);
+	gb->generalReg.h = value;
+}
+
+/*
+ * @brief Op code function for Decimal Adjust Accumulator instruction (0x27): DAA
+ * @details if (N):: if (H): Add $6 to adjust / if (C): Add $60 to adjust. Subtract adjust from register A
+	if (!N):: initialize adjust to 0 / if(H || A & $F > $9): add $6 to adjust / if(C || A > $99): add
+	$60 to adjust and set C flag/ Add adjust to register A. Binary Coded Decimal
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
+ * @note Affects flags: Z, H, C
+ */
+void opDAA_0x27(gameBoy_t* gb)  
+{
+	uint8_t adjust = 0;
+
+	gbFlagsSync(gb);
+
+	// Behavior differs based on whether N flag is set or not
+	if(gb->generalReg.f & FLAG_REG_SUB)
+	{
+		if(gb->generalReg.f & FLAG_REG_HALF_CARRY)
+		{
+			adjust += 0x06;
+		}
+		if(gb->generalReg.f & FLAG_REG_CARRY)
+		{
+			adjust += 0x60;
+		}
+		gb->generalReg.a -= adjust;
+	}
+	else
+	{
+		if((gb->generalReg.f & FLAG_REG_HALF_CARRY) || ((gb->generalReg.a & 0x0F) > 0x09))
+		{
+			adjust += 0x06;
+		}
+		if((gb->generalReg.f & FLAG_REG_CARRY) || (gb->generalReg.a > 0x99))
+		{
+			adjust += 0x60;
+			gb->generalReg.f |= FLAG_REG_CARRY;
+		}
+		gb->generalReg.a += adjust;
+	}
+
+	// Set Z flag if 0. Clear otherwise
+	if(gb->generalReg.a == 0)
+	{
+		gb->generalReg.f |= FLAG_REG_ZERO;
+	}
+	else
+	{
+		gb->generalReg.f &= ~FLAG_REG_ZERO;
+	}
+
+	gb->generalReg.f &= ~FLAG_REG_HALF_CARRY;
+}
+
+/*
+ * @brief Op code function for Relative Jump instruction (0x20): JR r8
+ * @details If Z flag is set, jump to 8-bit signed offset 
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 2 bytes long and requires 8(false) or 12(true) cycles to execute
+ */
+void opJR_0x28(gameBoy_t* gb) 
+{
+	// Memory needs to be casted as int8_t 
+	int8_t offset = (int8_t)gbRead8(gb, gb->pc + 1);
+
+	gbFlagsSync(gb);
+
+	// Jump if flag Z is set
+	if(gb->generalReg.f & FLAG_REG_ZERO)
+	{
+		gbJumpRelative(gb, offset);
+		// If true, add 4 cycles to the 8 in table to get 12
+		gb->cyclesExtraFlag = true;
+	}
+}
+
+/*
+ * @brief Op code function for Add instruction (0x29): ADD HL, HL
+ * @details Add the value in register HL to register HL
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
+ * @note Affects flags: N, H, C
+ */
+void opADD_0x29(gameBoy_t* gb)
+{
+	uint16_t value = gb->generalReg.hl;
+	gbADD_HL_r16(gb, value);
+}
+
+/*
+ * @brief Op code function for Load instruction (0x2A): LD A,(HL+)
+ * @details Loads value pointed to register HL to register A, then increments HL
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
+ */
+void opLD_0x2A(gameBoy_t* gb)
+{
+	uint8_t value = gbRead8(gb, gb->generalReg.hl);
+	gb->generalReg.a = value;
+	gb->generalReg.hl++;
+}
+
+/*
+ * @brief Op code function for Load instruction (0x2E): LD L, d8
+ * @details Loads 8-bit value to register L 
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 2 byte long and requires 8 cycles to execute
+ */
+void opLD_0x2E(gameBoy_t* gb)
+{
+	uint8_t value = gbRead8(gb, gb->pc + 1);
+	gb->generalReg.l = value;
+}
+
+/*
+ * @brief Op code function for Complement instruction (0x2F): CPL
+ * @details Complements (Bitwise NOT) operation on accumulator
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
+ * @note Affects flags: N, H
+ */
+void opCPL_0x2F(gameBoy_t* gb)
+{
+	gbFlagsSync(gb);
+
+	gb->generalReg.a = ~gb->generalReg.a;
+
+	// Set N and H
+	gb->generalReg.f |= FLAG_REG_SUB;
+	gb->generalReg.f |= FLAG_REG_HALF_CARRY;
+}
+
+/*
+ * @brief Op code function for Relative Jump instruction (0x30): JR NC, r8
+ * @details If C flag is clear, jump to 8-bit signed offset 
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 2 bytes long and requires 8(false) or 12(true) cycles to execute
+ */
+void opJR_0x30(gameBoy_t* gb)
+{
+	// Memory needs to be casted as int8_t 
+	int8_t offset = (int8_t)gbRead8(gb, gb->pc + 1);
+
+	gbFlagsSync(gb);
+
+	// Jump if flag C is not set
+	if(!(gb->generalReg.f & FLAG_REG_CARRY))
+	{
+		gbJumpRelative(gb, offset);
+		// If true, add 4 cycles to the 8 in table to get 12
+		gb->cyclesExtraFlag = true;
+	}
+}
+
+/*
+ * @brief Op code function for Load instruction (0x31): LD SP, n16
+ * @details Copy the value n16 into register SP
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 3 bytes long and requires 12 cycles to execute
+ */
+void opLD_0x31(gameBoy_t* gb) 
+{
+	uint16_t value = gbRead8(gb, gb->pc + 1) | (gbRead8(gb, gb->pc + 2) << 8);
+	gb->sp = value;
+}
+
+/*
+ * @brief Op code function for Load instruction (0x32): LD (HL-), A
+ * @details Loads the value in register A to the memory address pointed to by register HL. HL is then decremented
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
+ */
+void opLD_0x32(gameBoy_t* gb) 
+{
+	uint8_t value = gb->generalReg.a;
+	gbWrite8(gb, gb->generalReg.hl, value);
+	gb->generalReg.hl--;
+}
+
+/*
+ * @brief Op code function for Increment instruction (0x33): INC SP
+ * @details Increments value in SP
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
+ */
+void opINC_0x33(gameBoy_t* gb)
+{
+	gb->sp++;
+}
+
+/*
+ * @brief Op code function for Increment instruction (0x34): INC (HL)
+ * @details Increment value pointed to by register HL
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 12 cycles to execute
+ * @note Affects flags: Z, N, H
+ */
+void opINC_0x34(gameBoy_t* gb)
+{
+	uint8_t value = gbRead8(gb, gb->generalReg.hl);
+	gbINC_r8(gb, &value);
+	gbWrite8(gb, gb->generalReg.hl, value);
+}
+
+/*
+ * @brief Op code function for Decrement instruction (0x35): DEC (HL)
+ * @details Decrement value pointed to by register HL
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 12 cycles to execute
+ * @note Affects flags: Z, N, H
+ */
+void opDEC_0x35(gameBoy_t* gb)
+{
+	uint8_t value = gbRead8(gb, gb->generalReg.hl);
+	gbDEC_r8(gb, &value);
+	gbWrite8(gb, gb->generalReg.hl, value);
+}
+
+/*
+ * @brief Op code function for Load instruction (0x36): LD (HL), n8
+ * @details Copies value n8 into address pointed to by register HL
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 2 bytes long and requires 12 cycles to execute
+ */
+void opLD_0x36(gameBoy_t* gb) 
+{
+	uint8_t value = gbRead8(gb, gb->pc + 1);
+	gbWrite8(gb, gb->generalReg.hl, value);
+}
+
+/*
+ * @brief Op code function for Set Carry Flag instruction (0x37): SCF
+ * @details Sets Carry flag
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 bytes long and requires 4 cycles to execute
+ * @note Affects flags: H, C, N
+ */
+void opSCF_0x37(gameBoy_t* gb) 
+{
+	gbFlagsSync(gb);
+
+	// Set C
+	gb->generalReg.f |= FLAG_REG_CARRY; 
+	// Set H
+	gb->generalReg.f &= ~FLAG_REG_HALF_CARRY; 
+	// Set N
+	gb->generalReg.f &= ~FLAG_REG_SUB; 
+}
+
+/*
+ * @brief Op code function for Relative Jump instruction (0x38): JR C, r8
+ * @details If C flag is set, jump to 8-bit signed offset 
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 2 bytes long and requires 8(false) or 12(true) cycles to execute
+ */
+void opJR_0x38(gameBoy_t* gb)
+{
+	// Memory needs to be casted as int8_t 
+	int8_t offset = (int8_t)gbRead8(gb, gb->pc + 1);
+
+	gbFlagsSync(gb);
+
+	// Jump if flag C is set
+	if(gb->generalReg.f & FLAG_REG_CARRY)
+	{
+		gbJumpRelative(gb, offset);
+		// If true, add 4 cycles to the 8 in table to get 12
+		gb->cyclesExtraFlag = true;
+	}
+}
+
+/*
+ * @brief Op code function for Add instruction (0x39): ADD HL, SP
+ * @details Add the value in SP to register HL
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
+ * @note Affects flags: N, H, C
+ */
+void opADD_0x39(gameBoy_t* gb)
+{
+	uint16_t value = gb->sp;
+	gbADD_HL_r16(gb, value);
+}
+
+/*
+ * @brief Op code function for Load instruction (0x3A): LD A, (HL-)
+ * @details Loads the value pointed to by register HL to register A. HL is then decremented
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 bytes long and requires 8 cycles to execute
+ */
+void opLD_0x3A(gameBoy_t* gb) 
+{
+	uint8_t value = gbRead8(gb, gb->generalReg.hl);
+	gb->generalReg.a = value;
+	gb->generalReg.hl--;
+}
+
+/*
+ * @brief Op code function for Decrement instruction (0x3B): DEC SP
+ * @details Decrement value of SP
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
+ */
+void opDEC_0x3B(gameBoy_t* gb)
+{
+	gb->sp--;
+}
+
+/*
+ * @brief Op code function for Decrement instruction (0x3C): INC A
+ * @details Increment value of register A
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
+ * @note Affects flags: Z, N, H
+ */
+void opINC_0x3C(gameBoy_t* gb)
+{
+	gbINC_r8(gb, &gb->generalReg.a);
+}
+
+/*
+ * @brief Op code function for Decrement instruction (0x3D): DEC A
+ * @details Decrement value of register A
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
+ * @note Affects flags: Z, N, H
+ */
+void opDEC_0x3D(gameBoy_t* gb)
+{
+	gbDEC_r8(gb, &gb->generalReg.a);
+}
+
+/*
+ * @brief Op code function for Load instruction (0x3E): LD A, n8
+ * @details Copies value n8 into register A
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 2 bytes long and requires 8 cycles to execute
+ */
+void opLD_0x3E(gameBoy_t* gb) 
+{
+	uint8_t value = gbRead8(gb, gb->pc + 1);
+	gb->generalReg.a = value;
+}
 
-	// Set Z flag if 0. Clear otherwise
-	if(gb->generalReg.a == 0)
+/*
+ * @brief Op code function for Complement Carry Flag instruction (0x3F): CCF
+ * @details Complements Carry flag
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 1 bytes long and requires 4 cycles to execute
+ * @note Affects flags: H, C, N
+ */
+void opCCF_0x3F(gameBoy_t* gb) 
+{
+	gbFlagsSync(gb);
+
+	// Complement C
+	if(gb->generalReg.f & FLAG_REG_CARRY)
 	{
-		gb->generalReg.f |= FLAG_REG_ZERO;
+		gb->generalReg.f &= ~FLAG_REG_CARRY; 
 	}
 	else
 	{
-		gb->generalReg.f &= ~FLAG_REG_ZERO;
+		gb->generalReg.f |= FLAG_REG_CARRY; 
 	}
 
-	gb->generalReg.f &= ~FLAG_REG_HALF_CARRY;
+	// Set H
+	gb->generalReg.f &= ~FLAG_REG_HALF_CARRY; 
+	// Set N
+	gb->generalReg.f &= ~FLAG_REG_SUB; 
 }
 
 /*
- * @brief Op code function for Relative Jump instruction (0x20): JR r8
- * @details If Z flag is set, jump to 8-bit signed offset 
+ * @brief Decode templates for the regular op code blocks
+ * @details The LR35902 encodes 8-bit register operands in bits 5-3 (destination) and 2-0 (source) in the order
+	B, C, D, E, H, L, (HL), A. Rather than hand-writing each of these handlers, every op code in the regular blocks
+	is stamped out from one of the templates below. Each op code still gets its own handler and table slot, so
+	there's no operand decoding left to do at run time
+ */
+
+/*
+ * @brief Templates for Load instructions (0x40-0x7F): LD r, r' / LD r, (HL) / LD (HL), r
+ * @note These instructions are 1 byte long and require 4 cycles, or 8 if (HL) is involved, to execute
+ */
+#define GB_OP_LD_R_R(opCode, dst, src) \
+void opLD_##opCode(gameBoy_t* gb) \
+{ \
+	gb->generalReg.dst = gb->generalReg.src; \
+}
+
+#define GB_OP_LD_R_HL(opCode, dst) \
+void opLD_##opCode(gameBoy_t* gb) \
+{ \
+	gb->generalReg.dst = gbRead8(gb, gb->generalReg.hl); \
+}
+
+#define GB_OP_LD_HL_R(opCode, src) \
+void opLD_##opCode(gameBoy_t* gb) \
+{ \
+	gbWrite8(gb, gb->generalReg.hl, gb->generalReg.src); \
+}
+
+GB_OP_LD_R_R(0x40, b, b)
+GB_OP_LD_R_R(0x41, b, c)
+GB_OP_LD_R_R(0x42, b, d)
+GB_OP_LD_R_R(0x43, b, e)
+GB_OP_LD_R_R(0x44, b, h)
+GB_OP_LD_R_R(0x45, b, l)
+GB_OP_LD_R_HL(0x46, b)
+GB_OP_LD_R_R(0x47, b, a)
+GB_OP_LD_R_R(0x48, c, b)
+GB_OP_LD_R_R(0x49, c, c)
+GB_OP_LD_R_R(0x4A, c, d)
+GB_OP_LD_R_R(0x4B, c, e)
+GB_OP_LD_R_R(0x4C, c, h)
+GB_OP_LD_R_R(0x4D, c, l)
+GB_OP_LD_R_HL(0x4E, c)
+GB_OP_LD_R_R(0x4F, c, a)
+GB_OP_LD_R_R(0x50, d, b)
+GB_OP_LD_R_R(0x51, d, c)
+GB_OP_LD_R_R(0x52, d, d)
+GB_OP_LD_R_R(0x53, d, e)
+GB_OP_LD_R_R(0x54, d, h)
+GB_OP_LD_R_R(0x55, d, l)
+GB_OP_LD_R_HL(0x56, d)
+GB_OP_LD_R_R(0x57, d, a)
+GB_OP_LD_R_R(0x58, e, b)
+GB_OP_LD_R_R(0x59, e, c)
+GB_OP_LD_R_R(0x5A, e, d)
+GB_OP_LD_R_R(0x5B, e, e)
+GB_OP_LD_R_R(0x5C, e, h)
+GB_OP_LD_R_R(0x5D, e, l)
+GB_OP_LD_R_HL(0x5E, e)
+GB_OP_LD_R_R(0x5F, e, a)
+GB_OP_LD_R_R(0x60, h, b)
+GB_OP_LD_R_R(0x61, h, c)
+GB_OP_LD_R_R(0x62, h, d)
+GB_OP_LD_R_R(0x63, h, e)
+GB_OP_LD_R_R(0x64, h, h)
+GB_OP_LD_R_R(0x65, h, l)
+GB_OP_LD_R_HL(0x66, h)
+GB_OP_LD_R_R(0x67, h, a)
+GB_OP_LD_R_R(0x68, l, b)
+GB_OP_LD_R_R(0x69, l, c)
+GB_OP_LD_R_R(0x6A, l, d)
+GB_OP_LD_R_R(0x6B, l, e)
+GB_OP_LD_R_R(0x6C, l, h)
+GB_OP_LD_R_R(0x6D, l, l)
+GB_OP_LD_R_HL(0x6E, l)
+GB_OP_LD_R_R(0x6F, l, a)
+GB_OP_LD_HL_R(0x70, b)
+GB_OP_LD_HL_R(0x71, c)
+GB_OP_LD_HL_R(0x72, d)
+GB_OP_LD_HL_R(0x73, e)
+GB_OP_LD_HL_R(0x74, h)
+GB_OP_LD_HL_R(0x75, l)
+GB_OP_LD_HL_R(0x77, a)
+GB_OP_LD_R_R(0x78, a, b)
+GB_OP_LD_R_R(0x79, a, c)
+GB_OP_LD_R_R(0x7A, a, d)
+GB_OP_LD_R_R(0x7B, a, e)
+GB_OP_LD_R_R(0x7C, a, h)
+GB_OP_LD_R_R(0x7D, a, l)
+GB_OP_LD_R_HL(0x7E, a)
+GB_OP_LD_R_R(0x7F, a, a)
+
+/*
+ * @brief Op code function for Halt instruction (0x76): HALT
+ * @details Stops the CPU until an interrupt is pending. gbRunCycles skips straight from one scheduled event to the
+	next in the meantime, as only an event can request an interrupt
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 2 bytes long and requires 8(false) or 12(true) cycles to execute
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
  */
-void opJR_0x28(gameBoy_t* gb) 
+void opHALT_0x76(gameBoy_t* gb)
+{
+	gb->halted = true;
+	// Stops the CPU core, and wakes the CPU straight away if an interrupt is already pending
+	schedAdd(gb, SCHED_EVENT_INTERRUPT, gb->cyclesCurrent);
+}
+
+/*
+ * @brief Templates for 8-bit arithmetic/logic instructions (0x80-0xBF, and the d8 forms in 0xC6-0xFE)
+ * @details ADD/ADC/SUB/SBC/AND/XOR/OR/CP register A with r, (HL) or an 8-bit immediate. name selects the gb<name>_A helper
+ * @note These instructions are 1 byte long and require 4 cycles, 8 for (HL). The d8 forms are 2 bytes long and require 8 cycles
+ * @note Affects flags: Z, N, H, C
+ */
+#define GB_OP_ALU_R(name, opCode, src) \
+void op##name##_##opCode(gameBoy_t* gb) \
+{ \
+	gb##name##_A(gb, gb->generalReg.src); \
+}
+
+#define GB_OP_ALU_HL(name, opCode) \
+void op##name##_##opCode(gameBoy_t* gb) \
+{ \
+	gb##name##_A(gb, gbRead8(gb, gb->generalReg.hl)); \
+}
+
+#define GB_OP_ALU_D8(name, opCode) \
+void op##name##_##opCode(gameBoy_t* gb) \
+{ \
+	gb##name##_A(gb, gbRead8(gb, gb->pc + 1)); \
+}
+
+GB_OP_ALU_R(ADD, 0x80, b)
+GB_OP_ALU_R(ADD, 0x81, c)
+GB_OP_ALU_R(ADD, 0x82, d)
+GB_OP_ALU_R(ADD, 0x83, e)
+GB_OP_ALU_R(ADD, 0x84, h)
+GB_OP_ALU_R(ADD, 0x85, l)
+GB_OP_ALU_HL(ADD, 0x86)
+GB_OP_ALU_R(ADD, 0x87, a)
+GB_OP_ALU_R(ADC, 0x88, b)
+GB_OP_ALU_R(ADC, 0x89, c)
+GB_OP_ALU_R(ADC, 0x8A, d)
+GB_OP_ALU_R(ADC, 0x8B, e)
+GB_OP_ALU_R(ADC, 0x8C, h)
+GB_OP_ALU_R(ADC, 0x8D, l)
+GB_OP_ALU_HL(ADC, 0x8E)
+GB_OP_ALU_R(ADC, 0x8F, a)
+GB_OP_ALU_R(SUB, 0x90, b)
+GB_OP_ALU_R(SUB, 0x91, c)
+GB_OP_ALU_R(SUB, 0x92, d)
+GB_OP_ALU_R(SUB, 0x93, e)
+GB_OP_ALU_R(SUB, 0x94, h)
+GB_OP_ALU_R(SUB, 0x95, l)
+GB_OP_ALU_HL(SUB, 0x96)
+GB_OP_ALU_R(SUB, 0x97, a)
+GB_OP_ALU_R(SBC, 0x98, b)
+GB_OP_ALU_R(SBC, 0x99, c)
+GB_OP_ALU_R(SBC, 0x9A, d)
+GB_OP_ALU_R(SBC, 0x9B, e)
+GB_OP_ALU_R(SBC, 0x9C, h)
+GB_OP_ALU_R(SBC, 0x9D, l)
+GB_OP_ALU_HL(SBC, 0x9E)
+GB_OP_ALU_R(SBC, 0x9F, a)
+GB_OP_ALU_R(AND, 0xA0, b)
+GB_OP_ALU_R(AND, 0xA1, c)
+GB_OP_ALU_R(AND, 0xA2, d)
+GB_OP_ALU_R(AND, 0xA3, e)
+GB_OP_ALU_R(AND, 0xA4, h)
+GB_OP_ALU_R(AND, 0xA5, l)
+GB_OP_ALU_HL(AND, 0xA6)
+GB_OP_ALU_R(AND, 0xA7, a)
+GB_OP_ALU_R(XOR, 0xA8, b)
+GB_OP_ALU_R(XOR, 0xA9, c)
+GB_OP_ALU_R(XOR, 0xAA, d)
+GB_OP_ALU_R(XOR, 0xAB, e)
+GB_OP_ALU_R(XOR, 0xAC, h)
+GB_OP_ALU_R(XOR, 0xAD, l)
+GB_OP_ALU_HL(XOR, 0xAE)
+GB_OP_ALU_R(XOR, 0xAF, a)
+GB_OP_ALU_R(OR, 0xB0, b)
+GB_OP_ALU_R(OR, 0xB1, c)
+GB_OP_ALU_R(OR, 0xB2, d)
+GB_OP_ALU_R(OR, 0xB3, e)
+GB_OP_ALU_R(OR, 0xB4, h)
+GB_OP_ALU_R(OR, 0xB5, l)
+GB_OP_ALU_HL(OR, 0xB6)
+GB_OP_ALU_R(OR, 0xB7, a)
+GB_OP_ALU_R(CP, 0xB8, b)
+GB_OP_ALU_R(CP, 0xB9, c)
+GB_OP_ALU_R(CP, 0xBA, d)
+GB_OP_ALU_R(CP, 0xBB, e)
+GB_OP_ALU_R(CP, 0xBC, h)
+GB_OP_ALU_R(CP, 0xBD, l)
+GB_OP_ALU_HL(CP, 0xBE)
+GB_OP_ALU_R(CP, 0xBF, a)
+
+/*
+ * @brief Templates for the conditional control flow instructions: RET cc, JP cc, a16 and CALL cc, a16
+ * @details The condition (NZ, Z, NC, C) is encoded in bits 4-3 of the op code and is resolved by gbCondition
+ * @note RET cc requires 8(false) or 20(true) cycles, JP cc 12(false) or 16(true), CALL cc 12(false) or 24(true)
+ */
+#define GB_OP_RET_CC(opCode) \
+void opRET_##opCode(gameBoy_t* gb) \
+{ \
+	if(gbCondition(gb, opCode)) \
+	{ \
+		gbReturn(gb); \
+		gb->cyclesExtraFlag = true; \
+	} \
+}
+
+#define GB_OP_JP_CC(opCode) \
+void opJP_##opCode(gameBoy_t* gb) \
+{ \
+	if(gbCondition(gb, opCode)) \
+	{ \
+		gbJump(gb, gbRead8(gb, gb->pc + 1) | (gbRead8(gb, gb->pc + 2) << 8), 3); \
+		gb->cyclesExtraFlag = true; \
+	} \
+}
+
+#define GB_OP_CALL_CC(opCode) \
+void opCALL_##opCode(gameBoy_t* gb) \
+{ \
+	if(gbCondition(gb, opCode)) \
+	{ \
+		gbCall(gb, gbRead8(gb, gb->pc + 1) | (gbRead8(gb, gb->pc + 2) << 8), 3); \
+		gb->cyclesExtraFlag = true; \
+	} \
+}
+
+/*
+ * @brief Template for Restart instructions (0xC7-0xFF): RST vec
+ * @details Calls the fixed address encoded in bits 5-3 of the op code (0x00, 0x08, ... 0x38)
+ * @note These instructions are 1 byte long and require 16 cycles to execute
+ */
+#define GB_OP_RST(opCode) \
+void opRST_##opCode(gameBoy_t* gb) \
+{ \
+	gbCall(gb, (opCode) & 0x38, 1); \
+}
+
+/*
+ * @brief Templates for the stack instructions: PUSH rr / POP rr
+ * @note These instructions are 1 byte long and require 16 (PUSH) or 12 (POP) cycles to execute
+ */
+#define GB_OP_PUSH(opCode, src) \
+void opPUSH_##opCode(gameBoy_t* gb) \
+{ \
+	gbPush16(gb, gb->generalReg.src); \
+}
+
+#define GB_OP_POP(opCode, dst) \
+void opPOP_##opCode(gameBoy_t* gb) \
+{ \
+	gb->generalReg.dst = gbPop16(gb); \
+}
+
+GB_OP_RET_CC(0xC0)
+GB_OP_RET_CC(0xC8)
+GB_OP_RET_CC(0xD0)
+GB_OP_RET_CC(0xD8)
+GB_OP_JP_CC(0xC2)
+GB_OP_JP_CC(0xCA)
+GB_OP_JP_CC(0xD2)
+GB_OP_JP_CC(0xDA)
+GB_OP_CALL_CC(0xC4)
+GB_OP_CALL_CC(0xCC)
+GB_OP_CALL_CC(0xD4)
+GB_OP_CALL_CC(0xDC)
+GB_OP_RST(0xC7)
+GB_OP_RST(0xCF)
+GB_OP_RST(0xD7)
+GB_OP_RST(0xDF)
+GB_OP_RST(0xE7)
+GB_OP_RST(0xEF)
+GB_OP_RST(0xF7)
+GB_OP_RST(0xFF)
+GB_OP_POP(0xC1, bc)
+GB_OP_POP(0xD1, de)
+GB_OP_POP(0xE1, hl)
+GB_OP_PUSH(0xC5, bc)
+GB_OP_PUSH(0xD5, de)
+GB_OP_PUSH(0xE5, hl)
+GB_OP_ALU_D8(ADD, 0xC6)
+GB_OP_ALU_D8(ADC, 0xCE)
+GB_OP_ALU_D8(SUB, 0xD6)
+GB_OP_ALU_D8(SBC, 0xDE)
+GB_OP_ALU_D8(AND, 0xE6)
+GB_OP_ALU_D8(XOR, 0xEE)
+GB_OP_ALU_D8(OR, 0xF6)
+GB_OP_ALU_D8(CP, 0xFE)
+
+/*
+ * @brief Op code function for Jump instruction (0xC3): JP a16
+ * @details Unconditional jump to 16-bit address
+ * @param Pointer to gb struct containing registers
+ * @return void
+ * @note This instruction is 3 bytes long and requires 16 cycles to execute
+ */
+void opJP_0xC3(gameBoy_t* gb)
 {
-	// Memory needs to be casted as int8_t 
-	int8_t offset = (int8_t)gb->memory[gb->pc + 1];
-
-	// Jump if flag Z is set
-	if(gb->generalReg.f & FLAG_REG_ZERO)
-	{
-		gb->pc += offset;
-		// If true, add 4 cycles to the 8 in table to get 12
-		gb->cyclesExtraFlag = true;
-	}
+	uint16_t memAddr = gbRead8(gb, gb->pc + 1) | (gbRead8(gb, gb->pc + 2) << 8);
+	gbJump(gb, memAddr, 3);
 }
 
 /*
- * @brief Op code function for Add instruction (0x29): ADD HL, HL
- * @details Add the value in register HL to register HL
+ * @brief Op code function for Return instruction (0xC9): RET
+ * @details Pops the return address off of the stack into PC
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 1 byte long and requires 8 cycles to execute
- * @note Affects flags: N, H, C
+ * @note This instruction is 1 byte long and requires 16 cycles to execute
  */
-void opADD_0x29(gameBoy_t* gb)
+void opRET_0xC9(gameBoy_t* gb)
 {
-	uint16_t value = gb->generalReg.hl;
-	gbADD_HL_r16(gb, value);
+	gbReturn(gb);
 }
 
 /*
- * @brief Op code function for Load instruction (0x2A): LD A,(HL+)
- * @details Loads value pointed to register HL to register A, then increments HL
+ * @brief Op code function for Call instruction (0xCD): CALL a16
+ * @details Pushes the address of the next instruction onto the stack and jumps to 16-bit address
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 1 byte long and requires 8 cycles to execute
+ * @note This instruction is 3 bytes long and requires 24 cycles to execute
  */
-void opLD_0x2A(gameBoy_t* gb)
+void opCALL_0xCD(gameBoy_t* gb)
 {
-	uint8_t value = gb->memory[gb->generalReg.hl];
-	gb->generalReg.a = value;
-	gb->generalReg.hl++;
+	uint16_t memAddr = gbRead8(gb, gb->pc + 1) | (gbRead8(gb, gb->pc + 2) << 8);
+	gbCall(gb, memAddr, 3);
 }
 
 /*
- * @brief Op code function for Load instruction (0x2E): LD L, d8
- * @details Loads 8-bit value to register L 
+ * @brief Op code function for Return from Interrupt instruction (0xD9): RETI
+ * @details Pops the return address off of the stack into PC and enables interrupts
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 2 byte long and requires 8 cycles to execute
+ * @note This instruction is 1 byte long and requires 16 cycles to execute
  */
-void opLD_0x2E(gameBoy_t* gb)
+void opRETI_0xD9(gameBoy_t* gb)
 {
-	uint8_t value = gb->memory[gb->pc + 1];
-	gb->generalReg.l = value;
+	gbReturn(gb);
+	gb->ime = true;
+	interruptsCheck(gb);
 }
 
 /*
- * @brief Op code function for Complement instruction (0x2F): CPL
- * @details Complements (Bitwise NOT) operation on accumulator
+ * @brief Op code function for Load High instruction (0xE0): LDH (a8), A
+ * @details Stores register A into memory address 0xFF00 + 8-bit immediate (I/O registers and HRAM)
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 1 byte long and requires 4 cycles to execute
+ * @note This instruction is 2 bytes long and requires 12 cycles to execute
  */
-void opCPL_0x2F(gameBoy_t* gb)
+void opLDH_0xE0(gameBoy_t* gb)
 {
-	gb->generalReg.a = ~gb->generalReg.a;
+	uint16_t memAddr = 0xFF00 | gbRead8(gb, gb->pc + 1);
+	gbWrite8(gb, memAddr, gb->generalReg.a);
 }
 
 /*
- * @brief Op code function for Load instruction (0x31): LD SP, n16
- * @details Copy the value n16 into register SP
+ * @brief Op code function for Load instruction (0xE2): LD (C), A
+ * @details Stores register A into memory address 0xFF00 + register C
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 3 bytes long and requires 12 cycles to execute
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
  */
-void opLD_0x31(gameBoy_t* gb) 
+void opLD_0xE2(gameBoy_t* gb)
 {
-	uint16_t value = gb->memory[gb->pc + 1];
-	gb->sp = value;
+	uint16_t memAddr = 0xFF00 | gb->generalReg.c;
+	gbWrite8(gb, memAddr, gb->generalReg.a);
 }
 
 /*
- * @brief Op code function for Load instruction (0x32): LD (HL-), A
- * @details Loads the value in register A to the memory address pointed to by register HL. HL is then decremented
+ * @brief Op code function for Add instruction (0xE8): ADD SP, r8
+ * @details Adds 8-bit signed immediate to SP
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 1 byte long and requires 8 cycles to execute
+ * @note This instruction is 2 bytes long and requires 16 cycles to execute
+ * @note Affects flags: Z, N, H, C
  */
-void opLD_0x32(gameBoy_t* gb) 
+void opADD_0xE8(gameBoy_t* gb)
 {
-	uint8_t value = gb->generalReg.a;
-	gb->memory[gb->generalReg.hl] = value;
-	gb->generalReg.hl--;
+	gb->sp = gbSP_r8(gb);
 }
 
 /*
- * @brief Op code function for Increment instruction (0x33): INC SP
- * @details Increments value in SP
+ * @brief Op code function for Jump instruction (0xE9): JP HL
+ * @details Jumps to the address held in register HL
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 1 byte long and requires 8 cycles to execute
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
  */
-void opINC_0x33(gameBoy_t* gb)
+void opJP_0xE9(gameBoy_t* gb)
 {
-	gb->sp++;
+	gbJump(gb, gb->generalReg.hl, 1);
 }
 
 /*
- * @brief Op code function for Increment instruction (0x34): INC (HL)
- * @details Increment value pointed to by register HL
+ * @brief Op code function for Load instruction (0xEA): LD (a16), A
+ * @details Stores register A into 16-bit memory address
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 1 byte long and requires 12 cycles to execute
- * @note Affects flags: Z, N, H
+ * @note This instruction is 3 bytes long and requires 16 cycles to execute
  */
-void opINC_0x34(gameBoy_t* gb)
+void opLD_0xEA(gameBoy_t* gb)
 {
-	gbINC_r8(gb, &gb->memory[gb->generalReg.hl]);
+	uint16_t memAddr = gbRead8(gb, gb->pc + 1) | (gbRead8(gb, gb->pc + 2) << 8);
+	gbWrite8(gb, memAddr, gb->generalReg.a);
 }
 
 /*
- * @brief Op code function for Decrement instruction (0x35): DEC (HL)
- * @details Decrement value pointed to by register HL
+ * @brief Op code function for Load High instruction (0xF0): LDH A, (a8)
+ * @details Loads the value at memory address 0xFF00 + 8-bit immediate into register A
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 1 byte long and requires 12 cycles to execute
- * @note Affects flags: Z, N, H
+ * @note This instruction is 2 bytes long and requires 12 cycles to execute
  */
-void opDEC_0x35(gameBoy_t* gb)
+void opLDH_0xF0(gameBoy_t* gb)
 {
-	gbDEC_r8(gb, &gb->memory[gb->generalReg.hl]);
+	uint16_t memAddr = 0xFF00 | gbRead8(gb, gb->pc + 1);
+	gb->generalReg.a = gbRead8(gb, memAddr);
 }
 
 /*
- * @brief Op code function for Load instruction (0x36): LD (HL), n8
- * @details Copies value n8 into address pointed to by register HL
+ * @brief Op code function for Pop instruction (0xF1): POP AF
+ * @details Pops 16-bit value off of the stack into register AF
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 2 bytes long and requires 12 cycles to execute
+ * @note This instruction is 1 byte long and requires 12 cycles to execute
+ * @note Affects flags: Z, N, H, C. The lower nibble of F always reads back as 0
  */
-void opLD_0x36(gameBoy_t* gb) 
+void opPOP_0xF1(gameBoy_t* gb)
 {
-	uint8_t value = gb->memory[gb->pc + 1];
-	gb->memory[gb->generalReg.hl] = value;
+	gbFlagsDiscard(gb);
+	gb->generalReg.af = gbPop16(gb) & 0xFFF0;
 }
 
 /*
- * @brief Op code function for Set Carry Flag instruction (0x37): SCF
- * @details Sets Carry flag
+ * @brief Op code function for Load instruction (0xF2): LD A, (C)
+ * @details Loads the value at memory address 0xFF00 + register C into register A
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 1 bytes long and requires 4 cycles to execute
- * @note Affects flags: H, C, N
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
  */
-void opSCF_0x37(gameBoy_t* gb) 
+void opLD_0xF2(gameBoy_t* gb)
 {
-	// Set C
-	gb->generalReg.f |= FLAG_REG_CARRY; 
-	// Set H
-	gb->generalReg.f &= ~FLAG_REG_HALF_CARRY; 
-	// Set N
-	gb->generalReg.f &= ~FLAG_REG_SUB; 
+	uint16_t memAddr = 0xFF00 | gb->generalReg.c;
+	gb->generalReg.a = gbRead8(gb, memAddr);
 }
 
 /*
- * @brief Op code function for Load instruction (0x3A): LD A, (HL-)
- * @details Loads the value pointed to by register HL to register A. HL is then decremented
+ * @brief Op code function for Disable Interrupts instruction (0xF3): DI
+ * @details Clears the Interrupt Master Enable flag
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 1 bytes long and requires 8 cycles to execute
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
  */
-void opLD_0x3A(gameBoy_t* gb) 
+void opDI_0xF3(gameBoy_t* gb)
 {
-	uint8_t value = gb->memory[gb->generalReg.hl];
-	gb->generalReg.a = value;
-	gb->generalReg.hl--;
+	gb->ime = false;
+	// Also cancels an EI that hasn't taken effect yet
+	schedCancel(gb, SCHED_EVENT_IME);
 }
 
 /*
- * @brief Op code function for Decrement instruction (0x3B): DEC SP
- * @details Decrement value of SP
+ * @brief Op code function for Push instruction (0xF5): PUSH AF
+ * @details Pushes register AF onto the stack
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 1 byte long and requires 8 cycles to execute
+ * @note This instruction is 1 byte long and requires 16 cycles to execute
+ * @note F is the one register that can hold lazily evaluated flags, so it's synced before being pushed
  */
-void opDEC_0x3B(gameBoy_t* gb)
+void opPUSH_0xF5(gameBoy_t* gb)
 {
-	gb->sp--;
+	gbFlagsSync(gb);
+	gbPush16(gb, gb->generalReg.af);
 }
 
 /*
- * @brief Op code function for Decrement instruction (0x3C): INC A
- * @details Increment value of register A
+ * @brief Op code function for Load instruction (0xF8): LD HL, SP+r8
+ * @details Loads SP plus 8-bit signed immediate into register HL
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 1 byte long and requires 4 cycles to execute
- * @note Affects flags: Z, N, H
+ * @note This instruction is 2 bytes long and requires 12 cycles to execute
+ * @note Affects flags: Z, N, H, C
  */
-void opINC_0x3C(gameBoy_t* gb)
+void opLD_0xF8(gameBoy_t* gb)
 {
-	gbINC_r8(gb, &gb->generalReg.a);
+	gb->generalReg.hl = gbSP_r8(gb);
 }
 
 /*
- * @brief Op code function for Decrement instruction (0x3D): DEC A
- * @details Decrement value of register A
+ * @brief Op code function for Load instruction (0xF9): LD SP, HL
+ * @details Copies register HL into SP
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 1 byte long and requires 4 cycles to execute
- * @note Affects flags: Z, N, H
+ * @note This instruction is 1 byte long and requires 8 cycles to execute
  */
-void opDEC_0x3D(gameBoy_t* gb)
+void opLD_0xF9(gameBoy_t* gb)
 {
-	gbDEC_r8(gb, &gb->generalReg.a);
+	gb->sp = gb->generalReg.hl;
 }
 
 /*
- * @brief Op code function for Load instruction (0x3E): LD A, n8
- * @details Copies value n8 into register A
+ * @brief Op code function for Load instruction (0xFA): LD A, (a16)
+ * @details Loads the value at 16-bit memory address into register A
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 2 bytes long and requires 8 cycles to execute
+ * @note This instruction is 3 bytes long and requires 16 cycles to execute
  */
-void opLD_0x3E(gameBoy_t* gb) 
+void opLD_0xFA(gameBoy_t* gb)
 {
-	uint8_t value = gb->memory[gb->pc + 1];
-	gb->generalReg.a = value;
+	uint16_t memAddr = gbRead8(gb, gb->pc + 1) | (gbRead8(gb, gb->pc + 2) << 8);
+	gb->generalReg.a = gbRead8(gb, memAddr);
 }
 
 /*
- * @brief Op code function for Complement Carry Flag instruction (0x3F): CCF
- * @details Complements Carry flag
+ * @brief Op code function for Enable Interrupts instruction (0xFB): EI
+ * @details Sets the Interrupt Master Enable flag once the instruction following EI has completed
  * @param Pointer to gb struct containing registers
  * @return void
- * @note This instruction is 1 bytes long and requires 4 cycles to execute
- * @note Affects flags: H, C, N
+ * @note This instruction is 1 byte long and requires 4 cycles to execute
+ * @note SCHED_EVENT_IME is due 1 cycle into the next instruction, so it's handled at the end of it
  */
-void opCCF_0x3F(gameBoy_t* gb) 
+void opEI_0xFB(gameBoy_t* gb)
 {
-	// Complement C
-	if(gb->generalReg.f & FLAG_REG_CARRY)
-	{
-		gb->generalReg.f &= ~FLAG_REG_CARRY; 
-	}
-	else
+	if(!gb->ime)
 	{
-		gb->generalReg.f |= FLAG_REG_CARRY; 
+		schedAdd(gb, SCHED_EVENT_IME, gb->cyclesCurrent + gbDispatchTable[0xFB].clockCycles + 1);
 	}
-
-	// Set H
-	gb->generalReg.f &= ~FLAG_REG_HALF_CARRY; 
-	// Set N
-	gb->generalReg.f &= ~FLAG_REG_SUB; 
 }
 
+/*
+ * @brief Templates for the CB-prefixed instructions (0xCB00-0xCBFF)
+ * @details Rotate/shift (RLC, RRC, RL, RR, SLA, SRA, SWAP, SRL) r or (HL), where name selects the gb<name>_r8 helper,
+	followed by BIT, RES and SET for each bit of r or (HL)
+ * @note These instructions are 2 bytes long (including the prefix) and require 8 cycles, or 16 for (HL) (12 for BIT b, (HL))
+ * @note Rotate/shift affects flags Z, N, H, C. BIT affects flags Z, N, H. RES/SET don't affect flags
+ */
+#define GB_OP_CB_R(name, opCode, reg) \
+void op##name##_0xCB##opCode(gameBoy_t* gb) \
+{ \
+	gb->generalReg.reg = gb##name##_r8(gb, gb->generalReg.reg); \
+}
+
+#define GB_OP_CB_HL(name, opCode) \
+void op##name##_0xCB##opCode(gameBoy_t* gb) \
+{ \
+	gbWrite8(gb, gb->generalReg.hl, gb##name##_r8(gb, gbRead8(gb, gb->generalReg.hl))); \
+}
+
+#define GB_OP_BIT_R(opCode, bit, reg) \
+void opBIT_0xCB##opCode(gameBoy_t* gb) \
+{ \
+	gbBIT_r8(gb, bit, gb->generalReg.reg); \
+}
+
+#define GB_OP_BIT_HL(opCode, bit) \
+void opBIT_0xCB##opCode(gameBoy_t* gb) \
+{ \
+	gbBIT_r8(gb, bit, gbRead8(gb, gb->generalReg.hl)); \
+}
+
+#define GB_OP_RES_R(opCode, bit, reg) \
+void opRES_0xCB##opCode(gameBoy_t* gb) \
+{ \
+	gb->generalReg.reg &= ~(1 << (bit)); \
+}
+
+#define GB_OP_RES_HL(opCode, bit) \
+void opRES_0xCB##opCode(gameBoy_t* gb) \
+{ \
+	gbWrite8(gb, gb->generalReg.hl, gbRead8(gb, gb->generalReg.hl) & ~(1 << (bit))); \
+}
+
+#define GB_OP_SET_R(opCode, bit, reg) \
+void opSET_0xCB##opCode(gameBoy_t* gb) \
+{ \
+	gb->generalReg.reg |= (1 << (bit)); \
+}
+
+#define GB_OP_SET_HL(opCode, bit) \
+void opSET_0xCB##opCode(gameBoy_t* gb) \
+{ \
+	gbWrite8(gb, gb->generalReg.hl, gbRead8(gb, gb->generalReg.hl) | (1 << (bit))); \
+}
+
+GB_OP_CB_R(RLC, 00, b)
+GB_OP_CB_R(RLC, 01, c)
+GB_OP_CB_R(RLC, 02, d)
+GB_OP_CB_R(RLC, 03, e)
+GB_OP_CB_R(RLC, 04, h)
+GB_OP_CB_R(RLC, 05, l)
+GB_OP_CB_HL(RLC, 06)
+GB_OP_CB_R(RLC, 07, a)
+GB_OP_CB_R(RRC, 08, b)
+GB_OP_CB_R(RRC, 09, c)
+GB_OP_CB_R(RRC, 0A, d)
+GB_OP_CB_R(RRC, 0B, e)
+GB_OP_CB_R(RRC, 0C, h)
+GB_OP_CB_R(RRC, 0D, l)
+GB_OP_CB_HL(RRC, 0E)
+GB_OP_CB_R(RRC, 0F, a)
+GB_OP_CB_R(RL, 10, b)
+GB_OP_CB_R(RL, 11, c)
+GB_OP_CB_R(RL, 12, d)
+GB_OP_CB_R(RL, 13, e)
+GB_OP_CB_R(RL, 14, h)
+GB_OP_CB_R(RL, 15, l)
+GB_OP_CB_HL(RL, 16)
+GB_OP_CB_R(RL, 17, a)
+GB_OP_CB_R(RR, 18, b)
+GB_OP_CB_R(RR, 19, c)
+GB_OP_CB_R(RR, 1A, d)
+GB_OP_CB_R(RR, 1B, e)
+GB_OP_CB_R(RR, 1C, h)
+GB_OP_CB_R(RR, 1D, l)
+GB_OP_CB_HL(RR, 1E)
+GB_OP_CB_R(RR, 1F, a)
+GB_OP_CB_R(SLA, 20, b)
+GB_OP_CB_R(SLA, 21, c)
+GB_OP_CB_R(SLA, 22, d)
+GB_OP_CB_R(SLA, 23, e)
+GB_OP_CB_R(SLA, 24, h)
+GB_OP_CB_R(SLA, 25, l)
+GB_OP_CB_HL(SLA, 26)
+GB_OP_CB_R(SLA, 27, a)
+GB_OP_CB_R(SRA, 28, b)
+GB_OP_CB_R(SRA, 29, c)
+GB_OP_CB_R(SRA, 2A, d)
+GB_OP_CB_R(SRA, 2B, e)
+GB_OP_CB_R(SRA, 2C, h)
+GB_OP_CB_R(SRA, 2D, l)
+GB_OP_CB_HL(SRA, 2E)
+GB_OP_CB_R(SRA, 2F, a)
+GB_OP_CB_R(SWAP, 30, b)
+GB_OP_CB_R(SWAP, 31, c)
+GB_OP_CB_R(SWAP, 32, d)
+GB_OP_CB_R(SWAP, 33, e)
+GB_OP_CB_R(SWAP, 34, h)
+GB_OP_CB_R(SWAP, 35, l)
+GB_OP_CB_HL(SWAP, 36)
+GB_OP_CB_R(SWAP, 37, a)
+GB_OP_CB_R(SRL, 38, b)
+GB_OP_CB_R(SRL, 39, c)
+GB_OP_CB_R(SRL, 3A, d)
+GB_OP_CB_R(SRL, 3B, e)
+GB_OP_CB_R(SRL, 3C, h)
+GB_OP_CB_R(SRL, 3D, l)
+GB_OP_CB_HL(SRL, 3E)
+GB_OP_CB_R(SRL, 3F, a)
+GB_OP_BIT_R(40, 0, b)
+GB_OP_BIT_R(41, 0, c)
+GB_OP_BIT_R(42, 0, d)
+GB_OP_BIT_R(43, 0, e)
+GB_OP_BIT_R(44, 0, h)
+GB_OP_BIT_R(45, 0, l)
+GB_OP_BIT_HL(46, 0)
+GB_OP_BIT_R(47, 0, a)
+GB_OP_BIT_R(48, 1, b)
+GB_OP_BIT_R(49, 1, c)
+GB_OP_BIT_R(4A, 1, d)
+GB_OP_BIT_R(4B, 1, e)
+GB_OP_BIT_R(4C, 1, h)
+GB_OP_BIT_R(4D, 1, l)
+GB_OP_BIT_HL(4E, 1)
+GB_OP_BIT_R(4F, 1, a)
+GB_OP_BIT_R(50, 2, b)
+GB_OP_BIT_R(51, 2, c)
+GB_OP_BIT_R(52, 2, d)
+GB_OP_BIT_R(53, 2, e)
+GB_OP_BIT_R(54, 2, h)
+GB_OP_BIT_R(55, 2, l)
+GB_OP_BIT_HL(56, 2)
+GB_OP_BIT_R(57, 2, a)
+GB_OP_BIT_R(58, 3, b)
+GB_OP_BIT_R(59, 3, c)
+GB_OP_BIT_R(5A, 3, d)
+GB_OP_BIT_R(5B, 3, e)
+GB_OP_BIT_R(5C, 3, h)
+GB_OP_BIT_R(5D, 3, l)
+GB_OP_BIT_HL(5E, 3)
+GB_OP_BIT_R(5F, 3, a)
+GB_OP_BIT_R(60, 4, b)
+GB_OP_BIT_R(61, 4, c)
+GB_OP_BIT_R(62, 4, d)
+GB_OP_BIT_R(63, 4, e)
+GB_OP_BIT_R(64, 4, h)
+GB_OP_BIT_R(65, 4, l)
+GB_OP_BIT_HL(66, 4)
+GB_OP_BIT_R(67, 4, a)
+GB_OP_BIT_R(68, 5, b)
+GB_OP_BIT_R(69, 5, c)
+GB_OP_BIT_R(6A, 5, d)
+GB_OP_BIT_R(6B, 5, e)
+GB_OP_BIT_R(6C, 5, h)
+GB_OP_BIT_R(6D, 5, l)
+GB_OP_BIT_HL(6E, 5)
+GB_OP_BIT_R(6F, 5, a)
+GB_OP_BIT_R(70, 6, b)
+GB_OP_BIT_R(71, 6, c)
+GB_OP_BIT_R(72, 6, d)
+GB_OP_BIT_R(73, 6, e)
+GB_OP_BIT_R(74, 6, h)
+GB_OP_BIT_R(75, 6, l)
+GB_OP_BIT_HL(76, 6)
+GB_OP_BIT_R(77, 6, a)
+GB_OP_BIT_R(78, 7, b)
+GB_OP_BIT_R(79, 7, c)
+GB_OP_BIT_R(7A, 7, d)
+GB_OP_BIT_R(7B, 7, e)
+GB_OP_BIT_R(7C, 7, h)
+GB_OP_BIT_R(7D, 7, l)
+GB_OP_BIT_HL(7E, 7)
+GB_OP_BIT_R(7F, 7, a)
+GB_OP_RES_R(80, 0, b)
+GB_OP_RES_R(81, 0, c)
+GB_OP_RES_R(82, 0, d)
+GB_OP_RES_R(83, 0, e)
+GB_OP_RES_R(84, 0, h)
+GB_OP_RES_R(85, 0, l)
+GB_OP_RES_HL(86, 0)
+GB_OP_RES_R(87, 0, a)
+GB_OP_RES_R(88, 1, b)
+GB_OP_RES_R(89, 1, c)
+GB_OP_RES_R(8A, 1, d)
+GB_OP_RES_R(8B, 1, e)
+GB_OP_RES_R(8C, 1, h)
+GB_OP_RES_R(8D, 1, l)
+GB_OP_RES_HL(8E, 1)
+GB_OP_RES_R(8F, 1, a)
+GB_OP_RES_R(90, 2, b)
+GB_OP_RES_R(91, 2, c)
+GB_OP_RES_R(92, 2, d)
+GB_OP_RES_R(93, 2, e)
+GB_OP_RES_R(94, 2, h)
+GB_OP_RES_R(95, 2, l)
+GB_OP_RES_HL(96, 2)
+GB_OP_RES_R(97, 2, a)
+GB_OP_RES_R(98, 3, b)
+GB_OP_RES_R(99, 3, c)
+GB_OP_RES_R(9A, 3, d)
+GB_OP_RES_R(9B, 3, e)
+GB_OP_RES_R(9C, 3, h)
+GB_OP_RES_R(9D, 3, l)
+GB_OP_RES_HL(9E, 3)
+GB_OP_RES_R(9F, 3, a)
+GB_OP_RES_R(A0, 4, b)
+GB_OP_RES_R(A1, 4, c)
+GB_OP_RES_R(A2, 4, d)
+GB_OP_RES_R(A3, 4, e)
+GB_OP_RES_R(A4, 4, h)
+GB_OP_RES_R(A5, 4, l)
+GB_OP_RES_HL(A6, 4)
+GB_OP_RES_R(A7, 4, a)
+GB_OP_RES_R(A8, 5, b)
+GB_OP_RES_R(A9, 5, c)
+GB_OP_RES_R(AA, 5, d)
+GB_OP_RES_R(AB, 5, e)
+GB_OP_RES_R(AC, 5, h)
+GB_OP_RES_R(AD, 5, l)
+GB_OP_RES_HL(AE, 5)
+GB_OP_RES_R(AF, 5, a)
+GB_OP_RES_R(B0, 6, b)
+GB_OP_RES_R(B1, 6, c)
+GB_OP_RES_R(B2, 6, d)
+GB_OP_RES_R(B3, 6, e)
+GB_OP_RES_R(B4, 6, h)
+GB_OP_RES_R(B5, 6, l)
+GB_OP_RES_HL(B6, 6)
+GB_OP_RES_R(B7, 6, a)
+GB_OP_RES_R(B8, 7, b)
+GB_OP_RES_R(B9, 7, c)
+GB_OP_RES_R(BA, 7, d)
+GB_OP_RES_R(BB, 7, e)
+GB_OP_RES_R(BC, 7, h)
+GB_OP_RES_R(BD, 7, l)
+GB_OP_RES_HL(BE, 7)
+GB_OP_RES_R(BF, 7, a)
+GB_OP_SET_R(C0, 0, b)
+GB_OP_SET_R(C1, 0, c)
+GB_OP_SET_R(C2, 0, d)
+GB_OP_SET_R(C3, 0, e)
+GB_OP_SET_R(C4, 0, h)
+GB_OP_SET_R(C5, 0, l)
+GB_OP_SET_HL(C6, 0)
+GB_OP_SET_R(C7, 0, a)
+GB_OP_SET_R(C8, 1, b)
+GB_OP_SET_R(C9, 1, c)
+GB_OP_SET_R(CA, 1, d)
+GB_OP_SET_R(CB, 1, e)
+GB_OP_SET_R(CC, 1, h)
+GB_OP_SET_R(CD, 1, l)
+GB_OP_SET_HL(CE, 1)
+GB_OP_SET_R(CF, 1, a)
+GB_OP_SET_R(D0, 2, b)
+GB_OP_SET_R(D1, 2, c)
+GB_OP_SET_R(D2, 2, d)
+GB_OP_SET_R(D3, 2, e)
+GB_OP_SET_R(D4, 2, h)
+GB_OP_SET_R(D5, 2, l)
+GB_OP_SET_HL(D6, 2)
+GB_OP_SET_R(D7, 2, a)
+GB_OP_SET_R(D8, 3, b)
+GB_OP_SET_R(D9, 3, c)
+GB_OP_SET_R(DA, 3, d)
+GB_OP_SET_R(DB, 3, e)
+GB_OP_SET_R(DC, 3, h)
+GB_OP_SET_R(DD, 3, l)
+GB_OP_SET_HL(DE, 3)
+GB_OP_SET_R(DF, 3, a)
+GB_OP_SET_R(E0, 4, b)
+GB_OP_SET_R(E1, 4, c)
+GB_OP_SET_R(E2, 4, d)
+GB_OP_SET_R(E3, 4, e)
+GB_OP_SET_R(E4, 4, h)
+GB_OP_SET_R(E5, 4, l)
+GB_OP_SET_HL(E6, 4)
+GB_OP_SET_R(E7, 4, a)
+GB_OP_SET_R(E8, 5, b)
+GB_OP_SET_R(E9, 5, c)
+GB_OP_SET_R(EA, 5, d)
+GB_OP_SET_R(EB, 5, e)
+GB_OP_SET_R(EC, 5, h)
+GB_OP_SET_R(ED, 5, l)
+GB_OP_SET_HL(EE, 5)
+GB_OP_SET_R(EF, 5, a)
+GB_OP_SET_R(F0, 6, b)
+GB_OP_SET_R(F1, 6, c)
+GB_OP_SET_R(F2, 6, d)
+GB_OP_SET_R(F3, 6, e)
+GB_OP_SET_R(F4, 6, h)
+GB_OP_SET_R(F5, 6, l)
+GB_OP_SET_HL(F6, 6)
+GB_OP_SET_R(F7, 6, a)
+GB_OP_SET_R(F8, 7, b)
+GB_OP_SET_R(F9, 7, c)
+GB_OP_SET_R(FA, 7, d)
+GB_OP_SET_R(FB, 7, e)
+GB_OP_SET_R(FC, 7, h)
+GB_OP_SET_R(FD, 7, l)
+GB_OP_SET_HL(FE, 7)
+GB_OP_SET_R(FF, 7, a)
+
 /*
  * @brief Consolidated table containing data for each operation supported by the LR35902 processor (Intel 8080 + Zilog Z80)
  * @details { function pointer, cycles required, extra cycles required (for ops w/ variable timing), size in bytes }
- */
+	Indexed directly by op code (see gbGetOpCode). Every one of the 512 slots is filled, illegal op codes with invalid.
+	Kept as an X-macro list so the threaded core (GB_CORE_THREADED) can be generated from the same data
+ */
+#define GB_OPCODE_LIST(X) \
+/*	  op code function         cycles extra size */ \
+	X(0x00,  opNOP_0x00,       4,     0,     1)  /* NOP */ \
+	X(0x01,  opLD_0x01,       12,     0,     3)  /* LD BC, d16 */ \
+	X(0x02,  opLD_0x02,        8,     0,     1)  /* LD (BC), A */ \
+	X(0x03,  opINC_0x03,       8,     0,     1)  /* INC BC */ \
+	X(0x04,  opINC_0x04,       4,     0,     1)  /* INC B */ \
+	X(0x05,  opDEC_0x05,       4,     0,     1)  /* DEC B */ \
+	X(0x06,  opLD_0x06,        8,     0,     2)  /* LD B, d8 */ \
+	X(0x07,  opRLCA_0x07,      4,     0,     1)  /* RLCA */ \
+	X(0x08,  opLD_0x08,       20,     0,     3)  /* LD (a16), SP */ \
+	X(0x09,  opADD_0x09,       8,     0,     1)  /* ADD HL, BC */ \
+	X(0x0A,  opLD_0x0A,        8,     0,     1)  /* LD A, (BC) */ \
+	X(0x0B,  opDEC_0x0B,       8,     0,     1)  /* DEC BC */ \
+	X(0x0C,  opINC_0x0C,       4,     0,     1)  /* INC C */ \
+	X(0x0D,  opDEC_0x0D,       4,     0,     1)  /* DEC C */ \
+	X(0x0E,  opLD_0x0E,        8,     0,     2)  /* LD C, d8 */ \
+	X(0x0F,  opRRCA_0x0F,      4,     0,     1)  /* RRCA */ \
+	X(0x10,  opSTOP_0x10,      4,     0,     2)  /* STOP d8 */ \
+	X(0x11,  opLD_0x11,       12,     0,     3)  /* LD DE, d16 */ \
+	X(0x12,  opLD_0x12,        8,     0,     1)  /* LD (DE), A */ \
+	X(0x13,  opINC_0x13,       8,     0,     1)  /* INC DE */ \
+	X(0x14,  opINC_0x14,       4,     0,     1)  /* INC D */ \
+	X(0x15,  opDEC_0x15,       4,     0,     1)  /* DEC D */ \
+	X(0x16,  opLD_0x16,        8,     0,     2)  /* LD D, d8 */ \
+	X(0x17,  opRLA_0x17,       4,     0,     1)  /* RLA */ \
+	X(0x18,  opJR_0x18,       12,     0,     2)  /* JR r8 */ \
+	X(0x19,  opADD_0x19,       8,     0,     1)  /* ADD HL, DE */ \
+	X(0x1A,  opLD_0x1A,        8,     0,     1)  /* LD A,(DE) */ \
+	X(0x1B,  opDEC_0x1B,       8,     0,     1)  /* DEC DE */ \
+	X(0x1C,  opINC_0x1C,       4,     0,     1)  /* INC E */ \
+	X(0x1D,  opDEC_0x1D,       4,     0,     1)  /* DEC E */ \
+	X(0x1E,  opLD_0x1E,        8,     0,     2)  /* LD E,d8 */ \
+	X(0x1F,  opRRA_0x1F,       4,     0,     1)  /* RRA */ \
+	X(0x20,  opJR_0x20,        8,     4,     2)  /* JR NZ, e8 */ \
+	X(0x21,  opLD_0x21,       12,     0,     3)  /* LD HL, d16 */ \
+	X(0x22,  opLD_0x22,        8,     0,     1)  /* LD (HL+), A */ \
+	X(0x23,  opINC_0x23,       8,     0,     1)  /* INC HL */ \
+	X(0x24,  opINC_0x24,       4,     0,     1)  /* INC H */ \
+	X(0x25,  opDEC_0x25,       4,     0,     1)  /* DEC H */ \
+	X(0x26,  opLD_0x26,        8,     0,     2)  /* LD H, d8 */ \
+	X(0x27,  opDAA_0x27,       4,     0,     1)  /* DAA */ \
+	X(0x28,  opJR_0x28,        8,     4,     2)  /* JR Z */ \
+	X(0x29,  opADD_0x29,       8,     0,     1)  /* ADD HL, HL */ \
+	X(0x2A,  opLD_0x2A,        8,     0,     1)  /* LD A, (HL+) */ \
+	X(0x2B,  opDEC_0x2B,       8,     0,     1)  /* DEC HL */ \
+	X(0x2C,  opINC_0x2C,       4,     0,     1)  /* INC L */ \
+	X(0x2D,  opDEC_0x2D,       4,     0,     1)  /* DEC L */ \
+	X(0x2E,  opLD_0x2E,        8,     0,     2)  /* LD L, d8 */ \
+	X(0x2F,  opCPL_0x2F,       4,     0,     1)  /* CPL */ \
+	X(0x30,  opJR_0x30,        8,     4,     2)  /* JR NC, e8 */ \
+	X(0x31,  opLD_0x31,       12,     0,     3)  /* LD SP, n16 */ \
+	X(0x32,  opLD_0x32,        8,     0,     1)  /* LD (HL-), A */ \
+	X(0x33,  opINC_0x33,       8,     0,     1)  /* INC SP */ \
+	X(0x34,  opINC_0x34,      12,     0,     1)  /* INC (HL) */ \
+	X(0x35,  opDEC_0x35,      12,     0,     1)  /* DEC (HL) */ \
+	X(0x36,  opLD_0x36,       12,     0,     2)  /* LD (HL), n8 */ \
+	X(0x37,  opSCF_0x37,       4,     0,     1)  /* SCF */ \
+	X(0x38,  opJR_0x38,        8,     4,     2)  /* JR C, e8 */ \
+	X(0x39,  opADD_0x39,       8,     0,     1)  /* ADD HL, SP */ \
+	X(0x3A,  opLD_0x3A,        8,     0,     1)  /* LD A, (HL-) */ \
+	X(0x3B,  opDEC_0x3B,       8,     0,     1)  /* DEC SP */ \
+	X(0x3C,  opINC_0x3C,       4,     0,     1)  /* INC A */ \
+	X(0x3D,  opDEC_0x3D,       4,     0,     1)  /* DEC A */ \
+	X(0x3E,  opLD_0x3E,        8,     0,     2)  /* LD A, n8 */ \
+	X(0x3F,  opCCF_0x3F,       4,     0,     1)  /* CCF */ \
+	X(0x40,  opLD_0x40,        4,     0,     1)  /* LD B, B */ \
+	X(0x41,  opLD_0x41,        4,     0,     1)  /* LD B, C */ \
+	X(0x42,  opLD_0x42,        4,     0,     1)  /* LD B, D */ \
+	X(0x43,  opLD_0x43,        4,     0,     1)  /* LD B, E */ \
+	X(0x44,  opLD_0x44,        4,     0,     1)  /* LD B, H */ \
+	X(0x45,  opLD_0x45,        4,     0,     1)  /* LD B, L */ \
+	X(0x46,  opLD_0x46,        8,     0,     1)  /* LD B, (HL) */ \
+	X(0x47,  opLD_0x47,        4,     0,     1)  /* LD B, A */ \
+	X(0x48,  opLD_0x48,        4,     0,     1)  /* LD C, B */ \
+	X(0x49,  opLD_0x49,        4,     0,     1)  /* LD C, C */ \
+	X(0x4A,  opLD_0x4A,        4,     0,     1)  /* LD C, D */ \
+	X(0x4B,  opLD_0x4B,        4,     0,     1)  /* LD C, E */ \
+	X(0x4C,  opLD_0x4C,        4,     0,     1)  /* LD C, H */ \
+	X(0x4D,  opLD_0x4D,        4,     0,     1)  /* LD C, L */ \
+	X(0x4E,  opLD_0x4E,        8,     0,     1)  /* LD C, (HL) */ \
+	X(0x4F,  opLD_0x4F,        4,     0,     1)  /* LD C, A */ \
+	X(0x50,  opLD_0x50,        4,     0,     1)  /* LD D, B */ \
+	X(0x51,  opLD_0x51,        4,     0,     1)  /* LD D, C */ \
+	X(0x52,  opLD_0x52,        4,     0,     1)  /* LD D, D */ \
+	X(0x53,  opLD_0x53,        4,     0,     1)  /* LD D, E */ \
+	X(0x54,  opLD_0x54,        4,     0,     1)  /* LD D, H */ \
+	X(0x55,  opLD_0x55,        4,     0,     1)  /* LD D, L */ \
+	X(0x56,  opLD_0x56,        8,     0,     1)  /* LD D, (HL) */ \
+	X(0x57,  opLD_0x57,        4,     0,     1)  /* LD D, A */ \
+	X(0x58,  opLD_0x58,        4,     0,     1)  /* LD E, B */ \
+	X(0x59,  opLD_0x59,        4,     0,     1)  /* LD E, C */ \
+	X(0x5A,  opLD_0x5A,        4,     0,     1)  /* LD E, D */ \
+	X(0x5B,  opLD_0x5B,        4,     0,     1)  /* LD E, E */ \
+	X(0x5C,  opLD_0x5C,        4,     0,     1)  /* LD E, H */ \
+	X(0x5D,  opLD_0x5D,        4,     0,     1)  /* LD E, L */ \
+	X(0x5E,  opLD_0x5E,        8,     0,     1)  /* LD E, (HL) */ \
+	X(0x5F,  opLD_0x5F,        4,     0,     1)  /* LD E, A */ \
+	X(0x60,  opLD_0x60,        4,     0,     1)  /* LD H, B */ \
+	X(0x61,  opLD_0x61,        4,     0,     1)  /* LD H, C */ \
+	X(0x62,  opLD_0x62,        4,     0,     1)  /* LD H, D */ \
+	X(0x63,  opLD_0x63,        4,     0,     1)  /* LD H, E */ \
+	X(0x64,  opLD_0x64,        4,     0,     1)  /* LD H, H */ \
+	X(0x65,  opLD_0x65,        4,     0,     1)  /* LD H, L */ \
+	X(0x66,  opLD_0x66,        8,     0,     1)  /* LD H, (HL) */ \
+	X(0x67,  opLD_0x67,        4,     0,     1)  /* LD H, A */ \
+	X(0x68,  opLD_0x68,        4,     0,     1)  /* LD L, B */ \
+	X(0x69,  opLD_0x69,        4,     0,     1)  /* LD L, C */ \
+	X(0x6A,  opLD_0x6A,        4,     0,     1)  /* LD L, D */ \
+	X(0x6B,  opLD_0x6B,        4,     0,     1)  /* LD L, E */ \
+	X(0x6C,  opLD_0x6C,        4,     0,     1)  /* LD L, H */ \
+	X(0x6D,  opLD_0x6D,        4,     0,     1)  /* LD L, L */ \
+	X(0x6E,  opLD_0x6E,        8,     0,     1)  /* LD L, (HL) */ \
+	X(0x6F,  opLD_0x6F,        4,     0,     1)  /* LD L, A */ \
+	X(0x70,  opLD_0x70,        8,     0,     1)  /* LD (HL), B */ \
+	X(0x71,  opLD_0x71,        8,     0,     1)  /* LD (HL), C */ \
+	X(0x72,  opLD_0x72,        8,     0,     1)  /* LD (HL), D */ \
+	X(0x73,  opLD_0x73,        8,     0,     1)  /* LD (HL), E */ \
+	X(0x74,  opLD_0x74,        8,     0,     1)  /* LD (HL), H */ \
+	X(0x75,  opLD_0x75,        8,     0,     1)  /* LD (HL), L */ \
+	X(0x76,  opHALT_0x76,      4,     0,     1)  /* HALT */ \
+	X(0x77,  opLD_0x77,        8,     0,     1)  /* LD (HL), A */ \
+	X(0x78,  opLD_0x78,        4,     0,     1)  /* LD A, B */ \
+	X(0x79,  opLD_0x79,        4,     0,     1)  /* LD A, C */ \
+	X(0x7A,  opLD_0x7A,        4,     0,     1)  /* LD A, D */ \
+	X(0x7B,  opLD_0x7B,        4,     0,     1)  /* LD A, E */ \
+	X(0x7C,  opLD_0x7C,        4,     0,     1)  /* LD A, H */ \
+	X(0x7D,  opLD_0x7D,        4,     0,     1)  /* LD A, L */ \
+	X(0x7E,  opLD_0x7E,        8,     0,     1)  /* LD A, (HL) */ \
+	X(0x7F,  opLD_0x7F,        4,     0,     1)  /* LD A, A */ \
+	X(0x80,  opADD_0x80,       4,     0,     1)  /* ADD A, B */ \
+	X(0x81,  opADD_0x81,       4,     0,     1)  /* ADD A, C */ \
+	X(0x82,  opADD_0x82,       4,     0,     1)  /* ADD A, D */ \
+	X(0x83,  opADD_0x83,       4,     0,     1)  /* ADD A, E */ \
+	X(0x84,  opADD_0x84,       4,     0,     1)  /* ADD A, H */ \
+	X(0x85,  opADD_0x85,       4,     0,     1)  /* ADD A, L */ \
+	X(0x86,  opADD_0x86,       8,     0,     1)  /* ADD A, (HL) */ \
+	X(0x87,  opADD_0x87,       4,     0,     1)  /* ADD A, A */ \
+	X(0x88,  opADC_0x88,       4,     0,     1)  /* ADC A, B */ \
+	X(0x89,  opADC_0x89,       4,     0,     1)  /* ADC A, C */ \
+	X(0x8A,  opADC_0x8A,       4,     0,     1)  /* ADC A, D */ \
+	X(0x8B,  opADC_0x8B,       4,     0,     1)  /* ADC A, E */ \
+	X(0x8C,  opADC_0x8C,       4,     0,     1)  /* ADC A, H */ \
+	X(0x8D,  opADC_0x8D,       4,     0,     1)  /* ADC A, L */ \
+	X(0x8E,  opADC_0x8E,       8,     0,     1)  /* ADC A, (HL) */ \
+	X(0x8F,  opADC_0x8F,       4,     0,     1)  /* ADC A, A */ \
+	X(0x90,  opSUB_0x90,       4,     0,     1)  /* SUB B */ \
+	X(0x91,  opSUB_0x91,       4,     0,     1)  /* SUB C */ \
+	X(0x92,  opSUB_0x92,       4,     0,     1)  /* SUB D */ \
+	X(0x93,  opSUB_0x93,       4,     0,     1)  /* SUB E */ \
+	X(0x94,  opSUB_0x94,       4,     0,     1)  /* SUB H */ \
+	X(0x95,  opSUB_0x95,       4,     0,     1)  /* SUB L */ \
+	X(0x96,  opSUB_0x96,       8,     0,     1)  /* SUB (HL) */ \
+	X(0x97,  opSUB_0x97,       4,     0,     1)  /* SUB A */ \
+	X(0x98,  opSBC_0x98,       4,     0,     1)  /* SBC A, B */ \
+	X(0x99,  opSBC_0x99,       4,     0,     1)  /* SBC A, C */ \
+	X(0x9A,  opSBC_0x9A,       4,     0,     1)  /* SBC A, D */ \
+	X(0x9B,  opSBC_0x9B,       4,     0,     1)  /* SBC A, E */ \
+	X(0x9C,  opSBC_0x9C,       4,     0,     1)  /* SBC A, H */ \
+	X(0x9D,  opSBC_0x9D,       4,     0,     1)  /* SBC A, L */ \
+	X(0x9E,  opSBC_0x9E,       8,     0,     1)  /* SBC A, (HL) */ \
+	X(0x9F,  opSBC_0x9F,       4,     0,     1)  /* SBC A, A */ \
+	X(0xA0,  opAND_0xA0,       4,     0,     1)  /* AND B */ \
+	X(0xA1,  opAND_0xA1,       4,     0,     1)  /* AND C */ \
+	X(0xA2,  opAND_0xA2,       4,     0,     1)  /* AND D */ \
+	X(0xA3,  opAND_0xA3,       4,     0,     1)  /* AND E */ \
+	X(0xA4,  opAND_0xA4,       4,     0,     1)  /* AND H */ \
+	X(0xA5,  opAND_0xA5,       4,     0,     1)  /* AND L */ \
+	X(0xA6,  opAND_0xA6,       8,     0,     1)  /* AND (HL) */ \
+	X(0xA7,  opAND_0xA7,       4,     0,     1)  /* AND A */ \
+	X(0xA8,  opXOR_0xA8,       4,     0,     1)  /* XOR B */ \
+	X(0xA9,  opXOR_0xA9,       4,     0,     1)  /* XOR C */ \
+	X(0xAA,  opXOR_0xAA,       4,     0,     1)  /* XOR D */ \
+	X(0xAB,  opXOR_0xAB,       4,     0,     1)  /* XOR E */ \
+	X(0xAC,  opXOR_0xAC,       4,     0,     1)  /* XOR H */ \
+	X(0xAD,  opXOR_0xAD,       4,     0,     1)  /* XOR L */ \
+	X(0xAE,  opXOR_0xAE,       8,     0,     1)  /* XOR (HL) */ \
+	X(0xAF,  opXOR_0xAF,       4,     0,     1)  /* XOR A */ \
+	X(0xB0,  opOR_0xB0,        4,     0,     1)  /* OR B */ \
+	X(0xB1,  opOR_0xB1,        4,     0,     1)  /* OR C */ \
+	X(0xB2,  opOR_0xB2,        4,     0,     1)  /* OR D */ \
+	X(0xB3,  opOR_0xB3,        4,     0,     1)  /* OR E */ \
+	X(0xB4,  opOR_0xB4,        4,     0,     1)  /* OR H */ \
+	X(0xB5,  opOR_0xB5,        4,     0,     1)  /* OR L */ \
+	X(0xB6,  opOR_0xB6,        8,     0,     1)  /* OR (HL) */ \
+	X(0xB7,  opOR_0xB7,        4,     0,     1)  /* OR A */ \
+	X(0xB8,  opCP_0xB8,        4,     0,     1)  /* CP B */ \
+	X(0xB9,  opCP_0xB9,        4,     0,     1)  /* CP C */ \
+	X(0xBA,  opCP_0xBA,        4,     0,     1)  /* CP D */ \
+	X(0xBB,  opCP_0xBB,        4,     0,     1)  /* CP E */ \
+	X(0xBC,  opCP_0xBC,        4,     0,     1)  /* CP H */ \
+	X(0xBD,  opCP_0xBD,        4,     0,     1)  /* CP L */ \
+	X(0xBE,  opCP_0xBE,        8,     0,     1)  /* CP (HL) */ \
+	X(0xBF,  opCP_0xBF,        4,     0,     1)  /* CP A */ \
+	X(0xC0,  opRET_0xC0,       8,     12,     1)  /* RET NZ */ \
+	X(0xC1,  opPOP_0xC1,      12,     0,     1)  /* POP BC */ \
+	X(0xC2,  opJP_0xC2,       12,     4,     3)  /* JP NZ, a16 */ \
+	X(0xC3,  opJP_0xC3,       16,     0,     3)  /* JP a16 */ \
+	X(0xC4,  opCALL_0xC4,     12,     12,     3)  /* CALL NZ, a16 */ \
+	X(0xC5,  opPUSH_0xC5,     16,     0,     1)  /* PUSH BC */ \
+	X(0xC6,  opADD_0xC6,       8,     0,     2)  /* ADD A, d8 */ \
+	X(0xC7,  opRST_0xC7,      16,     0,     1)  /* RST 00H */ \
+	X(0xC8,  opRET_0xC8,       8,     12,     1)  /* RET Z */ \
+	X(0xC9,  opRET_0xC9,      16,     0,     1)  /* RET */ \
+	X(0xCA,  opJP_0xCA,       12,     4,     3)  /* JP Z, a16 */ \
+	X(0xCB,  invalid,          4,     0,     1)  /* PREFIX CB (decoded by gbGetOpCode) */ \
+	X(0xCC,  opCALL_0xCC,     12,     12,     3)  /* CALL Z, a16 */ \
+	X(0xCD,  opCALL_0xCD,     24,     0,     3)  /* CALL a16 */ \
+	X(0xCE,  opADC_0xCE,       8,     0,     2)  /* ADC A, d8 */ \
+	X(0xCF,  opRST_0xCF,      16,     0,     1)  /* RST 08H */ \
+	X(0xD0,  opRET_0xD0,       8,     12,     1)  /* RET NC */ \
+	X(0xD1,  opPOP_0xD1,      12,     0,     1)  /* POP DE */ \
+	X(0xD2,  opJP_0xD2,       12,     4,     3)  /* JP NC, a16 */ \
+	X(0xD3,  invalid,          4,     0,     1)  /* Illegal */ \
+	X(0xD4,  opCALL_0xD4,     12,     12,     3)  /* CALL NC, a16 */ \
+	X(0xD5,  opPUSH_0xD5,     16,     0,     1)  /* PUSH DE */ \
+	X(0xD6,  opSUB_0xD6,       8,     0,     2)  /* SUB d8 */ \
+	X(0xD7,  opRST_0xD7,      16,     0,     1)  /* RST 10H */ \
+	X(0xD8,  opRET_0xD8,       8,     12,     1)  /* RET C */ \
+	X(0xD9,  opRETI_0xD9,     16,     0,     1)  /* RETI */ \
+	X(0xDA,  opJP_0xDA,       12,     4,     3)  /* JP C, a16 */ \
+	X(0xDB,  invalid,          4,     0,     1)  /* Illegal */ \
+	X(0xDC,  opCALL_0xDC,     12,     12,     3)  /* CALL C, a16 */ \
+	X(0xDD,  invalid,          4,     0,     1)  /* Illegal */ \
+	X(0xDE,  opSBC_0xDE,       8,     0,     2)  /* SBC A, d8 */ \
+	X(0xDF,  opRST_0xDF,      16,     0,     1)  /* RST 18H */ \
+	X(0xE0,  opLDH_0xE0,      12,     0,     2)  /* LDH (a8), A */ \
+	X(0xE1,  opPOP_0xE1,      12,     0,     1)  /* POP HL */ \
+	X(0xE2,  opLD_0xE2,        8,     0,     1)  /* LD (C), A */ \
+	X(0xE3,  invalid,          4,     0,     1)  /* Illegal */ \
+	X(0xE4,  invalid,          4,     0,     1)  /* Illegal */ \
+	X(0xE5,  opPUSH_0xE5,     16,     0,     1)  /* PUSH HL */ \
+	X(0xE6,  opAND_0xE6,       8,     0,     2)  /* AND d8 */ \
+	X(0xE7,  opRST_0xE7,      16,     0,     1)  /* RST 20H */ \
+	X(0xE8,  opADD_0xE8,      16,     0,     2)  /* ADD SP, r8 */ \
+	X(0xE9,  opJP_0xE9,        4,     0,     1)  /* JP HL */ \
+	X(0xEA,  opLD_0xEA,       16,     0,     3)  /* LD (a16), A */ \
+	X(0xEB,  invalid,          4,     0,     1)  /* Illegal */ \
+	X(0xEC,  invalid,          4,     0,     1)  /* Illegal */ \
+	X(0xED,  invalid,          4,     0,     1)  /* Illegal */ \
+	X(0xEE,  opXOR_0xEE,       8,     0,     2)  /* XOR d8 */ \
+	X(0xEF,  opRST_0xEF,      16,     0,     1)  /* RST 28H */ \
+	X(0xF0,  opLDH_0xF0,      12,     0,     2)  /* LDH A, (a8) */ \
+	X(0xF1,  opPOP_0xF1,      12,     0,     1)  /* POP AF */ \
+	X(0xF2,  opLD_0xF2,        8,     0,     1)  /* LD A, (C) */ \
+	X(0xF3,  opDI_0xF3,        4,     0,     1)  /* DI */ \
+	X(0xF4,  invalid,          4,     0,     1)  /* Illegal */ \
+	X(0xF5,  opPUSH_0xF5,     16,     0,     1)  /* PUSH AF */ \
+	X(0xF6,  opOR_0xF6,        8,     0,     2)  /* OR d8 */ \
+	X(0xF7,  opRST_0xF7,      16,     0,     1)  /* RST 30H */ \
+	X(0xF8,  opLD_0xF8,       12,     0,     2)  /* LD HL, SP+r8 */ \
+	X(0xF9,  opLD_0xF9,        8,     0,     1)  /* LD SP, HL */ \
+	X(0xFA,  opLD_0xFA,       16,     0,     3)  /* LD A, (a16) */ \
+	X(0xFB,  opEI_0xFB,        4,     0,     1)  /* EI */ \
+	X(0xFC,  invalid,          4,     0,     1)  /* Illegal */ \
+	X(0xFD,  invalid,          4,     0,     1)  /* Illegal */ \
+	X(0xFE,  opCP_0xFE,        8,     0,     2)  /* CP d8 */ \
+	X(0xFF,  opRST_0xFF,      16,     0,     1)  /* RST 38H */ \
+	\
+	/* CB-prefixed op codes, indexed by GB_OPCODE_CB_OFFSET | second byte. Cycles include the prefix */ \
+	X(0x100, opRLC_0xCB00,     8,     0,     2)  /* RLC B */ \
+	X(0x101, opRLC_0xCB01,     8,     0,     2)  /* RLC C */ \
+	X(0x102, opRLC_0xCB02,     8,     0,     2)  /* RLC D */ \
+	X(0x103, opRLC_0xCB03,     8,     0,     2)  /* RLC E */ \
+	X(0x104, opRLC_0xCB04,     8,     0,     2)  /* RLC H */ \
+	X(0x105, opRLC_0xCB05,     8,     0,     2)  /* RLC L */ \
+	X(0x106, opRLC_0xCB06,    16,     0,     2)  /* RLC (HL) */ \
+	X(0x107, opRLC_0xCB07,     8,     0,     2)  /* RLC A */ \
+	X(0x108, opRRC_0xCB08,     8,     0,     2)  /* RRC B */ \
+	X(0x109, opRRC_0xCB09,     8,     0,     2)  /* RRC C */ \
+	X(0x10A, opRRC_0xCB0A,     8,     0,     2)  /* RRC D */ \
+	X(0x10B, opRRC_0xCB0B,     8,     0,     2)  /* RRC E */ \
+	X(0x10C, opRRC_0xCB0C,     8,     0,     2)  /* RRC H */ \
+	X(0x10D, opRRC_0xCB0D,     8,     0,     2)  /* RRC L */ \
+	X(0x10E, opRRC_0xCB0E,    16,     0,     2)  /* RRC (HL) */ \
+	X(0x10F, opRRC_0xCB0F,     8,     0,     2)  /* RRC A */ \
+	X(0x110, opRL_0xCB10,      8,     0,     2)  /* RL B */ \
+	X(0x111, opRL_0xCB11,      8,     0,     2)  /* RL C */ \
+	X(0x112, opRL_0xCB12,      8,     0,     2)  /* RL D */ \
+	X(0x113, opRL_0xCB13,      8,     0,     2)  /* RL E */ \
+	X(0x114, opRL_0xCB14,      8,     0,     2)  /* RL H */ \
+	X(0x115, opRL_0xCB15,      8,     0,     2)  /* RL L */ \
+	X(0x116, opRL_0xCB16,     16,     0,     2)  /* RL (HL) */ \
+	X(0x117, opRL_0xCB17,      8,     0,     2)  /* RL A */ \
+	X(0x118, opRR_0xCB18,      8,     0,     2)  /* RR B */ \
+	X(0x119, opRR_0xCB19,      8,     0,     2)  /* RR C */ \
+	X(0x11A, opRR_0xCB1A,      8,     0,     2)  /* RR D */ \
+	X(0x11B, opRR_0xCB1B,      8,     0,     2)  /* RR E */ \
+	X(0x11C, opRR_0xCB1C,      8,     0,     2)  /* RR H */ \
+	X(0x11D, opRR_0xCB1D,      8,     0,     2)  /* RR L */ \
+	X(0x11E, opRR_0xCB1E,     16,     0,     2)  /* RR (HL) */ \
+	X(0x11F, opRR_0xCB1F,      8,     0,     2)  /* RR A */ \
+	X(0x120, opSLA_0xCB20,     8,     0,     2)  /* SLA B */ \
+	X(0x121, opSLA_0xCB21,     8,     0,     2)  /* SLA C */ \
+	X(0x122, opSLA_0xCB22,     8,     0,     2)  /* SLA D */ \
+	X(0x123, opSLA_0xCB23,     8,     0,     2)  /* SLA E */ \
+	X(0x124, opSLA_0xCB24,     8,     0,     2)  /* SLA H */ \
+	X(0x125, opSLA_0xCB25,     8,     0,     2)  /* SLA L */ \
+	X(0x126, opSLA_0xCB26,    16,     0,     2)  /* SLA (HL) */ \
+	X(0x127, opSLA_0xCB27,     8,     0,     2)  /* SLA A */ \
+	X(0x128, opSRA_0xCB28,     8,     0,     2)  /* SRA B */ \
+	X(0x129, opSRA_0xCB29,     8,     0,     2)  /* SRA C */ \
+	X(0x12A, opSRA_0xCB2A,     8,     0,     2)  /* SRA D */ \
+	X(0x12B, opSRA_0xCB2B,     8,     0,     2)  /* SRA E */ \
+	X(0x12C, opSRA_0xCB2C,     8,     0,     2)  /* SRA H */ \
+	X(0x12D, opSRA_0xCB2D,     8,     0,     2)  /* SRA L */ \
+	X(0x12E, opSRA_0xCB2E,    16,     0,     2)  /* SRA (HL) */ \
+	X(0x12F, opSRA_0xCB2F,     8,     0,     2)  /* SRA A */ \
+	X(0x130, opSWAP_0xCB30,    8,     0,     2)  /* SWAP B */ \
+	X(0x131, opSWAP_0xCB31,    8,     0,     2)  /* SWAP C */ \
+	X(0x132, opSWAP_0xCB32,    8,     0,     2)  /* SWAP D */ \
+	X(0x133, opSWAP_0xCB33,    8,     0,     2)  /* SWAP E */ \
+	X(0x134, opSWAP_0xCB34,    8,     0,     2)  /* SWAP H */ \
+	X(0x135, opSWAP_0xCB35,    8,     0,     2)  /* SWAP L */ \
+	X(0x136, opSWAP_0xCB36,   16,     0,     2)  /* SWAP (HL) */ \
+	X(0x137, opSWAP_0xCB37,    8,     0,     2)  /* SWAP A */ \
+	X(0x138, opSRL_0xCB38,     8,     0,     2)  /* SRL B */ \
+	X(0x139, opSRL_0xCB39,     8,     0,     2)  /* SRL C */ \
+	X(0x13A, opSRL_0xCB3A,     8,     0,     2)  /* SRL D */ \
+	X(0x13B, opSRL_0xCB3B,     8,     0,     2)  /* SRL E */ \
+	X(0x13C, opSRL_0xCB3C,     8,     0,     2)  /* SRL H */ \
+	X(0x13D, opSRL_0xCB3D,     8,     0,     2)  /* SRL L */ \
+	X(0x13E, opSRL_0xCB3E,    16,     0,     2)  /* SRL (HL) */ \
+	X(0x13F, opSRL_0xCB3F,     8,     0,     2)  /* SRL A */ \
+	X(0x140, opBIT_0xCB40,     8,     0,     2)  /* BIT 0, B */ \
+	X(0x141, opBIT_0xCB41,     8,     0,     2)  /* BIT 0, C */ \
+	X(0x142, opBIT_0xCB42,     8,     0,     2)  /* BIT 0, D */ \
+	X(0x143, opBIT_0xCB43,     8,     0,     2)  /* BIT 0, E */ \
+	X(0x144, opBIT_0xCB44,     8,     0,     2)  /* BIT 0, H */ \
+	X(0x145, opBIT_0xCB45,     8,     0,     2)  /* BIT 0, L */ \
+	X(0x146, opBIT_0xCB46,    12,     0,     2)  /* BIT 0, (HL) */ \
+	X(0x147, opBIT_0xCB47,     8,     0,     2)  /* BIT 0, A */ \
+	X(0x148, opBIT_0xCB48,     8,     0,     2)  /* BIT 1, B */ \
+	X(0x149, opBIT_0xCB49,     8,     0,     2)  /* BIT 1, C */ \
+	X(0x14A, opBIT_0xCB4A,     8,     0,     2)  /* BIT 1, D */ \
+	X(0x14B, opBIT_0xCB4B,     8,     0,     2)  /* BIT 1, E */ \
+	X(0x14C, opBIT_0xCB4C,     8,     0,     2)  /* BIT 1, H */ \
+	X(0x14D, opBIT_0xCB4D,     8,     0,     2)  /* BIT 1, L */ \
+	X(0x14E, opBIT_0xCB4E,    12,     0,     2)  /* BIT 1, (HL) */ \
+	X(0x14F, opBIT_0xCB4F,     8,     0,     2)  /* BIT 1, A */ \
+	X(0x150, opBIT_0xCB50,     8,     0,     2)  /* BIT 2, B */ \
+	X(0x151, opBIT_0xCB51,     8,     0,     2)  /* BIT 2, C */ \
+	X(0x152, opBIT_0xCB52,     8,     0,     2)  /* BIT 2, D */ \
+	X(0x153, opBIT_0xCB53,     8,     0,     2)  /* BIT 2, E */ \
+	X(0x154, opBIT_0xCB54,     8,     0,     2)  /* BIT 2, H */ \
+	X(0x155, opBIT_0xCB55,     8,     0,     2)  /* BIT 2, L */ \
+	X(0x156, opBIT_0xCB56,    12,     0,     2)  /* BIT 2, (HL) */ \
+	X(0x157, opBIT_0xCB57,     8,     0,     2)  /* BIT 2, A */ \
+	X(0x158, opBIT_0xCB58,     8,     0,     2)  /* BIT 3, B */ \
+	X(0x159, opBIT_0xCB59,     8,     0,     2)  /* BIT 3, C */ \
+	X(0x15A, opBIT_0xCB5A,     8,     0,     2)  /* BIT 3, D */ \
+	X(0x15B, opBIT_0xCB5B,     8,     0,     2)  /* BIT 3, E */ \
+	X(0x15C, opBIT_0xCB5C,     8,     0,     2)  /* BIT 3, H */ \
+	X(0x15D, opBIT_0xCB5D,     8,     0,     2)  /* BIT 3, L */ \
+	X(0x15E, opBIT_0xCB5E,    12,     0,     2)  /* BIT 3, (HL) */ \
+	X(0x15F, opBIT_0xCB5F,     8,     0,     2)  /* BIT 3, A */ \
+	X(0x160, opBIT_0xCB60,     8,     0,     2)  /* BIT 4, B */ \
+	X(0x161, opBIT_0xCB61,     8,     0,     2)  /* BIT 4, C */ \
+	X(0x162, opBIT_0xCB62,     8,     0,     2)  /* BIT 4, D */ \
+	X(0x163, opBIT_0xCB63,     8,     0,     2)  /* BIT 4, E */ \
+	X(0x164, opBIT_0xCB64,     8,     0,     2)  /* BIT 4, H */ \
+	X(0x165, opBIT_0xCB65,     8,     0,     2)  /* BIT 4, L */ \
+	X(0x166, opBIT_0xCB66,    12,     0,     2)  /* BIT 4, (HL) */ \
+	X(0x167, opBIT_0xCB67,     8,     0,     2)  /* BIT 4, A */ \
+	X(0x168, opBIT_0xCB68,     8,     0,     2)  /* BIT 5, B */ \
+	X(0x169, opBIT_0xCB69,     8,     0,     2)  /* BIT 5, C */ \
+	X(0x16A, opBIT_0xCB6A,     8,     0,     2)  /* BIT 5, D */ \
+	X(0x16B, opBIT_0xCB6B,     8,     0,     2)  /* BIT 5, E */ \
+	X(0x16C, opBIT_0xCB6C,     8,     0,     2)  /* BIT 5, H */ \
+	X(0x16D, opBIT_0xCB6D,     8,     0,     2)  /* BIT 5, L */ \
+	X(0x16E, opBIT_0xCB6E,    12,     0,     2)  /* BIT 5, (HL) */ \
+	X(0x16F, opBIT_0xCB6F,     8,     0,     2)  /* BIT 5, A */ \
+	X(0x170, opBIT_0xCB70,     8,     0,     2)  /* BIT 6, B */ \
+	X(0x171, opBIT_0xCB71,     8,     0,     2)  /* BIT 6, C */ \
+	X(0x172, opBIT_0xCB72,     8,     0,     2)  /* BIT 6, D */ \
+	X(0x173, opBIT_0xCB73,     8,     0,     2)  /* BIT 6, E */ \
+	X(0x174, opBIT_0xCB74,     8,     0,     2)  /* BIT 6, H */ \
+	X(0x175, opBIT_0xCB75,     8,     0,     2)  /* BIT 6, L */ \
+	X(0x176, opBIT_0xCB76,    12,     0,     2)  /* BIT 6, (HL) */ \
+	X(0x177, opBIT_0xCB77,     8,     0,     2)  /* BIT 6, A */ \
+	X(0x178, opBIT_0xCB78,     8,     0,     2)  /* BIT 7, B */ \
+	X(0x179, opBIT_0xCB79,     8,     0,     2)  /* BIT 7, C */ \
+	X(0x17A, opBIT_0xCB7A,     8,     0,     2)  /* BIT 7, D */ \
+	X(0x17B, opBIT_0xCB7B,     8,     0,     2)  /* BIT 7, E */ \
+	X(0x17C, opBIT_0xCB7C,     8,     0,     2)  /* BIT 7, H */ \
+	X(0x17D, opBIT_0xCB7D,     8,     0,     2)  /* BIT 7, L */ \
+	X(0x17E, opBIT_0xCB7E,    12,     0,     2)  /* BIT 7, (HL) */ \
+	X(0x17F, opBIT_0xCB7F,     8,     0,     2)  /* BIT 7, A */ \
+	X(0x180, opRES_0xCB80,     8,     0,     2)  /* RES 0, B */ \
+	X(0x181, opRES_0xCB81,     8,     0,     2)  /* RES 0, C */ \
+	X(0x182, opRES_0xCB82,     8,     0,     2)  /* RES 0, D */ \
+	X(0x183, opRES_0xCB83,     8,     0,     2)  /* RES 0, E */ \
+	X(0x184, opRES_0xCB84,     8,     0,     2)  /* RES 0, H */ \
+	X(0x185, opRES_0xCB85,     8,     0,     2)  /* RES 0, L */ \
+	X(0x186, opRES_0xCB86,    16,     0,     2)  /* RES 0, (HL) */ \
+	X(0x187, opRES_0xCB87,     8,     0,     2)  /* RES 0, A */ \
+	X(0x188, opRES_0xCB88,     8,     0,     2)  /* RES 1, B */ \
+	X(0x189, opRES_0xCB89,     8,     0,     2)  /* RES 1, C */ \
+	X(0x18A, opRES_0xCB8A,     8,     0,     2)  /* RES 1, D */ \
+	X(0x18B, opRES_0xCB8B,     8,     0,     2)  /* RES 1, E */ \
+	X(0x18C, opRES_0xCB8C,     8,     0,     2)  /* RES 1, H */ \
+	X(0x18D, opRES_0xCB8D,     8,     0,     2)  /* RES 1, L */ \
+	X(0x18E, opRES_0xCB8E,    16,     0,     2)  /* RES 1, (HL) */ \
+	X(0x18F, opRES_0xCB8F,     8,     0,     2)  /* RES 1, A */ \
+	X(0x190, opRES_0xCB90,     8,     0,     2)  /* RES 2, B */ \
+	X(0x191, opRES_0xCB91,     8,     0,     2)  /* RES 2, C */ \
+	X(0x192, opRES_0xCB92,     8,     0,     2)  /* RES 2, D */ \
+	X(0x193, opRES_0xCB93,     8,     0,     2)  /* RES 2, E */ \
+	X(0x194, opRES_0xCB94,     8,     0,     2)  /* RES 2, H */ \
+	X(0x195, opRES_0xCB95,     8,     0,     2)  /* RES 2, L */ \
+	X(0x196, opRES_0xCB96,    16,     0,     2)  /* RES 2, (HL) */ \
+	X(0x197, opRES_0xCB97,     8,     0,     2)  /* RES 2, A */ \
+	X(0x198, opRES_0xCB98,     8,     0,     2)  /* RES 3, B */ \
+	X(0x199, opRES_0xCB99,     8,     0,     2)  /* RES 3, C */ \
+	X(0x19A, opRES_0xCB9A,     8,     0,     2)  /* RES 3, D */ \
+	X(0x19B, opRES_0xCB9B,     8,     0,     2)  /* RES 3, E */ \
+	X(0x19C, opRES_0xCB9C,     8,     0,     2)  /* RES 3, H */ \
+	X(0x19D, opRES_0xCB9D,     8,     0,     2)  /* RES 3, L */ \
+	X(0x19E, opRES_0xCB9E,    16,     0,     2)  /* RES 3, (HL) */ \
+	X(0x19F, opRES_0xCB9F,     8,     0,     2)  /* RES 3, A */ \
+	X(0x1A0, opRES_0xCBA0,     8,     0,     2)  /* RES 4, B */ \
+	X(0x1A1, opRES_0xCBA1,     8,     0,     2)  /* RES 4, C */ \
+	X(0x1A2, opRES_0xCBA2,     8,     0,     2)  /* RES 4, D */ \
+	X(0x1A3, opRES_0xCBA3,     8,     0,     2)  /* RES 4, E */ \
+	X(0x1A4, opRES_0xCBA4,     8,     0,     2)  /* RES 4, H */ \
+	X(0x1A5, opRES_0xCBA5,     8,     0,     2)  /* RES 4, L */ \
+	X(0x1A6, opRES_0xCBA6,    16,     0,     2)  /* RES 4, (HL) */ \
+	X(0x1A7, opRES_0xCBA7,     8,     0,     2)  /* RES 4, A */ \
+	X(0x1A8, opRES_0xCBA8,     8,     0,     2)  /* RES 5, B */ \
+	X(0x1A9, opRES_0xCBA9,     8,     0,     2)  /* RES 5, C */ \
+	X(0x1AA, opRES_0xCBAA,     8,     0,     2)  /* RES 5, D */ \
+	X(0x1AB, opRES_0xCBAB,     8,     0,     2)  /* RES 5, E */ \
+	X(0x1AC, opRES_0xCBAC,     8,     0,     2)  /* RES 5, H */ \
+	X(0x1AD, opRES_0xCBAD,     8,     0,     2)  /* RES 5, L */ \
+	X(0x1AE, opRES_0xCBAE,    16,     0,     2)  /* RES 5, (HL) */ \
+	X(0x1AF, opRES_0xCBAF,     8,     0,     2)  /* RES 5, A */ \
+	X(0x1B0, opRES_0xCBB0,     8,     0,     2)  /* RES 6, B */ \
+	X(0x1B1, opRES_0xCBB1,     8,     0,     2)  /* RES 6, C */ \
+	X(0x1B2, opRES_0xCBB2,     8,     0,     2)  /* RES 6, D */ \
+	X(0x1B3, opRES_0xCBB3,     8,     0,     2)  /* RES 6, E */ \
+	X(0x1B4, opRES_0xCBB4,     8,     0,     2)  /* RES 6, H */ \
+	X(0x1B5, opRES_0xCBB5,     8,     0,     2)  /* RES 6, L */ \
+	X(0x1B6, opRES_0xCBB6,    16,     0,     2)  /* RES 6, (HL) */ \
+	X(0x1B7, opRES_0xCBB7,     8,     0,     2)  /* RES 6, A */ \
+	X(0x1B8, opRES_0xCBB8,     8,     0,     2)  /* RES 7, B */ \
+	X(0x1B9, opRES_0xCBB9,     8,     0,     2)  /* RES 7, C */ \
+	X(0x1BA, opRES_0xCBBA,     8,     0,     2)  /* RES 7, D */ \
+	X(0x1BB, opRES_0xCBBB,     8,     0,     2)  /* RES 7, E */ \
+	X(0x1BC, opRES_0xCBBC,     8,     0,     2)  /* RES 7, H */ \
+	X(0x1BD, opRES_0xCBBD,     8,     0,     2)  /* RES 7, L */ \
+	X(0x1BE, opRES_0xCBBE,    16,     0,     2)  /* RES 7, (HL) */ \
+	X(0x1BF, opRES_0xCBBF,     8,     0,     2)  /* RES 7, A */ \
+	X(0x1C0, opSET_0xCBC0,     8,     0,     2)  /* SET 0, B */ \
+	X(0x1C1, opSET_0xCBC1,     8,     0,     2)  /* SET 0, C */ \
+	X(0x1C2, opSET_0xCBC2,     8,     0,     2)  /* SET 0, D */ \
+	X(0x1C3, opSET_0xCBC3,     8,     0,     2)  /* SET 0, E */ \
+	X(0x1C4, opSET_0xCBC4,     8,     0,     2)  /* SET 0, H */ \
+	X(0x1C5, opSET_0xCBC5,     8,     0,     2)  /* SET 0, L */ \
+	X(0x1C6, opSET_0xCBC6,    16,     0,     2)  /* SET 0, (HL) */ \
+	X(0x1C7, opSET_0xCBC7,     8,     0,     2)  /* SET 0, A */ \
+	X(0x1C8, opSET_0xCBC8,     8,     0,     2)  /* SET 1, B */ \
+	X(0x1C9, opSET_0xCBC9,     8,     0,     2)  /* SET 1, C */ \
+	X(0x1CA, opSET_0xCBCA,     8,     0,     2)  /* SET 1, D */ \
+	X(0x1CB, opSET_0xCBCB,     8,     0,     2)  /* SET 1, E */ \
+	X(0x1CC, opSET_0xCBCC,     8,     0,     2)  /* SET 1, H */ \
+	X(0x1CD, opSET_0xCBCD,     8,     0,     2)  /* SET 1, L */ \
+	X(0x1CE, opSET_0xCBCE,    16,     0,     2)  /* SET 1, (HL) */ \
+	X(0x1CF, opSET_0xCBCF,     8,     0,     2)  /* SET 1, A */ \
+	X(0x1D0, opSET_0xCBD0,     8,     0,     2)  /* SET 2, B */ \
+	X(0x1D1, opSET_0xCBD1,     8,     0,     2)  /* SET 2, C */ \
+	X(0x1D2, opSET_0xCBD2,     8,     0,     2)  /* SET 2, D */ \
+	X(0x1D3, opSET_0xCBD3,     8,     0,     2)  /* SET 2, E */ \
+	X(0x1D4, opSET_0xCBD4,     8,     0,     2)  /* SET 2, H */ \
+	X(0x1D5, opSET_0xCBD5,     8,     0,     2)  /* SET 2, L */ \
+	X(0x1D6, opSET_0xCBD6,    16,     0,     2)  /* SET 2, (HL) */ \
+	X(0x1D7, opSET_0xCBD7,     8,     0,     2)  /* SET 2, A */ \
+	X(0x1D8, opSET_0xCBD8,     8,     0,     2)  /* SET 3, B */ \
+	X(0x1D9, opSET_0xCBD9,     8,     0,     2)  /* SET 3, C */ \
+	X(0x1DA, opSET_0xCBDA,     8,     0,     2)  /* SET 3, D */ \
+	X(0x1DB, opSET_0xCBDB,     8,     0,     2)  /* SET 3, E */ \
+	X(0x1DC, opSET_0xCBDC,     8,     0,     2)  /* SET 3, H */ \
+	X(0x1DD, opSET_0xCBDD,     8,     0,     2)  /* SET 3, L */ \
+	X(0x1DE, opSET_0xCBDE,    16,     0,     2)  /* SET 3, (HL) */ \
+	X(0x1DF, opSET_0xCBDF,     8,     0,     2)  /* SET 3, A */ \
+	X(0x1E0, opSET_0xCBE0,     8,     0,     2)  /* SET 4, B */ \
+	X(0x1E1, opSET_0xCBE1,     8,     0,     2)  /* SET 4, C */ \
+	X(0x1E2, opSET_0xCBE2,     8,     0,     2)  /* SET 4, D */ \
+	X(0x1E3, opSET_0xCBE3,     8,     0,     2)  /* SET 4, E */ \
+	X(0x1E4, opSET_0xCBE4,     8,     0,     2)  /* SET 4, H */ \
+	X(0x1E5, opSET_0xCBE5,     8,     0,     2)  /* SET 4, L */ \
+	X(0x1E6, opSET_0xCBE6,    16,     0,     2)  /* SET 4, (HL) */ \
+	X(0x1E7, opSET_0xCBE7,     8,     0,     2)  /* SET 4, A */ \
+	X(0x1E8, opSET_0xCBE8,     8,     0,     2)  /* SET 5, B */ \
+	X(0x1E9, opSET_0xCBE9,     8,     0,     2)  /* SET 5, C */ \
+	X(0x1EA, opSET_0xCBEA,     8,     0,     2)  /* SET 5, D */ \
+	X(0x1EB, opSET_0xCBEB,     8,     0,     2)  /* SET 5, E */ \
+	X(0x1EC, opSET_0xCBEC,     8,     0,     2)  /* SET 5, H */ \
+	X(0x1ED, opSET_0xCBED,     8,     0,     2)  /* SET 5, L */ \
+	X(0x1EE, opSET_0xCBEE,    16,     0,     2)  /* SET 5, (HL) */ \
+	X(0x1EF, opSET_0xCBEF,     8,     0,     2)  /* SET 5, A */ \
+	X(0x1F0, opSET_0xCBF0,     8,     0,     2)  /* SET 6, B */ \
+	X(0x1F1, opSET_0xCBF1,     8,     0,     2)  /* SET 6, C */ \
+	X(0x1F2, opSET_0xCBF2,     8,     0,     2)  /* SET 6, D */ \
+	X(0x1F3, opSET_0xCBF3,     8,     0,     2)  /* SET 6, E */ \
+	X(0x1F4, opSET_0xCBF4,     8,     0,     2)  /* SET 6, H */ \
+	X(0x1F5, opSET_0xCBF5,     8,     0,     2)  /* SET 6, L */ \
+	X(0x1F6, opSET_0xCBF6,    16,     0,     2)  /* SET 6, (HL) */ \
+	X(0x1F7, opSET_0xCBF7,     8,     0,     2)  /* SET 6, A */ \
+	X(0x1F8, opSET_0xCBF8,     8,     0,     2)  /* SET 7, B */ \
+	X(0x1F9, opSET_0xCBF9,     8,     0,     2)  /* SET 7, C */ \
+	X(0x1FA, opSET_0xCBFA,     8,     0,     2)  /* SET 7, D */ \
+	X(0x1FB, opSET_0xCBFB,     8,     0,     2)  /* SET 7, E */ \
+	X(0x1FC, opSET_0xCBFC,     8,     0,     2)  /* SET 7, H */ \
+	X(0x1FD, opSET_0xCBFD,     8,     0,     2)  /* SET 7, L */ \
+	X(0x1FE, opSET_0xCBFE,    16,     0,     2)  /* SET 7, (HL) */ \
+	X(0x1FF, opSET_0xCBFF,     8,     0,     2)  /* SET 7, A */ \
+
+
+#define GB_DISPATCH_TABLE_ENTRY(opCode, function, cycles, extra, size) [opCode] = { function, cycles, extra, size },
+
 struct gbInstruction gbDispatchTable[GB_NUM_OF_OPCODES] =
 {
-//	{ function,     cycles,  extra,  size } 
-	{ opNOP_0x00,   4,       0,      1    },  // NOP
-	{ opLD_0x01,    12,      0,	 3    },  // LD BC, d16
-	{ opLD_0x02,    8,       0,	 1    },  // LD (BC), A
-	{ opINC_0x03,   8,       0,	 1    },  // INC BC 
-	{ opINC_0x04,   4,       0,	 1    },  // INC B
-	{ opDEC_0x05,   4,       0,	 1    },  // DEC B
-	{ opLD_0x06,    8,       0,	 2    },  // LD B, d8
-	{ opRLCA_0x07,  4,       0,	 1    },  // RLCA
-	{ opLD_0x08,    20,      0,	 3    },  // LD (a16), SP
-	{ opADD_0x09,   8,       0,	 1    },  // ADD HL, BC
-	{ opLD_0x0A,    8,       0,	 1    },  // LD A, (BC) 
-	{ opDEC_0x0B,   8,       0,	 1    },  // DEC BC 
-	{ opINC_0x0C,   4,       0,	 1    },  // INC C 
-	{ opDEC_0x0D,   4,       0,	 1    },  // DEC C 
-	{ opLD_0x0E,    8,       0,	 2    },  // LD C, d8 
-	{ opRRCA_0x0F,  4,       0,	 1    },  // RRCA
-	{ opSTOP_0x10,  4,       0,	 2    },  // STOP d8
-	{ opLD_0x11,    12,      0,	 3    },  // LD DE, d16
-	{ opLD_0x12,    8,       0,	 1    },  // LD (DE), A
-	{ opINC_0x13,   8,       0,	 1    },  // INC DE
-	{ opINC_0x14,   4,       0,	 1    },  // INC D
-	{ opDEC_0x15,   4,       0,	 1    },  // DEC D
-	{ opLD_0x16,    8,       0,	 2    },  // LD D, d8
-	{ opRLA_0x17,   4,       0,	 1    },  // RLA
-	{ opJR_0x18,    12,      0,	 2    },  // JR r8
-	{ opADD_0x19,   8,       0,	 1    },  // ADD HL, DE
-	{ opLD_0x1A,    8,       0,	 1    },  // LD A,(DE)
-	{ opDEC_0x1B,   8,       0,	 1    },  // DEC DE
-	{ opINC_0x1C,   4,       0,	 1    },  // INC E
-	{ opDEC_0x1D,   4,       0,	 1    },  // DEC E
-	{ opLD_0x1E,    8,       0,	 2    },  // LD E,d8
-	{ opRRA_0x1F,   4,       0,	 1    },  // RRA
-	{ opJR_0x20,    8,       4,	 2    },  // JR NZ, e8 
-	{ opLD_0x21,    12,      0,	 3    },  // LD HL, d16
-	{ opLD_0x22,    8,       0,	 1    },  // LD (HL+), A
-	{ opINC_0x23,   8,       0,	 1    },  // INC HL
-	{ opINC_0x24,   4,       0,	 1    },  // INC H
-	{ opDEC_0x25,   4,       0,	 1    },  // DEC H
-	{ opLD_0x26,    8,       0,	 2    },  // LD H, d8
-	{ opDAA_0x27,   4,       0,	 1    },  // DAA
-	{ opJR_0x28,    8,       4,	 2    },  // JR Z
-	{ opADD_0x29,   8,       0,	 1    },  // ADD HL, HL
-	{ opLD_0x2A,    8,       0,	 1    },  // LD A, (HL+)
-	{ opDEC_0x2B,   8,       0,	 1    },  // DEC HL
-	{ opINC_0x2C,   4,       0,	 1    },  // INC L
-	{ opDEC_0x2D,   4,       0,	 1    },  // DEC L
-	{ opLD_0x2E,    8,       0,	 2    },  // LD L, d8
-	{ opCPL_0x2F,   4,       0,	 1    },  // CPL
-	{ opLD_0x31,   12,       0,	 3    },  // LD SP, n16
-	{ opLD_0x32,    8,       0,	 1    },  // LD (HL-), A
-	{ opINC_0x33,   8,       0,	 1    },  // INC SP
-	{ opINC_0x34,  12,       0,	 1    },  // INC (HL)
-	{ opDEC_0x35,  12,       0,	 1    },  // DEC (HL)
-	{ opLD_0x36,   12,       0,	 2    },  // LD (HL), n8 
-	{ opSCF_0x37,   4,       0,	 1    },  // SCF
-	{ opLD_0x3A,   	8,       0,	 1    },  // LD A, (HL-) 
-	{ opDEC_0x3B,   8,       0,	 1    },  // DEC SP
-	{ opINC_0x3C,   4,       0,	 1    },  // INC A
-	{ opDEC_0x3D,   4,       0,	 1    },  // DEC A
-	{ opLD_0x3E,    8,       0,	 2    },  // LD A, n8 
-	{ opCCF_0x3F,   4,       0,	 1    },  // CCF
+	GB_OPCODE_LIST(GB_DISPATCH_TABLE_ENTRY)
 };
+
+/*
+ * @brief Initializes the gb struct to the state the DMG leaves it in once the boot ROM hands over to the cartridge
+ * @param gb Pointer to gb struct to be initialized
+ * @return void
+ */
+void gbInit(gameBoy_t* gb)
+{
+	memset(gb, 0, sizeof(gameBoy_t));
+	busRemap(gb);
+
+	gb->generalReg.a = 0x01;
+	gb->generalReg.f = 0xB0;
+	gb->generalReg.b = 0x00;
+	gb->generalReg.c = 0x13;
+	gb->generalReg.d = 0x00;
+	gb->generalReg.e = 0xD8;
+	gb->generalReg.h = 0x01;
+	gb->generalReg.l = 0x4D;
+	gb->pc = 0x0100;
+	gb->sp = 0xFFFE;
+	schedInit(gb);
+	ppuInit(gb);
+	timersInit(gb);
+	apuInit(gb);
+	inputInit(gb);
+	idleInit(gb);
+}
+
+/*
+ * @brief Frees anything gbInit or the CPU core allocated for the gb struct
+ * @param gb Pointer to gb struct to be cleaned up
+ * @return void
+ */
+void gbDeinit(gameBoy_t* gb)
+{
+	cartUnload(gb);
+	blockCacheDestroy(gb->blockCache);
+	gb->blockCache = NULL;
+	jitArenaDestroy(gb->jitArena);
+	gb->jitArena = NULL;
+}
+
+/*
+ * @brief Fetches, decodes and executes the instruction pointed to by the Program Counter
+ * @param gb Pointer to gb struct containing registers
+ * @return Number of clock cycles consumed by the instruction
+ */
+static inline uint8_t gbExecuteInstruction(gameBoy_t* gb)
+{
+	uint16_t currentOpCode = gbGetOpCode(gb);
+	uint8_t cycles = gbDispatchTable[currentOpCode].clockCycles;
+
+	gbDispatchTable[currentOpCode].operation(gb);
+	gb->pc += gbDispatchTable[currentOpCode].opCodeSize;
+
+	// Some operations consume a variable amount of time. Account for that extra time if necessary
+	if(gb->cyclesExtraFlag == true)
+	{
+		cycles += gbDispatchTable[currentOpCode].clockCyclesExtra;
+		gb->cyclesExtraFlag = false;
+	}
+
+	return cycles;
+}
+
 /*
  * @brief Function for handling the emulator's dispatch process (fetching, decoding, executing)
  * @details Uses a function/dispatch table to minimize time complexity by mapping each function pointer's index to their 
 	corresponding op code
  * @param Pointer to gb struct containing registers
  * @return void
+ * @note Steps a single T-cycle. Prefer gbRunCycles/gbRunFrame, which don't pay a function call per cycle
  */
 void gbHandleCycle(gameBoy_t* gb)
 {
-	uint16_t currentOpCode = 0;
-	// If the execution time for the current operation has elapsed, move on to the next
-	if(gb->cyclesCurrent == gb->cyclesTarget)
+	// If the execution time for the current operation has elapsed, move on to the next. Taking an interrupt can
+	// carry cyclesCurrent past cyclesTarget
+	if(gb->cyclesCurrent >= gb->cyclesTarget)
+	{
+		// Set cyclesTarget so we know when to move on. A halted CPU just lets time pass
+		gb->cyclesTarget = gb->cyclesCurrent + (gb->halted ? 1 : gbExecuteInstruction(gb));
+	}
+
+	gb->cyclesCurrent++;
+	if(gb->cyclesCurrent >= schedNext(&gb->sched))
+	{
+		schedRun(gb);
+	}
+}
+
+#ifdef GB_CORE_THREADED
+/*
+ * @brief Handler block for a single op code in the threaded core
+ * @details Calls the same op* function as the dispatch table, but directly by name, so the compiler can inline it into
+	the block. The block then does its own PC/cycle bookkeeping (with cycles, extra and size as constants) and jumps
+	straight to the next op code's block. Every block ends in its own indirect jump, which gives the branch predictor
+	one history slot per op code instead of a single shared one in the dispatch loop
+ */
+#define GB_THREADED_HANDLER(opCode, function, cycles, extra, size) \
+label_##opCode: \
+	function(gb); \
+	gb->pc += (size); \
+	gb->cyclesCurrent += (cycles); \
+	if((extra) != 0 && gb->cyclesExtraFlag == true) \
+	{ \
+		gb->cyclesCurrent += (extra); \
+		gb->cyclesExtraFlag = false; \
+	} \
+	GB_THREADED_DISPATCH();
+
+#define GB_THREADED_LABEL(opCode, function, cycles, extra, size) [opCode] = &&label_##opCode,
+
+#define GB_THREADED_DISPATCH() \
+	if(gb->cyclesCurrent >= gb->cyclesEnd) \
+	{ \
+		goto done; \
+	} \
+	goto *labels[gbGetOpCode(gb)]
+
+/*
+ * @brief Runs whole instructions back to back until gb->cyclesEnd has been reached
+ * @details Threaded-code core built on GCC's labels-as-values (computed goto), selected with `make CORE=threaded`.
+	Semantics match the dispatch table core exactly, as both are generated from GB_OPCODE_LIST
+ * @param gb Pointer to gb struct containing registers
+ * @return void
+ * @note The last instruction is always completed, so cyclesCurrent can end up past cyclesEnd by up to one instruction
+ */
+static void gbRunCore(gameBoy_t* gb)
+{
+	static void* const labels[GB_NUM_OF_OPCODES] =
+	{
+		GB_OPCODE_LIST(GB_THREADED_LABEL)
+	};
+
+	GB_THREADED_DISPATCH();
+	GB_OPCODE_LIST(GB_THREADED_HANDLER)
+
+done:
+	return;
+}
+#elif defined(GB_CORE_BLOCK)
+/*
+ * @brief Runs whole instructions back to back until gb->cyclesEnd has been reached
+ * @details Block core, selected with `make CORE=block`. Runs pre-decoded blocks out of the block cache (see block.c),
+	so op codes are only fetched and looked up in gbDispatchTable the first time a block is reached
+ * @param gb Pointer to gb struct containing registers
+ * @return void
+ * @note The last instruction is always completed, so cyclesCurrent can end up past cyclesEnd by up to one instruction
+ */
+static void gbRunCore(gameBoy_t* gb)
+{
+	if(gb->blockCache == NULL)
+	{
+		gb->blockCache = blockCacheCreate();
+	}
+#ifdef GB_JIT
+	if(gb->jitArena == NULL)
+	{
+		gb->jitArena = jitArenaCreate();
+	}
+#endif
+
+	while(gb->cyclesCurrent < gb->cyclesEnd)
+	{
+		block_t* block = blockLookup(gb);
+		uint64_t cyclesEnd = gb->cyclesEnd;
+		bool bounded = false;
+		uint8_t i = 0;
+
+		if(block == NULL)
+		{
+			// Running from OAM or the I/O registers, which are never cached
+			gb->blockCache->running = NULL;
+			gb->cyclesCurrent += gbExecuteInstruction(gb);
+			continue;
+		}
+
+		// Only branches (always last in a block) take extra cycles, so if the whole block fits in the budget
+		// there's no need to check it between instructions
+		bounded = (gb->cyclesCurrent + block->cycles) > cyclesEnd;
+		gb->blockCache->running = block;
+#ifdef GB_JIT
+		// Count runs of each block, translating it to native code once it's hot. The translation covers everything
+		// but the closing branch, and is only used when the block fits in the budget so cycle accounting stays exact
+		if((block->jitCode == NULL) && (++block->execCount == JIT_HOT_THRESHOLD))
+		{
+			jitCompile(gb, block);
+		}
+		if((block->jitCode != NULL) && !bounded)
+		{
+			i = block->jitCode(gb);
+			if(!block->valid)
+			{
+				continue;
+			}
+			// The translation also returns early once a write (or I/O read) has scheduled an event the block no longer
+			// fits before
+			bounded = gb->cyclesEnd < cyclesEnd;
+			if(bounded && (gb->cyclesCurrent >= gb->cyclesEnd))
+			{
+				// e.g. an interrupt requested by the write, which has to be taken before the next instruction
+				continue;
+			}
+		}
+#endif
+
+		for(; i < block->count; i++)
+		{
+			blockInstruction_t* instruction = &block->instructions[i];
+
+			instruction->operation(gb);
+			gb->pc += instruction->opCodeSize;
+			gb->cyclesCurrent += instruction->clockCycles;
+
+			if(gb->cyclesExtraFlag == true)
+			{
+				gb->cyclesCurrent += instruction->clockCyclesExtra;
+				gb->cyclesExtraFlag = false;
+			}
+
+			if(instruction->writesMemory)
+			{
+				// Stop if the instruction overwrote (or bank switched out) the block it's running from
+				if(!block->valid)
+				{
+					break;
+				}
+				// A write to an I/O register can schedule an event sooner than the block was started with, in which
+				// case the rest of the block is checked against the new budget
+				bounded = bounded || (gb->cyclesEnd < cyclesEnd);
+			}
+			else if(instruction->readsMemory)
+			{
+				// So can a read that has the PPU catch up, e.g. polling STAT
+				bounded = bounded || (gb->cyclesEnd < cyclesEnd);
+			}
+			if(bounded && (gb->cyclesCurrent >= gb->cyclesEnd))
+			{
+				break;
+			}
+		}
+	}
+}
+#else
+/*
+ * @brief Runs whole instructions back to back until gb->cyclesEnd has been reached
+ * @param gb Pointer to gb struct containing registers
+ * @return void
+ * @note The last instruction is always completed, so cyclesCurrent can end up past cyclesEnd by up to one instruction
+ */
+static void gbRunCore(gameBoy_t* gb)
+{
+	while(gb->cyclesCurrent < gb->cyclesEnd)
+	{
+		gb->cyclesCurrent += gbExecuteInstruction(gb);
+	}
+}
+#endif // GB_CORE_THREADED / GB_CORE_BLOCK
+
+/*
+ * @brief Runs whole instructions back to back until a budget of clock cycles has been used up
+ * @details The CPU core runs uninterrupted up to the next scheduled event (see sched.c), then the handlers of
+	whatever's due are called, and so on until the budget runs out. Interrupts are taken by one such handler (see
+	interrupts.c). While the CPU is halted, time skips straight from one event to the next
+ * @param gb Pointer to gb struct containing registers
+ * @param budget Number of clock cycles to run for
+ * @return Number of clock cycles actually consumed
+ * @note The last instruction is always completed, so the return value can exceed budget by up to one instruction
+ */
+uint32_t gbRunCycles(gameBoy_t* gb, uint32_t budget)
+{
+	uint64_t cyclesStart = gb->cyclesCurrent;
+	uint64_t cyclesEnd = cyclesStart + budget;
+
+	while(gb->cyclesCurrent < cyclesEnd)
 	{
-		currentOpCode = gbGetOpCode(gb);
-		// Execute operation
-		gbDispatchTable[currentOpCode].operation(gb);
-		// Different opcodes have different lengths. Increment PC by length of most recent operation in bytes
-		gb->pc+= gbDispatchTable[currentOpCode].opCodeSize;
-		// Set cyclesTarget so we know when to move on
-		gb->cyclesTarget = gb->cyclesCurrent + gbDispatchTable[currentOpCode].clockCycles;
-
-		// Some operations consume a variable amount of time. Account for that extra time if necessary
-		if(gb->cyclesExtraFlag == true)
+		uint64_t deadline = schedNext(&gb->sched);
+
+		gb->cyclesEnd = (deadline < cyclesEnd) ? deadline : cyclesEnd;
+		if(gb->halted)
+		{
+			if(gb->cyclesCurrent < gb->cyclesEnd)
+			{
+				gb->cyclesCurrent = gb->cyclesEnd;
+			}
+		}
+		else
 		{
-			gb->cyclesTarget += gbDispatchTable[currentOpCode].clockCyclesExtra;
-			gb->cyclesExtraFlag = false;
+			gbRunCore(gb);
 		}
+		schedRun(gb);
 	}
 
-	gb->cyclesCurrent++;
+	// Keep gbHandleCycle in step in case callers mix the two
+	gb->cyclesTarget = gb->cyclesCurrent;
+	// Render whatever the CPU has run past, so the framebuffer is current on return
+	ppuSync(gb);
+
+	return (uint32_t)(gb->cyclesCurrent - cyclesStart);
+}
+
+/*
+ * @brief Runs the CPU up to the end of the current video frame
+ * @param gb Pointer to gb struct containing registers
+ * @return Number of clock cycles actually consumed
+ * @note Frames end on multiples of GB_CYCLES_PER_FRAME, so overshoot from the last instruction of one frame
+ * is taken out of the next one rather than accumulating
+ */
+uint32_t gbRunFrame(gameBoy_t* gb)
+{
+	uint64_t frameEnd = (gb->cyclesCurrent / GB_CYCLES_PER_FRAME + 1) * GB_CYCLES_PER_FRAME;
+
+	return gbRunCycles(gb, (uint32_t)(frameEnd - gb->cyclesCurrent));
 }
@@ -1,11 +1,142 @@
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
 #include <SDL2/SDL.h>
 #include "graphics.h"
 
+/*
+ * graphics.c: SDL frontend. Emulation runs on its own thread and publishes each finished frame, the main thread
+ * presents them as the display allows. Frames are handed over through 3 buffers (triple buffering): one being
+ * written by the emulation thread, one ready to be presented and one being presented, so neither side ever holds
+ * up the other in GRAPHICS_PRESENT_LATEST mode
+ */
+
+// Written straight from the newest frame with SDL_LockTexture, then scaled up to the window by the renderer
+static SDL_Texture* graphicsTexture = NULL;
+
+static uint32_t graphicsFrames[3][RESOLUTION_X * RESOLUTION_Y];
+// Which of graphicsFrames each side holds. Swapped under graphicsLock
+static uint8_t graphicsBack = 0; 	// Being written by graphicsPublishFrame
+static uint8_t graphicsReady = 1; 	// Newest complete frame
+static uint8_t graphicsFront = 2; 	// Being presented by graphicsPresent
+static bool graphicsFresh = false; 	// graphicsReady hasn't been presented yet
+static bool graphicsStopped = false;
+static graphicsPresentMode_t graphicsMode = GRAPHICS_PRESENT_LATEST;
+static pthread_mutex_t graphicsLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t graphicsTaken = PTHREAD_COND_INITIALIZER;
+
 int graphicsInit(SDL_Window** window, SDL_Renderer** renderer)
 {
 	int retVal = SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO);
 	*window = SDL_CreateWindow("Felix's GB Emulator", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, RESOLUTION_X * RESOLUTION_SCALE, 
 		RESOLUTION_Y * RESOLUTION_SCALE, SDL_WINDOW_SHOWN);
-	*renderer = SDL_CreateRenderer(*window, -1, SDL_WINDOW_SHOWN);
+	*renderer = SDL_CreateRenderer(*window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+	graphicsTexture = SDL_CreateTexture(*renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+		RESOLUTION_X, RESOLUTION_Y);
 	return retVal;
 }
+
+/*
+ * @brief Frees the texture created by graphicsInit
+ * @return void
+ */
+void graphicsDeinit(void)
+{
+	if(graphicsTexture != NULL)
+	{
+		SDL_DestroyTexture(graphicsTexture);
+		graphicsTexture = NULL;
+	}
+}
+
+/*
+ * @brief Picks whether stale frames are dropped (the default) or every frame is presented
+ * @param mode GRAPHICS_PRESENT_LATEST or GRAPHICS_PRESENT_EVERY
+ * @return void
+ * @note GRAPHICS_PRESENT_EVERY slows emulation down to the display's refresh rate if that's lower
+ */
+void graphicsSetPresentMode(graphicsPresentMode_t mode)
+{
+	pthread_mutex_lock(&graphicsLock);
+	graphicsMode = mode;
+	pthread_cond_broadcast(&graphicsTaken);
+	pthread_mutex_unlock(&graphicsLock);
+}
+
+/*
+ * @brief Hands a finished frame over to be presented. Called from the emulation thread
+ * @param frame RESOLUTION_X x RESOLUTION_Y ARGB8888 pixels, as returned by ppuGetFrame
+ * @return void
+ * @note The frame is copied, as the PPU starts drawing the next one over it straight away
+ */
+void graphicsPublishFrame(const uint32_t* frame)
+{
+	uint8_t written = 0;
+
+	memcpy(graphicsFrames[graphicsBack], frame, sizeof(graphicsFrames[0]));
+
+	pthread_mutex_lock(&graphicsLock);
+	while((graphicsMode == GRAPHICS_PRESENT_EVERY) && graphicsFresh && !graphicsStopped)
+	{
+		pthread_cond_wait(&graphicsTaken, &graphicsLock);
+	}
+	// If the ready frame was never presented, it's dropped here
+	written = graphicsBack;
+	graphicsBack = graphicsReady;
+	graphicsReady = written;
+	graphicsFresh = true;
+	pthread_mutex_unlock(&graphicsLock);
+}
+
+/*
+ * @brief Presents the newest frame, if one has been published since the last call. Called from the main thread
+ * @param renderer Renderer created by graphicsInit
+ * @return true if a frame was presented, false if there was nothing new
+ * @note Blocks until vertical sync, which only holds up this thread
+ */
+bool graphicsPresent(SDL_Renderer* renderer)
+{
+	uint8_t taken = 0;
+	void* pixels = NULL;
+	int pitch = 0;
+
+	pthread_mutex_lock(&graphicsLock);
+	if(!graphicsFresh)
+	{
+		pthread_mutex_unlock(&graphicsLock);
+		return false;
+	}
+	taken = graphicsReady;
+	graphicsReady = graphicsFront;
+	graphicsFront = taken;
+	graphicsFresh = false;
+	pthread_cond_signal(&graphicsTaken);
+	pthread_mutex_unlock(&graphicsLock);
+
+	if(SDL_LockTexture(graphicsTexture, NULL, &pixels, &pitch) == 0)
+	{
+		for(uint32_t y = 0; y < RESOLUTION_Y; y++)
+		{
+			memcpy((uint8_t*)pixels + y * pitch, &graphicsFrames[graphicsFront][y * RESOLUTION_X],
+				RESOLUTION_X * sizeof(uint32_t));
+		}
+		SDL_UnlockTexture(graphicsTexture);
+	}
+	SDL_RenderClear(renderer);
+	SDL_RenderCopy(renderer, graphicsTexture, NULL, NULL);
+	SDL_RenderPresent(renderer);
+
+	return true;
+}
+
+/*
+ * @brief Releases the emulation thread if it's waiting in graphicsPublishFrame, so it can see it's been stopped
+ * @return void
+ */
+void graphicsStop(void)
+{
+	pthread_mutex_lock(&graphicsLock);
+	graphicsStopped = true;
+	pthread_cond_broadcast(&graphicsTaken);
+	pthread_mutex_unlock(&graphicsLock);
+}
@@ -0,0 +1,501 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bus.h"
+#include "cart.h"
+#include "gb.h"
+#include "idle.h"
+#include "image.h"
+#include "input.h"
+#include "movie.h"
+#include "pool.h"
+#include "ppu.h"
+#include "romindex.h"
+#include "state.h"
+#include "utils.h"
+
+/*
+ * headless.c: Frontend without SDL, built as felixGB-headless. Runs a ROM for a set number of frames or clock cycles
+ * as fast as the host allows (no frame pacing, no audio synthesis), optionally writes out the last frame and a hash
+ * of memory, then exits. For batch runs and regression checks on machines without a display. Given several ROMs (or
+ * a manifest listing them), runs one emulator instance per ROM across a pool of threads, one per core by default.
+ * A single run can start from a save state and save one at the end, to restart from mid-game checkpoints, or replay
+ * an input movie and check it ends up where the recording did. With --hash, each ROM is also identified by its SHA-1,
+ * taken from a ROM index (--rom-index, built with --index) when it has a current entry for the ROM rather than hashed
+ */
+
+#define HEADLESS_DEFAULT_FRAMES 600
+
+// Settings shared (read only) by every instance in a run
+typedef struct
+{
+	uint64_t frames;
+	uint64_t cycles; 	// Run for this many cycles instead of frames, if set
+	bool hash;
+	bool idleSkip;
+	const movie_t* movie; 	// Replay this instead, if set
+	const romIndex_t* romIndex; // Metadata of ROMs hashed before (empty if no index was given)
+} headlessOptions_t;
+
+// What one instance of a batch run did
+typedef struct
+{
+	bool loaded;
+	uint64_t cycles;
+	double seconds;
+	uint8_t digest[UTILS_SHA1_SIZE];
+	romIndexEntry_t rom; 	// Looked up for --hash
+} headlessResult_t;
+
+typedef struct
+{
+	const headlessOptions_t* options;
+	char** roms;
+	headlessResult_t* results;
+} headlessBatch_t;
+
+/*
+ * @brief Prints the command line options
+ * @return void
+ */
+static void headlessUsage(void)
+{
+	printf("Usage: felixGB-headless [--frames <n> | --cycles <n>] [--screenshot <file.png|file.ppm>]\r\n");
+	printf("                        [--hash [--rom-index <index_file>]] [--no-idle-skip] [--load-state <file>]\r\n");
+	printf("                        [--save-state <file>] [--replay <movie>] <rom_file>\r\n");
+	printf("       felixGB-headless [--frames <n> | --cycles <n>] [--hash [--rom-index <index_file>]] [--no-idle-skip]\r\n");
+	printf("                        [--threads <n>] [--manifest <file>] [<rom_file>...]\r\n");
+	printf("       felixGB-headless --index <rom_dir> <index_file>\r\n");
+}
+
+/*
+ * @brief Returns whether a string ends in a given (lower case) suffix, ignoring case
+ */
+static bool headlessEndsWith(const char* string, const char* suffix)
+{
+	size_t length = strlen(string);
+	size_t suffixLength = strlen(suffix);
+
+	if(length < suffixLength)
+	{
+		return false;
+	}
+	for(size_t i = 0; i < suffixLength; i++)
+	{
+		char c = string[length - suffixLength + i];
+		if(((c >= 'A') && (c <= 'Z') ? (c - 'A' + 'a') : c) != suffix[i])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * @brief Prints a SHA-1 digest in hex, without a line ending
+ * @return void
+ */
+static void headlessPrintDigest(const uint8_t digest[UTILS_SHA1_SIZE])
+{
+	for(uint8_t i = 0; i < UTILS_SHA1_SIZE; i++)
+	{
+		printf("%02x", digest[i]);
+	}
+}
+
+/*
+ * @brief Returns the seconds from one monotonic clock reading to another
+ */
+static double headlessSeconds(const struct timespec* start, const struct timespec* end)
+{
+	return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/*
+ * @brief Runs a loaded ROM for the number of frames or cycles asked for, or through a movie
+ * @param gb Pointer to gb struct
+ * @param options Settings for the run
+ * @return Clock cycles actually run
+ */
+static uint64_t headlessRun(gameBoy_t* gb, const headlessOptions_t* options)
+{
+	uint64_t cyclesStart = gb->cyclesCurrent;
+
+	if(options->movie != NULL)
+	{
+		for(uint32_t i = 0; i < movieFrameCount(options->movie); i++)
+		{
+			inputSetButtons(gb, movieGetFrame(options->movie, i));
+			gbRunFrame(gb);
+		}
+	}
+	else if(options->cycles > 0)
+	{
+		// gbRunCycles takes 32-bit budgets, so long runs go a frame's worth at a time
+		while(gb->cyclesCurrent - cyclesStart < options->cycles)
+		{
+			uint64_t remaining = options->cycles - (gb->cyclesCurrent - cyclesStart);
+			gbRunCycles(gb, (uint32_t)((remaining < GB_CYCLES_PER_FRAME) ? remaining : GB_CYCLES_PER_FRAME));
+		}
+	}
+	else
+	{
+		for(uint64_t i = 0; i < options->frames; i++)
+		{
+			gbRunFrame(gb);
+		}
+	}
+
+	return gb->cyclesCurrent - cyclesStart;
+}
+
+/*
+ * @brief Pool task for a batch run: runs one ROM in its own emulator instance and records how it went
+ * @param arg Pointer to the headlessBatch_t
+ * @param index Which ROM to run
+ * @return void
+ */
+static void headlessBatchTask(void* arg, uint32_t index)
+{
+	headlessBatch_t* batch = arg;
+	headlessResult_t* result = &batch->results[index];
+	gameBoy_t* gb = malloc(sizeof(gameBoy_t));
+	struct timespec start;
+	struct timespec end;
+
+	if(gb == NULL)
+	{
+		printf("Failed to allocate emulator instance\r\n");
+		exit(1);
+	}
+	gbInit(gb);
+	idleSetEnabled(gb, batch->options->idleSkip);
+
+	result->loaded = cartLoadRom(gb, batch->roms[index]);
+	if(result->loaded)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		result->cycles = headlessRun(gb, batch->options);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		result->seconds = headlessSeconds(&start, &end);
+		if(batch->options->hash)
+		{
+			movieHashMemory(gb, result->digest);
+			romIndexLookup(batch->options->romIndex, batch->roms[index], &result->rom);
+		}
+	}
+
+	gbDeinit(gb);
+	free(gb);
+}
+
+/*
+ * @brief Adds the ROMs listed in a manifest file (one path per line, # for comments) to a list
+ * @param path Path to the manifest
+ * @param roms List to add to, grown as needed
+ * @param count Number of entries in the list
+ * @return false if the manifest couldn't be read
+ */
+static bool headlessReadManifest(const char* path, char*** roms, uint32_t* count)
+{
+	FILE* file = fopen(path, "r");
+	char line[4096];
+
+	if(file == NULL)
+	{
+		printf("Failed to open manifest %s\r\n", path);
+		return false;
+	}
+	while(fgets(line, sizeof(line), file) != NULL)
+	{
+		size_t length = strlen(line);
+
+		while((length > 0) && ((line[length - 1] == '\n') || (line[length - 1] == '\r') ||
+			(line[length - 1] == ' ') || (line[length - 1] == '\t')))
+		{
+			line[--length] = '\0';
+		}
+		if((length == 0) || (line[0] == '#'))
+		{
+			continue;
+		}
+		*roms = realloc(*roms, (*count + 1) * sizeof(char*));
+		if((*roms == NULL) || (((*roms)[*count] = strdup(line)) == NULL))
+		{
+			printf("Failed to allocate manifest entry\r\n");
+			exit(1);
+		}
+		(*count)++;
+	}
+	fclose(file);
+
+	return true;
+}
+
+/*
+ * @brief Runs every ROM in its own emulator instance across a thread pool, then reports on each and on the whole run
+ * @param options Settings shared by every instance
+ * @param roms Paths to the ROMs
+ * @param count Number of ROMs
+ * @param threads Number of worker threads
+ * @return 0 if every ROM loaded, 1 otherwise
+ */
+static int headlessBatch(const headlessOptions_t* options, char** roms, uint32_t count, uint32_t threads)
+{
+	headlessBatch_t batch = { options, roms, calloc(count, sizeof(headlessResult_t)) };
+	struct timespec start;
+	struct timespec end;
+	uint64_t cycles = 0;
+	double seconds = 0;
+	int status = 0;
+
+	if((batch.results == NULL) && (count > 0))
+	{
+		printf("Failed to allocate batch results\r\n");
+		exit(1);
+	}
+	if(threads > count)
+	{
+		threads = count;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	poolRun(count, threads, headlessBatchTask, &batch);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	seconds = headlessSeconds(&start, &end);
+
+	// Reported in the order given rather than the order finished, so runs can be diffed
+	for(uint32_t i = 0; i < count; i++)
+	{
+		headlessResult_t* result = &batch.results[i];
+
+		if(!result->loaded)
+		{
+			printf("%s: failed to load\r\n", roms[i]);
+			status = 1;
+			continue;
+		}
+		cycles += result->cycles;
+		printf("%s: %.1f frames in %.3fs, %.1f frames/s", roms[i], (double)result->cycles / GB_CYCLES_PER_FRAME,
+			result->seconds, (result->seconds > 0) ? ((double)result->cycles / GB_CYCLES_PER_FRAME / result->seconds) : 0);
+		if(options->hash)
+		{
+			printf(", ROM SHA-1 ");
+			headlessPrintDigest(result->rom.sha1);
+			printf(", memory SHA-1 ");
+			headlessPrintDigest(result->digest);
+		}
+		printf("\r\n");
+	}
+	printf("%u instances on %u threads: %.1f frames in %.3fs, %.1f frames/s\r\n", count, threads,
+		(double)cycles / GB_CYCLES_PER_FRAME, seconds, (seconds > 0) ? ((double)cycles / GB_CYCLES_PER_FRAME / seconds) : 0);
+
+	free(batch.results);
+	return status;
+}
+
+int main(int argc, char** argv)
+{
+	static gameBoy_t gb;
+	headlessOptions_t options = { HEADLESS_DEFAULT_FRAMES, 0, false, true, NULL, NULL };
+	romIndex_t romIndex;
+	const char* screenshot = NULL;
+	const char* manifest = NULL;
+	const char* loadState = NULL;
+	const char* saveState = NULL;
+	const char* replay = NULL;
+	movie_t* movie = NULL;
+	uint32_t threads = poolDefaultThreads();
+	char** roms = NULL;
+	uint32_t romCount = 0;
+	int arg = 1;
+	int status = 0;
+	struct timespec start;
+	struct timespec end;
+	uint64_t cycles = 0;
+	double seconds = 0;
+
+	// Index mode: no emulation, just writes out metadata for a directory of ROMs (see romindex.c)
+	if ((argc == 4) && (strcmp(argv[1], "--index") == 0))
+	{
+		return romIndexBuild(argv[2], argv[3]) ? 0 : 1;
+	}
+
+	memset(&romIndex, 0, sizeof(romIndex));
+	options.romIndex = &romIndex;
+	for (arg = 1; (arg < argc) && (strncmp(argv[arg], "--", 2) == 0); arg++)
+	{
+		if ((strcmp(argv[arg], "--frames") == 0) && (arg + 1 < argc))
+		{
+			options.frames = strtoull(argv[++arg], NULL, 0);
+			options.cycles = 0;
+		}
+		else if ((strcmp(argv[arg], "--cycles") == 0) && (arg + 1 < argc))
+		{
+			options.cycles = strtoull(argv[++arg], NULL, 0);
+		}
+		else if ((strcmp(argv[arg], "--screenshot") == 0) && (arg + 1 < argc))
+		{
+			screenshot = argv[++arg];
+		}
+		else if (strcmp(argv[arg], "--hash") == 0)
+		{
+			options.hash = true;
+		}
+		else if (strcmp(argv[arg], "--no-idle-skip") == 0)
+		{
+			options.idleSkip = false;
+		}
+		else if ((strcmp(argv[arg], "--load-state") == 0) && (arg + 1 < argc))
+		{
+			loadState = argv[++arg];
+		}
+		else if ((strcmp(argv[arg], "--save-state") == 0) && (arg + 1 < argc))
+		{
+			saveState = argv[++arg];
+		}
+		else if ((strcmp(argv[arg], "--replay") == 0) && (arg + 1 < argc))
+		{
+			replay = argv[++arg];
+		}
+		else if ((strcmp(argv[arg], "--threads") == 0) && (arg + 1 < argc))
+		{
+			threads = (uint32_t)strtoul(argv[++arg], NULL, 0);
+		}
+		else if ((strcmp(argv[arg], "--manifest") == 0) && (arg + 1 < argc))
+		{
+			manifest = argv[++arg];
+		}
+		else if ((strcmp(argv[arg], "--rom-index") == 0) && (arg + 1 < argc))
+		{
+			// Missing or out of date indexes just mean ROMs get hashed
+			if (!romIndexLoad(argv[++arg], &romIndex))
+			{
+				printf("No usable ROM index in %s\r\n", argv[arg]);
+			}
+		}
+		else
+		{
+			headlessUsage();
+			return -1;
+		}
+	}
+
+	// Several ROMs, or a manifest, make it a batch run
+	if ((manifest != NULL) || (argc - arg > 1))
+	{
+		if ((screenshot != NULL) || (loadState != NULL) || (saveState != NULL) || (replay != NULL) ||
+			(threads == 0))
+		{
+			headlessUsage();
+			return -1;
+		}
+		if ((manifest != NULL) && !headlessReadManifest(manifest, &roms, &romCount))
+		{
+			return 1;
+		}
+		for (; arg < argc; arg++)
+		{
+			roms = realloc(roms, (romCount + 1) * sizeof(char*));
+			if ((roms == NULL) || ((roms[romCount] = strdup(argv[arg])) == NULL))
+			{
+				printf("Failed to allocate ROM list\r\n");
+				exit(1);
+			}
+			romCount++;
+		}
+		status = headlessBatch(&options, roms, romCount, threads);
+		for (uint32_t i = 0; i < romCount; i++)
+		{
+			free(roms[i]);
+		}
+		free(roms);
+		romIndexFree(&romIndex);
+		return status;
+	}
+	if (arg != argc - 1)
+	{
+		headlessUsage();
+		return -1;
+	}
+
+	gbInit(&gb);
+	idleSetEnabled(&gb, options.idleSkip);
+	if (!cartLoadRom(&gb, argv[arg]) || ((loadState != NULL) && !stateLoadFile(&gb, loadState)))
+	{
+		gbDeinit(&gb);
+		return 1;
+	}
+	// Movies start from power-on, so can't be replayed from a save state
+	if ((replay != NULL) && ((loadState != NULL) || ((movie = movieLoad(&gb, replay)) == NULL)))
+	{
+		if (loadState != NULL)
+		{
+			headlessUsage();
+		}
+		gbDeinit(&gb);
+		return 1;
+	}
+	options.movie = movie;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	cycles = headlessRun(&gb, &options);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	seconds = headlessSeconds(&start, &end);
+	printf("Ran %llu cycles (%.1f frames) in %.3fs: %.1f frames/s\r\n", (unsigned long long)cycles,
+		(double)cycles / GB_CYCLES_PER_FRAME, seconds, (seconds > 0) ? ((double)cycles / GB_CYCLES_PER_FRAME / seconds) : 0);
+
+	if (screenshot != NULL)
+	{
+		bool written = headlessEndsWith(screenshot, ".png") ?
+			imageWritePng(screenshot, ppuGetFrame(&gb), PPU_SCREEN_WIDTH, PPU_SCREEN_HEIGHT) :
+			imageWritePpm(screenshot, ppuGetFrame(&gb), PPU_SCREEN_WIDTH, PPU_SCREEN_HEIGHT);
+		if (!written)
+		{
+			printf("Failed to write %s\r\n", screenshot);
+			gbDeinit(&gb);
+			return 1;
+		}
+	}
+
+	if ((saveState != NULL) && !stateSaveFile(&gb, saveState))
+	{
+		gbDeinit(&gb);
+		return 1;
+	}
+
+	if (options.hash)
+	{
+		uint8_t digest[UTILS_SHA1_SIZE];
+		romIndexEntry_t rom;
+
+		if (romIndexLookup(&romIndex, argv[arg], &rom))
+		{
+			printf("ROM SHA-1: ");
+			headlessPrintDigest(rom.sha1);
+			printf("\r\n");
+		}
+		movieHashMemory(&gb, digest);
+		printf("Memory SHA-1: ");
+		headlessPrintDigest(digest);
+		printf("\r\n");
+	}
+
+	if ((movie != NULL) && !movieCheck(movie, &gb))
+	{
+		status = 1;
+	}
+	if (movie != NULL)
+	{
+		movieDestroy(movie);
+	}
+	romIndexFree(&romIndex);
+
+	gbDeinit(&gb);
+	return status;
+}
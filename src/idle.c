@@ -0,0 +1,449 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "gb.h"
+#include "bus.h"
+#include "ppu.h"
+#include "timers.h"
+#include "idle.h"
+
+/*
+ * idle.c: Idle loop detection. Games waiting on something (LY reaching a line, a flag set by an interrupt handler)
+ * often poll it in a tight loop closed by a backward JR instead of HALTing. If the loop only reads memory, and every
+ * register it changes is worked out afresh on each pass, then each pass leaves the CPU exactly as the last one did
+ * until what it reads changes. The JR then skips as many whole passes as end before that can happen: the next
+ * scheduled event (the only way RAM can change while the CPU is stuck in the loop, through an interrupt handler), or
+ * the next change of a polled LY/STAT/DIV/TIMA. The outcome is the same as running every pass, cycle for cycle, so
+ * turning detection off (idleSetEnabled) is only useful to compare against
+ */
+
+// Registers, as bits of the sets of registers an instruction reads/writes. B-A are in operand order (6 is (HL)). The
+// flags are split in two, as INC/DEC/BIT leave the carry alone
+#define IDLE_REG(operand) 	((uint16_t)(1 << (operand)))
+#define IDLE_REG_B 		IDLE_REG(0)
+#define IDLE_REG_C 		IDLE_REG(1)
+#define IDLE_REG_D 		IDLE_REG(2)
+#define IDLE_REG_E 		IDLE_REG(3)
+#define IDLE_REG_H 		IDLE_REG(4)
+#define IDLE_REG_L 		IDLE_REG(5)
+#define IDLE_REG_A 		IDLE_REG(7)
+#define IDLE_FLAGS_ZNH 		IDLE_REG(8)
+#define IDLE_FLAGS_C 		IDLE_REG(9)
+
+// No memory read
+#define IDLE_READ_NONE 		0xFF
+
+/*
+ * @brief Works out which registers an instruction reads and writes, and where it reads memory from
+ * @param opCode Index into gbDispatchTable
+ * @param read Set to the registers the instruction reads
+ * @param written Set to the registers the instruction writes
+ * @param memory Set to the idleRead_t the instruction reads memory through, or IDLE_READ_NONE
+ * @return false if the instruction can't be part of an idle loop (it writes memory, touches SP/PC, etc.)
+ */
+static bool idleEffects(uint16_t opCode, uint16_t* read, uint16_t* written, uint8_t* memory)
+{
+	uint8_t operand = 0;
+
+	*read = 0;
+	*written = 0;
+	*memory = IDLE_READ_NONE;
+
+	if(opCode >= GB_OPCODE_CB_OFFSET)
+	{
+		uint8_t cbOpCode = opCode & 0xFF;
+
+		operand = cbOpCode & 0x07;
+		if(operand == 6)
+		{
+			// Of the (HL) forms, only BIT leaves memory alone
+			if((cbOpCode & 0xC0) != 0x40)
+			{
+				return false;
+			}
+			*read = IDLE_REG_H | IDLE_REG_L;
+			*written = IDLE_FLAGS_ZNH;
+			*memory = IDLE_READ_HL;
+			return true;
+		}
+
+		*read = IDLE_REG(operand);
+		if(cbOpCode < 0x40)
+		{
+			// Rotates/shifts. RL and RR shift the carry in
+			*written = IDLE_REG(operand) | IDLE_FLAGS_ZNH | IDLE_FLAGS_C;
+			if(((cbOpCode >> 3) == 2) || ((cbOpCode >> 3) == 3))
+			{
+				*read |= IDLE_FLAGS_C;
+			}
+		}
+		else if(cbOpCode < 0x80)
+		{
+			// BIT
+			*written = IDLE_FLAGS_ZNH;
+		}
+		else
+		{
+			// RES/SET
+			*written = IDLE_REG(operand);
+		}
+		return true;
+	}
+
+	operand = (opCode >> 3) & 0x07;
+
+	if(opCode == 0x00)
+	{
+		// NOP
+		return true;
+	}
+	if(((opCode & 0xC7) == 0x06) && (operand != 6))
+	{
+		// LD r, d8
+		*written = IDLE_REG(operand);
+		return true;
+	}
+	if(((opCode & 0xC6) == 0x04) && (operand != 6))
+	{
+		// INC r, DEC r
+		*read = IDLE_REG(operand);
+		*written = IDLE_REG(operand) | IDLE_FLAGS_ZNH;
+		return true;
+	}
+	if((opCode >= 0x40) && (opCode < 0x80) && (opCode != 0x76))
+	{
+		// LD r, r' and LD r, (HL)
+		if(operand == 6)
+		{
+			return false;
+		}
+		if((opCode & 0x07) == 6)
+		{
+			*read = IDLE_REG_H | IDLE_REG_L;
+			*memory = IDLE_READ_HL;
+		}
+		else
+		{
+			*read = IDLE_REG(opCode & 0x07);
+		}
+		*written = IDLE_REG(operand);
+		return true;
+	}
+	if(((opCode >= 0x80) && (opCode < 0xC0)) || ((opCode & 0xC7) == 0xC6))
+	{
+		// ADD/ADC/SUB/SBC/AND/XOR/OR/CP A with r, (HL) or d8. operand is the operation here
+		if(opCode < 0xC0)
+		{
+			if((opCode & 0x07) == 6)
+			{
+				*read = IDLE_REG_H | IDLE_REG_L;
+				*memory = IDLE_READ_HL;
+			}
+			else
+			{
+				*read = IDLE_REG(opCode & 0x07);
+			}
+		}
+		*read |= IDLE_REG_A;
+		if((operand == 1) || (operand == 3))
+		{
+			*read |= IDLE_FLAGS_C;
+		}
+		// SUB A and XOR A always give 0, whatever A was
+		if((opCode == 0x97) || (opCode == 0xAF))
+		{
+			*read = 0;
+		}
+		*written = IDLE_FLAGS_ZNH | IDLE_FLAGS_C | ((operand == 7) ? 0 : IDLE_REG_A);
+		return true;
+	}
+
+	switch(opCode)
+	{
+		case 0x0A: // LD A, (BC)
+			*read = IDLE_REG_B | IDLE_REG_C;
+			*memory = IDLE_READ_BC;
+			break;
+		case 0x1A: // LD A, (DE)
+			*read = IDLE_REG_D | IDLE_REG_E;
+			*memory = IDLE_READ_DE;
+			break;
+		case 0xF0: // LDH A, (a8)
+		case 0xFA: // LD A, (a16)
+			*memory = IDLE_READ_ADDR;
+			break;
+		case 0xF2: // LDH A, (C)
+			*read = IDLE_REG_C;
+			*memory = IDLE_READ_C;
+			break;
+		default:
+			return false;
+	}
+	*written = IDLE_REG_A;
+	return true;
+}
+
+/*
+ * @brief Decodes a loop and works out whether it's idle
+ * @details A loop is idle if it's straight-line code that doesn't write memory, and no register is read before the
+	pass has written it unless the loop never writes it at all. What a pass leaves behind then only depends on what it
+	read from memory and registers the loop doesn't touch, so another pass reading the same values changes nothing
+ * @param gb Pointer to gb struct containing memory
+ * @param loop Cache entry, with pc and target filled in
+ * @return void
+ */
+static void idleAnalyse(gameBoy_t* gb, idleLoop_t* loop)
+{
+	uint16_t read[IDLE_MAX_LENGTH];
+	uint16_t written[IDLE_MAX_LENGTH];
+	uint16_t writtenAll = 0;
+	uint16_t defined = 0;
+	uint8_t count = 0;
+	uint16_t addr = loop->target;
+	uint8_t jrOpCode = 0;
+
+	loop->idle = false;
+	loop->length = (uint8_t)(loop->pc + 2 - loop->target);
+	loop->cycles = 0;
+	loop->readCount = 0;
+	loop->lastCycles = 0;
+	loop->lastStable = 0;
+	for(uint8_t i = 0; i < loop->length; i++)
+	{
+		loop->code[i] = gbRead8(gb, loop->target + i);
+	}
+
+	while(addr < loop->pc)
+	{
+		uint16_t opCode = gbRead8(gb, addr);
+		uint8_t memory = IDLE_READ_NONE;
+
+		if(opCode == GB_OPCODE_PREFIX_CB)
+		{
+			opCode = GB_OPCODE_CB_OFFSET | gbRead8(gb, addr + 1);
+		}
+		if(!idleEffects(opCode, &read[count], &written[count], &memory))
+		{
+			return;
+		}
+		if(memory != IDLE_READ_NONE)
+		{
+			if(loop->readCount == IDLE_MAX_READS)
+			{
+				return;
+			}
+			loop->readKind[loop->readCount] = memory;
+			if(opCode == 0xF0)
+			{
+				loop->readAddr[loop->readCount] = BUS_ADDR_IO | gbRead8(gb, addr + 1);
+			}
+			else if(opCode == 0xFA)
+			{
+				loop->readAddr[loop->readCount] = gbRead8(gb, addr + 1) | (gbRead8(gb, addr + 2) << 8);
+			}
+			loop->readCount++;
+		}
+
+		writtenAll |= written[count];
+		loop->cycles += gbDispatchTable[opCode].clockCycles;
+		addr += gbDispatchTable[opCode].opCodeSize;
+		count++;
+	}
+
+	// The last instruction ran into the JR
+	if(addr != loop->pc)
+	{
+		return;
+	}
+
+	// The JR itself, which reads the flag it's conditional on
+	jrOpCode = gbRead8(gb, loop->pc);
+	read[count] = (jrOpCode == 0x18) ? 0 : ((jrOpCode < 0x30) ? IDLE_FLAGS_ZNH : IDLE_FLAGS_C);
+	written[count] = 0;
+	loop->cycles += gbDispatchTable[jrOpCode].clockCycles + gbDispatchTable[jrOpCode].clockCyclesExtra;
+	count++;
+
+	for(uint8_t i = 0; i < count; i++)
+	{
+		if(read[i] & writtenAll & ~defined)
+		{
+			return;
+		}
+		defined |= written[i];
+	}
+
+	loop->idle = true;
+}
+
+/*
+ * @brief Returns the soonest cycle count the value at an address could change at, with the CPU stuck in a loop that
+	doesn't write memory
+ * @param gb Pointer to gb struct containing memory
+ * @param addr Address read by the loop
+ * @return Cycle count, or UINT64_MAX if the address only changes when written
+ */
+static uint64_t idleNextChange(gameBoy_t* gb, uint16_t addr)
+{
+	if((addr == PPU_REG_LY) || (addr == PPU_REG_STAT))
+	{
+		return ppuNextChange(gb, addr);
+	}
+	if((addr >= TIMERS_REG_DIV) && (addr <= TIMERS_REG_TAC))
+	{
+		return timersNextChange(gb, addr);
+	}
+	if((gb->readPage[addr >> GB_PAGE_SHIFT] != NULL) || (addr >= BUS_ADDR_OAM))
+	{
+		// Plain memory, or I/O registers which are only changed by writes and events (e.g. IF)
+		return UINT64_MAX;
+	}
+
+	// Cartridge registers such as the MBC3 RTC can change at any time
+	return gb->cyclesCurrent;
+}
+
+/*
+ * @brief Returns the soonest cycle count anything a loop reads could change at
+ * @param gb Pointer to gb struct containing registers
+ * @param loop Idle loop the CPU is in
+ * @return Cycle count
+ */
+static uint64_t idleStableUntil(gameBoy_t* gb, const idleLoop_t* loop)
+{
+	// Memory can only change through an interrupt handler, so never past the next event
+	uint64_t stable = gb->cyclesEnd;
+
+	for(uint8_t i = 0; i < loop->readCount; i++)
+	{
+		uint16_t addr = loop->readAddr[i];
+		uint64_t change = 0;
+
+		switch(loop->readKind[i])
+		{
+			case IDLE_READ_C:
+				addr = BUS_ADDR_IO | gb->generalReg.c;
+				break;
+			case IDLE_READ_BC:
+				addr = gb->generalReg.bc;
+				break;
+			case IDLE_READ_DE:
+				addr = gb->generalReg.de;
+				break;
+			case IDLE_READ_HL:
+				addr = gb->generalReg.hl;
+				break;
+			default:
+				break;
+		}
+		change = idleNextChange(gb, addr);
+		if(change < stable)
+		{
+			stable = change;
+		}
+	}
+
+	return stable;
+}
+
+/*
+ * @brief Clears the cache of loops and turns detection on
+ * @param gb Pointer to gb struct
+ * @return void
+ */
+void idleInit(gameBoy_t* gb)
+{
+	memset(&gb->idle, 0, sizeof(gb->idle));
+	gb->idle.enabled = true;
+}
+
+/*
+ * @brief Forgets every loop looked at, leaving detection on or off as it was
+ * @param gb Pointer to gb struct
+ * @return void
+ * @note For when the gb struct is overwritten wholesale (see stateLoad). Cached loops hold host page pointers and
+ * cycle counts from before
+ */
+void idleReset(gameBoy_t* gb)
+{
+	bool enabled = gb->idle.enabled;
+
+	idleInit(gb);
+	gb->idle.enabled = enabled;
+}
+
+/*
+ * @brief Turns idle loop detection on or off
+ * @param gb Pointer to gb struct
+ * @param enabled false to run every pass of every loop, e.g. to compare against
+ * @return void
+ */
+void idleSetEnabled(gameBoy_t* gb, bool enabled)
+{
+	gb->idle.enabled = enabled;
+}
+
+/*
+ * @brief Called by a JR jumping a short way backwards. Skips whole passes of the loop if it's idle
+ * @param gb Pointer to gb struct containing registers
+ * @param pc Address of the JR
+ * @param target Address the JR jumps to
+ * @return void
+ * @note Passes are only skipped once the JR has been taken twice in a row with nothing read changing in between, so
+ * the pass just run read the same values the skipped ones would have
+ */
+void idleSkip(gameBoy_t* gb, uint16_t pc, uint16_t target)
+{
+	idleLoop_t* loop = &gb->idle.loops[pc & (IDLE_CACHE_SIZE - 1)];
+	const uint8_t* page = gb->readPage[pc >> GB_PAGE_SHIFT];
+	uint64_t now = gb->cyclesCurrent;
+	uint64_t stable = 0;
+	uint64_t start = 0;
+	uint64_t passes = 0;
+	uint8_t jrOpCode = 0;
+
+	if((loop->pc != pc) || (loop->target != target) || (loop->page != page))
+	{
+		loop->pc = pc;
+		loop->target = target;
+		loop->page = page;
+		idleAnalyse(gb, loop);
+	}
+	else if(pc >= BUS_ADDR_VRAM)
+	{
+		// Code in RAM may have been overwritten since. ROM can only be bank switched, which changes page
+		for(uint8_t i = 0; i < loop->length; i++)
+		{
+			if(gbRead8(gb, target + i) != loop->code[i])
+			{
+				idleAnalyse(gb, loop);
+				break;
+			}
+		}
+	}
+	if(!loop->idle)
+	{
+		return;
+	}
+
+	// Unless the last pass ran straight through from the last time the JR was taken (no interrupt in between), with
+	// nothing it read changing since then, just note when what it read will next change
+	if((loop->lastCycles + loop->cycles != now) || (loop->lastStable <= now))
+	{
+		loop->lastCycles = now;
+		loop->lastStable = idleStableUntil(gb, loop);
+		return;
+	}
+
+	// Nothing has changed, so neither has when it next will. An event may have been scheduled sooner, though
+	stable = (gb->cyclesEnd < loop->lastStable) ? gb->cyclesEnd : loop->lastStable;
+
+	// Skip every pass that ends by the time something could change. The JR being run still has to complete first
+	jrOpCode = loop->code[loop->length - 2];
+	start = now + gbDispatchTable[jrOpCode].clockCycles + gbDispatchTable[jrOpCode].clockCyclesExtra;
+	if(stable > start)
+	{
+		passes = (stable - start) / loop->cycles;
+	}
+	loop->lastCycles = now + (passes * loop->cycles);
+	gb->cyclesCurrent = loop->lastCycles;
+}
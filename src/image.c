@@ -0,0 +1,168 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "utils.h"
+#include "image.h"
+
+/*
+ * image.c: Writes ARGB8888 frames (as returned by ppuGetFrame) out as image files, for headless runs. PNGs are
+ * written without a compression library: the image data goes into stored (uncompressed) deflate blocks, which any
+ * PNG reader accepts. The alpha channel is dropped
+ */
+
+// Most data a stored deflate block can hold
+#define IMAGE_STORED_BLOCK_MAX 	0xFFFF
+#define IMAGE_ADLER_MOD 	65521
+
+static const uint8_t imagePngSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+/*
+ * @brief Writes an integer to a buffer, big-endian as PNG uses
+ */
+static void imagePutBe32(uint8_t* buffer, uint32_t value)
+{
+	buffer[0] = (uint8_t)(value >> 24);
+	buffer[1] = (uint8_t)(value >> 16);
+	buffer[2] = (uint8_t)(value >> 8);
+	buffer[3] = (uint8_t)value;
+}
+
+/*
+ * @brief Writes a PNG chunk: length, type, data and the CRC of type and data
+ * @return false on a write error
+ */
+static bool imageWriteChunk(FILE* file, const char* type, const uint8_t* data, uint32_t size)
+{
+	uint8_t header[8];
+	uint8_t crc[4];
+
+	imagePutBe32(header, size);
+	for(uint8_t i = 0; i < 4; i++)
+	{
+		header[4 + i] = (uint8_t)type[i];
+	}
+	imagePutBe32(crc, utilsCrc32(utilsCrc32(0, &header[4], 4), data, size));
+
+	return (fwrite(header, 1, sizeof(header), file) == sizeof(header)) &&
+		((size == 0) || (fwrite(data, 1, size, file) == size)) &&
+		(fwrite(crc, 1, sizeof(crc), file) == sizeof(crc));
+}
+
+/*
+ * @brief Writes a frame as a binary PPM (P6)
+ * @param path File to be written
+ * @param pixels ARGB8888 pixels, row by row
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @return false if the file couldn't be written
+ */
+bool imageWritePpm(const char* path, const uint32_t* pixels, uint32_t width, uint32_t height)
+{
+	FILE* file = fopen(path, "wb");
+	bool ok = (file != NULL);
+
+	if(!ok)
+	{
+		return false;
+	}
+
+	ok = fprintf(file, "P6\n%u %u\n255\n", width, height) > 0;
+	for(uint32_t i = 0; ok && (i < width * height); i++)
+	{
+		uint8_t rgb[3] = { (uint8_t)(pixels[i] >> 16), (uint8_t)(pixels[i] >> 8), (uint8_t)pixels[i] };
+		ok = fwrite(rgb, 1, sizeof(rgb), file) == sizeof(rgb);
+	}
+
+	return (fclose(file) == 0) && ok;
+}
+
+/*
+ * @brief Writes a frame as an 8-bit RGB PNG
+ * @param path File to be written
+ * @param pixels ARGB8888 pixels, row by row
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @return false if the file couldn't be written
+ */
+bool imageWritePng(const char* path, const uint32_t* pixels, uint32_t width, uint32_t height)
+{
+	// Each row is a filter type byte (0: none) then RGB pixels
+	uint32_t rawSize = height * (1 + width * 3);
+	uint32_t blocks = (rawSize + IMAGE_STORED_BLOCK_MAX - 1) / IMAGE_STORED_BLOCK_MAX;
+	// zlib header, 5 byte header per stored block, the data, then the Adler-32 of the data
+	uint32_t idatSize = 2 + blocks * 5 + rawSize + 4;
+	uint8_t* raw = malloc(rawSize);
+	uint8_t* idat = malloc(idatSize);
+	uint8_t ihdr[13];
+	uint32_t adlerA = 1;
+	uint32_t adlerB = 0;
+	uint32_t in = 0;
+	uint32_t out = 0;
+	FILE* file = NULL;
+	bool ok = false;
+
+	if((raw == NULL) || (idat == NULL))
+	{
+		free(raw);
+		free(idat);
+		return false;
+	}
+
+	for(uint32_t y = 0; y < height; y++)
+	{
+		raw[in++] = 0;
+		for(uint32_t x = 0; x < width; x++)
+		{
+			uint32_t pixel = pixels[y * width + x];
+
+			raw[in++] = (uint8_t)(pixel >> 16);
+			raw[in++] = (uint8_t)(pixel >> 8);
+			raw[in++] = (uint8_t)pixel;
+		}
+	}
+
+	// zlib header: deflate with a 32K window, no preset dictionary, lowest compression level
+	idat[out++] = 0x78;
+	idat[out++] = 0x01;
+	for(in = 0; in < rawSize; )
+	{
+		uint32_t size = ((rawSize - in) < IMAGE_STORED_BLOCK_MAX) ? (rawSize - in) : IMAGE_STORED_BLOCK_MAX;
+
+		// Final block flag, then the length and its complement, little-endian
+		idat[out++] = ((in + size) == rawSize) ? 0x01 : 0x00;
+		idat[out++] = (uint8_t)size;
+		idat[out++] = (uint8_t)(size >> 8);
+		idat[out++] = (uint8_t)~size;
+		idat[out++] = (uint8_t)(~size >> 8);
+		for(uint32_t i = 0; i < size; i++, in++)
+		{
+			idat[out++] = raw[in];
+			adlerA = (adlerA + raw[in]) % IMAGE_ADLER_MOD;
+			adlerB = (adlerB + adlerA) % IMAGE_ADLER_MOD;
+		}
+	}
+	imagePutBe32(&idat[out], (adlerB << 16) | adlerA);
+
+	imagePutBe32(&ihdr[0], width);
+	imagePutBe32(&ihdr[4], height);
+	ihdr[8] = 8; 	// Bit depth
+	ihdr[9] = 2; 	// Colour type: RGB
+	ihdr[10] = 0; 	// Compression: deflate
+	ihdr[11] = 0; 	// Filter method
+	ihdr[12] = 0; 	// No interlacing
+
+	file = fopen(path, "wb");
+	if(file != NULL)
+	{
+		ok = (fwrite(imagePngSignature, 1, sizeof(imagePngSignature), file) == sizeof(imagePngSignature)) &&
+			imageWriteChunk(file, "IHDR", ihdr, sizeof(ihdr)) &&
+			imageWriteChunk(file, "IDAT", idat, idatSize) &&
+			imageWriteChunk(file, "IEND", NULL, 0);
+		ok = (fclose(file) == 0) && ok;
+	}
+
+	free(raw);
+	free(idat);
+	return ok;
+}
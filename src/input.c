@@ -0,0 +1,113 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "gb.h"
+#include "input.h"
+#include "interrupts.h"
+
+/*
+ * input.c: Joypad. The frontend sets which buttons are held between runs of the CPU (see inputSetButtons), and the
+ * game reads them through P1, a group at a time. memory[INPUT_REG_P1] only holds the group select bits, the rest of
+ * the register is worked out on read. The joypad interrupt is requested whenever one of the lines P1 reads goes from
+ * high to low. STOP is woken by the lines themselves, see inputPressed
+ */
+
+/*
+ * @brief Returns P1 bits 0-3 as the game would read them: 0 for each selected button held
+ */
+static uint8_t inputLines(const gameBoy_t* gb)
+{
+	uint8_t select = gb->memory[INPUT_REG_P1];
+	uint8_t lines = 0x0F;
+
+	if(!(select & INPUT_P1_DIRECTIONS))
+	{
+		lines &= ~(gb->input.buttons & 0x0F);
+	}
+	if(!(select & INPUT_P1_BUTTONS))
+	{
+		lines &= ~(gb->input.buttons >> 4);
+	}
+
+	return lines;
+}
+
+/*
+ * @brief Requests the joypad interrupt if any line went from high to low
+ * @param gb Pointer to gb struct
+ * @param before Lines before the change, from inputLines
+ * @return void
+ */
+static void inputCheckInterrupt(gameBoy_t* gb, uint8_t before)
+{
+	if(before & ~inputLines(gb))
+	{
+		interruptsRequest(gb, GB_INT_JOYPAD);
+	}
+}
+
+/*
+ * @brief Returns whether any P1 line is low, i.e. a button in a selected group is held
+ * @param gb Pointer to gb struct
+ * @return True if any line is low
+ * @note This is what wakes the CPU from STOP, whatever IF and IE hold
+ */
+bool inputPressed(const gameBoy_t* gb)
+{
+	return inputLines(gb) != 0x0F;
+}
+
+/*
+ * @brief Sets the joypad up with nothing selected or held, as the boot ROM leaves it
+ * @param gb Pointer to gb struct
+ * @return void
+ */
+void inputInit(gameBoy_t* gb)
+{
+	gb->input.buttons = 0;
+	gb->memory[INPUT_REG_P1] = INPUT_P1_SELECT;
+}
+
+/*
+ * @brief Sets which buttons are held
+ * @param gb Pointer to gb struct
+ * @param buttons INPUT_* bits of the buttons held
+ * @return void
+ * @note Only call between runs of the CPU (gbRunCycles/gbRunFrame). Replaying the same buttons at the same points
+ * reproduces a run exactly (see movie.c)
+ */
+void inputSetButtons(gameBoy_t* gb, uint8_t buttons)
+{
+	uint8_t before = inputLines(gb);
+
+	gb->input.buttons = buttons;
+	inputCheckInterrupt(gb, before);
+	if(gb->stopped)
+	{
+		interruptsCheck(gb);
+	}
+}
+
+/*
+ * @brief Reads P1
+ * @param gb Pointer to gb struct
+ * @return Register value. Bits 6-7 are unused and read 1
+ */
+uint8_t inputRead(gameBoy_t* gb)
+{
+	return 0xC0 | (gb->memory[INPUT_REG_P1] & INPUT_P1_SELECT) | inputLines(gb);
+}
+
+/*
+ * @brief Writes P1. Only the group select bits can be written
+ * @param gb Pointer to gb struct
+ * @param value Value written
+ * @return void
+ * @note Selecting a group with a button held pulls its line low, which requests the interrupt just like a press
+ */
+void inputWrite(gameBoy_t* gb, uint8_t value)
+{
+	uint8_t before = inputLines(gb);
+
+	gb->memory[INPUT_REG_P1] = value & INPUT_P1_SELECT;
+	inputCheckInterrupt(gb, before);
+}
@@ -0,0 +1,103 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "gb.h"
+#include "sched.h"
+#include "interrupts.h"
+
+/*
+ * interrupts.c: Interrupt controller. Interrupts are only ever taken between instructions, so rather than the CPU core
+ * checking IE & IF after every instruction, anything that can make an interrupt pending (a component requesting one,
+ * a write to IF/IE, RETI, EI taking effect, HALT) schedules SCHED_EVENT_INTERRUPT for the current cycle count. That
+ * stops the core at the end of the instruction being run, and interruptsEvent then wakes the CPU from HALT/STOP and
+ * calls the handler. While halted, gbRunCycles skips straight to the next event, as nothing else can wake the CPU
+ */
+
+/*
+ * @brief Returns the interrupts which are both requested and enabled
+ */
+static inline uint8_t interruptsPending(const gameBoy_t* gb)
+{
+	return gb->memory[GB_REG_IE] & gb->memory[GB_REG_IF] & INTERRUPTS_MASK;
+}
+
+/*
+ * @brief Requests one or more interrupts by setting their bits in IF
+ * @param gb Pointer to gb struct containing memory
+ * @param mask GB_INT_* bits to request
+ * @return void
+ */
+void interruptsRequest(gameBoy_t* gb, uint8_t mask)
+{
+	gb->memory[GB_REG_IF] |= mask;
+	interruptsCheck(gb);
+}
+
+/*
+ * @brief Schedules the interrupt controller to run after the current instruction if an interrupt can be taken, or
+	the CPU woken up
+ * @param gb Pointer to gb struct containing memory
+ * @return void
+ * @note Called whenever IF, IE or IME may have changed, and by inputSetButtons while stopped, as STOP is woken by
+	the P1 lines rather than IF (see inputPressed)
+ */
+void interruptsCheck(gameBoy_t* gb)
+{
+	bool wake = (interruptsPending(gb) != 0) || (gb->stopped && inputPressed(gb));
+
+	if(wake && (gb->ime || gb->halted))
+	{
+		schedAdd(gb, SCHED_EVENT_INTERRUPT, gb->cyclesCurrent);
+	}
+}
+
+/*
+ * @brief Scheduler handler for SCHED_EVENT_INTERRUPT. Wakes the CPU and calls the handler of the highest priority
+	pending interrupt
+ * @param gb Pointer to gb struct containing registers
+ * @return void
+ * @note HALT is left as soon as an interrupt is pending, whether or not IME is set. STOP is only left by the joypad.
+ * The HALT bug (PC failing to increment when HALT is left straight away with IME clear) isn't emulated
+ */
+void interruptsEvent(gameBoy_t* gb)
+{
+	uint8_t pending = interruptsPending(gb);
+	uint8_t bit = 0;
+
+	if(gb->stopped)
+	{
+		if(!inputPressed(gb))
+		{
+			return;
+		}
+		gb->stopped = false;
+	}
+	else if(pending == 0)
+	{
+		return;
+	}
+	gb->halted = false;
+
+	if(!gb->ime || (pending == 0))
+	{
+		return;
+	}
+
+	// Lowest bit first: VBlank, STAT, timer, serial, joypad
+	bit = (uint8_t)__builtin_ctz(pending);
+	gb->ime = false;
+	gb->memory[GB_REG_IF] &= ~(1 << bit);
+	gbPush16(gb, gb->pc);
+	gb->pc = INTERRUPTS_VECTOR_BASE + (bit * INTERRUPTS_VECTOR_SPACING);
+	gb->cyclesCurrent += INTERRUPTS_DISPATCH_CYCLES;
+}
+
+/*
+ * @brief Scheduler handler for SCHED_EVENT_IME. Sets IME once the instruction following EI has completed
+ * @param gb Pointer to gb struct containing registers
+ * @return void
+ */
+void interruptsEnableEvent(gameBoy_t* gb)
+{
+	gb->ime = true;
+	interruptsCheck(gb);
+}
@@ -0,0 +1,595 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "jit.h"
+
+/*
+ * jit.c: Dynamic recompiler translating hot blocks (see block.c) to x86-64 code, enabled with `make JIT=1`.
+ * A translated block covers every instruction of a block but the final branch, which is left to the block core so
+ * taken/not taken timing stays in one place. Register-only instructions are emitted as native code operating on the
+ * gb struct directly. Anything else (memory/I-O accesses, flag-heavy ALU ops whose flags are still needed) falls back
+ * to calling the instruction's handler from gbDispatchTable, with PC and the cycle counter brought up to date first.
+ * Flags are only computed when something can read them: a backwards liveness pass over the block lets ALU ops whose
+ * flags are overwritten before use be emitted as plain x86 arithmetic
+ */
+
+#if defined(__x86_64__)
+
+// Registers as encoded in the ModRM byte
+#define X86_EAX 0
+#define X86_EBX 3
+
+#define JIT_FLAGS_ALL (FLAG_REG_ZERO | FLAG_REG_SUB | FLAG_REG_HALF_CARRY | FLAG_REG_CARRY)
+#define JIT_FLAGS_ZNH (FLAG_REG_ZERO | FLAG_REG_SUB | FLAG_REG_HALF_CARRY)
+
+// Offsets of the 8-bit registers within gameBoy_t, in LR35902 operand order (B, C, D, E, H, L, (HL), A)
+static const int32_t jitReg8Offset[8] =
+{
+	offsetof(gameBoy_t, generalReg.b), offsetof(gameBoy_t, generalReg.c),
+	offsetof(gameBoy_t, generalReg.d), offsetof(gameBoy_t, generalReg.e),
+	offsetof(gameBoy_t, generalReg.h), offsetof(gameBoy_t, generalReg.l),
+	-1, 								   offsetof(gameBoy_t, generalReg.a),
+};
+
+// Offsets of the 16-bit registers within gameBoy_t, in LR35902 operand order (BC, DE, HL, SP)
+static const int32_t jitReg16Offset[4] =
+{
+	offsetof(gameBoy_t, generalReg.bc), offsetof(gameBoy_t, generalReg.de),
+	offsetof(gameBoy_t, generalReg.hl), offsetof(gameBoy_t, sp),
+};
+
+// Emitter state for the block being translated
+typedef struct
+{
+	uint8_t* code;
+	size_t size;
+	uint32_t cyclesPending; // Cycles of instructions emitted since the cycle counter was last brought up to date
+} jitEmitter_t;
+
+static void jitEmit8(jitEmitter_t* emitter, uint8_t value)
+{
+	emitter->code[emitter->size++] = value;
+}
+
+static void jitEmit16(jitEmitter_t* emitter, uint16_t value)
+{
+	memcpy(&emitter->code[emitter->size], &value, sizeof(value));
+	emitter->size += sizeof(value);
+}
+
+static void jitEmit32(jitEmitter_t* emitter, uint32_t value)
+{
+	memcpy(&emitter->code[emitter->size], &value, sizeof(value));
+	emitter->size += sizeof(value);
+}
+
+static void jitEmit64(jitEmitter_t* emitter, uint64_t value)
+{
+	memcpy(&emitter->code[emitter->size], &value, sizeof(value));
+	emitter->size += sizeof(value);
+}
+
+/*
+ * @brief Emits an op code followed by a [rbx + disp32] memory operand, rbx holding the gb struct pointer
+ * @param reg Register or op code extension for the ModRM reg field
+ */
+static void jitEmitRbxOperand(jitEmitter_t* emitter, uint8_t reg, int32_t disp)
+{
+	// mod = 10 (disp32), rm = rbx
+	jitEmit8(emitter, 0x80 | (reg << 3) | X86_EBX);
+	jitEmit32(emitter, (uint32_t)disp);
+}
+
+/*
+ * @brief Emits code bringing gb->cyclesCurrent up to date with the instructions emitted so far
+ */
+static void jitEmitSyncCycles(jitEmitter_t* emitter)
+{
+	if(emitter->cyclesPending == 0)
+	{
+		return;
+	}
+
+	// add qword [rbx + cyclesCurrent], imm32
+	jitEmit8(emitter, 0x48);
+	jitEmit8(emitter, 0x81);
+	jitEmitRbxOperand(emitter, 0, offsetof(gameBoy_t, cyclesCurrent));
+	jitEmit32(emitter, emitter->cyclesPending);
+	emitter->cyclesPending = 0;
+}
+
+/*
+ * @brief Emits code setting gb->pc
+ */
+static void jitEmitSetPc(jitEmitter_t* emitter, uint16_t pc)
+{
+	// mov word [rbx + pc], imm16
+	jitEmit8(emitter, 0x66);
+	jitEmit8(emitter, 0xC7);
+	jitEmitRbxOperand(emitter, 0, offsetof(gameBoy_t, pc));
+	jitEmit16(emitter, pc);
+}
+
+/*
+ * @brief Emits code returning from the translated block
+ * @param pc Address of the next instruction to be run by the block core
+ * @param count Number of instructions of the block that have been run
+ */
+static void jitEmitExit(jitEmitter_t* emitter, uint16_t pc, uint8_t count)
+{
+	jitEmitSyncCycles(emitter);
+	jitEmitSetPc(emitter, pc);
+	// mov eax, count / pop rbx / ret
+	jitEmit8(emitter, 0xB8);
+	jitEmit32(emitter, count);
+	jitEmit8(emitter, 0x5B);
+	jitEmit8(emitter, 0xC3);
+}
+
+/*
+ * @brief Emits a call to an instruction's handler, for instructions that aren't translated to native code
+ * @param pc Address of the instruction, which the handler reads its operands relative to
+ */
+static void jitEmitFallback(jitEmitter_t* emitter, const blockInstruction_t* instruction, uint16_t pc)
+{
+	// Handlers can read memory (and, later, I/O registers whose value depends on time), so bring everything up to date
+	jitEmitSyncCycles(emitter);
+	jitEmitSetPc(emitter, pc);
+
+	// mov rdi, rbx / mov rax, imm64 / call rax
+	jitEmit8(emitter, 0x48);
+	jitEmit8(emitter, 0x89);
+	jitEmit8(emitter, 0xDF);
+	jitEmit8(emitter, 0x48);
+	jitEmit8(emitter, 0xB8);
+	jitEmit64(emitter, (uint64_t)(uintptr_t)instruction->operation);
+	jitEmit8(emitter, 0xFF);
+	jitEmit8(emitter, 0xD0);
+}
+
+/*
+ * @brief Patches the rel32 operand of a jump emitted earlier to land at the current end of the code
+ */
+static void jitPatchJump(jitEmitter_t* emitter, size_t jumpOffset)
+{
+	uint32_t rel = (uint32_t)(emitter->size - (jumpOffset + 4));
+
+	memcpy(&emitter->code[jumpOffset], &rel, sizeof(rel));
+}
+
+/*
+ * @brief Emits code leaving the translated block if the block was invalidated by a write, or if the write (or an I/O
+ * register read) scheduled an event (see schedAdd) due before the end of the block
+ * @param block Block being translated
+ * @param pc Address of the instruction following the write/read
+ * @param count Number of instructions run once the write/read has completed
+ * @param cyclesRemaining Clock cycles of the instructions after the write/read, up to the end of the block
+ */
+static void jitEmitExitCheck(jitEmitter_t* emitter, const block_t* block, uint16_t pc, uint8_t count,
+	uint32_t cyclesRemaining)
+{
+	size_t invalidOffset = 0;
+	size_t fitsOffset = 0;
+
+	// mov rax, &block->valid / cmp byte [rax], 0 / je rel32 (to the exit)
+	jitEmit8(emitter, 0x48);
+	jitEmit8(emitter, 0xB8);
+	jitEmit64(emitter, (uint64_t)(uintptr_t)&block->valid);
+	jitEmit8(emitter, 0x80);
+	jitEmit8(emitter, 0x38);
+	jitEmit8(emitter, 0x00);
+	jitEmit8(emitter, 0x0F);
+	jitEmit8(emitter, 0x84);
+	invalidOffset = emitter->size;
+	jitEmit32(emitter, 0);
+
+	// mov rax, [rbx + cyclesCurrent] / add rax, imm32 / cmp rax, [rbx + cyclesEnd] / jbe rel32 (over the exit)
+	jitEmit8(emitter, 0x48);
+	jitEmit8(emitter, 0x8B);
+	jitEmitRbxOperand(emitter, X86_EAX, offsetof(gameBoy_t, cyclesCurrent));
+	jitEmit8(emitter, 0x48);
+	jitEmit8(emitter, 0x05);
+	jitEmit32(emitter, emitter->cyclesPending + cyclesRemaining);
+	jitEmit8(emitter, 0x48);
+	jitEmit8(emitter, 0x3B);
+	jitEmitRbxOperand(emitter, X86_EAX, offsetof(gameBoy_t, cyclesEnd));
+	jitEmit8(emitter, 0x0F);
+	jitEmit8(emitter, 0x86);
+	fitsOffset = emitter->size;
+	jitEmit32(emitter, 0);
+
+	// The exit path can't consume the pending cycles, as the path that carries on still needs them
+	jitPatchJump(emitter, invalidOffset);
+	uint32_t cyclesPending = emitter->cyclesPending;
+	jitEmitExit(emitter, pc, count);
+	emitter->cyclesPending = cyclesPending;
+
+	jitPatchJump(emitter, fitsOffset);
+}
+
+/*
+ * @brief Works out which flags an instruction reads and which it overwrites
+ * @param opCode Index into gbDispatchTable
+ * @param read Set to the flags the instruction reads
+ * @param written Set to the flags the instruction always overwrites
+ * @return void
+ * @note Anything not listed is assumed to read every flag, which is always safe
+ */
+static void jitFlagUsage(uint16_t opCode, uint8_t* read, uint8_t* written)
+{
+	*read = 0;
+	*written = 0;
+
+	if(opCode >= GB_OPCODE_CB_OFFSET)
+	{
+		uint8_t cbOpCode = opCode & 0xFF;
+		if(cbOpCode < 0x40)
+		{
+			// RL/RR shift the carry back in
+			*read = ((cbOpCode >= 0x10) && (cbOpCode < 0x20)) ? FLAG_REG_CARRY : 0;
+			*written = JIT_FLAGS_ALL;
+		}
+		else if(cbOpCode < 0x80)
+		{
+			*written = JIT_FLAGS_ZNH; // BIT
+		}
+		return;
+	}
+
+	if((opCode >= 0x40) && (opCode < 0x80) && (opCode != 0x76))
+	{
+		return; // LD r, r'
+	}
+
+	if(((opCode >= 0x80) && (opCode < 0xC0)) || ((opCode >= 0xC6) && ((opCode & 0x07) == 0x06)))
+	{
+		// ADC/SBC read the carry
+		uint8_t operation = (opCode >> 3) & 0x07;
+		*read = ((operation == 1) || (operation == 3)) ? FLAG_REG_CARRY : 0;
+		*written = JIT_FLAGS_ALL;
+		return;
+	}
+
+	switch(opCode)
+	{
+		case 0x00: case 0x01: case 0x02: case 0x03: case 0x06: case 0x08: case 0x0A: case 0x0B: case 0x0E:
+		case 0x11: case 0x12: case 0x13: case 0x16: case 0x1A: case 0x1B: case 0x1E:
+		case 0x21: case 0x22: case 0x23: case 0x26: case 0x2A: case 0x2B: case 0x2E:
+		case 0x31: case 0x32: case 0x33: case 0x36: case 0x3A: case 0x3B: case 0x3E:
+		case 0xC1: case 0xD1: case 0xE1: case 0xC5: case 0xD5: case 0xE5:
+		case 0xE0: case 0xE2: case 0xEA: case 0xF0: case 0xF2: case 0xFA: case 0xF9:
+			return;
+		case 0x04: case 0x0C: case 0x14: case 0x1C: case 0x24: case 0x2C: case 0x34: case 0x3C: // INC r
+		case 0x05: case 0x0D: case 0x15: case 0x1D: case 0x25: case 0x2D: case 0x35: case 0x3D: // DEC r
+			*written = JIT_FLAGS_ZNH;
+			return;
+		case 0x09: case 0x19: case 0x29: case 0x39: // ADD HL, rr
+			*written = FLAG_REG_SUB | FLAG_REG_HALF_CARRY | FLAG_REG_CARRY;
+			return;
+		case 0x07: case 0x0F: case 0xE8: case 0xF8: case 0xF1:
+			*written = JIT_FLAGS_ALL;
+			return;
+		case 0x17: case 0x1F: // RLA, RRA
+			*read = FLAG_REG_CARRY;
+			*written = JIT_FLAGS_ALL;
+			return;
+		case 0x2F: // CPL
+			*written = FLAG_REG_SUB | FLAG_REG_HALF_CARRY;
+			return;
+		case 0x37: // SCF
+			*written = FLAG_REG_SUB | FLAG_REG_HALF_CARRY | FLAG_REG_CARRY;
+			return;
+		case 0x3F: // CCF
+			*read = FLAG_REG_CARRY;
+			*written = FLAG_REG_SUB | FLAG_REG_HALF_CARRY | FLAG_REG_CARRY;
+			return;
+		default:
+			*read = JIT_FLAGS_ALL;
+			return;
+	}
+}
+
+/*
+ * @brief Tries to emit an instruction as native code
+ * @param flagsLive true if anything can read the flags the instruction writes
+ * @return true if the instruction was emitted, false if it has to fall back to its handler
+ */
+static bool jitEmitNative(jitEmitter_t* emitter, const blockInstruction_t* instruction, bool flagsLive)
+{
+	uint16_t opCode = instruction->opCode;
+
+	if(opCode >= GB_OPCODE_CB_OFFSET)
+	{
+		return false;
+	}
+
+	// NOP
+	if(opCode == 0x00)
+	{
+		return true;
+	}
+
+	// LD r, r'
+	if((opCode >= 0x40) && (opCode < 0x80) && ((opCode & 0x07) != 0x06) && (((opCode >> 3) & 0x07) != 0x06))
+	{
+		// movzx eax, byte [rbx + src] / mov byte [rbx + dst], al
+		jitEmit8(emitter, 0x0F);
+		jitEmit8(emitter, 0xB6);
+		jitEmitRbxOperand(emitter, X86_EAX, jitReg8Offset[opCode & 0x07]);
+		jitEmit8(emitter, 0x88);
+		jitEmitRbxOperand(emitter, X86_EAX, jitReg8Offset[(opCode >> 3) & 0x07]);
+		return true;
+	}
+
+	if(opCode < 0x40)
+	{
+		uint8_t reg = (opCode >> 3) & 0x07;
+
+		switch(opCode & 0x0F)
+		{
+			case 0x01:
+				// LD rr, d16: mov word [rbx + rr], imm16
+				jitEmit8(emitter, 0x66);
+				jitEmit8(emitter, 0xC7);
+				jitEmitRbxOperand(emitter, 0, jitReg16Offset[opCode >> 4]);
+				jitEmit16(emitter, instruction->immediate);
+				return true;
+			case 0x03:
+			case 0x0B:
+				// INC rr / DEC rr: inc/dec word [rbx + rr]
+				jitEmit8(emitter, 0x66);
+				jitEmit8(emitter, 0xFF);
+				jitEmitRbxOperand(emitter, (opCode & 0x08) ? 1 : 0, jitReg16Offset[opCode >> 4]);
+				return true;
+			case 0x04:
+			case 0x05:
+			case 0x0C:
+			case 0x0D:
+				// INC r / DEC r, only when Z, N and H are dead: inc/dec byte [rbx + r]
+				if(flagsLive || (reg == 6))
+				{
+					return false;
+				}
+				jitEmit8(emitter, 0xFE);
+				jitEmitRbxOperand(emitter, (opCode & 0x01) ? 1 : 0, jitReg8Offset[reg]);
+				return true;
+			case 0x06:
+			case 0x0E:
+				// LD r, d8: mov byte [rbx + r], imm8
+				if(reg == 6)
+				{
+					return false;
+				}
+				jitEmit8(emitter, 0xC6);
+				jitEmitRbxOperand(emitter, 0, jitReg8Offset[reg]);
+				jitEmit8(emitter, instruction->immediate & 0xFF);
+				return true;
+			case 0x0F:
+				// CPL, only when N and H are dead: not byte [rbx + a]
+				if((opCode != 0x2F) || flagsLive)
+				{
+					return false;
+				}
+				jitEmit8(emitter, 0xF6);
+				jitEmitRbxOperand(emitter, 2, jitReg8Offset[7]);
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	// ADD/SUB/AND/XOR/OR/CP A, r or d8, only when every flag they write is dead
+	if(((opCode >= 0x80) && (opCode < 0xC0)) || ((opCode >= 0xC6) && ((opCode & 0x07) == 0x06)))
+	{
+		// x86 op code for "op r/m8, r8", indexed by LR35902 ALU operation. ADC/SBC (1 and 3) need the carry so
+		// aren't emitted, and CP (7) emits nothing
+		static const uint8_t x86AluOpCode[8] = { 0x00, 0, 0x28, 0, 0x20, 0x30, 0x08, 0 };
+		uint8_t operation = (opCode >> 3) & 0x07;
+		uint8_t src = opCode & 0x07;
+
+		if(flagsLive || (operation == 1) || (operation == 3) || ((opCode < 0xC0) && (src == 6)))
+		{
+			return false;
+		}
+
+		// CP only sets flags, so with them dead there's nothing left to do
+		if(operation == 7)
+		{
+			return true;
+		}
+
+		if(opCode >= 0xC0)
+		{
+			// mov al, imm8
+			jitEmit8(emitter, 0xB0);
+			jitEmit8(emitter, instruction->immediate & 0xFF);
+		}
+		else
+		{
+			// movzx eax, byte [rbx + src]
+			jitEmit8(emitter, 0x0F);
+			jitEmit8(emitter, 0xB6);
+			jitEmitRbxOperand(emitter, X86_EAX, jitReg8Offset[src]);
+		}
+		// op byte [rbx + a], al
+		jitEmit8(emitter, x86AluOpCode[operation]);
+		jitEmitRbxOperand(emitter, X86_EAX, jitReg8Offset[7]);
+		return true;
+	}
+
+	// LD SP, HL: movzx eax, word [rbx + hl] / mov word [rbx + sp], ax
+	if(opCode == 0xF9)
+	{
+		jitEmit8(emitter, 0x0F);
+		jitEmit8(emitter, 0xB7);
+		jitEmitRbxOperand(emitter, X86_EAX, jitReg16Offset[2]);
+		jitEmit8(emitter, 0x66);
+		jitEmit8(emitter, 0x89);
+		jitEmitRbxOperand(emitter, X86_EAX, jitReg16Offset[3]);
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * @brief Flushes every translated block, making the whole arena available again
+ */
+static void jitFlush(gameBoy_t* gb)
+{
+	for(uint32_t i = 0; i < BLOCK_CACHE_SIZE; i++)
+	{
+		gb->blockCache->blocks[i].jitCode = NULL;
+		gb->blockCache->blocks[i].execCount = 0;
+	}
+	gb->jitArena->used = 0;
+}
+
+/*
+ * @brief Allocates an (empty) executable arena for translated blocks
+ * @return Pointer to the new arena. If the host won't map executable memory the arena is disabled
+ */
+jitArena_t* jitArenaCreate(void)
+{
+	jitArena_t* arena = calloc(1, sizeof(jitArena_t));
+
+	if(arena == NULL)
+	{
+		printf("JIT arena allocation error\r\n");
+		exit(1);
+	}
+
+	arena->code = mmap(NULL, JIT_ARENA_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(arena->code == MAP_FAILED)
+	{
+		printf("JIT arena mapping error, falling back to the interpreter\r\n");
+		arena->code = NULL;
+		arena->disabled = true;
+	}
+
+	return arena;
+}
+
+/*
+ * @brief Unmaps and frees an executable arena
+ */
+void jitArenaDestroy(jitArena_t* arena)
+{
+	if(arena == NULL)
+	{
+		return;
+	}
+
+	if(arena->code != NULL)
+	{
+		munmap(arena->code, JIT_ARENA_SIZE);
+	}
+	free(arena);
+}
+
+/*
+ * @brief Translates a block to native code, setting block->jitCode
+ * @param gb Pointer to gb struct containing registers
+ * @param block Hot block to translate
+ * @return void
+ * @note The generated function returns the number of instructions it ran. That's every instruction but the last unless
+ * a write invalidated the block, or a write or I/O read brought gb->cyclesEnd forward to before the end of it, part way
+ * through
+ */
+void jitCompile(gameBoy_t* gb, block_t* block)
+{
+	jitArena_t* arena = gb->jitArena;
+	jitEmitter_t emitter;
+	bool flagsLive[BLOCK_MAX_INSTRUCTIONS];
+	uint8_t live = JIT_FLAGS_ALL;
+	uint16_t pc = block->pc;
+	uint32_t cyclesRemaining = block->cycles;
+
+	if(arena->disabled || (block->count < 2))
+	{
+		return;
+	}
+
+	if((arena->used + (block->count * JIT_MAX_INSTRUCTION_SIZE) + 16) > JIT_ARENA_SIZE)
+	{
+		jitFlush(gb);
+	}
+
+	// Backwards liveness pass. The last instruction is run by the block core, and everything after it is unknown
+	for(int i = block->count - 1; i >= 0; i--)
+	{
+		uint8_t read = 0;
+		uint8_t written = 0;
+
+		jitFlagUsage(block->instructions[i].opCode, &read, &written);
+		flagsLive[i] = (written & live) != 0;
+		live = (live & ~written) | read;
+	}
+
+	emitter.code = arena->code + arena->used;
+	emitter.size = 0;
+	emitter.cyclesPending = 0;
+
+	// push rbx / mov rbx, rdi
+	jitEmit8(&emitter, 0x53);
+	jitEmit8(&emitter, 0x48);
+	jitEmit8(&emitter, 0x89);
+	jitEmit8(&emitter, 0xFB);
+
+	for(uint8_t i = 0; i < (block->count - 1); i++)
+	{
+		const blockInstruction_t* instruction = &block->instructions[i];
+
+		if(!jitEmitNative(&emitter, instruction, flagsLive[i]))
+		{
+			jitEmitFallback(&emitter, instruction, pc);
+		}
+		emitter.cyclesPending += instruction->clockCycles;
+		cyclesRemaining -= instruction->clockCycles;
+		pc += instruction->opCodeSize;
+
+		if(instruction->writesMemory || instruction->readsMemory)
+		{
+			jitEmitExitCheck(&emitter, block, pc, i + 1, cyclesRemaining);
+		}
+	}
+
+	jitEmitExit(&emitter, pc, block->count - 1);
+
+	block->jitCode = (jitBlockFn*)(void*)emitter.code;
+	arena->used += (emitter.size + 15) & ~(size_t)15;
+}
+
+#else
+
+jitArena_t* jitArenaCreate(void)
+{
+	jitArena_t* arena = calloc(1, sizeof(jitArena_t));
+
+	if(arena == NULL)
+	{
+		printf("JIT arena allocation error\r\n");
+		exit(1);
+	}
+
+	// Only x86-64 code can be generated. Everything stays interpreted
+	arena->disabled = true;
+	return arena;
+}
+
+void jitArenaDestroy(jitArena_t* arena)
+{
+	free(arena);
+}
+
+void jitCompile(gameBoy_t* gb, block_t* block)
+{
+	(void)gb;
+	(void)block;
+}
+
+#endif // __x86_64__
@@ -1,42 +1,285 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
 #include <SDL2/SDL.h>
+#include "apu.h"
+#include "audio.h"
 #include "cart.h"
 #include "emu.h"
 #include "gb.h"
 #include "graphics.h"
+#include "idle.h"
+#include "input.h"
+#include "movie.h"
+#include "ppu.h"
+#include "rewind.h"
+#include "ring.h"
+#include "romindex.h"
+
+// Length of a GameBoy frame in nanoseconds (~59.73 frames per second)
+#define MAIN_FRAME_NS 	((uint64_t)GB_CYCLES_PER_FRAME * 1000000000 / GB_CLOCK_HZ)
+
+// Handed to the emulation thread
+typedef struct
+{
+	gameBoy_t* gb;
+	emuContext_t* context;
+	rewind_t* history; 	// NULL if rewinding is turned off
+	movie_t* record; 	// Movie the buttons held are added to, if recording
+	movie_t* replay; 	// Movie the buttons are taken from until it runs out, if replaying
+} mainEmulation_t;
+
+/*
+ * @brief Returns the joypad button a key is mapped to: arrow keys, X (A), Z (B), Right Shift (Select), Enter (Start)
+ * @return INPUT_* bit, or 0 if the key isn't mapped
+ */
+static uint8_t mainKeyButton(SDL_Keycode key)
+{
+	switch (key)
+	{
+		case SDLK_RIGHT: return INPUT_RIGHT;
+		case SDLK_LEFT: return INPUT_LEFT;
+		case SDLK_UP: return INPUT_UP;
+		case SDLK_DOWN: return INPUT_DOWN;
+		case SDLK_x: return INPUT_A;
+		case SDLK_z: return INPUT_B;
+		case SDLK_RSHIFT: return INPUT_SELECT;
+		case SDLK_RETURN: return INPUT_START;
+		default: return 0;
+	}
+}
+
+/*
+ * @brief Emulation thread. Runs frames at the GameBoy's own rate, independent of the display's
+ * @param arg Pointer to mainEmulation_t with the gb struct to be run and its context
+ * @return NULL
+ */
+static void* mainEmulate(void* arg)
+{
+	gameBoy_t* gb = ((mainEmulation_t*)arg)->gb;
+	emuContext_t* context = ((mainEmulation_t*)arg)->context;
+	rewind_t* history = ((mainEmulation_t*)arg)->history;
+	movie_t* record = ((mainEmulation_t*)arg)->record;
+	movie_t* replay = ((mainEmulation_t*)arg)->replay;
+	uint32_t frame = 0;
+	struct timespec deadline;
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+	while(context->running)
+	{
+		struct timespec now;
+
+		if(context->paused)
+		{
+			struct timespec pause = { 0, 10000000 };
+			nanosleep(&pause, NULL);
+			clock_gettime(CLOCK_MONOTONIC, &deadline);
+			continue;
+		}
+		if(context->rewinding && (history != NULL))
+		{
+			// One state back per frame. Once the oldest is reached it stays on screen until rewinding stops
+			rewindStep(history, gb);
+		}
+		else
+		{
+			uint8_t buttons = context->buttons;
+
+			if((replay != NULL) && (frame < movieFrameCount(replay)))
+			{
+				buttons = movieGetFrame(replay, frame);
+			}
+			inputSetButtons(gb, buttons);
+			// Whole instructions are run back to back for a frame's worth of cycles at a time
+			gbRunFrame(gb);
+			if(record != NULL)
+			{
+				movieAddFrame(record, buttons);
+			}
+			if((replay != NULL) && (++frame == movieFrameCount(replay)))
+			{
+				// The keyboard takes over from here
+				movieCheck(replay, gb);
+			}
+			if(history != NULL)
+			{
+				rewindFrame(history, gb);
+			}
+		}
+		graphicsPublishFrame(ppuGetFrame(gb));
+
+		deadline.tv_nsec += MAIN_FRAME_NS;
+		if(deadline.tv_nsec >= 1000000000)
+		{
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000;
+		}
+		// More than a frame behind (e.g. after the host stalled): start again from now rather than racing to catch up
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		if((now.tv_sec - deadline.tv_sec) * 1000000000 + (now.tv_nsec - deadline.tv_nsec) > (int64_t)MAIN_FRAME_NS)
+		{
+			deadline = now;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+	}
+
+	return NULL;
+}
 
 int main(int argc, char** argv)
 {
 	SDL_Event sEvent;
 	SDL_Window* sWindow = NULL;
 	SDL_Renderer* sRenderer = NULL;
+	pthread_t emuThread;
 	gameBoy_t gb;
+	emuContext_t context;
+	mainEmulation_t emulation = { &gb, &context, NULL, NULL, NULL };
+	ring_t* audioRing = NULL;
+	size_t rewindCapacity = REWIND_DEFAULT_CAPACITY;
+	const char* recordPath = NULL;
+	const char* replayPath = NULL;
+	uint8_t buttons = 0;
+	int arg = 1;
+
+	// Index mode: no emulation, just writes out metadata for a directory of ROMs
+	if ((argc == 4) && (strcmp(argv[1], "--index") == 0))
+	{
+		return romIndexBuild(argv[2], argv[3]) ? 0 : 1;
+	}
 
-	// TODO: create proper function to initialize gb struct
-	gb.cyclesExtraFlag = false;
+	gbInit(&gb);
 
-	if (argc != 2)
+	for (arg = 1; arg < argc - 1; arg++)
 	{
-		printf("Usage: gameboy_emulator <rom_file>");
+		if (strcmp(argv[arg], "--every-frame") == 0)
+		{
+			graphicsSetPresentMode(GRAPHICS_PRESENT_EVERY);
+		}
+		else if (strcmp(argv[arg], "--no-idle-skip") == 0)
+		{
+			// Run every pass of polling loops, e.g. to check skipping them doesn't change anything
+			idleSetEnabled(&gb, false);
+		}
+		else if ((strcmp(argv[arg], "--rewind-mb") == 0) && (arg + 1 < argc - 1))
+		{
+			// Memory for the rewind history, 0 to turn rewinding off
+			rewindCapacity = (size_t)strtoul(argv[++arg], NULL, 0) << 20;
+		}
+		else if ((strcmp(argv[arg], "--record") == 0) && (arg + 1 < argc - 1))
+		{
+			recordPath = argv[++arg];
+		}
+		else if ((strcmp(argv[arg], "--replay") == 0) && (arg + 1 < argc - 1))
+		{
+			replayPath = argv[++arg];
+		}
+		else
+		{
+			break;
+		}
+	}
+	if (arg != argc - 1)
+	{
+		printf("Usage: gameboy_emulator [--every-frame] [--no-idle-skip] [--rewind-mb <n>] [--record <movie>]\r\n");
+		printf("                        [--replay <movie>] <rom_file>\r\n");
+		printf("       gameboy_emulator --index <rom_dir> <index_file>\r\n");
 		return -1;
 	}
 
-	cartLoadRom(&gb, argv[1]);
+	if (!cartLoadRom(&gb, argv[argc - 1]))
+	{
+		return 1;
+	}
+	if (replayPath != NULL)
+	{
+		emulation.replay = movieLoad(&gb, replayPath);
+		if (emulation.replay == NULL)
+		{
+			gbDeinit(&gb);
+			return 1;
+		}
+	}
+	if (recordPath != NULL)
+	{
+		emulation.record = movieCreate(&gb);
+	}
+	if ((emulation.record != NULL) || (emulation.replay != NULL))
+	{
+		// Movies run straight through from power-on, so there's no going back
+		rewindCapacity = 0;
+	}
 	graphicsInit(&sWindow, &sRenderer);
+
+	// Without an audio device the APU is still run, but nothing is synthesised
+	audioRing = ringCreate(AUDIO_RING_SAMPLES);
+	if (audioInit(audioRing) == 0)
+	{
+		apuSetOutput(&gb, audioRing);
+	}
 	
 	// Initialize Emulator context
-	setEmuContextPaused(false);
-	setEmuContextRunning(true);
-	setEmuContextTicks(0);
+	emuContextInit(&context);
+	if (rewindCapacity > 0)
+	{
+		emulation.history = rewindCreate(rewindCapacity, REWIND_DEFAULT_INTERVAL);
+	}
 
-	while(getEmuContext()->running)
+	// Emulation runs on its own thread, so waiting for vertical sync here never holds it up
+	pthread_create(&emuThread, NULL, mainEmulate, &emulation);
+
+	while(context.running)
 	{
-		if(getEmuContext()->paused)
+		while(SDL_PollEvent(&sEvent))
 		{
+			if(sEvent.type == SDL_QUIT)
+			{
+				setEmuContextRunning(&context, false);
+			}
+			else if(((sEvent.type == SDL_KEYDOWN) || (sEvent.type == SDL_KEYUP)) &&
+				(sEvent.key.keysym.sym == SDLK_BACKSPACE))
+			{
+				// Held down to rewind
+				setEmuContextRewinding(&context, sEvent.type == SDL_KEYDOWN);
+			}
+			else if((sEvent.type == SDL_KEYDOWN) || (sEvent.type == SDL_KEYUP))
+			{
+				uint8_t button = mainKeyButton(sEvent.key.keysym.sym);
+
+				buttons = (sEvent.type == SDL_KEYDOWN) ? (buttons | button) : (buttons & ~button);
+				setEmuContextButtons(&context, buttons);
+			}
+		}
+		if(!graphicsPresent(sRenderer))
+		{
+			SDL_Delay(1);
 		}
-		// I've decide on using function table (jump table) (array of function pointers) for dispatching
-		gbHandleCycle(&gb);	
 	}
 
+	graphicsStop();
+	pthread_join(emuThread, NULL);
+	if (emulation.history != NULL)
+	{
+		rewindDestroy(emulation.history);
+	}
+	if (emulation.record != NULL)
+	{
+		movieSave(emulation.record, &gb, recordPath);
+		movieDestroy(emulation.record);
+	}
+	if (emulation.replay != NULL)
+	{
+		movieDestroy(emulation.replay);
+	}
+	audioDeinit();
+	ringDestroy(audioRing);
+	graphicsDeinit();
+	SDL_DestroyRenderer(sRenderer);
+	SDL_DestroyWindow(sWindow);
+	SDL_Quit();
+	gbDeinit(&gb);
 	return 0;
 }
@@ -0,0 +1,369 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "gb.h"
+#include "bus.h"
+#include "cart.h"
+#include "movie.h"
+#include "ppu.h"
+#include "utils.h"
+
+/*
+ * movie.c: Input movies. A movie is the buttons held on each frame of a run, starting from power-on (gbInit then
+ * cartLoadRom). Everything else the emulator does is deterministic, the RTC included, so setting those buttons
+ * (inputSetButtons) before each gbRunFrame reproduces the run exactly, whichever core and idle skip setting it's run
+ * with. The hashes of memory and the last frame at the end of the recording are saved with it to check that against.
+ * File layout, all little-endian: the magic number, version, frame count, the ROM's header and global checksums,
+ * the two SHA-1 hashes, then the buttons as runs of a LEB128 frame count and the button byte held for them
+ */
+
+// Size of the fixed part of the file
+#define MOVIE_HEADER_SIZE 	(4 + 4 + 4 + 1 + 2 + UTILS_SHA1_SIZE + UTILS_SHA1_SIZE)
+
+struct movie
+{
+	uint8_t* buttons; 	// One byte of INPUT_* bits per frame
+	uint32_t frames;
+	uint32_t allocated;
+	// ROM the movie was recorded with. All 0 without a cartridge
+	uint8_t headerChecksum;
+	uint16_t globalChecksum;
+	// State at the end of the recording. Not known until the movie is saved
+	bool hashed;
+	uint8_t memoryDigest[UTILS_SHA1_SIZE];
+	uint8_t frameDigest[UTILS_SHA1_SIZE];
+};
+
+/*
+ * @brief Fills in the checksums of the loaded ROM, which movies are matched to it by
+ */
+static void movieIdentify(const gameBoy_t* gb, uint8_t* headerChecksum, uint16_t* globalChecksum)
+{
+	*headerChecksum = 0;
+	*globalChecksum = 0;
+	if(gb->cart != NULL)
+	{
+		*headerChecksum = gb->cart->rom[ADDR_HEADER_CHECKSUM];
+		*globalChecksum = (gb->cart->rom[ADDR_GLOBAL_CHECKSUM] << 8) | gb->cart->rom[ADDR_GLOBAL_CHECKSUM + 1];
+	}
+}
+
+/*
+ * @brief Prints a SHA-1 digest in hex, without a line ending
+ */
+static void moviePrintDigest(const uint8_t digest[UTILS_SHA1_SIZE])
+{
+	for(uint8_t i = 0; i < UTILS_SHA1_SIZE; i++)
+	{
+		printf("%02x", digest[i]);
+	}
+}
+
+/*
+ * @brief Makes an empty movie, to be recorded from power-on with the ROM loaded into gb
+ * @param gb Pointer to gb struct, straight after gbInit and cartLoadRom
+ * @return Pointer to the movie. Exits if out of memory
+ */
+movie_t* movieCreate(gameBoy_t* gb)
+{
+	movie_t* movie = calloc(1, sizeof(movie_t));
+
+	if(movie == NULL)
+	{
+		printf("Movie allocation error\r\n");
+		exit(1);
+	}
+	movieIdentify(gb, &movie->headerChecksum, &movie->globalChecksum);
+
+	return movie;
+}
+
+/*
+ * @brief Frees a movie
+ */
+void movieDestroy(movie_t* movie)
+{
+	free(movie->buttons);
+	free(movie);
+}
+
+/*
+ * @brief Adds a frame to the end of a movie
+ * @param movie Pointer to the movie
+ * @param buttons INPUT_* bits of the buttons held for the frame
+ * @return void
+ */
+void movieAddFrame(movie_t* movie, uint8_t buttons)
+{
+	if(movie->frames == movie->allocated)
+	{
+		movie->allocated = (movie->allocated > 0) ? (movie->allocated * 2) : 4096;
+		movie->buttons = realloc(movie->buttons, movie->allocated);
+		if(movie->buttons == NULL)
+		{
+			printf("Movie allocation error\r\n");
+			exit(1);
+		}
+	}
+	movie->buttons[movie->frames++] = buttons;
+}
+
+/*
+ * @brief Returns the number of frames in a movie
+ */
+uint32_t movieFrameCount(const movie_t* movie)
+{
+	return movie->frames;
+}
+
+/*
+ * @brief Returns the buttons held on a frame of a movie
+ * @param movie Pointer to the movie
+ * @param frame Frame number, from 0. Must be less than movieFrameCount
+ * @return INPUT_* bits, to pass to inputSetButtons before running the frame
+ */
+uint8_t movieGetFrame(const movie_t* movie, uint32_t frame)
+{
+	return movie->buttons[frame];
+}
+
+/*
+ * @brief Hashes the RAM the game can change: VRAM through to IE in memory[], then cartridge RAM
+ * @param gb Pointer to gb struct
+ * @param digest SHA-1 of the memory
+ * @return void
+ * @note ROM is left out, as it can't change. Registers worked out on read (DIV, TIMA, P1) aren't held in memory[]
+ */
+void movieHashMemory(gameBoy_t* gb, uint8_t digest[UTILS_SHA1_SIZE])
+{
+	uint32_t ramSize = (gb->cart != NULL) ? gb->cart->ramSize : 0;
+	uint32_t size = (GB_MEMORY_SIZE - BUS_ADDR_VRAM) + ramSize;
+	uint8_t* data = malloc(size);
+
+	if(data == NULL)
+	{
+		printf("Failed to allocate memory to hash\r\n");
+		exit(1);
+	}
+	memcpy(data, &gb->memory[BUS_ADDR_VRAM], GB_MEMORY_SIZE - BUS_ADDR_VRAM);
+	if(ramSize > 0)
+	{
+		memcpy(&data[GB_MEMORY_SIZE - BUS_ADDR_VRAM], gb->cart->ram, ramSize);
+	}
+	utilsSha1(data, size, digest);
+	free(data);
+}
+
+/*
+ * @brief Hashes the framebuffer (see ppuGetFrame)
+ * @param gb Pointer to gb struct
+ * @param digest SHA-1 of the framebuffer's ARGB8888 pixels
+ * @return void
+ */
+void movieHashFrame(gameBoy_t* gb, uint8_t digest[UTILS_SHA1_SIZE])
+{
+	utilsSha1(ppuGetFrame(gb), PPU_SCREEN_WIDTH * PPU_SCREEN_HEIGHT * sizeof(uint32_t), digest);
+}
+
+/*
+ * @brief Saves a movie, along with hashes of the state it ended in
+ * @param movie Pointer to the movie
+ * @param gb Pointer to gb struct, having just run the movie's last frame
+ * @param path File to write, replacing it if it exists
+ * @return false if the file couldn't be written
+ */
+bool movieSave(movie_t* movie, gameBoy_t* gb, const char* path)
+{
+	// Every run could take 5 bytes to encode, plus its button byte
+	uint8_t* data = malloc(MOVIE_HEADER_SIZE + ((size_t)movie->frames * 6));
+	uint8_t* out = data;
+	FILE* file = NULL;
+	bool written = false;
+
+	if(data == NULL)
+	{
+		printf("Movie allocation error\r\n");
+		exit(1);
+	}
+	movieHashMemory(gb, movie->memoryDigest);
+	movieHashFrame(gb, movie->frameDigest);
+	movie->hashed = true;
+
+	memcpy(out, MOVIE_MAGIC, 4);
+	out += 4;
+	for(uint8_t i = 0; i < 4; i++)
+	{
+		*out++ = (uint8_t)(MOVIE_VERSION >> (i * 8));
+	}
+	for(uint8_t i = 0; i < 4; i++)
+	{
+		*out++ = (uint8_t)(movie->frames >> (i * 8));
+	}
+	*out++ = movie->headerChecksum;
+	*out++ = (uint8_t)movie->globalChecksum;
+	*out++ = (uint8_t)(movie->globalChecksum >> 8);
+	memcpy(out, movie->memoryDigest, UTILS_SHA1_SIZE);
+	out += UTILS_SHA1_SIZE;
+	memcpy(out, movie->frameDigest, UTILS_SHA1_SIZE);
+	out += UTILS_SHA1_SIZE;
+
+	for(uint32_t frame = 0; frame < movie->frames;)
+	{
+		uint32_t run = 1;
+
+		while((frame + run < movie->frames) && (movie->buttons[frame + run] == movie->buttons[frame]))
+		{
+			run++;
+		}
+		for(uint32_t value = run; ; value >>= 7)
+		{
+			*out++ = (uint8_t)((value & 0x7F) | ((value >= 0x80) ? 0x80 : 0));
+			if(value < 0x80)
+			{
+				break;
+			}
+		}
+		*out++ = movie->buttons[frame];
+		frame += run;
+	}
+
+	file = fopen(path, "wb");
+	if(file != NULL)
+	{
+		written = (fwrite(data, 1, (size_t)(out - data), file) == (size_t)(out - data));
+		written = (fclose(file) == 0) && written;
+	}
+	if(!written)
+	{
+		printf("Movie write error: %s\r\n", path);
+	}
+
+	free(data);
+	return written;
+}
+
+/*
+ * @brief Loads a movie recorded with the ROM loaded into gb
+ * @param gb Pointer to gb struct, with the ROM the movie was recorded with loaded
+ * @param path File written by movieSave
+ * @return Pointer to the movie, or NULL if the file couldn't be read, isn't a movie or is for another ROM
+ */
+movie_t* movieLoad(gameBoy_t* gb, const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	uint8_t header[MOVIE_HEADER_SIZE];
+	const uint8_t* in = header;
+	movie_t* movie = NULL;
+	uint32_t version = 0;
+	uint32_t frames = 0;
+	int c = 0;
+
+	if((file == NULL) || (fread(header, 1, sizeof(header), file) != sizeof(header)))
+	{
+		printf("Movie read error: %s\r\n", path);
+		if(file != NULL)
+		{
+			fclose(file);
+		}
+		return NULL;
+	}
+
+	movie = movieCreate(gb);
+	for(uint8_t i = 0; i < 4; i++)
+	{
+		version |= (uint32_t)in[4 + i] << (i * 8);
+		frames |= (uint32_t)in[8 + i] << (i * 8);
+	}
+	in += 12;
+	if((memcmp(header, MOVIE_MAGIC, 4) != 0) || (version != MOVIE_VERSION))
+	{
+		printf("Not a movie (or not version %u) error: %s\r\n", MOVIE_VERSION, path);
+		fclose(file);
+		movieDestroy(movie);
+		return NULL;
+	}
+	if((in[0] != movie->headerChecksum) || ((in[1] | (in[2] << 8)) != movie->globalChecksum))
+	{
+		printf("Movie is for a different ROM error: %s\r\n", path);
+		fclose(file);
+		movieDestroy(movie);
+		return NULL;
+	}
+	in += 3;
+	memcpy(movie->memoryDigest, in, UTILS_SHA1_SIZE);
+	memcpy(movie->frameDigest, &in[UTILS_SHA1_SIZE], UTILS_SHA1_SIZE);
+	movie->hashed = true;
+
+	while((movie->frames < frames) && ((c = fgetc(file)) != EOF))
+	{
+		uint32_t run = 0;
+		uint8_t shift = 0;
+
+		// LEB128 run length, then the buttons
+		run = c & 0x7F;
+		while((c & 0x80) && (shift < 28) && ((c = fgetc(file)) != EOF))
+		{
+			shift += 7;
+			run |= (uint32_t)(c & 0x7F) << shift;
+		}
+		if((c == EOF) || ((c = fgetc(file)) == EOF) || (run > frames - movie->frames))
+		{
+			break;
+		}
+		while(run-- > 0)
+		{
+			movieAddFrame(movie, (uint8_t)c);
+		}
+	}
+	fclose(file);
+
+	if(movie->frames != frames)
+	{
+		printf("Movie truncated error: %s\r\n", path);
+		movieDestroy(movie);
+		return NULL;
+	}
+
+	return movie;
+}
+
+/*
+ * @brief Checks that a replay ended up where the recording did, and prints the result
+ * @param movie Pointer to the movie
+ * @param gb Pointer to gb struct, having just run the movie's last frame
+ * @return true if the hashes of memory and the last frame both match
+ */
+bool movieCheck(const movie_t* movie, gameBoy_t* gb)
+{
+	uint8_t memoryDigest[UTILS_SHA1_SIZE];
+	uint8_t frameDigest[UTILS_SHA1_SIZE];
+	bool match = false;
+
+	if(!movie->hashed)
+	{
+		printf("Movie has no hashes to check against\r\n");
+		return false;
+	}
+	movieHashMemory(gb, memoryDigest);
+	movieHashFrame(gb, frameDigest);
+	match = (memcmp(memoryDigest, movie->memoryDigest, UTILS_SHA1_SIZE) == 0) &&
+		(memcmp(frameDigest, movie->frameDigest, UTILS_SHA1_SIZE) == 0);
+
+	printf("Replay %s: memory SHA-1 ", match ? "matches" : "MISMATCH");
+	moviePrintDigest(memoryDigest);
+	printf(", frame SHA-1 ");
+	moviePrintDigest(frameDigest);
+	printf("\r\n");
+	if(!match)
+	{
+		printf("Recorded: memory SHA-1 ");
+		moviePrintDigest(movie->memoryDigest);
+		printf(", frame SHA-1 ");
+		moviePrintDigest(movie->frameDigest);
+		printf("\r\n");
+	}
+
+	return match;
+}
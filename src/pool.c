@@ -0,0 +1,163 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "pool.h"
+
+/*
+ * pool.c: Work-stealing thread pool, for running many independent emulator instances from one process. The tasks
+ * are split evenly between the workers up front, each into its own deque. A worker takes its own tasks from the back,
+ * and once it runs out, steals from the front of the others' deques, so workers that drew short tasks pick up the
+ * slack of ones that drew long tasks. Tasks are whole emulator runs, so a lock per deque costs nothing measurable
+ */
+
+// A worker's deque. Its tasks are the contiguous indices [head, tail)
+typedef struct
+{
+	pthread_mutex_t lock;
+	uint32_t head; 		// Stolen from by other workers
+	uint32_t tail; 		// Taken from by the owner
+} poolDeque_t;
+
+typedef struct
+{
+	poolDeque_t* deques;
+	uint32_t threads;
+	poolTask_t* task;
+	void* arg;
+} pool_t;
+
+typedef struct
+{
+	pool_t* pool;
+	uint32_t id;
+	pthread_t thread;
+} poolWorker_t;
+
+/*
+ * @brief Takes a task from the back (owner) or front (thief) of a deque
+ * @return false if the deque is empty
+ */
+static bool poolTake(poolDeque_t* deque, bool steal, uint32_t* index)
+{
+	bool taken = false;
+
+	pthread_mutex_lock(&deque->lock);
+	if(deque->head < deque->tail)
+	{
+		*index = steal ? deque->head++ : --deque->tail;
+		taken = true;
+	}
+	pthread_mutex_unlock(&deque->lock);
+
+	return taken;
+}
+
+/*
+ * @brief Worker thread. Runs its own tasks, then steals until every deque is empty
+ * @param arg Pointer to the worker's poolWorker_t
+ * @return NULL
+ * @note No tasks are added once the pool is running, so finding every deque empty means there's nothing left to do
+ */
+static void* poolWork(void* arg)
+{
+	poolWorker_t* worker = arg;
+	pool_t* pool = worker->pool;
+	uint32_t index = 0;
+
+	for(;;)
+	{
+		bool found = poolTake(&pool->deques[worker->id], false, &index);
+
+		// Try the others in turn, starting with the next worker along so thieves spread out
+		for(uint32_t i = 1; !found && (i < pool->threads); i++)
+		{
+			found = poolTake(&pool->deques[(worker->id + i) % pool->threads], true, &index);
+		}
+		if(!found)
+		{
+			break;
+		}
+		pool->task(pool->arg, index);
+	}
+
+	return NULL;
+}
+
+/*
+ * @brief Returns the number of worker threads to use by default: one per online CPU
+ * @return Thread count, at least 1
+ */
+uint32_t poolDefaultThreads(void)
+{
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return (cpus > 0) ? (uint32_t)cpus : 1;
+}
+
+/*
+ * @brief Runs task(arg, index) for every index from 0 to count - 1 across a pool of threads, and waits for them all
+ * @param count Number of tasks
+ * @param threads Number of worker threads. Capped to count
+ * @param task Function to run for each index. Must be safe to call from several threads at once
+ * @param arg Passed to every call of task
+ * @return void
+ */
+void poolRun(uint32_t count, uint32_t threads, poolTask_t* task, void* arg)
+{
+	pool_t pool;
+	poolWorker_t* workers = NULL;
+
+	if(threads > count)
+	{
+		threads = count;
+	}
+	if(threads == 0)
+	{
+		return;
+	}
+
+	pool.threads = threads;
+	pool.task = task;
+	pool.arg = arg;
+	pool.deques = calloc(threads, sizeof(poolDeque_t));
+	workers = calloc(threads, sizeof(poolWorker_t));
+	if((pool.deques == NULL) || (workers == NULL))
+	{
+		printf("Thread pool allocation error\r\n");
+		exit(1);
+	}
+
+	for(uint32_t i = 0; i < threads; i++)
+	{
+		pthread_mutex_init(&pool.deques[i].lock, NULL);
+		pool.deques[i].head = (uint32_t)(((uint64_t)count * i) / threads);
+		pool.deques[i].tail = (uint32_t)(((uint64_t)count * (i + 1)) / threads);
+		workers[i].pool = &pool;
+		workers[i].id = i;
+	}
+
+	// The calling thread is worker 0
+	for(uint32_t i = 1; i < threads; i++)
+	{
+		if(pthread_create(&workers[i].thread, NULL, poolWork, &workers[i]) != 0)
+		{
+			printf("Thread pool thread creation error\r\n");
+			exit(1);
+		}
+	}
+	poolWork(&workers[0]);
+	for(uint32_t i = 1; i < threads; i++)
+	{
+		pthread_join(workers[i].thread, NULL);
+	}
+
+	for(uint32_t i = 0; i < threads; i++)
+	{
+		pthread_mutex_destroy(&pool.deques[i].lock);
+	}
+	free(pool.deques);
+	free(workers);
+}
@@ -0,0 +1,843 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "gb.h"
+#include "ppu.h"
+#include "compose.h"
+#include "sched.h"
+#include "interrupts.h"
+
+/*
+ * ppu.c: Pixel Processing Unit. Renders whole scanlines into gb->ppu.framebuffer, copied to gb->ppu.frame at VBlank.
+ * The PPU isn't stepped alongside the CPU. Instead ppuSync catches it up to the CPU's cycle count whenever something
+ * could observe or change what it's doing (PPU register, VRAM and OAM accesses go through the bus slow path, which
+ * calls ppuSync first) and at the end of every gbRunCycles call. Registers live in gb->memory like any other I/O
+ */
+
+/*
+ * @brief Returns one row of a tile, decoding the tile first if VRAM writes have changed it
+ * @param gb Pointer to gb struct containing memory
+ * @param tile Tile index (0-383), counted from 0x8000
+ * @param row Row within the tile (0-7)
+ * @return 8 colour numbers (0-3), left to right
+ */
+static const uint8_t* ppuTileRow(gameBoy_t* gb, uint16_t tile, uint8_t row)
+{
+	ppu_t* ppu = &gb->ppu;
+	uint64_t mask = 1ULL << (tile & 63);
+
+	if(ppu->tileDirty[tile >> 6] & mask)
+	{
+		const uint8_t* data = &gb->memory[PPU_ADDR_TILE_DATA + tile * PPU_TILE_BYTES];
+
+		for(uint8_t y = 0; y < PPU_TILE_SIZE; y++)
+		{
+			uint8_t low = data[y * 2];
+			uint8_t high = data[y * 2 + 1];
+
+			for(uint8_t x = 0; x < PPU_TILE_SIZE; x++)
+			{
+				uint8_t bit = 7 - x;
+				ppu->tileCache[tile][y][x] = (((high >> bit) & 0x01) << 1) | ((low >> bit) & 0x01);
+			}
+		}
+		ppu->tileDirty[tile >> 6] &= ~mask;
+	}
+
+	return ppu->tileCache[tile][row];
+}
+
+/*
+ * @brief Returns the tile index (0-383) of a background/window tile number
+ * @note LCDC bit 4 picks between 0x8000 with unsigned tile numbers and 0x9000 with signed ones
+ */
+static uint16_t ppuBgTile(uint8_t lcdc, uint8_t tile)
+{
+	if(lcdc & PPU_LCDC_TILE_DATA)
+	{
+		return tile;
+	}
+
+	return 256 + (int8_t)tile;
+}
+
+/*
+ * @brief Picks the sprites on the current line: the first 10 in OAM order
+ * @param gb Pointer to gb struct containing memory
+ * @param selected Filled in with the OAM index of each sprite picked
+ * @return Number of sprites picked
+ */
+static uint8_t ppuScanOam(gameBoy_t* gb, uint8_t selected[PPU_OBJS_PER_LINE])
+{
+	const uint8_t* oam = &gb->memory[0xFE00];
+	uint8_t height = (gb->memory[PPU_REG_LCDC] & PPU_LCDC_OBJ_SIZE) ? 16 : 8;
+	uint8_t ly = gb->ppu.ly;
+	uint8_t count = 0;
+
+	for(uint8_t i = 0; (i < PPU_OAM_ENTRIES) && (count < PPU_OBJS_PER_LINE); i++)
+	{
+		int16_t y = oam[i * 4] - 16;
+		if((ly >= y) && (ly < y + height))
+		{
+			selected[count++] = i;
+		}
+	}
+
+	return count;
+}
+
+/*
+ * @brief Returns the row of a sprite's tile on the current line, taking Y flip and 8x16 sprites into account
+ * @param gb Pointer to gb struct containing memory
+ * @param obj Sprite's 4 bytes of OAM
+ * @return 8 colour numbers (0-3), left to right before X flip
+ */
+static const uint8_t* ppuObjRow(gameBoy_t* gb, const uint8_t* obj)
+{
+	uint8_t height = (gb->memory[PPU_REG_LCDC] & PPU_LCDC_OBJ_SIZE) ? 16 : 8;
+	uint8_t y = gb->ppu.ly - (obj[0] - 16);
+	uint8_t tile = (height == 16) ? (obj[2] & 0xFE) : obj[2];
+
+	if(obj[3] & PPU_OBJ_FLIP_Y)
+	{
+		y = height - 1 - y;
+	}
+
+	// The bottom half of an 8x16 sprite is the next tile
+	return ppuTileRow(gb, tile + (y / 8), y & 7);
+}
+
+/*
+ * @brief Renders the current line (gb->ppu.ly) into the framebuffer
+ * @param gb Pointer to gb struct containing memory
+ * @return void
+ */
+static void ppuRenderLine(gameBoy_t* gb)
+{
+	const uint8_t* memory = gb->memory;
+	ppu_t* ppu = &gb->ppu;
+	uint8_t lcdc = memory[PPU_REG_LCDC];
+	uint8_t ly = ppu->ly;
+	uint32_t* line = &ppu->framebuffer[ly * PPU_SCREEN_WIDTH];
+	// Colour numbers before palette mapping. Sprites flagged as behind the background only show over colour 0
+	uint8_t bgColour[PPU_SCREEN_WIDTH];
+	uint8_t objColour[PPU_SCREEN_WIDTH];
+	uint8_t objAttr[PPU_SCREEN_WIDTH];
+
+	memset(bgColour, 0, sizeof(bgColour));
+	memset(objColour, 0, sizeof(objColour));
+	memset(objAttr, 0, sizeof(objAttr));
+
+	// Background
+	if(lcdc & PPU_LCDC_BG_ENABLE)
+	{
+		uint16_t map = (lcdc & PPU_LCDC_BG_MAP) ? 0x9C00 : 0x9800;
+		uint8_t y = ly + memory[PPU_REG_SCY];
+		const uint8_t* row = NULL;
+
+		for(uint8_t x = 0; x < PPU_SCREEN_WIDTH; x++)
+		{
+			uint8_t mapX = x + memory[PPU_REG_SCX];
+			if((row == NULL) || ((mapX & 7) == 0))
+			{
+				row = ppuTileRow(gb, ppuBgTile(lcdc, memory[map + (y / 8) * 32 + (mapX / 8)]), y & 7);
+			}
+			bgColour[x] = row[mapX & 7];
+		}
+	}
+
+	// Window. Drawn over the background from WX - 7 onwards
+	if((lcdc & PPU_LCDC_BG_ENABLE) && (lcdc & PPU_LCDC_WINDOW_ENABLE) && (ly >= memory[PPU_REG_WY]) &&
+		(memory[PPU_REG_WX] <= 166))
+	{
+		uint16_t map = (lcdc & PPU_LCDC_WINDOW_MAP) ? 0x9C00 : 0x9800;
+		int16_t start = memory[PPU_REG_WX] - 7;
+		uint8_t y = ppu->windowLine;
+		const uint8_t* row = NULL;
+
+		for(int16_t x = (start < 0) ? 0 : start; x < PPU_SCREEN_WIDTH; x++)
+		{
+			uint8_t mapX = x - start;
+			if((row == NULL) || ((mapX & 7) == 0))
+			{
+				row = ppuTileRow(gb, ppuBgTile(lcdc, memory[map + (y / 8) * 32 + (mapX / 8)]), y & 7);
+			}
+			bgColour[x] = row[mapX & 7];
+		}
+		ppu->windowLine++;
+	}
+
+	// Sprites. Up to 10 per line, picked in OAM order. Where they overlap, the one with the lower X wins, then the
+	// one earlier in OAM
+	if(lcdc & PPU_LCDC_OBJ_ENABLE)
+	{
+		const uint8_t* oam = &memory[0xFE00];
+		uint8_t selected[PPU_OBJS_PER_LINE];
+		uint8_t count = ppuScanOam(gb, selected);
+
+		// Stable insertion sort by X, so equal X keeps OAM order
+		for(uint8_t i = 1; i < count; i++)
+		{
+			uint8_t index = selected[i];
+			uint8_t j = i;
+			while((j > 0) && (oam[selected[j - 1] * 4 + 1] > oam[index * 4 + 1]))
+			{
+				selected[j] = selected[j - 1];
+				j--;
+			}
+			selected[j] = index;
+		}
+
+		for(uint8_t i = 0; i < count; i++)
+		{
+			const uint8_t* obj = &oam[selected[i] * 4];
+			const uint8_t* row = ppuObjRow(gb, obj);
+
+			for(uint8_t column = 0; column < 8; column++)
+			{
+				int16_t x = obj[1] - 8 + column;
+				uint8_t colour = 0;
+
+				// Pixels already taken by a higher priority sprite are skipped, even if that sprite is behind the
+				// background there
+				if((x < 0) || (x >= PPU_SCREEN_WIDTH) || (objColour[x] != 0))
+				{
+					continue;
+				}
+				colour = row[(obj[3] & PPU_OBJ_FLIP_X) ? (7 - column) : column];
+				if(colour != 0)
+				{
+					objColour[x] = colour;
+					objAttr[x] = obj[3];
+				}
+			}
+		}
+	}
+
+	composeLine(line, bgColour, objColour, objAttr, PPU_SCREEN_WIDTH, memory[PPU_REG_BGP], memory[PPU_REG_OBP0],
+		memory[PPU_REG_OBP1]);
+}
+
+/*
+ * @brief Sets up the pixel FIFO for a new line, at the start of mode 3
+ * @param gb Pointer to gb struct containing memory
+ * @return void
+ */
+static void ppuFifoStart(gameBoy_t* gb)
+{
+	ppu_t* ppu = &gb->ppu;
+	ppuFifo_t* fifo = &ppu->fifo;
+	bool wyTriggered = fifo->wyTriggered && (ppu->ly != 0);
+
+	memset(fifo, 0, sizeof(ppuFifo_t));
+	fifo->active = true;
+	fifo->wyTriggered = wyTriggered || (ppu->ly == gb->memory[PPU_REG_WY]);
+	fifo->discard = gb->memory[PPU_REG_SCX] & 7;
+	fifo->fetchDummy = true;
+	fifo->objPending = -1;
+	fifo->objCount = ppuScanOam(gb, fifo->objSelected);
+}
+
+/*
+ * @brief Runs the background fetcher for one clock cycle
+ * @param gb Pointer to gb struct containing memory
+ * @return void
+ */
+static void ppuFifoFetch(gameBoy_t* gb)
+{
+	const uint8_t* memory = gb->memory;
+	ppuFifo_t* fifo = &gb->ppu.fifo;
+	uint8_t lcdc = memory[PPU_REG_LCDC];
+	uint8_t y = fifo->window ? gb->ppu.windowLine : (uint8_t)(gb->ppu.ly + memory[PPU_REG_SCY]);
+
+	if(fifo->fetchStep == 3)
+	{
+		// Push, which waits for the FIFO to be empty
+		if(fifo->bgCount == 0)
+		{
+			memcpy(fifo->bgColour, fifo->fetchRow, PPU_TILE_SIZE);
+			fifo->bgCount = PPU_TILE_SIZE;
+			fifo->fetchX++;
+			fifo->fetchStep = 0;
+		}
+		return;
+	}
+
+	if(++fifo->fetchCycles < 2)
+	{
+		return;
+	}
+	fifo->fetchCycles = 0;
+
+	if(fifo->fetchStep == 0)
+	{
+		// SCX is read on every tile, so coarse scroll changes take effect from the next tile
+		if(fifo->window)
+		{
+			uint16_t map = (lcdc & PPU_LCDC_WINDOW_MAP) ? 0x9C00 : 0x9800;
+			fifo->fetchTile = memory[map + (y / 8) * 32 + (fifo->fetchX & 31)];
+		}
+		else
+		{
+			uint16_t map = (lcdc & PPU_LCDC_BG_MAP) ? 0x9C00 : 0x9800;
+			fifo->fetchTile = memory[map + (y / 8) * 32 + (((memory[PPU_REG_SCX] / 8) + fifo->fetchX) & 31)];
+		}
+	}
+	else if(fifo->fetchStep == 2)
+	{
+		// Both data bytes are taken from the tile cache here, rather than one per step
+		memcpy(fifo->fetchRow, ppuTileRow(gb, ppuBgTile(lcdc, fifo->fetchTile), y & 7), PPU_TILE_SIZE);
+		if(fifo->fetchDummy)
+		{
+			fifo->fetchDummy = false;
+			fifo->fetchStep = 0;
+			return;
+		}
+	}
+	fifo->fetchStep++;
+}
+
+/*
+ * @brief Merges a fetched sprite into the sprite FIFO
+ * @param gb Pointer to gb struct containing memory
+ * @param obj Sprite's 4 bytes of OAM
+ * @return void
+ * @note Only transparent entries are filled, so sprites fetched earlier (lower X, then lower OAM index) win
+ */
+static void ppuFifoMergeObj(gameBoy_t* gb, const uint8_t* obj)
+{
+	ppuFifo_t* fifo = &gb->ppu.fifo;
+	const uint8_t* row = ppuObjRow(gb, obj);
+	// Sprites partly off the left edge start part way in
+	uint8_t skip = (obj[1] < 8) ? (8 - obj[1]) : 0;
+
+	for(uint8_t column = skip; column < 8; column++)
+	{
+		uint8_t slot = (fifo->objHead + column - skip) & 7;
+		uint8_t colour = row[(obj[3] & PPU_OBJ_FLIP_X) ? (7 - column) : column];
+
+		if((fifo->objColour[slot] == 0) && (colour != 0))
+		{
+			fifo->objColour[slot] = colour;
+			fifo->objAttr[slot] = obj[3];
+		}
+	}
+}
+
+/*
+ * @brief Runs the pixel FIFO renderer for one clock cycle of mode 3
+ * @param gb Pointer to gb struct containing memory
+ * @return true once the last pixel of the line has been output, false otherwise
+ * @note Mode 3 length falls out of this: 6 cycles for the thrown away first fetch, 6 for the first real one, then a
+ * pixel per cycle (172 in all), plus SCX % 8 discarded pixels, 6 when the window starts and 6-11 per sprite
+ */
+static bool ppuFifoDot(gameBoy_t* gb)
+{
+	const uint8_t* memory = gb->memory;
+	ppu_t* ppu = &gb->ppu;
+	ppuFifo_t* fifo = &ppu->fifo;
+	uint8_t lcdc = memory[PPU_REG_LCDC];
+	uint8_t bg = 0;
+	uint8_t obj = 0;
+	uint8_t attr = 0;
+	uint32_t colour = 0;
+
+	// A sprite at the current X pauses output while it's fetched. Sprites partly off the left edge are all due at once,
+	// in which case the lowest X goes first so it wins where they overlap
+	if((fifo->objPending < 0) && (lcdc & PPU_LCDC_OBJ_ENABLE) && (fifo->discard == 0))
+	{
+		for(uint8_t i = 0; i < fifo->objCount; i++)
+		{
+			uint8_t objX = memory[0xFE00 + fifo->objSelected[i] * 4 + 1];
+
+			if(!(fifo->objFetched & (1 << i)) && (objX <= fifo->x + 8) && ((fifo->objPending < 0) ||
+				(objX < memory[0xFE00 + fifo->objSelected[fifo->objPending] * 4 + 1])))
+			{
+				fifo->objPending = i;
+			}
+		}
+		if(fifo->objPending >= 0)
+		{
+			fifo->objFetched |= 1 << fifo->objPending;
+			fifo->objCycles = 0;
+		}
+	}
+	if(fifo->objPending >= 0)
+	{
+		// The background fetcher gets to finish its current tile first
+		if(fifo->fetchStep < 3)
+		{
+			ppuFifoFetch(gb);
+			if(fifo->fetchStep < 3)
+			{
+				return false;
+			}
+		}
+		if(++fifo->objCycles == 6)
+		{
+			ppuFifoMergeObj(gb, &memory[0xFE00 + fifo->objSelected[fifo->objPending] * 4]);
+			fifo->objPending = -1;
+		}
+		return false;
+	}
+
+	// The window restarts the fetcher from its first tile. With WX < 7 its first 7 - WX pixels are off the left edge
+	if(!fifo->window && (lcdc & PPU_LCDC_WINDOW_ENABLE) && fifo->wyTriggered &&
+		(fifo->x + 7 >= memory[PPU_REG_WX]))
+	{
+		fifo->window = true;
+		fifo->discard = (memory[PPU_REG_WX] < 7) ? (7 - memory[PPU_REG_WX]) : 0;
+		fifo->bgCount = 0;
+		fifo->fetchStep = 0;
+		fifo->fetchCycles = 0;
+		fifo->fetchX = 0;
+	}
+
+	ppuFifoFetch(gb);
+	if(fifo->bgCount == 0)
+	{
+		return false;
+	}
+	bg = fifo->bgColour[PPU_TILE_SIZE - fifo->bgCount];
+	fifo->bgCount--;
+	if(fifo->discard > 0)
+	{
+		fifo->discard--;
+		return false;
+	}
+
+	obj = fifo->objColour[fifo->objHead];
+	attr = fifo->objAttr[fifo->objHead];
+	fifo->objColour[fifo->objHead] = 0;
+	fifo->objHead = (fifo->objHead + 1) & 7;
+
+	// Palettes and the layer enables are applied as each pixel goes out
+	if(!(lcdc & PPU_LCDC_BG_ENABLE))
+	{
+		bg = 0;
+	}
+	if(!(lcdc & PPU_LCDC_OBJ_ENABLE))
+	{
+		obj = 0;
+	}
+	// Sprites flagged as behind the background only show over colour 0
+	colour = ppu->palettes[0][bg];
+	if((obj != 0) && !((attr & PPU_OBJ_BEHIND_BG) && (bg != 0)))
+	{
+		colour = ppu->palettes[(attr & PPU_OBJ_PALETTE) ? 2 : 1][obj];
+	}
+	ppu->framebuffer[ppu->ly * PPU_SCREEN_WIDTH + fifo->x] = colour;
+	fifo->x++;
+
+	return fifo->x == PPU_SCREEN_WIDTH;
+}
+
+/*
+ * @brief Updates LY, the STAT mode/coincidence bits and the STAT interrupt line after any change to them
+ * @param gb Pointer to gb struct containing memory
+ * @return void
+ */
+static void ppuUpdateStat(gameBoy_t* gb)
+{
+	ppu_t* ppu = &gb->ppu;
+	uint8_t stat = (gb->memory[PPU_REG_STAT] & 0x78) | 0x80 | ppu->mode;
+	bool statLine = false;
+
+	if(ppu->ly == gb->memory[PPU_REG_LYC])
+	{
+		stat |= PPU_STAT_COINCIDENCE;
+	}
+
+	gb->memory[PPU_REG_LY] = ppu->ly;
+	gb->memory[PPU_REG_STAT] = stat;
+
+	if(gb->memory[PPU_REG_LCDC] & PPU_LCDC_ENABLE)
+	{
+		statLine = ((stat & PPU_STAT_INT_LYC) && (stat & PPU_STAT_COINCIDENCE)) ||
+			((stat & PPU_STAT_INT_HBLANK) && (ppu->mode == PPU_MODE_HBLANK)) ||
+			((stat & PPU_STAT_INT_VBLANK) && (ppu->mode == PPU_MODE_VBLANK)) ||
+			((stat & PPU_STAT_INT_OAM) && (ppu->mode == PPU_MODE_OAM_SCAN));
+	}
+	if(statLine && !ppu->statLine)
+	{
+		interruptsRequest(gb, GB_INT_STAT);
+	}
+	ppu->statLine = statLine;
+}
+
+/*
+ * @brief Schedules SCHED_EVENT_PPU for the next mode change that requests an interrupt
+ * @param gb Pointer to gb struct containing the PPU
+ * @return void
+ * @details Walks forward through the coming mode changes until one would request VBlank or (going by the STAT
+	interrupt enables and LYC) STAT. Most games only enable a few of them, so the CPU is usually only stopped once or
+	twice a frame rather than at every mode change
+ * @note The PPU must be synced up to the CPU. In FIFO mode the end of mode 3 isn't known in advance, so the event is
+ * set for the soonest it could be (a cycle per pixel left) and moved on from there
+ */
+static void ppuSchedule(gameBoy_t* gb)
+{
+	ppu_t* ppu = &gb->ppu;
+	uint8_t stat = gb->memory[PPU_REG_STAT];
+	uint8_t lyc = gb->memory[PPU_REG_LYC];
+	uint64_t time = ppu->cycles;
+	uint16_t lineCycles = ppu->lineCycles;
+	uint8_t ly = ppu->ly;
+	uint8_t mode = ppu->mode;
+
+	if(!(gb->memory[PPU_REG_LCDC] & PPU_LCDC_ENABLE))
+	{
+		schedCancel(gb, SCHED_EVENT_PPU);
+		return;
+	}
+
+	for(;;)
+	{
+		if(mode == PPU_MODE_OAM_SCAN)
+		{
+			time += PPU_CYCLES_MODE_2 - lineCycles;
+			lineCycles = PPU_CYCLES_MODE_2;
+			mode = PPU_MODE_DRAWING;
+		}
+		else if(mode == PPU_MODE_DRAWING)
+		{
+			if(stat & PPU_STAT_INT_HBLANK)
+			{
+				uint16_t end = PPU_CYCLES_MODE_2 + PPU_CYCLES_MODE_3;
+				if((ppu->mode == PPU_MODE_DRAWING) && ppu->fifo.active && (ly == ppu->ly))
+				{
+					end = lineCycles + (PPU_SCREEN_WIDTH - ppu->fifo.x);
+				}
+				time += end - lineCycles;
+				break;
+			}
+			// Nothing to request at the start of HBlank, so time can carry on from here to the end of the line
+			mode = PPU_MODE_HBLANK;
+		}
+		else
+		{
+			// End of the line
+			time += PPU_CYCLES_PER_LINE - lineCycles;
+			lineCycles = 0;
+			ly++;
+			if(ly == PPU_SCREEN_HEIGHT)
+			{
+				break;
+			}
+			if(ly == PPU_LINES_PER_FRAME)
+			{
+				ly = 0;
+			}
+			mode = (ly < PPU_SCREEN_HEIGHT) ? PPU_MODE_OAM_SCAN : PPU_MODE_VBLANK;
+			if(((stat & PPU_STAT_INT_LYC) && (ly == lyc)) || ((stat & PPU_STAT_INT_OAM) && (mode == PPU_MODE_OAM_SCAN)))
+			{
+				break;
+			}
+		}
+	}
+
+	schedAdd(gb, SCHED_EVENT_PPU, time);
+}
+
+/*
+ * @brief Sets up the PPU as the boot ROM leaves it: LCD on, at the start of line 0
+ * @param gb Pointer to gb struct containing memory
+ * @return void
+ */
+void ppuInit(gameBoy_t* gb)
+{
+	memset(&gb->ppu, 0, sizeof(ppu_t));
+	gb->memory[PPU_REG_LCDC] = 0x91;
+	gb->memory[PPU_REG_BGP] = 0xFC;
+	gb->memory[PPU_REG_OBP0] = 0xFF;
+	gb->memory[PPU_REG_OBP1] = 0xFF;
+	ppuDecodePalettes(gb);
+	gb->ppu.mode = PPU_MODE_OAM_SCAN;
+	gb->ppu.cycles = gb->cyclesCurrent;
+	ppuInvalidateTiles(gb);
+	ppuUpdateStat(gb);
+	ppuSchedule(gb);
+}
+
+/*
+ * @brief Handler for SCHED_EVENT_PPU. Catches up to the mode change it was scheduled for and schedules the next one
+ * @param gb Pointer to gb struct containing the PPU
+ * @return void
+ */
+void ppuEvent(gameBoy_t* gb)
+{
+	ppuSync(gb);
+	ppuSchedule(gb);
+}
+
+/*
+ * @brief Picks how lines are drawn: fast whole scanlines, or an accurate pixel FIFO
+ * @param gb Pointer to gb struct containing the PPU
+ * @param renderer PPU_RENDERER_SCANLINE (the default) or PPU_RENDERER_FIFO
+ * @return void
+ * @note Takes effect from the next line
+ */
+void ppuSetRenderer(gameBoy_t* gb, ppuRenderer_t renderer)
+{
+	ppuSync(gb);
+	gb->ppu.renderer = renderer;
+}
+
+/*
+ * @brief Catches the PPU up to the CPU, rendering every line it passes the end of
+ * @param gb Pointer to gb struct containing memory
+ * @return void
+ * @note Only mode changes do any work, so catching up over a whole frame is ~460 iterations plus rendering
+ */
+void ppuSync(gameBoy_t* gb)
+{
+	ppu_t* ppu = &gb->ppu;
+	uint64_t target = gb->cyclesCurrent;
+
+	if(!(gb->memory[PPU_REG_LCDC] & PPU_LCDC_ENABLE))
+	{
+		ppu->cycles = target;
+		return;
+	}
+
+	while(ppu->cycles < target)
+	{
+		uint16_t boundary = PPU_CYCLES_PER_LINE;
+		uint64_t step = 0;
+
+		if((ppu->mode == PPU_MODE_DRAWING) && ppu->fifo.active)
+		{
+			// Mode 3 lasts however long the pixel FIFO takes to output the line
+			bool done = false;
+			while((ppu->cycles < target) && !done)
+			{
+				done = ppuFifoDot(gb);
+				ppu->cycles++;
+				ppu->lineCycles++;
+			}
+			if(done)
+			{
+				if(ppu->fifo.window)
+				{
+					ppu->windowLine++;
+				}
+				ppu->mode = PPU_MODE_HBLANK;
+				ppuUpdateStat(gb);
+			}
+			continue;
+		}
+
+		if(ppu->mode == PPU_MODE_OAM_SCAN)
+		{
+			boundary = PPU_CYCLES_MODE_2;
+		}
+		else if(ppu->mode == PPU_MODE_DRAWING)
+		{
+			boundary = PPU_CYCLES_MODE_2 + PPU_CYCLES_MODE_3;
+		}
+
+		step = boundary - ppu->lineCycles;
+		if(ppu->cycles + step > target)
+		{
+			ppu->lineCycles += target - ppu->cycles;
+			ppu->cycles = target;
+			break;
+		}
+		ppu->cycles += step;
+		ppu->lineCycles = boundary;
+
+		switch(ppu->mode)
+		{
+			case PPU_MODE_OAM_SCAN:
+				ppu->mode = PPU_MODE_DRAWING;
+				ppu->fifo.active = false;
+				if(ppu->renderer == PPU_RENDERER_FIFO)
+				{
+					ppuFifoStart(gb);
+				}
+				break;
+			case PPU_MODE_DRAWING:
+				ppuRenderLine(gb);
+				ppu->mode = PPU_MODE_HBLANK;
+				break;
+			default:
+				// End of the line
+				ppu->lineCycles = 0;
+				ppu->ly++;
+				if(ppu->ly == PPU_SCREEN_HEIGHT)
+				{
+					ppu->mode = PPU_MODE_VBLANK;
+					ppu->frameCount++;
+					memcpy(ppu->frame, ppu->framebuffer, sizeof(ppu->frame));
+					interruptsRequest(gb, GB_INT_VBLANK);
+				}
+				else if(ppu->ly == PPU_LINES_PER_FRAME)
+				{
+					ppu->ly = 0;
+					ppu->windowLine = 0;
+					ppu->mode = PPU_MODE_OAM_SCAN;
+				}
+				else if(ppu->ly < PPU_SCREEN_HEIGHT)
+				{
+					ppu->mode = PPU_MODE_OAM_SCAN;
+				}
+				break;
+		}
+		ppuUpdateStat(gb);
+	}
+}
+
+/*
+ * @brief Returns the soonest cycle count LY or STAT could change at without being written
+ * @param gb Pointer to gb struct containing memory
+ * @param addr Register address (PPU_REG_LY or PPU_REG_STAT)
+ * @return Cycle count, or UINT64_MAX while the LCD is off
+ * @note Used to skip idle loops polling LY/STAT (see idle.c). With the pixel FIFO, mode 3 is assumed to output a pixel
+ * every cycle from here on, which is as early as it can end
+ */
+uint64_t ppuNextChange(gameBoy_t* gb, uint16_t addr)
+{
+	ppu_t* ppu = &gb->ppu;
+	uint16_t boundary = PPU_CYCLES_PER_LINE;
+
+	if(!(gb->memory[PPU_REG_LCDC] & PPU_LCDC_ENABLE))
+	{
+		return UINT64_MAX;
+	}
+
+	ppuSync(gb);
+	// LY only changes at the end of the line, STAT at every mode change
+	if(addr == PPU_REG_STAT)
+	{
+		if(ppu->mode == PPU_MODE_OAM_SCAN)
+		{
+			boundary = PPU_CYCLES_MODE_2;
+		}
+		else if(ppu->mode == PPU_MODE_DRAWING)
+		{
+			boundary = ppu->fifo.active ? (ppu->lineCycles + (PPU_SCREEN_WIDTH - ppu->fifo.x)) :
+				(PPU_CYCLES_MODE_2 + PPU_CYCLES_MODE_3);
+		}
+	}
+
+	return ppu->cycles + (boundary - ppu->lineCycles);
+}
+
+/*
+ * @brief Handles a write to one of the PPU registers (0xFF40-0xFF4B, except DMA)
+ * @param gb Pointer to gb struct containing memory
+ * @param addr Register address
+ * @param value 8-bit value written
+ * @return void
+ * @note The PPU must already have been synced up to the write
+ */
+void ppuWriteRegister(gameBoy_t* gb, uint16_t addr, uint8_t value)
+{
+	ppu_t* ppu = &gb->ppu;
+
+	switch(addr)
+	{
+		case PPU_REG_LCDC:
+			if((value ^ gb->memory[PPU_REG_LCDC]) & PPU_LCDC_ENABLE)
+			{
+				// Turning the LCD off or on restarts it from the top of line 0
+				ppu->ly = 0;
+				ppu->lineCycles = 0;
+				ppu->windowLine = 0;
+				ppu->mode = (value & PPU_LCDC_ENABLE) ? PPU_MODE_OAM_SCAN : PPU_MODE_HBLANK;
+				if(!(value & PPU_LCDC_ENABLE))
+				{
+					// The screen goes blank, and stays that way until the first frame after it's turned back on
+					for(uint32_t i = 0; i < PPU_SCREEN_WIDTH * PPU_SCREEN_HEIGHT; i++)
+					{
+						ppu->frame[i] = PPU_COLOUR_OFF;
+					}
+				}
+			}
+			gb->memory[addr] = value;
+			break;
+		case PPU_REG_STAT:
+			// Only the interrupt enables are writable
+			gb->memory[addr] = (value & 0x78) | (gb->memory[addr] & 0x07);
+			break;
+		case PPU_REG_LYC:
+			gb->memory[addr] = value;
+			break;
+		case PPU_REG_LY:
+			// Read only
+			return;
+		case PPU_REG_BGP:
+		case PPU_REG_OBP0:
+		case PPU_REG_OBP1:
+			gb->memory[addr] = value;
+			for(uint8_t colour = 0; colour < 4; colour++)
+			{
+				ppu->palettes[addr - PPU_REG_BGP][colour] = composeColour(value, colour);
+			}
+			return;
+		default:
+			gb->memory[addr] = value;
+			return;
+	}
+
+	// LCD on/off, the STAT interrupt enables and LYC all change which mode changes need an event
+	ppuUpdateStat(gb);
+	ppuSchedule(gb);
+}
+
+/*
+ * @brief Marks the tile holding a VRAM address as needing to be decoded again
+ * @param gb Pointer to gb struct containing the PPU
+ * @param addr VRAM address written to
+ * @return void
+ * @note Called by the bus for every VRAM write. Tile map writes (0x9800 onwards) don't touch the cache
+ */
+void ppuWriteVram(gameBoy_t* gb, uint16_t addr)
+{
+	if(addr < PPU_ADDR_TILE_MAP)
+	{
+		uint16_t tile = (addr - PPU_ADDR_TILE_DATA) / PPU_TILE_BYTES;
+		gb->ppu.tileDirty[tile >> 6] |= 1ULL << (tile & 63);
+	}
+}
+
+/*
+ * @brief Marks every tile as needing to be decoded again
+ * @param gb Pointer to gb struct containing the PPU
+ * @return void
+ * @note For anything that changes VRAM without going through the bus, e.g. writing gb->memory directly
+ */
+void ppuInvalidateTiles(gameBoy_t* gb)
+{
+	memset(gb->ppu.tileDirty, 0xFF, sizeof(gb->ppu.tileDirty));
+}
+
+/*
+ * @brief Decodes BGP, OBP0 and OBP1 into ppu.palettes
+ * @param gb Pointer to gb struct containing the PPU
+ * @return void
+ * @note For anything that changes the palette registers without going through the bus, e.g. loading a save state
+ */
+void ppuDecodePalettes(gameBoy_t* gb)
+{
+	for(uint8_t p = 0; p < 3; p++)
+	{
+		for(uint8_t colour = 0; colour < 4; colour++)
+		{
+			gb->ppu.palettes[p][colour] = composeColour(gb->memory[PPU_REG_BGP + p], colour);
+		}
+	}
+}
+
+/*
+ * @brief Returns the last frame the PPU completed (or a blank screen while the LCD is off)
+ * @param gb Pointer to gb struct containing the PPU
+ * @return PPU_SCREEN_WIDTH x PPU_SCREEN_HEIGHT ARGB8888 pixels, row by row
+ * @note Never has lines from two frames, wherever the frame in progress is. Turning the LCD off and on moves where
+ * frames start relative to gbRunFrame's frame boundaries
+ */
+const uint32_t* ppuGetFrame(gameBoy_t* gb)
+{
+	ppuSync(gb);
+	return gb->ppu.frame;
+}
@@ -0,0 +1,360 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "gb.h"
+#include "rewind.h"
+#include "state.h"
+
+/*
+ * rewind.c: Rewind history. A save state is taken every few frames. The newest is kept whole, and each older one as
+ * the XOR of it with the one after it, which is mostly zeros since little changes in a few frames. The deltas are run
+ * length encoded into a ring of bytes, the oldest being dropped to make room. Stepping back XORs the newest delta
+ * into the whole state, which turns it into the one before, so each step only decodes one delta.
+ * A delta is a run of tokens: the number of unchanged bytes, the number of changed bytes, then the changed bytes
+ * (XORed), the two counts being LEB128 varints
+ */
+
+struct rewind
+{
+	uint32_t interval;
+	uint32_t frames; 	// Frames run since the newest state was taken, or restored
+	size_t stateSize; 	// 0 until the first state is taken
+	uint8_t* current; 	// Newest state
+	uint8_t* next; 		// Scratch for the state being taken
+	uint8_t* scratch; 	// Scratch for encoding/decoding a delta
+	// Deltas, oldest first, in a ring of bytes. Each one ends where the next starts
+	uint8_t* data;
+	size_t capacity;
+	size_t head; 		// Where the next delta goes
+	size_t used;
+	// Size of each delta, in a ring of its own. The newest is the one before sizes[(first + count) % maxDeltas]
+	uint32_t* sizes;
+	uint32_t maxDeltas;
+	uint32_t first;
+	uint32_t count;
+};
+
+/*
+ * @brief Returns the most a delta of a state can take once encoded
+ * @note Runs of changed bytes only end at REWIND_MIN_ZERO_RUN unchanged ones, so each token covers at least that many
+ * bytes more than its two counts take, bar the first and last
+ */
+static size_t rewindEncodedBound(size_t size)
+{
+	return size + (size / REWIND_MIN_ZERO_RUN) * 2 + 32;
+}
+
+/*
+ * @brief Appends a LEB128 varint
+ * @return Where the next byte goes
+ */
+static uint8_t* rewindPutVarint(uint8_t* out, size_t value)
+{
+	while(value >= 0x80)
+	{
+		*out++ = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	*out++ = (uint8_t)value;
+
+	return out;
+}
+
+/*
+ * @brief Reads a LEB128 varint
+ * @return Where the next byte is
+ */
+static const uint8_t* rewindGetVarint(const uint8_t* in, size_t* value)
+{
+	uint8_t shift = 0;
+
+	*value = 0;
+	do
+	{
+		*value |= (size_t)(*in & 0x7F) << shift;
+		shift += 7;
+	} while(*in++ & 0x80);
+
+	return in;
+}
+
+/*
+ * @brief Returns how many bytes from position on are the same in both states, up to size
+ * @note Goes a word at a time, as most of a delta is unchanged bytes
+ */
+static size_t rewindSameRun(const uint8_t* a, const uint8_t* b, size_t position, size_t size)
+{
+	size_t start = position;
+
+	while((position + sizeof(uint64_t) <= size))
+	{
+		uint64_t wordA;
+		uint64_t wordB;
+
+		memcpy(&wordA, &a[position], sizeof(wordA));
+		memcpy(&wordB, &b[position], sizeof(wordB));
+		if(wordA != wordB)
+		{
+			break;
+		}
+		position += sizeof(uint64_t);
+	}
+	while((position < size) && (a[position] == b[position]))
+	{
+		position++;
+	}
+
+	return position - start;
+}
+
+/*
+ * @brief Encodes the XOR of two states
+ * @param a, b The states
+ * @param size Size of each
+ * @param out Where to encode to. Must have room for rewindEncodedBound(size)
+ * @return Size of the encoded delta
+ */
+static size_t rewindEncode(const uint8_t* a, const uint8_t* b, size_t size, uint8_t* out)
+{
+	uint8_t* start = out;
+	size_t position = 0;
+
+	while(position < size)
+	{
+		size_t same = rewindSameRun(a, b, position, size);
+		size_t changed = position + same;
+		size_t end = changed;
+
+		// Carry on through short runs of unchanged bytes, as a new token would cost more than it saves
+		while(end < size)
+		{
+			size_t run = rewindSameRun(a, b, end, size);
+			if((run >= REWIND_MIN_ZERO_RUN) || (end + run == size))
+			{
+				break;
+			}
+			end += run;
+			while((end < size) && (a[end] != b[end]))
+			{
+				end++;
+			}
+		}
+
+		out = rewindPutVarint(out, same);
+		out = rewindPutVarint(out, end - changed);
+		for(size_t i = changed; i < end; i++)
+		{
+			*out++ = a[i] ^ b[i];
+		}
+		position = end;
+	}
+
+	return (size_t)(out - start);
+}
+
+/*
+ * @brief XORs an encoded delta into a state
+ * @param in Encoded delta
+ * @param length Size of the encoded delta
+ * @param state State to apply it to
+ * @return void
+ */
+static void rewindDecode(const uint8_t* in, size_t length, uint8_t* state)
+{
+	const uint8_t* end = in + length;
+	size_t position = 0;
+
+	while(in < end)
+	{
+		size_t same = 0;
+		size_t changed = 0;
+
+		in = rewindGetVarint(in, &same);
+		in = rewindGetVarint(in, &changed);
+		position += same;
+		for(size_t i = 0; i < changed; i++)
+		{
+			state[position++] ^= *in++;
+		}
+	}
+}
+
+/*
+ * @brief Copies bytes into or out of the ring of deltas, wrapping around its end
+ * @param toRing true to copy from buffer into the ring at offset, false to copy out of it
+ */
+static void rewindCopy(rewind_t* history, size_t offset, uint8_t* buffer, size_t size, bool toRing)
+{
+	size_t first = (size < history->capacity - offset) ? size : (history->capacity - offset);
+
+	if(toRing)
+	{
+		memcpy(&history->data[offset], buffer, first);
+		memcpy(history->data, &buffer[first], size - first);
+	}
+	else
+	{
+		memcpy(buffer, &history->data[offset], first);
+		memcpy(&buffer[first], history->data, size - first);
+	}
+}
+
+/*
+ * @brief Forgets every delta
+ */
+static void rewindClear(rewind_t* history)
+{
+	history->head = 0;
+	history->used = 0;
+	history->first = 0;
+	history->count = 0;
+}
+
+/*
+ * @brief Allocates an empty rewind history
+ * @param capacity Bytes of compressed deltas to keep. The newest state and scratch space come on top
+ * @param interval Frames between two states
+ * @return Pointer to the history. Exits if out of memory
+ */
+rewind_t* rewindCreate(size_t capacity, uint32_t interval)
+{
+	rewind_t* history = calloc(1, sizeof(rewind_t));
+
+	if(history == NULL)
+	{
+		printf("Rewind allocation error\r\n");
+		exit(1);
+	}
+	history->interval = (interval > 0) ? interval : 1;
+	history->capacity = capacity;
+	// Deltas are rarely under 256 bytes, so the table of sizes runs out about when the bytes do
+	history->maxDeltas = (uint32_t)(capacity / 256) + 1;
+	history->data = malloc(capacity);
+	history->sizes = malloc(history->maxDeltas * sizeof(uint32_t));
+	if((history->data == NULL) || (history->sizes == NULL))
+	{
+		printf("Rewind allocation error\r\n");
+		exit(1);
+	}
+
+	return history;
+}
+
+/*
+ * @brief Frees a rewind history
+ */
+void rewindDestroy(rewind_t* history)
+{
+	free(history->current);
+	free(history->next);
+	free(history->scratch);
+	free(history->data);
+	free(history->sizes);
+	free(history);
+}
+
+/*
+ * @brief Called after each frame run. Takes a state every interval frames, adding the one before to the history
+ * @param history Pointer to the rewind history
+ * @param gb Pointer to gb struct
+ * @return void
+ * @note Costs a save state and one pass over it every interval frames, a small fraction of a frame's time
+ */
+void rewindFrame(rewind_t* history, gameBoy_t* gb)
+{
+	size_t size = 0;
+	size_t length = 0;
+	uint8_t* swap = NULL;
+
+	if(++history->frames < history->interval)
+	{
+		return;
+	}
+	history->frames = 0;
+
+	size = stateSize(gb);
+	if(size != history->stateSize)
+	{
+		// First state, or a different cartridge: deltas can't span the change
+		history->current = realloc(history->current, size);
+		history->next = realloc(history->next, size);
+		history->scratch = realloc(history->scratch, rewindEncodedBound(size));
+		if((history->current == NULL) || (history->next == NULL) || (history->scratch == NULL))
+		{
+			printf("Rewind allocation error\r\n");
+			exit(1);
+		}
+		history->stateSize = size;
+		rewindClear(history);
+		stateSave(gb, history->current, size);
+		return;
+	}
+
+	stateSave(gb, history->next, size);
+	length = rewindEncode(history->current, history->next, size, history->scratch);
+	if(length > history->capacity)
+	{
+		// Older states can only be reached through this delta, so they're lost with it
+		rewindClear(history);
+	}
+	else
+	{
+		// Make room by dropping the oldest deltas
+		while((history->used + length > history->capacity) || (history->count == history->maxDeltas))
+		{
+			history->used -= history->sizes[history->first];
+			history->first = (history->first + 1) % history->maxDeltas;
+			history->count--;
+		}
+		rewindCopy(history, history->head, history->scratch, length, true);
+		history->head = (history->head + length) % history->capacity;
+		history->used += length;
+		history->sizes[(history->first + history->count) % history->maxDeltas] = (uint32_t)length;
+		history->count++;
+	}
+
+	swap = history->current;
+	history->current = history->next;
+	history->next = swap;
+}
+
+/*
+ * @brief Steps back to the previous state in the history
+ * @param history Pointer to the rewind history
+ * @param gb Pointer to gb struct, which the state is loaded into
+ * @return false if there's nothing further back, in which case gb is left as it was
+ * @note Goes back to the newest state first, if frames have been run since it was taken. Running frames after
+ * stepping back carries on the history from there
+ */
+bool rewindStep(rewind_t* history, gameBoy_t* gb)
+{
+	if(history->stateSize == 0)
+	{
+		return false;
+	}
+	if(history->frames == 0)
+	{
+		size_t length = 0;
+		size_t offset = 0;
+		uint32_t newest = 0;
+
+		if(history->count == 0)
+		{
+			return false;
+		}
+		newest = (history->first + history->count - 1) % history->maxDeltas;
+		length = history->sizes[newest];
+		offset = (history->head + history->capacity - length) % history->capacity;
+		rewindCopy(history, offset, history->scratch, length, false);
+		rewindDecode(history->scratch, length, history->current);
+		history->head = offset;
+		history->used -= length;
+		history->count--;
+	}
+	history->frames = 0;
+
+	return stateLoad(gb, history->current, history->stateSize);
+}
@@ -0,0 +1,122 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "ring.h"
+
+/*
+ * ring.c: Single producer, single consumer ring buffer, used to hand audio samples from the emulation thread to the
+ * audio callback. Neither side ever takes a lock or waits on the other: the producer drops what doesn't fit, and the
+ * consumer takes whatever is there. Each side only writes its own counter, and publishes it with a release store
+ * once the samples it covers have been copied, which the other side picks up with an acquire load
+ */
+
+/*
+ * @brief Allocates an empty ring buffer
+ * @param capacity Number of samples it can hold. Rounded up to a power of 2
+ * @return Pointer to the ring buffer. Free with ringDestroy
+ */
+ring_t* ringCreate(size_t capacity)
+{
+	ring_t* ring = aligned_alloc(_Alignof(ring_t), sizeof(ring_t));
+	size_t size = 1;
+
+	while(size < capacity)
+	{
+		size <<= 1;
+	}
+
+	if(ring != NULL)
+	{
+		ring->data = calloc(size, sizeof(int16_t));
+	}
+	if((ring == NULL) || (ring->data == NULL))
+	{
+		printf("Failed to allocate the audio ring buffer\r\n");
+		exit(1);
+	}
+	ring->mask = size - 1;
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+
+	return ring;
+}
+
+/*
+ * @brief Frees a ring buffer allocated by ringCreate
+ * @param ring Pointer to the ring buffer, or NULL
+ * @return void
+ * @note Neither side may be using it any more
+ */
+void ringDestroy(ring_t* ring)
+{
+	if(ring != NULL)
+	{
+		free(ring->data);
+		free(ring);
+	}
+}
+
+/*
+ * @brief Copies samples into the ring buffer. Only ever called from the producer thread
+ * @param ring Pointer to the ring buffer
+ * @param samples Samples to be added
+ * @param count Number of samples
+ * @return Number of samples added. Anything that didn't fit is dropped
+ */
+size_t ringPush(ring_t* ring, const int16_t* samples, size_t count)
+{
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+	size_t space = (ring->mask + 1) - (head - tail);
+	size_t first = 0;
+
+	if(count > space)
+	{
+		count = space;
+	}
+
+	// Up to the end of the buffer, then the rest from the start
+	first = (ring->mask + 1) - (head & ring->mask);
+	if(first > count)
+	{
+		first = count;
+	}
+	memcpy(&ring->data[head & ring->mask], samples, first * sizeof(int16_t));
+	memcpy(ring->data, samples + first, (count - first) * sizeof(int16_t));
+
+	atomic_store_explicit(&ring->head, head + count, memory_order_release);
+	return count;
+}
+
+/*
+ * @brief Copies samples out of the ring buffer. Only ever called from the consumer thread
+ * @param ring Pointer to the ring buffer
+ * @param samples Where to copy the samples to
+ * @param count Most samples to take
+ * @return Number of samples taken, which is less than count if the ring buffer ran dry
+ */
+size_t ringPop(ring_t* ring, int16_t* samples, size_t count)
+{
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+	size_t available = head - tail;
+	size_t first = 0;
+
+	if(count > available)
+	{
+		count = available;
+	}
+
+	first = (ring->mask + 1) - (tail & ring->mask);
+	if(first > count)
+	{
+		first = count;
+	}
+	memcpy(samples, &ring->data[tail & ring->mask], first * sizeof(int16_t));
+	memcpy(samples + first, ring->data, (count - first) * sizeof(int16_t));
+
+	atomic_store_explicit(&ring->tail, tail + count, memory_order_release);
+	return count;
+}
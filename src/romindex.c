@@ -0,0 +1,423 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "romindex.h"
+
+/*
+ * romindex.c: On-disk index of ROM metadata (header fields, CRC32 and SHA-1), built with `felixGB --index` or
+ * `felixGB-headless --index`. Runs given the index (felixGB-headless --rom-index) look ROMs up in it (romIndexLookup).
+ * Hashing a multi-MB ROM costs far more than reading its record back, so entries are reused for as long as the file's
+ * size and modification time are unchanged. All integers in the index file are little-endian.
+ * Record layout: name length (2), name, file size (8), mtime seconds (8), mtime nanoseconds (4), CRC32 (4), SHA-1 (20),
+ * title (16), cart type (1), MBC (1), flags (1: bit 0 header checksum valid, bit 1 global checksum valid),
+ * ROM size (4), RAM size (4)
+ */
+
+#define ROM_INDEX_FLAG_HEADER_CHECKSUM 0x01
+#define ROM_INDEX_FLAG_GLOBAL_CHECKSUM 0x02
+
+/*
+ * @brief Writes an integer to the index file, little-endian
+ */
+static void romIndexWriteInt(FILE* file, uint64_t value, uint8_t size)
+{
+	for(uint8_t i = 0; i < size; i++)
+	{
+		fputc((value >> (i * 8)) & 0xFF, file);
+	}
+}
+
+/*
+ * @brief Reads a little-endian integer from the index file
+ * @return false if the file ended first
+ */
+static bool romIndexReadInt(FILE* file, uint64_t* value, uint8_t size)
+{
+	*value = 0;
+	for(uint8_t i = 0; i < size; i++)
+	{
+		int c = fgetc(file);
+		if(c == EOF)
+		{
+			return false;
+		}
+		*value |= (uint64_t)c << (i * 8);
+	}
+
+	return true;
+}
+
+/*
+ * @brief Appends an entry to an index, growing it if needed
+ * @return Pointer to the new (zeroed) entry. Exits if out of memory
+ */
+static romIndexEntry_t* romIndexAppend(romIndex_t* index)
+{
+	if(index->count == index->capacity)
+	{
+		uint32_t capacity = (index->capacity == 0) ? 64 : (index->capacity * 2);
+		romIndexEntry_t* entries = realloc(index->entries, capacity * sizeof(romIndexEntry_t));
+		if(entries == NULL)
+		{
+			printf("ROM index allocation error\r\n");
+			exit(1);
+		}
+		index->entries = entries;
+		index->capacity = capacity;
+	}
+
+	memset(&index->entries[index->count], 0, sizeof(romIndexEntry_t));
+	return &index->entries[index->count++];
+}
+
+static int romIndexCompare(const void* a, const void* b)
+{
+	return strcmp(((const romIndexEntry_t*)a)->name, ((const romIndexEntry_t*)b)->name);
+}
+
+/*
+ * @brief Checks whether a file name looks like a GameBoy ROM
+ */
+static bool romIndexIsRom(const char* name)
+{
+	const char* extension = strrchr(name, '.');
+
+	return (extension != NULL) && ((strcasecmp(extension, ".gb") == 0) || (strcasecmp(extension, ".gbc") == 0) ||
+		(strcasecmp(extension, ".sgb") == 0));
+}
+
+/*
+ * @brief Hashes a ROM file and parses its header into an index entry
+ * @param path Path to the ROM file
+ * @param fileStat Result of stat() on the file
+ * @param entry Entry to fill in. The name is left to the caller
+ * @return false if the file couldn't be read
+ */
+static bool romIndexScanFile(const char* path, const struct stat* fileStat, romIndexEntry_t* entry)
+{
+	int fd = open(path, O_RDONLY);
+	const uint8_t* rom = NULL;
+	cartHeader_t header;
+
+	if(fd < 0)
+	{
+		return false;
+	}
+	if(fileStat->st_size == 0)
+	{
+		close(fd);
+		return false;
+	}
+	rom = mmap(NULL, fileStat->st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(rom == MAP_FAILED)
+	{
+		return false;
+	}
+	// Read front to back exactly once (CRC32, SHA-1 and the global checksum each make a pass)
+	madvise((void*)rom, fileStat->st_size, MADV_SEQUENTIAL);
+
+	header = cartParseHeader(rom, fileStat->st_size);
+	entry->fileSize = fileStat->st_size;
+	entry->mtimeSec = fileStat->st_mtim.tv_sec;
+	entry->mtimeNsec = fileStat->st_mtim.tv_nsec;
+	entry->crc32 = utilsCrc32(0, rom, fileStat->st_size);
+	utilsSha1(rom, fileStat->st_size, entry->sha1);
+	memcpy(entry->title, header.title, sizeof(entry->title));
+	entry->cartType = header.cartType;
+	entry->mbc = header.mbc;
+	entry->romSize = header.romSize;
+	entry->ramSize = header.ramSize;
+	entry->headerChecksumValid = header.headerChecksumValid;
+	entry->globalChecksumValid = header.globalChecksumValid;
+
+	munmap((void*)rom, fileStat->st_size);
+	return true;
+}
+
+/*
+ * @brief Reads an index file
+ * @param indexPath Path to the index file
+ * @param index Receives the entries. Left empty if the file is missing or invalid
+ * @return true if the index was read
+ */
+bool romIndexLoad(const char* indexPath, romIndex_t* index)
+{
+	FILE* file = fopen(indexPath, "rb");
+	char magic[sizeof(ROM_INDEX_MAGIC) - 1];
+	uint64_t version = 0;
+	uint64_t count = 0;
+
+	memset(index, 0, sizeof(romIndex_t));
+	if(file == NULL)
+	{
+		return false;
+	}
+
+	if((fread(magic, 1, sizeof(magic), file) != sizeof(magic)) || (memcmp(magic, ROM_INDEX_MAGIC, sizeof(magic)) != 0) ||
+		!romIndexReadInt(file, &version, 2) || (version != ROM_INDEX_VERSION) || !romIndexReadInt(file, &count, 4))
+	{
+		fclose(file);
+		return false;
+	}
+
+	for(uint64_t i = 0; i < count; i++)
+	{
+		romIndexEntry_t* entry = romIndexAppend(index);
+		uint64_t value[10];
+		bool ok = romIndexReadInt(file, &value[0], 2) && (value[0] <= ROM_INDEX_NAME_MAX) &&
+			(fread(entry->name, 1, value[0], file) == value[0]) &&
+			romIndexReadInt(file, &value[1], 8) && romIndexReadInt(file, &value[2], 8) &&
+			romIndexReadInt(file, &value[3], 4) && romIndexReadInt(file, &value[4], 4) &&
+			(fread(entry->sha1, 1, UTILS_SHA1_SIZE, file) == UTILS_SHA1_SIZE) &&
+			(fread(entry->title, 1, CART_TITLE_SIZE, file) == CART_TITLE_SIZE) &&
+			romIndexReadInt(file, &value[5], 1) && romIndexReadInt(file, &value[6], 1) &&
+			romIndexReadInt(file, &value[7], 1) && romIndexReadInt(file, &value[8], 4) &&
+			romIndexReadInt(file, &value[9], 4);
+
+		if(!ok)
+		{
+			fclose(file);
+			romIndexFree(index);
+			return false;
+		}
+
+		entry->fileSize = value[1];
+		entry->mtimeSec = (int64_t)value[2];
+		entry->mtimeNsec = value[3];
+		entry->crc32 = value[4];
+		entry->cartType = value[5];
+		entry->mbc = value[6];
+		entry->headerChecksumValid = (value[7] & ROM_INDEX_FLAG_HEADER_CHECKSUM) != 0;
+		entry->globalChecksumValid = (value[7] & ROM_INDEX_FLAG_GLOBAL_CHECKSUM) != 0;
+		entry->romSize = value[8];
+		entry->ramSize = value[9];
+	}
+
+	fclose(file);
+	// Files from older builds may not be sorted
+	if(index->count > 0)
+	{
+		qsort(index->entries, index->count, sizeof(romIndexEntry_t), romIndexCompare);
+	}
+	return true;
+}
+
+/*
+ * @brief Writes an index file
+ * @param indexPath Path to the index file
+ * @param index Entries to be written. Sorted by name first
+ * @return true if the index was written
+ * @note Written to a temporary file which is then renamed over the old index, so readers never see a partial one
+ */
+bool romIndexSave(const char* indexPath, romIndex_t* index)
+{
+	char tempPath[4096];
+	FILE* file = NULL;
+	bool ok = false;
+
+	if(snprintf(tempPath, sizeof(tempPath), "%s.%ld.tmp", indexPath, (long)getpid()) >= (int)sizeof(tempPath))
+	{
+		return false;
+	}
+	file = fopen(tempPath, "wb");
+	if(file == NULL)
+	{
+		return false;
+	}
+
+	if(index->count > 0)
+	{
+		qsort(index->entries, index->count, sizeof(romIndexEntry_t), romIndexCompare);
+	}
+
+	fwrite(ROM_INDEX_MAGIC, 1, sizeof(ROM_INDEX_MAGIC) - 1, file);
+	romIndexWriteInt(file, ROM_INDEX_VERSION, 2);
+	romIndexWriteInt(file, index->count, 4);
+	for(uint32_t i = 0; i < index->count; i++)
+	{
+		const romIndexEntry_t* entry = &index->entries[i];
+		uint16_t nameLength = strlen(entry->name);
+
+		romIndexWriteInt(file, nameLength, 2);
+		fwrite(entry->name, 1, nameLength, file);
+		romIndexWriteInt(file, entry->fileSize, 8);
+		romIndexWriteInt(file, (uint64_t)entry->mtimeSec, 8);
+		romIndexWriteInt(file, entry->mtimeNsec, 4);
+		romIndexWriteInt(file, entry->crc32, 4);
+		fwrite(entry->sha1, 1, UTILS_SHA1_SIZE, file);
+		fwrite(entry->title, 1, CART_TITLE_SIZE, file);
+		romIndexWriteInt(file, entry->cartType, 1);
+		romIndexWriteInt(file, entry->mbc, 1);
+		romIndexWriteInt(file, (entry->headerChecksumValid ? ROM_INDEX_FLAG_HEADER_CHECKSUM : 0) |
+			(entry->globalChecksumValid ? ROM_INDEX_FLAG_GLOBAL_CHECKSUM : 0), 1);
+		romIndexWriteInt(file, entry->romSize, 4);
+		romIndexWriteInt(file, entry->ramSize, 4);
+	}
+
+	ok = (ferror(file) == 0);
+	ok = (fclose(file) == 0) && ok;
+	if(ok)
+	{
+		ok = (rename(tempPath, indexPath) == 0);
+	}
+	if(!ok)
+	{
+		remove(tempPath);
+	}
+
+	return ok;
+}
+
+/*
+ * @brief Frees the entries of an index
+ */
+void romIndexFree(romIndex_t* index)
+{
+	free(index->entries);
+	memset(index, 0, sizeof(romIndex_t));
+}
+
+/*
+ * @brief Looks up a ROM in an index
+ * @param index Index to search
+ * @param name File name, relative to the indexed directory
+ * @param fileStat Result of stat() on the file
+ * @return Matching entry, or NULL if the ROM isn't indexed or has changed since it was
+ */
+const romIndexEntry_t* romIndexFind(const romIndex_t* index, const char* name, const struct stat* fileStat)
+{
+	romIndexEntry_t key;
+	const romIndexEntry_t* entry = NULL;
+
+	if((index->count == 0) || (strlen(name) > ROM_INDEX_NAME_MAX))
+	{
+		return NULL;
+	}
+	strcpy(key.name, name);
+
+	entry = bsearch(&key, index->entries, index->count, sizeof(romIndexEntry_t), romIndexCompare);
+	if((entry == NULL) || (entry->fileSize != (uint64_t)fileStat->st_size) ||
+		(entry->mtimeSec != fileStat->st_mtim.tv_sec) || (entry->mtimeNsec != (uint32_t)fileStat->st_mtim.tv_nsec))
+	{
+		return NULL;
+	}
+
+	return entry;
+}
+
+/*
+ * @brief Gets the metadata for a ROM file, from an index if it has a current entry for the file, hashing it otherwise
+ * @param index Index to look in. May be empty, e.g. if no index was given
+ * @param path Path to the ROM file. Looked up by file name alone, as indexes only cover a single directory
+ * @param entry Receives the metadata
+ * @return false if the file couldn't be read
+ * @note Only reads the index, so any number of threads can look up ROMs in the same one at once
+ */
+bool romIndexLookup(const romIndex_t* index, const char* path, romIndexEntry_t* entry)
+{
+	const char* name = strrchr(path, '/');
+	const romIndexEntry_t* cached = NULL;
+	struct stat fileStat;
+
+	name = (name != NULL) ? (name + 1) : path;
+	if((stat(path, &fileStat) != 0) || !S_ISREG(fileStat.st_mode))
+	{
+		return false;
+	}
+
+	cached = romIndexFind(index, name, &fileStat);
+	if(cached != NULL)
+	{
+		*entry = *cached;
+		return true;
+	}
+
+	memset(entry, 0, sizeof(romIndexEntry_t));
+	snprintf(entry->name, sizeof(entry->name), "%s", name);
+	return romIndexScanFile(path, &fileStat, entry);
+}
+
+/*
+ * @brief Scans a directory of ROMs and writes an index of them
+ * @param romDir Directory holding .gb/.gbc/.sgb files (not searched recursively)
+ * @param indexPath Path to the index file. If it already exists, entries for unchanged files are reused
+ * @return true if the index was written
+ */
+bool romIndexBuild(const char* romDir, const char* indexPath)
+{
+	romIndex_t oldIndex;
+	romIndex_t newIndex;
+	DIR* dir = opendir(romDir);
+	struct dirent* dirEntry = NULL;
+	uint32_t hashed = 0;
+	uint32_t skipped = 0;
+	bool ok = false;
+
+	if(dir == NULL)
+	{
+		printf("ROM directory open error: %s\r\n", romDir);
+		return false;
+	}
+
+	romIndexLoad(indexPath, &oldIndex);
+	memset(&newIndex, 0, sizeof(newIndex));
+
+	while((dirEntry = readdir(dir)) != NULL)
+	{
+		char path[4096];
+		struct stat fileStat;
+		const romIndexEntry_t* cached = NULL;
+
+		if(!romIndexIsRom(dirEntry->d_name) || (strlen(dirEntry->d_name) > ROM_INDEX_NAME_MAX) ||
+			(snprintf(path, sizeof(path), "%s/%s", romDir, dirEntry->d_name) >= (int)sizeof(path)) ||
+			(stat(path, &fileStat) != 0) || !S_ISREG(fileStat.st_mode))
+		{
+			continue;
+		}
+
+		cached = romIndexFind(&oldIndex, dirEntry->d_name, &fileStat);
+		if(cached != NULL)
+		{
+			*romIndexAppend(&newIndex) = *cached;
+			continue;
+		}
+
+		romIndexEntry_t* entry = romIndexAppend(&newIndex);
+		strcpy(entry->name, dirEntry->d_name);
+		if(romIndexScanFile(path, &fileStat, entry))
+		{
+			hashed++;
+		}
+		else
+		{
+			printf("ROM read error: %s\r\n", path);
+			newIndex.count--;
+			skipped++;
+		}
+	}
+	closedir(dir);
+
+	ok = romIndexSave(indexPath, &newIndex);
+	if(ok)
+	{
+		printf("Indexed %u ROMs (%u hashed, %u reused, %u skipped)\r\n", newIndex.count, hashed,
+			newIndex.count - hashed, skipped);
+	}
+	else
+	{
+		printf("ROM index write error: %s\r\n", indexPath);
+	}
+
+	romIndexFree(&oldIndex);
+	romIndexFree(&newIndex);
+	return ok;
+}
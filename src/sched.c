@@ -0,0 +1,168 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "gb.h"
+#include "sched.h"
+#include "ppu.h"
+#include "timers.h"
+#include "interrupts.h"
+#include "apu.h"
+
+/*
+ * sched.c: Event scheduler. Rather than the CPU core checking on every component after every instruction, each
+ * component tells the scheduler the cycle count its next event is due at (e.g. the end of HBlank). gbRunCycles
+ * runs the CPU uninterrupted up to the soonest one, then schedRun calls the handlers of everything that's due, which
+ * schedule their next event in turn. Pending events are kept in a binary min-heap
+ */
+
+typedef void schedHandler_t(gameBoy_t* gb);
+
+static schedHandler_t* const schedHandlers[SCHED_NUM_OF_EVENTS] =
+{
+	[SCHED_EVENT_PPU] = ppuEvent,
+	[SCHED_EVENT_TIMER] = timersEvent,
+	[SCHED_EVENT_INTERRUPT] = interruptsEvent,
+	[SCHED_EVENT_IME] = interruptsEnableEvent,
+	[SCHED_EVENT_APU] = apuEvent,
+};
+
+/*
+ * @brief Swaps two entries of the heap, keeping position[] in step
+ */
+static void schedSwap(sched_t* sched, uint8_t a, uint8_t b)
+{
+	uint8_t event = sched->heap[a];
+
+	sched->heap[a] = sched->heap[b];
+	sched->heap[b] = event;
+	sched->position[sched->heap[a]] = a;
+	sched->position[sched->heap[b]] = b;
+}
+
+/*
+ * @brief Moves a heap entry up or down until its parent is due no later and its children no sooner
+ * @param sched Pointer to the scheduler
+ * @param index Index of the entry in the heap
+ * @return void
+ */
+static void schedFix(sched_t* sched, uint8_t index)
+{
+	// Up
+	while((index > 0) && (sched->time[sched->heap[index]] < sched->time[sched->heap[(index - 1) / 2]]))
+	{
+		schedSwap(sched, index, (index - 1) / 2);
+		index = (index - 1) / 2;
+	}
+
+	// Down
+	for(;;)
+	{
+		uint8_t soonest = index;
+		uint8_t left = index * 2 + 1;
+		uint8_t right = index * 2 + 2;
+
+		if((left < sched->count) && (sched->time[sched->heap[left]] < sched->time[sched->heap[soonest]]))
+		{
+			soonest = left;
+		}
+		if((right < sched->count) && (sched->time[sched->heap[right]] < sched->time[sched->heap[soonest]]))
+		{
+			soonest = right;
+		}
+		if(soonest == index)
+		{
+			break;
+		}
+		schedSwap(sched, index, soonest);
+		index = soonest;
+	}
+}
+
+/*
+ * @brief Clears the scheduler, leaving no events pending
+ * @param gb Pointer to gb struct containing the scheduler
+ * @return void
+ */
+void schedInit(gameBoy_t* gb)
+{
+	sched_t* sched = &gb->sched;
+
+	sched->count = 0;
+	for(uint8_t i = 0; i < SCHED_NUM_OF_EVENTS; i++)
+	{
+		sched->time[i] = UINT64_MAX;
+		sched->position[i] = UINT8_MAX;
+	}
+}
+
+/*
+ * @brief Schedules an event, replacing its previous time if it was already pending
+ * @param gb Pointer to gb struct containing the scheduler
+ * @param event Event to schedule
+ * @param time Cycle count the event is due at. Times already passed are handled at the next schedRun
+ * @return void
+ * @note If the CPU core is running, it's stopped at the event (or at the end of the instruction being run, if the
+ * event is due already) rather than carrying on to the deadline it was started with
+ */
+void schedAdd(gameBoy_t* gb, schedEvent_t event, uint64_t time)
+{
+	sched_t* sched = &gb->sched;
+
+	sched->time[event] = time;
+	if(sched->position[event] == UINT8_MAX)
+	{
+		sched->heap[sched->count] = event;
+		sched->position[event] = sched->count;
+		sched->count++;
+	}
+	schedFix(sched, sched->position[event]);
+
+	if(time < gb->cyclesEnd)
+	{
+		gb->cyclesEnd = time;
+	}
+}
+
+/*
+ * @brief Removes an event from the pending set, if it's there
+ * @param gb Pointer to gb struct containing the scheduler
+ * @param event Event to cancel
+ * @return void
+ */
+void schedCancel(gameBoy_t* gb, schedEvent_t event)
+{
+	sched_t* sched = &gb->sched;
+	uint8_t index = sched->position[event];
+
+	if(index == UINT8_MAX)
+	{
+		return;
+	}
+
+	sched->count--;
+	if(index != sched->count)
+	{
+		schedSwap(sched, index, sched->count);
+		schedFix(sched, index);
+	}
+	sched->time[event] = UINT64_MAX;
+	sched->position[event] = UINT8_MAX;
+}
+
+/*
+ * @brief Calls the handler of every event due by the current cycle count, soonest first
+ * @param gb Pointer to gb struct containing the scheduler
+ * @return void
+ * @note Each event is removed before its handler is called, so the handler can schedule it again
+ */
+void schedRun(gameBoy_t* gb)
+{
+	sched_t* sched = &gb->sched;
+
+	while((sched->count > 0) && (sched->time[sched->heap[0]] <= gb->cyclesCurrent))
+	{
+		schedEvent_t event = sched->heap[0];
+
+		schedCancel(gb, event);
+		schedHandlers[event](gb);
+	}
+}
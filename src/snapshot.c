@@ -0,0 +1,151 @@
+#define _GNU_SOURCE 	// memfd_create
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "gb.h"
+#include "bus.h"
+#include "cart.h"
+#include "idle.h"
+#include "snapshot.h"
+
+/*
+ * snapshot.c: Copy-on-write forking. A snapshot copies a gb struct and its cart struct into an in-memory file once.
+ * Each fork maps that file MAP_PRIVATE, so every fork shares the snapshot's pages until it writes to one, at which
+ * point the kernel copies just that 4KB page for it. Forking costs a mapping and a few pages of pointer fix-ups,
+ * however big memory[], the framebuffer and cartridge RAM are, and the ROM is shared as with any other instance
+ */
+
+struct snapshot
+{
+	int fd; 		// memfd holding the image: the gb struct, then the cart struct
+	cartRom_t* rom; 	// Reference to the ROM the image's cart struct points to, or NULL if there's no cartridge
+};
+
+/*
+ * @brief Returns where the cart struct starts in the image, a page after the gb struct
+ */
+static size_t snapshotCartOffset(void)
+{
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+	return (sizeof(gameBoy_t) + page - 1) & ~(page - 1);
+}
+
+/*
+ * @brief Returns the size of the image (and of every fork's mapping)
+ * @note Room is always left for a cart struct, so forks can be unmapped without knowing whether they had one
+ */
+static size_t snapshotSize(void)
+{
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+	return snapshotCartOffset() + ((sizeof(cart_t) + page - 1) & ~(page - 1));
+}
+
+/*
+ * @brief Freezes a copy of an instance for forking from
+ * @param gb Pointer to gb struct. Must be between calls to gbRunCycles/gbRunFrame. Left as it was, and free to be run
+	on or deinitialised while the snapshot is in use, as the snapshot holds a reference to the ROM of its own
+ * @return Pointer to the snapshot. Exits if out of memory
+ * @note Copies the whole instance once. Forks don't get the APU output or the block cache, which belong to gb
+ */
+snapshot_t* snapshotCreate(gameBoy_t* gb)
+{
+	snapshot_t* snapshot = calloc(1, sizeof(snapshot_t));
+	uint8_t* image = NULL;
+	gameBoy_t* copy = NULL;
+
+	if(snapshot == NULL)
+	{
+		printf("Snapshot allocation error\r\n");
+		exit(1);
+	}
+	snapshot->fd = memfd_create("felixGB-snapshot", MFD_CLOEXEC);
+	if((snapshot->fd < 0) || (ftruncate(snapshot->fd, (off_t)snapshotSize()) != 0))
+	{
+		printf("Snapshot file creation error\r\n");
+		exit(1);
+	}
+	image = mmap(NULL, snapshotSize(), PROT_READ | PROT_WRITE, MAP_SHARED, snapshot->fd, 0);
+	if(image == MAP_FAILED)
+	{
+		printf("Snapshot mapping error\r\n");
+		exit(1);
+	}
+
+	copy = (gameBoy_t*)image;
+	memcpy(copy, gb, sizeof(gameBoy_t));
+	copy->apu.output = NULL;
+	copy->blockCache = NULL;
+	copy->jitArena = NULL;
+	if(gb->cart != NULL)
+	{
+		// Only the cart RAM in use is copied. The rest of the file reads as 0 without taking up memory
+		memcpy(image + snapshotCartOffset(), gb->cart, offsetof(cart_t, ram) + gb->cart->ramSize);
+		((cart_t*)(image + snapshotCartOffset()))->external = true;
+		snapshot->rom = cartRetainRom(gb->cart);
+	}
+	// The page table and cart pointer are fixed up in each fork, as they point into wherever the fork is mapped
+	munmap(image, snapshotSize());
+
+	return snapshot;
+}
+
+/*
+ * @brief Frees a snapshot
+ * @note Forks already made carry on, as their mappings keep the image alive and each has a reference to the ROM
+ */
+void snapshotDestroy(snapshot_t* snapshot)
+{
+	if(snapshot->rom != NULL)
+	{
+		cartReleaseRom(snapshot->rom);
+	}
+	close(snapshot->fd);
+	free(snapshot);
+}
+
+/*
+ * @brief Makes a new instance in the state the snapshot was taken in, sharing its memory copy-on-write
+ * @param snapshot Snapshot to fork from
+ * @return Pointer to the new instance. Exits if out of memory
+ * @note The instance has to be freed with snapshotRelease rather than gbDeinit. It has no APU output until
+ * apuSetOutput is called, and runs exactly as the instance the snapshot was taken from would have
+ */
+gameBoy_t* snapshotFork(snapshot_t* snapshot)
+{
+	uint8_t* image = mmap(NULL, snapshotSize(), PROT_READ | PROT_WRITE, MAP_PRIVATE, snapshot->fd, 0);
+	gameBoy_t* gb = (gameBoy_t*)image;
+
+	if(image == MAP_FAILED)
+	{
+		printf("Snapshot fork mapping error\r\n");
+		exit(1);
+	}
+
+	if(gb->cart != NULL)
+	{
+		gb->cart = (cart_t*)(image + snapshotCartOffset());
+		cartRetainRom(gb->cart);
+	}
+	busRemap(gb);
+	// Cached loops hold page pointers into the instance the snapshot was taken from
+	idleReset(gb);
+
+	return gb;
+}
+
+/*
+ * @brief Frees an instance made by snapshotFork
+ * @param gb Pointer to the fork
+ * @return void
+ */
+void snapshotRelease(gameBoy_t* gb)
+{
+	gbDeinit(gb);
+	munmap(gb, snapshotSize());
+}
@@ -0,0 +1,462 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "gb.h"
+#include "bus.h"
+#include "cart.h"
+#include "idle.h"
+#include "ppu.h"
+#include "state.h"
+#ifdef GB_CORE_BLOCK
+#include "block.h"
+#endif
+
+/*
+ * state.c: Save states. The gb struct is mostly plain data, so a state is just the parts of it that matter copied
+ * out with memcpy, in tagged chunks so loading can check each one is the size this build expects. Anything that
+ * holds host pointers (the page table, the cartridge's ROM mapping, the APU's output ring) or can be rebuilt (decoded
+ * tiles, cached blocks and idle loops) is left out and put right after loading
+ */
+
+typedef struct
+{
+	char magic[STATE_TAG_SIZE];
+	uint32_t version;
+} stateHeader_t;
+
+typedef struct
+{
+	char tag[STATE_TAG_SIZE];
+	uint32_t size;
+} stateChunkHeader_t;
+
+// A run of bytes of the gb struct
+typedef struct
+{
+	size_t offset;
+	size_t size;
+} statePiece_t;
+
+#define STATE_MAX_PIECES 	2
+
+// A chunk made up of parts of the gb struct, saved one after the other
+typedef struct
+{
+	char tag[STATE_TAG_SIZE + 1];
+	statePiece_t pieces[STATE_MAX_PIECES];
+} stateChunk_t;
+
+// A whole field of the gb struct
+#define STATE_FIELD(field) 	{ offsetof(gameBoy_t, field), sizeof(((gameBoy_t*)0)->field) }
+// Fields from first up to (not including) end
+#define STATE_RANGE(first, end) { offsetof(gameBoy_t, first), offsetof(gameBoy_t, end) - offsetof(gameBoy_t, first) }
+// Fields from first to the end of the struct they're in
+#define STATE_TAIL(first, whole) { offsetof(gameBoy_t, first), \
+	offsetof(gameBoy_t, whole) + sizeof(((gameBoy_t*)0)->whole) - offsetof(gameBoy_t, first) }
+
+static const stateChunk_t stateChunks[] =
+{
+	// Registers, flags and cycle counts, which all come before memory[]
+	{ "CPU ", { STATE_RANGE(generalReg, memory) } },
+	// Decoded tiles are rebuilt from VRAM. The frame in progress and the last one completed are both kept, so frames
+	// (and screenshots straight after loading) match
+	{ "PPU ", { STATE_RANGE(ppu.cycles, ppu.tileCache), STATE_TAIL(ppu.framebuffer, ppu) } },
+	{ "TIMR", { STATE_FIELD(timers) } },
+	// Everything but the output ring, which belongs to whoever is listening to this instance
+	{ "APU ", { STATE_RANGE(apu.frameStep, apu.output), STATE_TAIL(apu.timeBase, apu) } },
+	{ "SCHD", { STATE_FIELD(sched) } },
+	{ "JOYP", { STATE_FIELD(input) } }
+};
+
+#define STATE_NUM_OF_CHUNKS 	(sizeof(stateChunks) / sizeof(stateChunks[0]))
+
+// Variable sized chunks, saved after the ones above
+#define STATE_TAG_MEMORY 	"MEM "
+#define STATE_TAG_CART 		"CART"
+
+// MBC registers and RTC, from ramEnable up to ram[]. Followed by the cartridge's RAM in the CART chunk
+#define STATE_CART_REGS_OFFSET 	offsetof(cart_t, ramEnable)
+#define STATE_CART_REGS_SIZE 	(offsetof(cart_t, ram) - offsetof(cart_t, ramEnable))
+
+// Start of the CART chunk, which a state can only be loaded over the same ROM with
+typedef struct
+{
+	uint32_t romSize;
+	uint32_t ramSize;
+	uint8_t mbc;
+	uint8_t headerChecksum;
+	uint16_t globalChecksum;
+} stateCartId_t;
+
+/*
+ * @brief Returns the first address of memory[] saved. With a cartridge, 0x0000-0x7FFF isn't used
+ */
+static uint32_t stateMemoryStart(const gameBoy_t* gb)
+{
+	return (gb->cart != NULL) ? BUS_ADDR_VRAM : 0;
+}
+
+/*
+ * @brief Returns the size of a chunk's data
+ */
+static size_t stateChunkSize(const stateChunk_t* chunk)
+{
+	size_t size = 0;
+
+	for(uint8_t i = 0; i < STATE_MAX_PIECES; i++)
+	{
+		size += chunk->pieces[i].size;
+	}
+
+	return size;
+}
+
+/*
+ * @brief Returns the size of the CART chunk's data for the loaded cartridge
+ */
+static size_t stateCartSize(const gameBoy_t* gb)
+{
+	return sizeof(stateCartId_t) + STATE_CART_REGS_SIZE + gb->cart->ramSize;
+}
+
+/*
+ * @brief Fills in what identifies the loaded cartridge's ROM
+ */
+static void stateCartIdentify(const gameBoy_t* gb, stateCartId_t* id)
+{
+	const cart_t* cart = gb->cart;
+
+	memset(id, 0, sizeof(stateCartId_t));
+	id->romSize = cart->romSize;
+	id->ramSize = cart->ramSize;
+	id->mbc = (uint8_t)cart->mbc;
+	id->headerChecksum = cart->rom[ADDR_HEADER_CHECKSUM];
+	id->globalChecksum = (cart->rom[ADDR_GLOBAL_CHECKSUM] << 8) | cart->rom[ADDR_GLOBAL_CHECKSUM + 1];
+}
+
+/*
+ * @brief Writes a chunk header
+ * @param out Where to write it
+ * @param tag Chunk tag
+ * @param size Size of the data to follow
+ * @return Where the chunk's data goes
+ */
+static uint8_t* stateWriteChunk(uint8_t* out, const char* tag, size_t size)
+{
+	stateChunkHeader_t header;
+
+	memcpy(header.tag, tag, STATE_TAG_SIZE);
+	header.size = (uint32_t)size;
+	memcpy(out, &header, sizeof(header));
+
+	return out + sizeof(header);
+}
+
+/*
+ * @brief Returns the size of a save state of a gb struct
+ * @param gb Pointer to gb struct
+ * @return Size in bytes. Only changes when a different cartridge is loaded
+ */
+size_t stateSize(gameBoy_t* gb)
+{
+	size_t size = sizeof(stateHeader_t) + sizeof(stateChunkHeader_t) + (GB_MEMORY_SIZE - stateMemoryStart(gb));
+
+	for(uint32_t i = 0; i < STATE_NUM_OF_CHUNKS; i++)
+	{
+		size += sizeof(stateChunkHeader_t) + stateChunkSize(&stateChunks[i]);
+	}
+	if(gb->cart != NULL)
+	{
+		size += sizeof(stateChunkHeader_t) + stateCartSize(gb);
+	}
+
+	return size;
+}
+
+/*
+ * @brief Saves the state of a gb struct into a buffer
+ * @param gb Pointer to gb struct. Must be between calls to gbRunCycles/gbRunFrame
+ * @param buffer Buffer to save into
+ * @param size Size of the buffer. Should be at least stateSize
+ * @return Bytes written, or 0 if the buffer is too small
+ */
+size_t stateSave(gameBoy_t* gb, uint8_t* buffer, size_t size)
+{
+	size_t total = stateSize(gb);
+	stateHeader_t header;
+	uint8_t* out = buffer;
+	uint32_t memoryStart = stateMemoryStart(gb);
+
+	if(size < total)
+	{
+		return 0;
+	}
+
+	memcpy(header.magic, STATE_MAGIC, STATE_TAG_SIZE);
+	header.version = STATE_VERSION;
+	memcpy(out, &header, sizeof(header));
+	out += sizeof(header);
+
+	for(uint32_t i = 0; i < STATE_NUM_OF_CHUNKS; i++)
+	{
+		const stateChunk_t* chunk = &stateChunks[i];
+
+		out = stateWriteChunk(out, chunk->tag, stateChunkSize(chunk));
+		for(uint8_t j = 0; j < STATE_MAX_PIECES; j++)
+		{
+			memcpy(out, (const uint8_t*)gb + chunk->pieces[j].offset, chunk->pieces[j].size);
+			out += chunk->pieces[j].size;
+		}
+	}
+
+	out = stateWriteChunk(out, STATE_TAG_MEMORY, GB_MEMORY_SIZE - memoryStart);
+	memcpy(out, &gb->memory[memoryStart], GB_MEMORY_SIZE - memoryStart);
+	out += GB_MEMORY_SIZE - memoryStart;
+
+	if(gb->cart != NULL)
+	{
+		stateCartId_t id;
+
+		stateCartIdentify(gb, &id);
+		out = stateWriteChunk(out, STATE_TAG_CART, stateCartSize(gb));
+		memcpy(out, &id, sizeof(id));
+		out += sizeof(id);
+		memcpy(out, (const uint8_t*)gb->cart + STATE_CART_REGS_OFFSET, STATE_CART_REGS_SIZE);
+		out += STATE_CART_REGS_SIZE;
+		memcpy(out, gb->cart->ram, gb->cart->ramSize);
+		out += gb->cart->ramSize;
+	}
+
+	return (size_t)(out - buffer);
+}
+
+/*
+ * @brief Loads a save state into a gb struct
+ * @param gb Pointer to gb struct, with the same cartridge loaded (if any) as when the state was saved
+ * @param buffer Save state, as written by stateSave
+ * @param size Size of the save state
+ * @return false if the state isn't one this build can load, or is for a different cartridge. The gb struct is left
+ * as it was
+ * @note Every chunk is checked before anything is copied. Chunks with tags this build doesn't know are skipped. The
+ * APU keeps sending samples to the output it already had, and idle skipping stays on or off as it was
+ */
+bool stateLoad(gameBoy_t* gb, const uint8_t* buffer, size_t size)
+{
+	const uint8_t* found[STATE_NUM_OF_CHUNKS] = { NULL };
+	const uint8_t* memory = NULL;
+	const uint8_t* cart = NULL;
+	uint32_t memoryStart = stateMemoryStart(gb);
+	stateHeader_t header;
+	size_t position = sizeof(header);
+
+	if(size < sizeof(header))
+	{
+		printf("Save state too small error\r\n");
+		return false;
+	}
+	memcpy(&header, buffer, sizeof(header));
+	if(memcmp(header.magic, STATE_MAGIC, STATE_TAG_SIZE) != 0)
+	{
+		printf("Not a save state error\r\n");
+		return false;
+	}
+	if(header.version != STATE_VERSION)
+	{
+		printf("Save state version error: %u, expected %u\r\n", header.version, STATE_VERSION);
+		return false;
+	}
+
+	while(position < size)
+	{
+		stateChunkHeader_t chunk;
+		size_t expected = 0;
+		const uint8_t** slot = NULL;
+
+		if(size - position < sizeof(chunk))
+		{
+			printf("Save state truncated error\r\n");
+			return false;
+		}
+		memcpy(&chunk, &buffer[position], sizeof(chunk));
+		position += sizeof(chunk);
+		if(size - position < chunk.size)
+		{
+			printf("Save state truncated error\r\n");
+			return false;
+		}
+
+		for(uint32_t i = 0; (i < STATE_NUM_OF_CHUNKS) && (slot == NULL); i++)
+		{
+			if(memcmp(chunk.tag, stateChunks[i].tag, STATE_TAG_SIZE) == 0)
+			{
+				slot = &found[i];
+				expected = stateChunkSize(&stateChunks[i]);
+			}
+		}
+		if(memcmp(chunk.tag, STATE_TAG_MEMORY, STATE_TAG_SIZE) == 0)
+		{
+			slot = &memory;
+			expected = GB_MEMORY_SIZE - memoryStart;
+		}
+		else if(memcmp(chunk.tag, STATE_TAG_CART, STATE_TAG_SIZE) == 0)
+		{
+			stateCartId_t id;
+			stateCartId_t savedId;
+
+			if(gb->cart == NULL)
+			{
+				printf("Save state needs a cartridge error\r\n");
+				return false;
+			}
+			stateCartIdentify(gb, &id);
+			memset(&savedId, 0, sizeof(savedId));
+			if(chunk.size >= sizeof(savedId))
+			{
+				memcpy(&savedId, &buffer[position], sizeof(savedId));
+			}
+			if(memcmp(&id, &savedId, sizeof(id)) != 0)
+			{
+				printf("Save state is for a different cartridge error\r\n");
+				return false;
+			}
+			slot = &cart;
+			expected = stateCartSize(gb);
+		}
+
+		if(slot != NULL)
+		{
+			if(chunk.size != expected)
+			{
+				printf("Save state chunk %.4s size error: %u, expected %zu\r\n", chunk.tag, chunk.size, expected);
+				return false;
+			}
+			*slot = &buffer[position];
+		}
+		position += chunk.size;
+	}
+
+	for(uint32_t i = 0; i < STATE_NUM_OF_CHUNKS; i++)
+	{
+		if(found[i] == NULL)
+		{
+			printf("Save state missing chunk error: %s\r\n", stateChunks[i].tag);
+			return false;
+		}
+	}
+	if((memory == NULL) || ((gb->cart != NULL) && (cart == NULL)))
+	{
+		printf("Save state missing chunk error: %s\r\n", (memory == NULL) ? STATE_TAG_MEMORY : STATE_TAG_CART);
+		return false;
+	}
+
+	// Everything checks out, so nothing can fail from here on
+	for(uint32_t i = 0; i < STATE_NUM_OF_CHUNKS; i++)
+	{
+		const uint8_t* in = found[i];
+
+		for(uint8_t j = 0; j < STATE_MAX_PIECES; j++)
+		{
+			memcpy((uint8_t*)gb + stateChunks[i].pieces[j].offset, in, stateChunks[i].pieces[j].size);
+			in += stateChunks[i].pieces[j].size;
+		}
+	}
+	memcpy(&gb->memory[memoryStart], memory, GB_MEMORY_SIZE - memoryStart);
+	if(gb->cart != NULL)
+	{
+		cart += sizeof(stateCartId_t);
+		memcpy((uint8_t*)gb->cart + STATE_CART_REGS_OFFSET, cart, STATE_CART_REGS_SIZE);
+		memcpy(gb->cart->ram, cart + STATE_CART_REGS_SIZE, gb->cart->ramSize);
+	}
+
+	// Put right what wasn't saved
+	busRemap(gb);
+	ppuInvalidateTiles(gb);
+	ppuDecodePalettes(gb);
+	idleReset(gb);
+#ifdef GB_CORE_BLOCK
+	blockInvalidateRam(gb);
+#endif
+
+	return true;
+}
+
+/*
+ * @brief Saves the state of a gb struct to a file
+ * @param gb Pointer to gb struct. Must be between calls to gbRunCycles/gbRunFrame
+ * @param path File to write, replacing it if it exists
+ * @return false if the file couldn't be written
+ */
+bool stateSaveFile(gameBoy_t* gb, const char* path)
+{
+	size_t size = stateSize(gb);
+	uint8_t* buffer = malloc(size);
+	FILE* file = NULL;
+	bool written = false;
+
+	if(buffer == NULL)
+	{
+		printf("Save state allocation error\r\n");
+		exit(1);
+	}
+	size = stateSave(gb, buffer, size);
+
+	file = fopen(path, "wb");
+	if(file != NULL)
+	{
+		written = (fwrite(buffer, 1, size, file) == size);
+		written = (fclose(file) == 0) && written;
+	}
+	if(!written)
+	{
+		printf("Save state write error: %s\r\n", path);
+	}
+
+	free(buffer);
+	return written;
+}
+
+/*
+ * @brief Loads a save state from a file into a gb struct
+ * @param gb Pointer to gb struct, with the same cartridge loaded (if any) as when the state was saved
+ * @param path File written by stateSaveFile
+ * @return false if the file couldn't be read or loaded (see stateLoad)
+ */
+bool stateLoadFile(gameBoy_t* gb, const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	uint8_t* buffer = NULL;
+	long size = 0;
+	bool loaded = false;
+
+	if((file == NULL) || (fseek(file, 0, SEEK_END) != 0) || ((size = ftell(file)) < 0) ||
+		(fseek(file, 0, SEEK_SET) != 0))
+	{
+		printf("Save state read error: %s\r\n", path);
+		if(file != NULL)
+		{
+			fclose(file);
+		}
+		return false;
+	}
+
+	buffer = malloc((size > 0) ? (size_t)size : 1);
+	if(buffer == NULL)
+	{
+		printf("Save state allocation error\r\n");
+		exit(1);
+	}
+	if(fread(buffer, 1, (size_t)size, file) == (size_t)size)
+	{
+		loaded = stateLoad(gb, buffer, (size_t)size);
+	}
+	else
+	{
+		printf("Save state read error: %s\r\n", path);
+	}
+
+	fclose(file);
+	free(buffer);
+	return loaded;
+}
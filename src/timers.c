@@ -0,0 +1,272 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "gb.h"
+#include "sched.h"
+#include "timers.h"
+#include "interrupts.h"
+
+/*
+ * timers.c: DIV/TIMA timers. Nothing is ticked per cycle. DIV is the upper byte of a 16-bit system counter, which is
+ * just cyclesCurrent - divBase. TIMA counts falling edges of one bit of that counter (picked by TAC), so the number
+ * of increments between two cycle counts is a subtraction of shifted counter values. Registers are worked out when
+ * read or written, and the only event scheduled is the next TIMA overflow, which requests the timer interrupt
+ */
+
+// Bit of the system counter whose falling edge increments TIMA, by TAC bits 0-1 (4096Hz, 262144Hz, 65536Hz, 16384Hz)
+static const uint8_t timersBit[4] = { 9, 3, 5, 7 };
+
+/*
+ * @brief Returns the value of the 16-bit system counter at a given cycle count, without wrapping it at 16 bits
+ */
+static inline uint64_t timersCounter(const gameBoy_t* gb, uint64_t cycles)
+{
+	return cycles - gb->timers.divBase;
+}
+
+/*
+ * @brief Returns whether TIMA is counting, and the period of the counter bit it counts falling edges of as a shift
+ */
+static inline bool timersEnabled(const gameBoy_t* gb, uint8_t* shift)
+{
+	uint8_t tac = gb->memory[TIMERS_REG_TAC];
+
+	*shift = timersBit[tac & 0x03] + 1;
+	return (tac & TIMERS_TAC_ENABLE) != 0;
+}
+
+/*
+ * @brief Brings TIMA up to the current cycle count, handling any overflows along the way
+ * @param gb Pointer to gb struct containing the timers
+ * @return void
+ */
+static void timersSync(gameBoy_t* gb)
+{
+	timers_t* timers = &gb->timers;
+	uint64_t now = gb->cyclesCurrent;
+	uint8_t shift = 0;
+
+	for(;;)
+	{
+		uint64_t edges = 0;
+
+		if(timers->overflow != UINT64_MAX)
+		{
+			// Reads 0 until the reload
+			if(now < timers->overflow + TIMERS_RELOAD_DELAY)
+			{
+				return;
+			}
+			timers->tima = gb->memory[TIMERS_REG_TMA];
+			timers->timaBase = timers->overflow + TIMERS_RELOAD_DELAY;
+			timers->overflow = UINT64_MAX;
+			interruptsRequest(gb, GB_INT_TIMER);
+		}
+
+		if(!timersEnabled(gb, &shift))
+		{
+			timers->timaBase = now;
+			return;
+		}
+
+		edges = (timersCounter(gb, now) >> shift) - (timersCounter(gb, timers->timaBase) >> shift);
+		if(timers->tima + edges <= 0xFF)
+		{
+			timers->tima += edges;
+			timers->timaBase = now;
+			return;
+		}
+
+		// Overflowed on the edge that took it past 0xFF
+		edges = (timersCounter(gb, timers->timaBase) >> shift) + (0x100 - timers->tima);
+		timers->overflow = timers->divBase + (edges << shift);
+		timers->tima = 0;
+	}
+}
+
+/*
+ * @brief Schedules SCHED_EVENT_TIMER for when TIMA next overflows (plus the reload delay), if it's counting
+ * @param gb Pointer to gb struct containing the timers
+ * @return void
+ * @note TIMA must be synced up to the CPU
+ */
+static void timersSchedule(gameBoy_t* gb)
+{
+	timers_t* timers = &gb->timers;
+	uint8_t shift = 0;
+
+	if(timers->overflow != UINT64_MAX)
+	{
+		schedAdd(gb, SCHED_EVENT_TIMER, timers->overflow + TIMERS_RELOAD_DELAY);
+	}
+	else if(timersEnabled(gb, &shift))
+	{
+		uint64_t edge = (timersCounter(gb, timers->timaBase) >> shift) + (0x100 - timers->tima);
+		schedAdd(gb, SCHED_EVENT_TIMER, timers->divBase + (edge << shift) + TIMERS_RELOAD_DELAY);
+	}
+	else
+	{
+		schedCancel(gb, SCHED_EVENT_TIMER);
+	}
+}
+
+/*
+ * @brief Increments TIMA once, outside of the normal counting. For the falling edges caused by DIV and TAC writes
+ * @param gb Pointer to gb struct containing the timers
+ * @return void
+ * @note TIMA must be synced up to the CPU
+ */
+static void timersTick(gameBoy_t* gb)
+{
+	timers_t* timers = &gb->timers;
+
+	if(timers->overflow != UINT64_MAX)
+	{
+		return;
+	}
+	if(timers->tima == 0xFF)
+	{
+		timers->tima = 0;
+		timers->overflow = gb->cyclesCurrent;
+	}
+	else
+	{
+		timers->tima++;
+	}
+}
+
+/*
+ * @brief Sets the timers up as the boot ROM leaves them
+ * @param gb Pointer to gb struct containing the timers
+ * @return void
+ */
+void timersInit(gameBoy_t* gb)
+{
+	// The system counter has been running during the boot ROM, which leaves DIV at 0xAB
+	gb->timers.divBase = gb->cyclesCurrent - 0xABCC;
+	gb->timers.timaBase = gb->cyclesCurrent;
+	gb->timers.overflow = UINT64_MAX;
+	gb->timers.tima = 0;
+	gb->memory[TIMERS_REG_TMA] = 0;
+	gb->memory[TIMERS_REG_TAC] = 0xF8;
+	timersSchedule(gb);
+}
+
+/*
+ * @brief Handler for SCHED_EVENT_TIMER. Reloads TIMA from TMA, requests the timer interrupt and schedules the next one
+ * @param gb Pointer to gb struct containing the timers
+ * @return void
+ */
+void timersEvent(gameBoy_t* gb)
+{
+	timersSync(gb);
+	timersSchedule(gb);
+}
+
+/*
+ * @brief Reads one of the timer registers
+ * @param gb Pointer to gb struct containing the timers
+ * @param addr Register address (0xFF04-0xFF07)
+ * @return 8-bit value read
+ */
+uint8_t timersRead(gameBoy_t* gb, uint16_t addr)
+{
+	switch(addr)
+	{
+		case TIMERS_REG_DIV:
+			return (uint8_t)(timersCounter(gb, gb->cyclesCurrent) >> 8);
+		case TIMERS_REG_TIMA:
+			timersSync(gb);
+			return gb->timers.tima;
+		default:
+			return gb->memory[addr];
+	}
+}
+
+/*
+ * @brief Returns the soonest cycle count one of the timer registers could change at without being written
+ * @param gb Pointer to gb struct containing the timers
+ * @param addr Register address (0xFF04-0xFF07)
+ * @return Cycle count, or UINT64_MAX if the register only changes when written
+ * @note Used to skip idle loops polling the register (see idle.c)
+ */
+uint64_t timersNextChange(gameBoy_t* gb, uint16_t addr)
+{
+	timers_t* timers = &gb->timers;
+	uint64_t counter = timersCounter(gb, gb->cyclesCurrent);
+	uint8_t shift = 8;
+
+	switch(addr)
+	{
+		case TIMERS_REG_DIV:
+			break;
+		case TIMERS_REG_TIMA:
+			timersSync(gb);
+			if(timers->overflow != UINT64_MAX)
+			{
+				return timers->overflow + TIMERS_RELOAD_DELAY;
+			}
+			if(!timersEnabled(gb, &shift))
+			{
+				return UINT64_MAX;
+			}
+			break;
+		default:
+			return UINT64_MAX;
+	}
+
+	// Next time the counter bit is about to fall
+	return timers->divBase + (((counter >> shift) + 1) << shift);
+}
+
+/*
+ * @brief Writes one of the timer registers
+ * @param gb Pointer to gb struct containing the timers
+ * @param addr Register address (0xFF04-0xFF07)
+ * @param value 8-bit value written
+ * @return void
+ * @note TIMA counts falling edges of (counter bit AND TAC enable), so resetting the counter with the bit set, or
+ * changing TAC so the signal drops, increments it too
+ */
+void timersWrite(gameBoy_t* gb, uint16_t addr, uint8_t value)
+{
+	timers_t* timers = &gb->timers;
+	uint8_t shift = 0;
+	bool enabled = false;
+	bool signal = false;
+
+	timersSync(gb);
+	enabled = timersEnabled(gb, &shift);
+	signal = enabled && ((timersCounter(gb, gb->cyclesCurrent) >> (shift - 1)) & 0x01);
+
+	switch(addr)
+	{
+		case TIMERS_REG_DIV:
+			if(signal)
+			{
+				timersTick(gb);
+			}
+			timers->divBase = gb->cyclesCurrent;
+			break;
+		case TIMERS_REG_TIMA:
+			// Writing during the reload delay cancels the reload and the interrupt
+			timers->overflow = UINT64_MAX;
+			timers->tima = value;
+			timers->timaBase = gb->cyclesCurrent;
+			break;
+		case TIMERS_REG_TMA:
+			gb->memory[addr] = value;
+			break;
+		case TIMERS_REG_TAC:
+			gb->memory[addr] = 0xF8 | (value & 0x07);
+			enabled = timersEnabled(gb, &shift);
+			if(signal && !(enabled && ((timersCounter(gb, gb->cyclesCurrent) >> (shift - 1)) & 0x01)))
+			{
+				timersTick(gb);
+			}
+			break;
+		default:
+			break;
+	}
+
+	timersSchedule(gb);
+}
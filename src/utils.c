@@ -0,0 +1,164 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <pthread.h>
+#include "utils.h"
+
+/*
+ * utils.c: Helpers which aren't specific to any one part of the GameBoy, such as the checksums/hashes used to
+ * identify ROM files
+ */
+
+static uint32_t utilsCrc32Table[256];
+static pthread_once_t utilsCrc32Once = PTHREAD_ONCE_INIT;
+
+/*
+ * @brief Fills in the lookup table for utilsCrc32, one entry per byte value
+ */
+static void utilsCrc32Init(void)
+{
+	for(uint32_t i = 0; i < 256; i++)
+	{
+		uint32_t crc = i;
+		for(uint8_t bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320) : (crc >> 1);
+		}
+		utilsCrc32Table[i] = crc;
+	}
+}
+
+/*
+ * @brief Computes the CRC-32 (as used by zip/PNG) of a buffer
+ * @param crc CRC of the data before this buffer, or 0 to start a new one
+ * @param data Buffer to be checksummed
+ * @param size Size of the buffer in bytes
+ * @return Updated CRC
+ */
+uint32_t utilsCrc32(uint32_t crc, const void* data, size_t size)
+{
+	const uint8_t* bytes = data;
+
+	pthread_once(&utilsCrc32Once, utilsCrc32Init);
+
+	crc = ~crc;
+	for(size_t i = 0; i < size; i++)
+	{
+		crc = utilsCrc32Table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+	}
+
+	return ~crc;
+}
+
+/*
+ * @brief Runs the SHA-1 compression function over one 64 byte block
+ * @param state Hash state (h0-h4)
+ * @param block 64 bytes of message
+ * @return void
+ */
+static void utilsSha1Block(uint32_t state[5], const uint8_t block[64])
+{
+	uint32_t w[80];
+	uint32_t a = state[0];
+	uint32_t b = state[1];
+	uint32_t c = state[2];
+	uint32_t d = state[3];
+	uint32_t e = state[4];
+
+	for(uint8_t i = 0; i < 16; i++)
+	{
+		w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) | ((uint32_t)block[i * 4 + 2] << 8) |
+			block[i * 4 + 3];
+	}
+	for(uint8_t i = 16; i < 80; i++)
+	{
+		uint32_t x = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+		w[i] = (x << 1) | (x >> 31);
+	}
+
+	for(uint8_t i = 0; i < 80; i++)
+	{
+		uint32_t f = 0;
+		uint32_t k = 0;
+		uint32_t temp = 0;
+
+		if(i < 20)
+		{
+			f = (b & c) | (~b & d);
+			k = 0x5A827999;
+		}
+		else if(i < 40)
+		{
+			f = b ^ c ^ d;
+			k = 0x6ED9EBA1;
+		}
+		else if(i < 60)
+		{
+			f = (b & c) | (b & d) | (c & d);
+			k = 0x8F1BBCDC;
+		}
+		else
+		{
+			f = b ^ c ^ d;
+			k = 0xCA62C1D6;
+		}
+
+		temp = ((a << 5) | (a >> 27)) + f + e + k + w[i];
+		e = d;
+		d = c;
+		c = (b << 30) | (b >> 2);
+		b = a;
+		a = temp;
+	}
+
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+}
+
+/*
+ * @brief Computes the SHA-1 digest of a buffer
+ * @param data Buffer to be hashed
+ * @param size Size of the buffer in bytes
+ * @param digest Receives the 20 byte digest
+ * @return void
+ */
+void utilsSha1(const void* data, size_t size, uint8_t digest[UTILS_SHA1_SIZE])
+{
+	const uint8_t* bytes = data;
+	uint32_t state[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+	uint8_t tail[128];
+	size_t tailSize = 0;
+	uint64_t bits = (uint64_t)size * 8;
+	size_t offset = 0;
+
+	for(offset = 0; offset + 64 <= size; offset += 64)
+	{
+		utilsSha1Block(state, &bytes[offset]);
+	}
+
+	// Pad with 0x80, zeros and the message length in bits (big-endian) to a whole number of blocks
+	tailSize = size - offset;
+	memset(tail, 0, sizeof(tail));
+	memcpy(tail, &bytes[offset], tailSize);
+	tail[tailSize++] = 0x80;
+	tailSize = (tailSize + 8 <= 64) ? 64 : 128;
+	for(uint8_t i = 0; i < 8; i++)
+	{
+		tail[tailSize - 1 - i] = (uint8_t)(bits >> (i * 8));
+	}
+	for(offset = 0; offset < tailSize; offset += 64)
+	{
+		utilsSha1Block(state, &tail[offset]);
+	}
+
+	for(uint8_t i = 0; i < 5; i++)
+	{
+		digest[i * 4] = state[i] >> 24;
+		digest[i * 4 + 1] = state[i] >> 16;
+		digest[i * 4 + 2] = state[i] >> 8;
+		digest[i * 4 + 3] = state[i];
+	}
+}
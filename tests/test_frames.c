@@ -0,0 +1,87 @@
+#include <stdint.h>
+#include <stdio.h>
+#include "gb.h"
+#include "ppu.h"
+#include "testrom.h"
+
+/*
+ * test_frames.c: Checks ppuGetFrame only ever returns whole frames. The ROM draws a black screen, turns the LCD off
+ * part way down it for a few frames, then back on (so frames no longer start where gbRunFrame's do) and from then on
+ * flips the background between black and white at every VBlank
+ */
+
+static const uint8_t testCode[] =
+{
+	0xF3, 				// DI
+	0x31, 0xFE, 0xFF, 		// LD SP, 0xFFFE
+	0x3E, 0xFF, 			// LD A, 0xFF
+	0xE0, 0x47, 			// LDH (BGP), A
+	0xF0, 0x44, 0xFE, 0x50, 0x20, 0xFA, // Wait for LY 80
+	0x3E, 0x11, 			// LD A, 0x11
+	0xE0, 0x40, 			// LDH (LCDC), A (LCD off)
+	0x01, 0x00, 0x20, 		// LD BC, 0x2000
+	0x0B, 				// DEC BC (~3 frames)
+	0x78, 				// LD A, B
+	0xB1, 				// OR C
+	0x20, 0xFB, 			// JR NZ, -5
+	0xAF, 				// XOR A
+	0xE0, 0x47, 			// LDH (BGP), A
+	0x3E, 0x91, 			// LD A, 0x91
+	0xE0, 0x40, 			// LDH (LCDC), A (LCD on)
+	// loop:
+	0xF0, 0x44, 0xFE, 0x90, 0x20, 0xFA, // Wait for LY 144 (VBlank)
+	0xF0, 0x47, 			// LDH A, (BGP)
+	0x2F, 				// CPL
+	0xE0, 0x47, 			// LDH (BGP), A
+	0xF0, 0x44, 0xFE, 0x90, 0x28, 0xFA, // Wait for LY to move on
+	0x18, 0xED 			// JR loop
+};
+
+int main(void)
+{
+	static gameBoy_t gb;
+	static testRom_t rom;
+	uint32_t blankFrames = 0;
+	uint32_t badBlankFrames = 0;
+	uint32_t tornFrames = 0;
+	uint32_t shownFrames = 0;
+	int failed = 0;
+
+	testRomInit(&rom, "FRAMES");
+	testRomPut(&rom, TESTROM_CODE, testCode, sizeof(testCode));
+
+	gbInit(&gb);
+	testRomLoad(&rom, &gb);
+	for(int frame = 0; frame < 12; frame++)
+	{
+		const uint32_t* pixels = NULL;
+		bool lcdOn = false;
+
+		gbRunFrame(&gb);
+		pixels = ppuGetFrame(&gb);
+		lcdOn = (gb.memory[PPU_REG_LCDC] & PPU_LCDC_ENABLE) != 0;
+		for(uint32_t i = 0; i < PPU_SCREEN_WIDTH * PPU_SCREEN_HEIGHT; i++)
+		{
+			if(!lcdOn && (pixels[i] != PPU_COLOUR_OFF))
+			{
+				badBlankFrames++;
+				break;
+			}
+			if(lcdOn && (pixels[i] != pixels[0]))
+			{
+				tornFrames++;
+				break;
+			}
+		}
+		blankFrames += lcdOn ? 0 : 1;
+		shownFrames += (lcdOn && (frame > 6)) ? 1 : 0;
+	}
+
+	failed = testCheck("LCD turned off", failed, blankFrames > 0, 1);
+	failed = testCheck("blank while the LCD is off", failed, badBlankFrames, 0);
+	failed = testCheck("LCD turned back on", failed, shownFrames > 0, 1);
+	failed = testCheck("no frames made of two halves", failed, tornFrames, 0);
+
+	gbDeinit(&gb);
+	return (failed == 0) ? 0 : 1;
+}
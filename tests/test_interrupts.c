@@ -0,0 +1,70 @@
+#include <stdint.h>
+#include <stdio.h>
+#include "gb.h"
+#include "testrom.h"
+
+/*
+ * test_interrupts.c: Checks an interrupt requested by a write is taken straight after the instruction that wrote it,
+ * even from a block the JIT has translated (the block is run 200 times, well past JIT_HOT_THRESHOLD)
+ */
+
+// Joypad interrupt handler: saves B, the number of INC B run before the interrupt was taken, and IF
+static const uint8_t testHandler[] =
+{
+	0x78, 			// LD A, B
+	0xEA, 0x00, 0xC0, 	// LD (0xC000), A
+	0x3E, 0x01, 		// LD A, 0x01
+	0xEA, 0x01, 0xC0, 	// LD (0xC001), A
+	0xF0, 0x0F, 		// LDH A, (IF)
+	0xEA, 0x02, 0xC0, 	// LD (0xC002), A
+	0x18, 0xFE 		// JR -2
+};
+
+// Writes IF on every pass, which only requests the (enabled) joypad interrupt on the last one, when D is 1
+static const uint8_t testCode[] =
+{
+	0x31, 0xFE, 0xFF, 	// LD SP, 0xFFFE
+	0x3E, 0x10, 		// LD A, 0x10
+	0xE0, 0xFF, 		// LDH (IE), A
+	0xAF, 			// XOR A
+	0xE0, 0x0F, 		// LDH (IF), A
+	0x47, 			// LD B, A
+	0x16, 0xC8, 		// LD D, 200
+	0xFB, 			// EI
+	// loop:
+	0x7A, 			// LD A, D
+	0xFE, 0x02, 		// CP 2
+	0x9F, 			// SBC A, A
+	0xE6, 0x10, 		// AND 0x10
+	0xE0, 0x0F, 		// LDH (IF), A
+	0x04, 			// INC B
+	0x15, 			// DEC D
+	0x20, 0xF4, 		// JR NZ, loop
+	0x18, 0xFE 		// JR -2
+};
+
+int main(void)
+{
+	static gameBoy_t gb;
+	static testRom_t rom;
+	int failed = 0;
+
+	testRomInit(&rom, "INTERRUPTS");
+	testRomPut(&rom, 0x0060, testHandler, sizeof(testHandler));
+	testRomPut(&rom, TESTROM_CODE, testCode, sizeof(testCode));
+
+	gbInit(&gb);
+	testRomLoad(&rom, &gb);
+	for(int frame = 0; frame < 4; frame++)
+	{
+		gbRunFrame(&gb);
+	}
+
+	failed = testCheck("joypad interrupt taken", failed, gb.memory[0xC001], 0x01);
+	failed = testCheck("taken before the next instruction", failed, gb.memory[0xC000], 199);
+	// Taking the interrupt cleared its bit, and nothing else is enabled. The unused bits read as 1
+	failed = testCheck("IF read back", failed, gb.memory[0xC002] & 0xF0, 0xE0);
+
+	gbDeinit(&gb);
+	return (failed == 0) ? 0 : 1;
+}
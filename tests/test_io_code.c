@@ -0,0 +1,55 @@
+#include <stdint.h>
+#include <stdio.h>
+#include "gb.h"
+#include "testrom.h"
+
+/*
+ * test_io_code.c: Checks code run from an I/O register sees the register's current value. With LYC set to RET, a
+ * CALL to LY runs whatever op code LY holds at the time: INC B on line 4, INC C on line 12. The block core must not
+ * run the first one again from its cache the second time round
+ */
+
+static const uint8_t testCode[] =
+{
+	0xF3, 				// DI
+	0x31, 0xFE, 0xFF, 		// LD SP, 0xFFFE
+	0x3E, 0xC9, 			// LD A, 0xC9 (RET)
+	0xE0, 0x45, 			// LDH (LYC), A
+	0xAF, 				// XOR A
+	0x47, 				// LD B, A
+	0x4F, 				// LD C, A
+	0xF0, 0x44, 0xFE, 0x03, 0x20, 0xFA, // Wait for LY to reach 3, then 4, so the CALL is early in line 4
+	0xF0, 0x44, 0xFE, 0x04, 0x20, 0xFA,
+	0xCD, 0x44, 0xFF, 		// CALL LY (INC B)
+	0xF0, 0x44, 0xFE, 0x0B, 0x20, 0xFA, // Same again for line 12
+	0xF0, 0x44, 0xFE, 0x0C, 0x20, 0xFA,
+	0xCD, 0x44, 0xFF, 		// CALL LY (INC C)
+	0x78, 				// LD A, B
+	0xEA, 0x00, 0xC0, 		// LD (0xC000), A
+	0x79, 				// LD A, C
+	0xEA, 0x01, 0xC0, 		// LD (0xC001), A
+	0x18, 0xFE 			// JR -2
+};
+
+int main(void)
+{
+	static gameBoy_t gb;
+	static testRom_t rom;
+	int failed = 0;
+
+	testRomInit(&rom, "IO CODE");
+	testRomPut(&rom, TESTROM_CODE, testCode, sizeof(testCode));
+
+	gbInit(&gb);
+	testRomLoad(&rom, &gb);
+	for(int frame = 0; frame < 4; frame++)
+	{
+		gbRunFrame(&gb);
+	}
+
+	failed = testCheck("LY run as INC B on line 4", failed, gb.memory[0xC000], 0x01);
+	failed = testCheck("LY run as INC C on line 12", failed, gb.memory[0xC001], 0x01);
+
+	gbDeinit(&gb);
+	return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+#include <stdint.h>
+#include <stdio.h>
+#include "gb.h"
+#include "testrom.h"
+
+/*
+ * test_jit_alu.c: Checks ADD A, r and ADD A, d8 give the same A with their flags dead, which is when the JIT emits
+ * them natively (the loop is run 200 times, well past JIT_HOT_THRESHOLD), as on the table core
+ */
+
+// Adds 3 + 0x11 + 5 to A on every pass. Only the last ADD's flags can be read, by JR NZ after DEC D
+static const uint8_t testCode[] =
+{
+	0x31, 0xFE, 0xFF, 	// LD SP, 0xFFFE
+	0xAF, 			// XOR A
+	0x06, 0x03, 		// LD B, 0x03
+	0x0E, 0x05, 		// LD C, 0x05
+	0x16, 0xC8, 		// LD D, 200
+	// loop:
+	0x80, 			// ADD A, B
+	0xC6, 0x11, 		// ADD A, 0x11
+	0x81, 			// ADD A, C
+	0x15, 			// DEC D
+	0x20, 0xF9, 		// JR NZ, loop
+	0xEA, 0x00, 0xC0, 	// LD (0xC000), A
+	0x18, 0xFE 		// JR -2
+};
+
+int main(void)
+{
+	static gameBoy_t gb;
+	static testRom_t rom;
+	int failed = 0;
+
+	testRomInit(&rom, "JIT ALU");
+	testRomPut(&rom, TESTROM_CODE, testCode, sizeof(testCode));
+
+	gbInit(&gb);
+	testRomLoad(&rom, &gb);
+	for(int frame = 0; frame < 2; frame++)
+	{
+		gbRunFrame(&gb);
+	}
+
+	failed = testCheck("A after the loop", failed, gb.memory[0xC000], (uint8_t)(200 * (0x03 + 0x11 + 0x05)));
+
+	gbDeinit(&gb);
+	return (failed == 0) ? 0 : 1;
+}
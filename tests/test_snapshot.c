@@ -0,0 +1,68 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "gb.h"
+#include "snapshot.h"
+#include "testrom.h"
+
+/*
+ * test_snapshot.c: Checks a snapshot keeps working once the instance it was taken from is gone. The instance is
+ * deinitialised (dropping its reference to the ROM) before anything is forked, and the snapshot is destroyed before
+ * the fork runs. The fork has to carry on from ROM exactly as an instance run straight through does
+ */
+
+// Counts up through WRAM from 0xC000, a byte at a time
+static const uint8_t testCode[] =
+{
+	0x31, 0xFE, 0xFF, 		// LD SP, 0xFFFE
+	0x21, 0x00, 0xC0, 		// LD HL, 0xC000
+	// loop:
+	0x34, 				// INC (HL)
+	0x20, 0xFD, 			// JR NZ, loop
+	0x2C, 				// INC L
+	0x18, 0xFA 			// JR loop
+};
+
+int main(void)
+{
+	static gameBoy_t source;
+	static gameBoy_t reference;
+	static testRom_t rom;
+	snapshot_t* snapshot = NULL;
+	gameBoy_t* fork = NULL;
+	int failed = 0;
+
+	testRomInit(&rom, "SNAPSHOT");
+	testRomPut(&rom, TESTROM_CODE, testCode, sizeof(testCode));
+
+	gbInit(&source);
+	testRomLoad(&rom, &source);
+	for(int frame = 0; frame < 5; frame++)
+	{
+		gbRunFrame(&source);
+	}
+	snapshot = snapshotCreate(&source);
+	gbDeinit(&source);
+
+	fork = snapshotFork(snapshot);
+	snapshotDestroy(snapshot);
+	for(int frame = 0; frame < 5; frame++)
+	{
+		gbRunFrame(fork);
+	}
+
+	gbInit(&reference);
+	testRomLoad(&rom, &reference);
+	for(int frame = 0; frame < 10; frame++)
+	{
+		gbRunFrame(&reference);
+	}
+
+	failed = testCheck("fork ran as far", failed, (uint32_t)fork->cyclesCurrent, (uint32_t)reference.cyclesCurrent);
+	failed = testCheck("fork PC", failed, fork->pc, reference.pc);
+	failed = testCheck("fork memory", failed, memcmp(fork->memory, reference.memory, sizeof(reference.memory)) != 0, 0);
+
+	snapshotRelease(fork);
+	gbDeinit(&reference);
+	return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+#include <stdint.h>
+#include <stdio.h>
+#include "gb.h"
+#include "testrom.h"
+
+/*
+ * test_stop.c: Checks STOP is woken by a selected button being held, not by IF: the joypad interrupt is masked and
+ * its IF bit is already set when STOP runs
+ */
+
+// Selects the buttons, stops, then stores 1 once woken up
+static const uint8_t testCode[] =
+{
+	0xF3, 			// DI
+	0x31, 0xFE, 0xFF, 	// LD SP, 0xFFFE
+	0xAF, 			// XOR A
+	0xE0, 0xFF, 		// LDH (IE), A
+	0x3E, 0x10, 		// LD A, 0x10
+	0xE0, 0x0F, 		// LDH (IF), A
+	0xE0, 0x00, 		// LDH (P1), A
+	0x10, 0x00, 		// STOP
+	0x3E, 0x01, 		// LD A, 0x01
+	0xEA, 0x00, 0xC0, 	// LD (0xC000), A
+	0x18, 0xFE 		// JR -2
+};
+
+int main(void)
+{
+	static gameBoy_t gb;
+	static testRom_t rom;
+	int failed = 0;
+
+	testRomInit(&rom, "STOP");
+	testRomPut(&rom, TESTROM_CODE, testCode, sizeof(testCode));
+
+	gbInit(&gb);
+	testRomLoad(&rom, &gb);
+	for(int frame = 0; frame < 2; frame++)
+	{
+		gbRunFrame(&gb);
+	}
+	failed = testCheck("IF alone doesn't wake", failed, gb.memory[0xC000], 0x00);
+
+	// The directions aren't selected, so their lines stay high
+	inputSetButtons(&gb, INPUT_RIGHT);
+	gbRunFrame(&gb);
+	failed = testCheck("unselected button doesn't wake", failed, gb.memory[0xC000], 0x00);
+
+	inputSetButtons(&gb, INPUT_RIGHT | INPUT_A);
+	gbRunFrame(&gb);
+	failed = testCheck("selected button wakes", failed, gb.memory[0xC000], 0x01);
+
+	gbDeinit(&gb);
+	return (failed == 0) ? 0 : 1;
+}
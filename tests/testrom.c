@@ -0,0 +1,97 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "gb.h"
+#include "cart.h"
+#include "testrom.h"
+
+/*
+ * testrom.c: Helpers shared by the regression tests (make test). Each test assembles a tiny ROM, runs it on the core
+ * the tree was built for and checks what it left in memory, so the same test covers every CORE/JIT/LAZY_FLAGS build
+ */
+
+/*
+ * @brief Clears a ROM image to NOPs and fills in the header, with the entry point jumping to TESTROM_CODE
+ * @param rom ROM image
+ * @param title Cartridge title, up to 16 characters
+ * @return void
+ */
+void testRomInit(testRom_t* rom, const char* title)
+{
+	const uint8_t entry[] = { 0x00, 0xC3, TESTROM_CODE & 0xFF, TESTROM_CODE >> 8 }; // NOP / JP TESTROM_CODE
+
+	memset(rom->data, 0x00, sizeof(rom->data));
+	testRomPut(rom, ADDR_ENTRY_START, entry, sizeof(entry));
+	strncpy((char*)&rom->data[ADDR_TITLE_START], title, CART_TITLE_SIZE);
+}
+
+/*
+ * @brief Copies code into a ROM image
+ * @param rom ROM image
+ * @param addr Address to place it at
+ * @param code Code to copy
+ * @param size Size of code in bytes
+ * @return void
+ */
+void testRomPut(testRom_t* rom, uint16_t addr, const uint8_t* code, size_t size)
+{
+	if((addr + size) > sizeof(rom->data))
+	{
+		printf("Test ROM overflow at %#06x\r\n", addr);
+		exit(1);
+	}
+	memcpy(&rom->data[addr], code, size);
+}
+
+/*
+ * @brief Writes the header checksum, then loads the image into a gb struct through a temporary file
+ * @param rom ROM image
+ * @param gb Pointer to gb struct, already initialised
+ * @return void
+ */
+void testRomLoad(testRom_t* rom, gameBoy_t* gb)
+{
+	char path[] = "/tmp/felixGB-test-XXXXXX";
+	uint8_t checksum = 0;
+	FILE* file = NULL;
+	int fd = mkstemp(path);
+
+	for(uint16_t addr = ADDR_TITLE_START; addr < ADDR_HEADER_CHECKSUM; addr++)
+	{
+		checksum = checksum - rom->data[addr] - 1;
+	}
+	rom->data[ADDR_HEADER_CHECKSUM] = checksum;
+
+	if((fd < 0) || ((file = fdopen(fd, "wb")) == NULL))
+	{
+		printf("Test ROM file error\r\n");
+		exit(1);
+	}
+	fwrite(rom->data, 1, sizeof(rom->data), file);
+	fclose(file);
+
+	// The file is mapped (see cartRomAcquire), so it can go as soon as it's loaded
+	cartLoadRom(gb, path);
+	unlink(path);
+}
+
+/*
+ * @brief Prints the outcome of one check
+ * @param name What was checked
+ * @param failed Number of checks failed so far
+ * @param value Value found
+ * @param expected Value expected
+ * @return failed, plus 1 if this check failed
+ */
+int testCheck(const char* name, int failed, uint32_t value, uint32_t expected)
+{
+	if(value != expected)
+	{
+		printf("FAIL %s: %#x, expected %#x\r\n", name, value, expected);
+		return failed + 1;
+	}
+	printf("ok   %s\r\n", name);
+	return failed;
+}
@@ -0,0 +1,25 @@
+#include <stdint.h>
+#include <stddef.h>
+#include "gb.h"
+
+#ifndef TESTROM_H
+#define TESTROM_H
+
+// Size of the ROM only (no MBC) image tests build, the most such a cart can hold
+#define TESTROM_SIZE 		0x8000
+// Address the code each test runs starts at. The entry point jumps here
+#define TESTROM_CODE 		0x0150
+
+// A ROM image assembled by hand, with a header good enough for cartLoadRom
+typedef struct
+{
+	uint8_t data[TESTROM_SIZE];
+} testRom_t;
+
+// Function prototypes
+void testRomInit(testRom_t* rom, const char* title);
+void testRomPut(testRom_t* rom, uint16_t addr, const uint8_t* code, size_t size);
+void testRomLoad(testRom_t* rom, gameBoy_t* gb);
+int testCheck(const char* name, int failed, uint32_t value, uint32_t expected);
+
+#endif // TESTROM_H